@@ -16,7 +16,6 @@
 #include <TBenchmark.h> // TBenchmark
 #include <TString.h> // TString, Form
 #include <TError.h> // gErrorAbortLevel, kError
-#include <TRandom3.h> // TRandom3
 #include <TLorentzVector.h> // TLorentzVector 
 #include <TMatrixD.h> // TMatrixD
 
@@ -30,8 +29,6 @@
 #include "tthAnalysis/HiggsToTauTau/interface/GenJetCollectionSelector.h" // GenJetCollectionSelector
 #include "tthAnalysis/HiggsToTauTau/interface/LHEInfoReader.h" // LHEInfoReader
 #include "tthAnalysis/HiggsToTauTau/interface/EventInfoReader.h" // EventInfoReader
-#include "tthAnalysis/HiggsToTauTau/interface/convert_to_ptrs.h" // convert_to_ptrs
-#include "tthAnalysis/HiggsToTauTau/interface/ParticleCollectionCleaner.h" // GenJetCollectionCleaner
 #include "tthAnalysis/HiggsToTauTau/interface/RunLumiEventSelector.h" // RunLumiEventSelector
 #include "tthAnalysis/HiggsToTauTau/interface/CutFlowTableHistManager.h" // CutFlowTableHistManager
 #include "tthAnalysis/HiggsToTauTau/interface/WeightHistManager.h" // WeightHistManager
@@ -41,7 +38,6 @@
 #include "tthAnalysis/HiggsToTauTau/interface/analysisAuxFunctions.h" // isHigherPt, isMatched, contains, findFile
 #include "tthAnalysis/HiggsToTauTau/interface/generalAuxFunctions.h" // format_vstring
 #include "tthAnalysis/HiggsToTauTau/interface/cutFlowTable.h" // cutFlowTableType
-#include "tthAnalysis/HiggsToTauTau/interface/TTreeWrapper.h" // TTreeWrapper
 #include "tthAnalysis/HiggsToTauTau/interface/hltFilter.h" // hltFilter()
 
 #include <boost/math/special_functions/sign.hpp> // boost::math::sign()
@@ -51,11 +47,20 @@
 #include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoDilepton.h"
 #include "hhAnalysis/bbwwMEM/interface/MeasuredParticle.h" // MeasuredParticle
 #include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h"
-#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/BJetTF_toy.h" // BJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwAlgoPool.h" // MEMbbwwAlgoPoolDilepton
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwProcessPool.h" // MEMbbwwProcessPool
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwTimingManager.h" // MEMbbwwTimingManager, MEMbbwwScopedTimer
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwCheckpointManager.h" // MEMbbwwCheckpointManager, MEMbbwwCheckpointState
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwResultCache.h" // MEMbbwwResultCache
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenEventSkim.h" // GenEventSkimReader, GenEventSkimWriter
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwInputTree.h" // MEMbbwwInputTree
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/selEntryIndexAuxFunctions.h" // getSelEntryRange, commitOutputFile
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/eventLoopAuxFunctions.h" // convert_to_ptrs, cleanCollection, selectCollection
 #include "hhAnalysis/bbww/interface/genMatchingAuxFunctions.h" // findGenLepton_and_NeutrinoFromWBoson
 #include "tthAnalysis/HiggsToTauTau/interface/histogramAuxFunctions.h" // fillWithOverFlow()
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenJetSmearer.h" // GenJetSmearer
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenMEtSmearer.h" // GenMEtSmearer
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/CounterBasedRandom.h" // CounterBasedRandom
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent_dilepton.h" // MEMEvent_dilepton
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwNtupleManager_dilepton.h" // MEMbbwwNtupleManager_dilepton
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/memNtupleAuxFunctions_dilepton.h" // addGenMatches_dilepton
@@ -67,6 +72,8 @@
 #include <vector> // std::vector<>
 #include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
 #include <fstream> // std::ofstream
+#include <deque> // std::deque<>
+#include <algorithm> // std::max(), std::find()
 #include <assert.h> // assert
 
 typedef math::PtEtaPhiMLorentzVector LV;
@@ -83,9 +90,10 @@ int main(int argc, char* argv[])
 
 //--- parse command-line arguments
   if ( argc < 2 ) {
-    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    std::cout << "Usage: " << argv[0] << " [parameters.py] [--resume]" << std::endl;
     return EXIT_FAILURE;
   }
+  bool resume = ( argc >= 3 && std::string(argv[2]) == "--resume" );
 
   std::cout << "<analyze_hh_bbwwMEM_dilepton>:" << std::endl;
 
@@ -129,8 +137,6 @@ int main(int argc, char* argv[])
   double jetSmearing_coeff = cfg_analyze.getParameter<double>("jetSmearing_coeff");
   GenJetSmearer genJetSmearer;
   genJetSmearer.set_coeff(jetSmearing_coeff);
-  mem::BJetTF_toy bjetTF;
-  bjetTF.set_coeff(jetSmearing_coeff);
 
   bool apply_metSmearing = cfg_analyze.getParameter<bool>("apply_metSmearing");
   double metSmearing_sigmaX = cfg_analyze.getParameter<double>("metSmearing_sigmaX");
@@ -138,6 +144,27 @@ int main(int argc, char* argv[])
   GenMEtSmearer genMEtSmearer;
   genMEtSmearer.set_sigmaX(metSmearing_sigmaX);
   genMEtSmearer.set_sigmaY(metSmearing_sigmaY);
+
+  // random numbers are computed from (seed, run, lumi, event, object index),
+  // so that the result of the smearing and of the choice of fake b-jets does not depend on how events are split into jobs;
+  // different seeds are used for jet smearing, MET smearing and for choosing fake b-jets, so that these random numbers are uncorrelated
+  unsigned randomSeed = cfg_analyze.getParameter<unsigned>("randomSeed");
+  genJetSmearer.set_seed(randomSeed + 1);
+  genMEtSmearer.set_seed(randomSeed + 2);
+
+//--- process several smearing variants (e.g. jet and MET smearing enabled or disabled) in the same job,
+//    so that the input files are read and the generator-level selection is run only once per event.
+//    Each variant has its own histogram directory and MEM ntuples.
+//    If no variants are configured, the smearing is applied according to apply_jetSmearing and apply_metSmearing
+  edm::VParameterSet cfg_smearingVariants = cfg_analyze.getParameter<edm::VParameterSet>("smearingVariants");
+  if ( cfg_smearingVariants.empty() ) {
+    edm::ParameterSet cfg_smearingVariant;
+    cfg_smearingVariant.addParameter<bool>("apply_jetSmearing", apply_jetSmearing);
+    cfg_smearingVariant.addParameter<bool>("apply_metSmearing", apply_metSmearing);
+    cfg_smearingVariant.addParameter<std::string>("histogramDir", histogramDir);
+    cfg_smearingVariants.push_back(cfg_smearingVariant);
+  }
+
   TMatrixD metCov(2,2);
   metCov[0][0] = mem::square(metSmearing_sigmaX);
   metCov[1][0] = 0.;
@@ -146,10 +173,6 @@ int main(int argc, char* argv[])
 
   double genBJet_pFake = cfg_analyze.getParameter<double>("genBJet_pFake");
 
-  // random number generator for choosing fake b-jets
-  TRandom3 rnd;
-  rnd.SetSeed(12345);
-
   const std::string central_or_shift = "central";
   bool hasLHE = cfg_analyze.getParameter<bool>("hasLHE");
   bool apply_genWeight = cfg_analyze.getParameter<bool>("apply_genWeight");
@@ -172,62 +195,139 @@ int main(int argc, char* argv[])
   fwlite::InputSource inputFiles(cfg);
   int maxEvents = inputFiles.maxEvents();
   std::cout << " maxEvents = " << maxEvents << std::endl;
-  int skipSelEvents = cfg_analyze.getParameter<int>("skipSelEvents");
-  std::cout << " skipSelEvents = " << skipSelEvents << std::endl;
   int maxSelEvents = cfg_analyze.getParameter<int>("maxSelEvents");
   std::cout << " maxSelEvents = " << maxSelEvents << std::endl;
-  unsigned reportEvery = inputFiles.reportAfter();
+
+  // process only the range [firstSelEntry, lastSelEntry) of entries in the input files:
+  // the range boundaries are taken from the index of entries passing the generator-level selection,
+  // which is written by running the analyzer with makeSelEntryIndex = True.
+  // In case selEntryRangeIdx >= 0, the range is read from the index file at the start of the job
+  // and contains the selected entries selEntryRangeIdx*maxSelEvents, ..., (selEntryRangeIdx + 1)*maxSelEvents - 1.
+  // Entries outside of the range are not read at all (see MEMbbwwInputTree::setFirstEntry and GenEventSkimReader::setFirstEntry)
+  Long64_t firstSelEntry = cfg_analyze.getParameter<int>("firstSelEntry");
+  Long64_t lastSelEntry = cfg_analyze.getParameter<int>("lastSelEntry");
+  bool makeSelEntryIndex = cfg_analyze.getParameter<bool>("makeSelEntryIndex");
+  std::string selEntryIndexFileName = cfg_analyze.getParameter<std::string>("selEntryIndexFileName");
+  std::cout << " makeSelEntryIndex = " << makeSelEntryIndex << " (selEntryIndexFileName = " << selEntryIndexFileName << ")" << std::endl;
+  int selEntryRangeIdx = cfg_analyze.getParameter<int>("selEntryRangeIdx");
+  std::cout << " selEntryRangeIdx = " << selEntryRangeIdx << std::endl;
+  if ( selEntryRangeIdx >= 0 ) {
+    if ( makeSelEntryIndex || selEntryIndexFileName == "" || maxSelEvents <= 0 )
+      throw cms::Exception("analyze_hh_bbwwMEM_dilepton")
+        << "Configuration parameter 'selEntryRangeIdx' requires 'selEntryIndexFileName' and 'maxSelEvents' > 0, and cannot be used together with 'makeSelEntryIndex' !!\n";
+    getSelEntryRange(selEntryIndexFileName, selEntryRangeIdx, maxSelEvents, firstSelEntry, lastSelEntry);
+  }
+  std::cout << " firstSelEntry = " << firstSelEntry << std::endl;
+  std::cout << " lastSelEntry = " << lastSelEntry << std::endl;
+  if ( lastSelEntry >= 0 && (maxEvents < 0 || lastSelEntry < maxEvents) ) {
+    maxEvents = lastSelEntry;
+  }
 
   fwlite::OutputFiles outputFile(cfg);
+
+  // write a checkpoint every 'checkpointInterval' selected events, so that a pre-empted job can be resumed
+  // by running the analyzer again with the option --resume on the command-line
+  int checkpointInterval = cfg_analyze.getParameter<int>("checkpointInterval");
+  std::cout << " checkpointInterval = " << checkpointInterval << " (resume = " << resume << ")" << std::endl;
+  MEMbbwwCheckpointManager checkpointManager(outputFile.file(), checkpointInterval, resume);
+  const MEMbbwwCheckpointState & checkpointState_resumed = checkpointManager.getState_resumed();
+  if ( checkpointManager.isResumed() && checkpointState_resumed.nextEntry_ > firstSelEntry ) {
+    firstSelEntry = checkpointState_resumed.nextEntry_;
+  }
+
+  // the index and skim files are written under a temporary name and renamed at the end of the job (see commitOutputFile)
+  std::ofstream* selEntryIndexFile = nullptr;
+  if ( makeSelEntryIndex ) {
+    if ( selEntryIndexFileName == "" )
+      throw cms::Exception("analyze_hh_bbwwMEM_dilepton")
+        << "Configuration parameter 'selEntryIndexFileName' not defined !!\n";
+    selEntryIndexFile = checkpointManager.openOutputFile(selEntryIndexFileName + ".tmp", std::ios::out | std::ios::binary, checkpointState_resumed.selEntryIndexFileSize_);
+  }
+
+//--- write the generator-level objects, weights and event identifiers of events passing the generator-level selection
+//    to a compact skim file, which can be read instead of the Ntuples by running the analyzer with skimFileName_input
+  std::string skimFileName_output = cfg_analyze.getParameter<std::string>("skimFileName_output");
+  std::cout << " skimFileName_output = " << skimFileName_output << std::endl;
+  GenEventSkimWriter* skimWriter = nullptr;
+  if ( skimFileName_output != "" ) {
+    skimWriter = new GenEventSkimWriter(skimFileName_output + ".tmp");
+  }
+  std::string skimFileName_input = cfg_analyze.getParameter<std::string>("skimFileName_input");
+  std::cout << " skimFileName_input = " << skimFileName_input << std::endl;
+  if ( skimFileName_input != "" && (skimWriter || selEntryIndexFile) )
+    throw cms::Exception("analyze_hh_bbwwMEM_dilepton")
+      << "Configuration parameter 'skimFileName_input' cannot be used together with 'skimFileName_output' or 'makeSelEntryIndex' !!\n";
+  // the histograms of generator-level particles and LHE weights need the full collections of generator-level particles and the LHE weights,
+  // which are read from the Ntuples and are not stored in the skim file
+  bool fillGenHistograms = cfg_analyze.getParameter<bool>("fillGenHistograms");
+  std::cout << " fillGenHistograms = " << fillGenHistograms << std::endl;
+  if ( skimFileName_input != "" && fillGenHistograms )
+    throw cms::Exception("analyze_hh_bbwwMEM_dilepton")
+      << "Histograms of generator-level particles and LHE weights cannot be filled from skim file = " << skimFileName_input << ","
+      << " set configuration parameter 'fillGenHistograms' to False !!\n";
+  unsigned reportEvery = inputFiles.reportAfter();
+
   fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
 
-  TTreeWrapper* inputTree = new TTreeWrapper(treeName.data(), inputFiles.files(), maxEvents);
-  std::cout << "Loaded " << inputTree->getFileCount() << " file(s)." << std::endl;
+  // the Ntuples are not opened in case the events are read from a skim file
+  MEMbbwwInputTree* inputTree = nullptr;
+  if ( skimFileName_input == "" ) {
+    inputTree = new MEMbbwwInputTree(treeName.data(), inputFiles.files(), maxEvents);
+    inputTree->setFirstEntry(firstSelEntry);
+    std::cout << "Loaded " << inputTree->getFileCount() << " file(s)." << std::endl;
+  }
 
 //--- declare event-level variables
   EventInfo eventInfo(analysisConfig);
   EventInfoReader eventInfoReader(&eventInfo);
-  inputTree->registerReader(&eventInfoReader);
+  GenEventSkimReader* skimReader = nullptr;
+  if ( inputTree ) {
+    inputTree->registerReader(&eventInfoReader);
+  } else {
+    skimReader = new GenEventSkimReader(skimFileName_input, maxEvents, &eventInfo);
+    skimReader->setFirstEntry(firstSelEntry);
+    std::cout << "Loaded " << skimReader->numEvents() << " event(s) from skim file." << std::endl;
+  }
 
 //--- declare collections of generator-level particles
   GenLeptonReader* genLeptonReader = nullptr;
   if ( branchName_genLeptons != "" ) {
     genLeptonReader = new GenLeptonReader(branchName_genLeptons);
-    inputTree->registerReader(genLeptonReader);
+    if ( inputTree ) inputTree->registerReader(genLeptonReader);
   }
   GenParticleReader* genNeutrinoReader = nullptr;
   if ( branchName_genNeutrinos != "" ) {
     genNeutrinoReader = new GenParticleReader(branchName_genNeutrinos);
-    inputTree->registerReader(genNeutrinoReader);
+    if ( inputTree ) inputTree->registerReader(genNeutrinoReader);
   }
   GenJetReader* genJetReader = nullptr;
   if ( branchName_genJets != "" ) {
     genJetReader = new GenJetReader(branchName_genJets);
-    inputTree->registerReader(genJetReader);
+    if ( inputTree ) inputTree->registerReader(genJetReader);
   }
     
   // collections specific to HH signal
   GenParticleReader* genParticleFromHiggsReader = nullptr;
   if ( branchName_genParticlesFromHiggs != "" ) {
     genParticleFromHiggsReader = new GenParticleReader(branchName_genParticlesFromHiggs);
-    inputTree->registerReader(genParticleFromHiggsReader);
+    if ( inputTree ) inputTree->registerReader(genParticleFromHiggsReader);
   }
 
   // collections specific to ttbar background
   GenLeptonReader* genLeptonFromTopReader = nullptr;
   if ( branchName_genLeptonsFromTop != "" ) {
     genLeptonFromTopReader = new GenLeptonReader(branchName_genLeptonsFromTop);
-    inputTree->registerReader(genLeptonFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genLeptonFromTopReader);
   }
   GenParticleReader* genNeutrinoFromTopReader = nullptr;
   if ( branchName_genNeutrinosFromTop != "" ) {
     genNeutrinoFromTopReader = new GenParticleReader(branchName_genNeutrinosFromTop);
-    inputTree->registerReader(genNeutrinoFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genNeutrinoFromTopReader);
   }
   GenParticleReader* genBQuarksFromTopReader = nullptr;
   if ( branchName_genBQuarksFromTop != "" ) {
     genBQuarksFromTopReader = new GenParticleReader(branchName_genBQuarksFromTop);
-    inputTree->registerReader(genBQuarksFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genBQuarksFromTopReader);
   }
 
   GenLeptonCollectionSelector genLeptonSelector(era, -1, isDEBUG);
@@ -237,24 +337,18 @@ int main(int argc, char* argv[])
   GenJetCollectionSelector genJetSelector(era, -1, isDEBUG);
   genJetSelector.getSelector().set_min_pt(20.);
   genJetSelector.getSelector().set_max_absEta(2.4);
-  GenJetCollectionCleaner genJetCleaner(0.4, isDEBUG);
+  // generator-level jets are required to be separated by dR >= 0.4 from the generator-level leptons and b-jets
+  const double genJetCleaning_dRmin = 0.4;
 
 //--- declare other generator level information
   LHEInfoReader* lheInfoReader = new LHEInfoReader(hasLHE);
-  inputTree->registerReader(lheInfoReader);
+  if ( inputTree ) inputTree->registerReader(lheInfoReader);
 
 //--- open output file containing run:lumi:event numbers of events passing final event selection criteria
-  std::ostream* selEventsFile = ( selEventsFileName_output != "" ) ? new std::ofstream(selEventsFileName_output.data(), std::ios::out) : 0;
+  std::ostream* selEventsFile = ( selEventsFileName_output != "" ) ? checkpointManager.openOutputFile(selEventsFileName_output, std::ios::out, checkpointState_resumed.selEventsFileSize_) : 0;
   std::cout << "selEventsFileName_output = " << selEventsFileName_output << std::endl;
 
 //--- declare histograms
-  GenEvtHistManager* genEvtHistManager_beforeCuts = new GenEvtHistManager(makeHistManager_cfg(process_string,
-    Form("%s/unbiased/genEvt", histogramDir.data()), era_string, central_or_shift));
-  genEvtHistManager_beforeCuts->bookHistograms(fs);
-  LHEInfoHistManager* lheInfoHistManager_beforeCuts = new LHEInfoHistManager(makeHistManager_cfg(process_string,
-    Form("%s/unbiased/lheInfo", histogramDir.data()), era_string, central_or_shift));
-  lheInfoHistManager_beforeCuts->bookHistograms(fs);
-  
   struct selHistManagerType
   {
     MEMbbwwHistManagerDilepton* mem_2genuineBJets_;
@@ -269,59 +363,28 @@ int main(int argc, char* argv[])
     LHEInfoHistManager* lheInfoHistManager_afterCuts_;
     WeightHistManager* weights_;
   };
-  selHistManagerType* selHistManager = new selHistManagerType();
-  selHistManager->mem_2genuineBJets_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_2genuineBJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_2genuineBJets_->bookHistograms(fs);
-  selHistManager->evt_2genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/evt_2genuineBJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->evt_2genuineBJets_->bookHistograms(fs);
-  selHistManager->mem_1genuineBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_1genuineBJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_1genuineBJet_->bookHistograms(fs);
-  selHistManager->evt_1genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/evt_1genuineBJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->evt_1genuineBJets_->bookHistograms(fs);
-  selHistManager->mem_0genuineBJets_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_0genuineBJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_0genuineBJets_->bookHistograms(fs);
-  selHistManager->evt_0genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/evt_0genuineBJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->evt_0genuineBJets_->bookHistograms(fs);
-  selHistManager->mem_missingBJet_genuineBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBJet_genuineBJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBJet_genuineBJet_->bookHistograms(fs);
-  selHistManager->mem_missingBJet_fakeBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBJet_fakeBJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBJet_fakeBJet_->bookHistograms(fs);
-  selHistManager->genEvtHistManager_afterCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/genEvt", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->genEvtHistManager_afterCuts_->bookHistograms(fs);
-  selHistManager->lheInfoHistManager_afterCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/lheInfo", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->lheInfoHistManager_afterCuts_->bookHistograms(fs);
-  selHistManager->weights_ = new WeightHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/weights", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->weights_->bookHistograms(fs, { "genWeight", "pileupWeight" });
 
-  std::string ntupleDir = Form("%s/ntuples/%s", histogramDir.data(), process_string.data());
-  MEMbbwwNtupleManager_dilepton* mem_ntuple = new MEMbbwwNtupleManager_dilepton(ntupleDir, "mem");
-  mem_ntuple->makeTree(fs);
-  mem_ntuple->initializeBranches();
-  MEMbbwwNtupleManager_dilepton* mem_ntuple_missingBJet = new MEMbbwwNtupleManager_dilepton(ntupleDir, "mem_missingBJet");
-  mem_ntuple_missingBJet->makeTree(fs);
-  mem_ntuple_missingBJet->initializeBranches();
-
-  int analyzedEntries = 0;
-  int skippedEntries = 0;
-  int selectedEntries = 0;
-  double selectedEntries_weighted = 0.;
-  TH1* histogram_analyzedEntries = fs.make<TH1D>("analyzedEntries", "analyzedEntries", 1, -0.5, +0.5);
-  TH1* histogram_selectedEntries = fs.make<TH1D>("selectedEntries", "selectedEntries", 1, -0.5, +0.5);
-  cutFlowTableType cutFlowTable;
-  const edm::ParameterSet cutFlowTableCfg = makeHistManager_cfg(
-    process_string, Form("%s/sel/cutFlow", histogramDir.data()), era_string, central_or_shift
-  );
+  struct smearingVariantType
+  {
+    // return true once maxSelEvents events have been selected for this variant
+    bool isDone(int maxSelEvents) const
+    {
+      return maxSelEvents >= 0 && selectedEntries_ >= maxSelEvents;
+    }
+    bool apply_jetSmearing_;
+    bool apply_metSmearing_;
+    std::string histogramDir_;
+    GenEvtHistManager* genEvtHistManager_beforeCuts_;
+    LHEInfoHistManager* lheInfoHistManager_beforeCuts_;
+    selHistManagerType* selHistManager_;
+    MEMbbwwNtupleManager_dilepton* mem_ntuple_;
+    MEMbbwwNtupleManager_dilepton* mem_ntuple_missingBJet_;
+    cutFlowTableType cutFlowTable_;
+    CutFlowTableHistManager* cutFlowHistManager_;
+    int selectedEntries_;
+    double selectedEntries_weighted_;
+  };
+
   const std::vector<std::string> cuts = {
     "run:ls:event selection",
     ">= 2 gen leptons",
@@ -331,498 +394,853 @@ int main(int argc, char* argv[])
     "m(ll) < 76 GeV",
     "m(ll) > 12 GeV"
   };
-  CutFlowTableHistManager * cutFlowHistManager = new CutFlowTableHistManager(cutFlowTableCfg, cuts);
-  cutFlowHistManager->bookHistograms(fs);
-  while ( inputTree->hasNextEvent() && (! run_lumi_eventSelector || (run_lumi_eventSelector && ! run_lumi_eventSelector -> areWeDone())) && selectedEntries < maxSelEvents ) {
-    if ( inputTree -> canReport(reportEvery) ) {
+
+  if ( checkpointManager.isResumed() && checkpointState_resumed.selectedEntries_variant_.size() != cfg_smearingVariants.size() )
+    throw cms::Exception("analyze_hh_bbwwMEM_dilepton")
+      << "Number of smearing variants stored in checkpoint = " << checkpointState_resumed.selectedEntries_variant_.size()
+      << " does not match number of smearing variants in configuration = " << cfg_smearingVariants.size() << " !!\n";
+
+  MEMbbwwNtupleWriteOptions memNtupleWriteOptions(cfg_analyze.getParameter<edm::ParameterSet>("memNtupleWriteOptions"));
+  bool useSparseHistograms = cfg_analyze.getParameter<bool>("useSparseHistograms");
+
+  std::vector<smearingVariantType*> smearingVariants;
+  for ( size_t idxVariant = 0; idxVariant < cfg_smearingVariants.size(); ++idxVariant ) {
+    const edm::ParameterSet& cfg_smearingVariant = cfg_smearingVariants[idxVariant];
+    smearingVariantType* smearingVariant = new smearingVariantType();
+    smearingVariant->apply_jetSmearing_ = cfg_smearingVariant.getParameter<bool>("apply_jetSmearing");
+    smearingVariant->apply_metSmearing_ = cfg_smearingVariant.getParameter<bool>("apply_metSmearing");
+    smearingVariant->histogramDir_ = cfg_smearingVariant.getParameter<std::string>("histogramDir");
+    std::cout << " smearing variant #" << idxVariant << ": apply_jetSmearing = " << smearingVariant->apply_jetSmearing_ << ","
+              << " apply_metSmearing = " << smearingVariant->apply_metSmearing_ << " (histogramDir = " << smearingVariant->histogramDir_ << ")" << std::endl;
+
+    smearingVariant->genEvtHistManager_beforeCuts_ = nullptr;
+    smearingVariant->lheInfoHistManager_beforeCuts_ = nullptr;
+    if ( fillGenHistograms ) {
+      smearingVariant->genEvtHistManager_beforeCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
+        Form("%s/unbiased/genEvt", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      smearingVariant->genEvtHistManager_beforeCuts_->bookHistograms(fs);
+      smearingVariant->lheInfoHistManager_beforeCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
+        Form("%s/unbiased/lheInfo", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      smearingVariant->lheInfoHistManager_beforeCuts_->bookHistograms(fs);
+    }
+
+    selHistManagerType* selHistManager = new selHistManagerType();
+    selHistManager->mem_2genuineBJets_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_2genuineBJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_2genuineBJets_->bookHistograms(fs);
+    selHistManager->evt_2genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/evt_2genuineBJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+    selHistManager->evt_2genuineBJets_->bookHistograms(fs);
+    selHistManager->mem_1genuineBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_1genuineBJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_1genuineBJet_->bookHistograms(fs);
+    selHistManager->evt_1genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/evt_1genuineBJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+    selHistManager->evt_1genuineBJets_->bookHistograms(fs);
+    selHistManager->mem_0genuineBJets_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_0genuineBJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_0genuineBJets_->bookHistograms(fs);
+    selHistManager->evt_0genuineBJets_ = new EventHistManager_dilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/evt_0genuineBJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+    selHistManager->evt_0genuineBJets_->bookHistograms(fs);
+    selHistManager->mem_missingBJet_genuineBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBJet_genuineBJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBJet_genuineBJet_->bookHistograms(fs);
+    selHistManager->mem_missingBJet_fakeBJet_ = new MEMbbwwHistManagerDilepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBJet_fakeBJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBJet_fakeBJet_->bookHistograms(fs);
+    selHistManager->genEvtHistManager_afterCuts_ = nullptr;
+    selHistManager->lheInfoHistManager_afterCuts_ = nullptr;
+    if ( fillGenHistograms ) {
+      selHistManager->genEvtHistManager_afterCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
+        Form("%s/sel/genEvt", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      selHistManager->genEvtHistManager_afterCuts_->bookHistograms(fs);
+      selHistManager->lheInfoHistManager_afterCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
+        Form("%s/sel/lheInfo", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      selHistManager->lheInfoHistManager_afterCuts_->bookHistograms(fs);
+    }
+    selHistManager->weights_ = new WeightHistManager(makeHistManager_cfg(process_string,
+      Form("%s/sel/weights", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+    selHistManager->weights_->bookHistograms(fs, { "genWeight", "pileupWeight" });
+    smearingVariant->selHistManager_ = selHistManager;
+
+    std::string ntupleDir = Form("%s/ntuples/%s", smearingVariant->histogramDir_.data(), process_string.data());
+    smearingVariant->mem_ntuple_ = new MEMbbwwNtupleManager_dilepton(ntupleDir, "mem");
+    smearingVariant->mem_ntuple_->makeTree(fs);
+    smearingVariant->mem_ntuple_->initializeBranches(memNtupleWriteOptions);
+    smearingVariant->mem_ntuple_missingBJet_ = new MEMbbwwNtupleManager_dilepton(ntupleDir, "mem_missingBJet");
+    smearingVariant->mem_ntuple_missingBJet_->makeTree(fs);
+    smearingVariant->mem_ntuple_missingBJet_->initializeBranches(memNtupleWriteOptions);
+
+    const edm::ParameterSet cutFlowTableCfg = makeHistManager_cfg(
+      process_string, Form("%s/sel/cutFlow", smearingVariant->histogramDir_.data()), era_string, central_or_shift
+    );
+    smearingVariant->cutFlowHistManager_ = new CutFlowTableHistManager(cutFlowTableCfg, cuts);
+    smearingVariant->cutFlowHistManager_->bookHistograms(fs);
+
+    if ( checkpointManager.isResumed() ) {
+      smearingVariant->selectedEntries_ = checkpointState_resumed.selectedEntries_variant_[idxVariant];
+      smearingVariant->selectedEntries_weighted_ = checkpointState_resumed.selectedEntries_weighted_variant_[idxVariant];
+    } else {
+      smearingVariant->selectedEntries_ = 0;
+      smearingVariant->selectedEntries_weighted_ = 0.;
+    }
+    smearingVariants.push_back(smearingVariant);
+  }
+
+  // the timing information is stored once per job, in the ntuple directory of the job-level histogramDir
+  std::string ntupleDir = Form("%s/ntuples/%s", histogramDir.data(), process_string.data());
+
+//--- create MEM algorithm instances once per job (instead of once per event)
+  MEMbbwwAlgoConfig memAlgoConfig;
+  memAlgoConfig.sqrtS_ = 13.e+3;
+  memAlgoConfig.pdfName_ = "MSTW2008lo68cl";
+  memAlgoConfig.madgraphFileName_signal_ = "hhAnalysis/bbwwMEM/data/param_hh_SM.dat";
+  memAlgoConfig.madgraphFileName_background_ = "hhAnalysis/bbwwMEM/data/param_ttbar.dat";
+  memAlgoConfig.applyOnshellWmassConstraint_signal_ = false;
+  memAlgoConfig.intMode_ = MEMbbwwAlgoDilepton::kVAMP;
+  memAlgoConfig.maxObjFunctionCalls_signal_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal");
+  memAlgoConfig.maxObjFunctionCalls_background_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background");
+  memAlgoConfig.maxObjFunctionCalls_inactive_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_inactive");
+  memAlgoConfig.memLRerrTarget_ = cfg_analyze.getParameter<double>("memLRerrTarget");
+  memAlgoConfig.maxObjFunctionCalls_signal_initial_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal_initial");
+  memAlgoConfig.maxObjFunctionCalls_background_initial_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background_initial");
+  memAlgoConfig.maxObjFunctionCalls_signal_max_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal_max");
+  memAlgoConfig.maxObjFunctionCalls_background_max_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background_max");
+  std::cout << " maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_ << ","
+            << " background = " << memAlgoConfig.maxObjFunctionCalls_background_ << std::endl;
+  if ( memAlgoConfig.memLRerrTarget_ > 0. ) {
+    std::cout << " adaptive integration: memLRerrTarget = " << memAlgoConfig.memLRerrTarget_ << ","
+              << " initial maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_initial_ << ","
+              << " background = " << memAlgoConfig.maxObjFunctionCalls_background_initial_ << ","
+              << " max. maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_max_ << ","
+              << " background = " << memAlgoConfig.maxObjFunctionCalls_background_max_ << std::endl;
+  }
+  memAlgoConfig.jetSmearing_coeff_ = jetSmearing_coeff;
+  memAlgoConfig.verbosity_ = 0;
+  MEMbbwwAlgoPoolDilepton memAlgoPool(memAlgoConfig);
+
+//--- measure wall-clock and CPU time spent in the different phases of the event processing
+  MEMbbwwTimingManager timingManager(ntupleDir, "timing");
+  memAlgoPool.setTimingManager(&timingManager);
+  if ( checkpointManager.isResumed() ) {
+    // add the times spent before the last checkpoint, so that the timing summary covers the whole job
+    for ( size_t idxPhase = 0; idxPhase < checkpointState_resumed.timingPhases_.size(); ++idxPhase ) {
+      timingManager.addTotals(checkpointState_resumed.timingPhases_[idxPhase].data(), checkpointState_resumed.timingNumCalls_[idxPhase],
+        checkpointState_resumed.timingWallTimes_[idxPhase], checkpointState_resumed.timingCpuTimes_[idxPhase]);
+    }
+  }
+
+//--- take MEM results from an on-disk cache in case the same inputs have been integrated by a previous job
+  std::string memResultCacheDir = cfg_analyze.getParameter<std::string>("memResultCacheDir");
+  std::cout << " memResultCacheDir = " << memResultCacheDir << std::endl;
+  MEMbbwwResultCache* memResultCache = nullptr;
+  if ( memResultCacheDir != "" ) {
+    memResultCache = new MEMbbwwResultCache(memResultCacheDir);
+    memAlgoPool.setResultCache(memResultCache);
+  }
+
+//--- run MEM integrations in numProcesses worker processes, while events are read and selected by the main process.
+//    The MEM ntuples and histograms are filled by the main process, in the order in which the events are read.
+//    The MEM algorithms share global state between instances, so integrations can only run concurrently in separate processes.
+//    The worker processes are forked when the MEMbbwwProcessPool is created,
+//    so the pool needs to be created once the MEM algorithm pool, the timing manager and the result cache are set up.
+//    Use test/checkProcessInvariance.sh to check that the output does not depend on the number of processes.
+//    If parallelHypotheses is enabled, the integrations for the different hypotheses (full, missing jet cases)
+//    of the same event are sent to different worker processes, which reduces the wall-clock time per event in case there are idle cores.
+  unsigned numProcesses = cfg_analyze.getParameter<unsigned>("numProcesses");
+  std::cout << " numProcesses = " << numProcesses << std::endl;
+  bool parallelHypotheses = cfg_analyze.getParameter<bool>("parallelHypotheses");
+  std::cout << " parallelHypotheses = " << parallelHypotheses << std::endl;
+  MEMbbwwProcessPool memProcessPool(numProcesses, [&memAlgoPool](const std::string & request, std::string & response) {
+    memAlgoPool.process<MEMbbwwResultDilepton>(request, response);
+  }, &timingManager);
+  const size_t maxMemTasks = std::max(1u, 4*memProcessPool.numProcesses());
+
+  struct memTaskType
+  {
+    memTaskType(MEMbbwwAlgoPoolDilepton & memAlgoPool, MEMbbwwProcessPool & memProcessPool)
+      : smearingVariant_(nullptr)
+      , measuredMEtPx_(0.)
+      , measuredMEtPy_(0.)
+      , numGenuineBJets_(0)
+      , numGenuineBJets_missingBJet_(0)
+      , mbb_(0.)
+      , mll_(0.)
+      , evtWeight_(1.)
+      , memRequest_(memAlgoPool, memProcessPool)
+    {}
+    // reset the task for the next event, keeping the memory of its collections and of its MEM request
+    void clear()
+    {
+      smearingVariant_ = nullptr;
+      memMeasuredParticles_.clear();
+      memEvent_ = MEMEvent_dilepton();
+      memResult_ = MEMbbwwResultDilepton();
+      memStats_ = MEMbbwwIntegrationStats();
+      memMeasuredParticles_missingBJet_.clear();
+      memEvent_missingBJet_ = MEMEvent_dilepton();
+      memResult_missingBJet_ = MEMbbwwResultDilepton();
+      memStats_missingBJet_ = MEMbbwwIntegrationStats();
+      measuredMEtPx_ = 0.;
+      measuredMEtPy_ = 0.;
+      numGenuineBJets_ = 0;
+      numGenuineBJets_missingBJet_ = 0;
+      mbb_ = 0.;
+      mll_ = 0.;
+      evtWeight_ = 1.;
+      memRequest_.clear();
+    }
+    smearingVariantType* smearingVariant_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_;
+    MEMEvent_dilepton memEvent_;
+    MEMbbwwResultDilepton memResult_;
+    MEMbbwwIntegrationStats memStats_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBJet_;
+    MEMEvent_dilepton memEvent_missingBJet_;
+    MEMbbwwResultDilepton memResult_missingBJet_;
+    MEMbbwwIntegrationStats memStats_missingBJet_;
+    double measuredMEtPx_;
+    double measuredMEtPy_;
+    int numGenuineBJets_;
+    int numGenuineBJets_missingBJet_;
+    double mbb_;
+    double mll_;
+    double evtWeight_;
+    MEMbbwwIntegrationRequest<MEMbbwwAlgoDilepton, MEMbbwwResultDilepton> memRequest_;
+  };
+  std::deque<memTaskType*> memTasks;
+  // tasks whose output has been written are reused for the following events,
+  // so that the memory of their collections and of their MEM requests is allocated only once
+  std::vector<memTaskType*> memTasks_free;
+
+  // fill MEM ntuples and histograms for finished events, 
+  // waiting for the oldest event in case more than maxMemTasks events are in flight
+  auto writeMEMTasks = [&](size_t maxMemTasks_inFlight) {
+    while ( !memTasks.empty() ) {
+      memTaskType* memTask = memTasks.front();
+      if ( memTasks.size() <= maxMemTasks_inFlight && !memTask->memRequest_.isReady() ) break;
+      {
+        MEMbbwwScopedTimer timer(&timingManager, "waiting for MEM integration");
+        memTask->memRequest_.receive();
+      }
+      memTasks.pop_front();
+      MEMbbwwScopedTimer timer(&timingManager, "ntuple and histogram filling");
+      smearingVariantType* smearingVariant = memTask->smearingVariant_;
+      selHistManagerType* selHistManager = smearingVariant->selHistManager_;
+
+      if ( isDEBUG ) {
+        std::cout << "MEM:"
+                  << " probability for signal hypothesis = " << memTask->memResult_.getProb_signal() 
+                  << " +/- " << memTask->memResult_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_.getProb_background() 
+                  << " +/- " << memTask->memResult_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_.cpuTime_ << ")" << std::endl;
+        std::cout << "MEM (missing b-jet case):" 
+                  << " probability for signal hypothesis = " << memTask->memResult_missingBJet_.getProb_signal() 
+                  << " +/- " << memTask->memResult_missingBJet_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_missingBJet_.getProb_background() 
+                  << " +/- " << memTask->memResult_missingBJet_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_missingBJet_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_missingBJet_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_missingBJet_.cpuTime_ << ")" << std::endl;
+      }
+
+      memTask->memEvent_.set_memResult(memTask->memResult_);
+      memTask->memEvent_.set_memCpuTime(memTask->memStats_.cpuTime_);
+      memTask->memEvent_.set_memIntegrationStats(memTask->memStats_);
+      smearingVariant->mem_ntuple_->read(memTask->memEvent_);
+      smearingVariant->mem_ntuple_->fill();
+
+      memTask->memEvent_missingBJet_.set_memResult(memTask->memResult_missingBJet_);
+      memTask->memEvent_missingBJet_.set_memCpuTime(memTask->memStats_missingBJet_.cpuTime_);
+      memTask->memEvent_missingBJet_.set_memIntegrationStats(memTask->memStats_missingBJet_);
+      smearingVariant->mem_ntuple_missingBJet_->read(memTask->memEvent_missingBJet_);
+      smearingVariant->mem_ntuple_missingBJet_->fill();
+
+      double evtWeight = memTask->evtWeight_;
+      if ( memTask->numGenuineBJets_ == 2 ) {
+        selHistManager->mem_2genuineBJets_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+        selHistManager->evt_2genuineBJets_->fillHistograms(memTask->mbb_, memTask->mll_, evtWeight);
+      } else if ( memTask->numGenuineBJets_ == 1 ) {
+        selHistManager->mem_1genuineBJet_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+        selHistManager->evt_1genuineBJets_->fillHistograms(memTask->mbb_, memTask->mll_, evtWeight);
+      } else {
+        selHistManager->mem_0genuineBJets_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+        selHistManager->evt_0genuineBJets_->fillHistograms(memTask->mbb_, memTask->mll_, evtWeight);
+      }
+      if ( memTask->numGenuineBJets_missingBJet_ == 1 ) {
+        selHistManager->mem_missingBJet_genuineBJet_->fillHistograms(memTask->memResult_missingBJet_, memTask->memStats_missingBJet_, evtWeight);
+      } else {
+        selHistManager->mem_missingBJet_fakeBJet_->fillHistograms(memTask->memResult_missingBJet_, memTask->memStats_missingBJet_, evtWeight);
+      }
+
+      memTask->clear();
+      memTasks_free.push_back(memTask);
+    }
+  };
+
+  // selectedEntries counts the events that are selected in at least one smearing variant
+  int analyzedEntries = checkpointState_resumed.analyzedEntries_;
+  int selectedEntries = checkpointState_resumed.selectedEntries_;
+  double selectedEntries_weighted = checkpointState_resumed.selectedEntries_weighted_;
+  TH1* histogram_analyzedEntries = fs.make<TH1D>("analyzedEntries", "analyzedEntries", 1, -0.5, +0.5);
+  TH1* histogram_selectedEntries = fs.make<TH1D>("selectedEntries", "selectedEntries", 1, -0.5, +0.5);
+
+//--- in case the job is resumed, add the histograms and ntuple entries of the events processed before the last checkpoint
+  checkpointManager.restore(fs.file());
+  auto hasNextEvent = [&]() {
+    MEMbbwwScopedTimer timer(&timingManager, "input reading");
+    if ( skimReader ) return skimReader->hasNextEvent();
+    return inputTree->hasNextEvent();
+  };
+  // stop reading the input files once maxSelEvents events have been selected for each smearing variant
+  auto isDone = [&]() {
+    for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+          smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+      if ( !(*smearingVariant)->isDone(maxSelEvents) ) return false;
+    }
+    return true;
+  };
+  // collections of generator-level particles, declared outside of the event loop so that their memory is reused for each event
+  // (the collections returned by the tthAnalysis readers are still allocated by the readers for each event)
+  std::vector<GenLepton> genLeptons;
+  std::vector<GenParticle> genNeutrinos;
+  std::vector<GenParticle> genParticlesFromHiggs;
+  std::vector<GenLepton> genLeptonsFromTop;
+  std::vector<GenParticle> genNeutrinosFromTop;
+  std::vector<GenParticle> genBQuarksFromTop;
+  std::vector<GenLepton> genLeptonsForMatching;
+  std::vector<GenJet> genBJetsForMatching;
+  std::vector<GenJet> genJets;
+  std::vector<GenLepton> genElectrons;
+  std::vector<GenLepton> genMuons;
+  std::vector<const GenLepton*> genLeptonsForMatching_ptrs;
+  std::vector<const GenLepton*> selGenLeptons;
+  std::vector<const GenJet*> genBJetsForMatching_ptrs;
+  std::vector<const GenJet*> cleanedGenBJets;
+  std::vector<const GenJet*> selGenBJets;
+  std::vector<const GenJet*> genJets_ptrs;
+  std::vector<const GenJet*> cleanedGenJets;
+  std::vector<const GenJet*> selGenJets;
+  std::vector<size_t> usedGenJets;
+  std::vector<GenJet> selGenBJets_smeared;
+  while ( hasNextEvent() && (! run_lumi_eventSelector || (run_lumi_eventSelector && ! run_lumi_eventSelector -> areWeDone())) && !isDone() ) {
+    const GenEventSkimRecord* skimRecord = ( skimReader ) ? &skimReader->getEvent() : nullptr;
+    if ( skimRecord ) {
+      if ( skimReader -> canReport(reportEvery) ) {
+        std::cout << "processing Entry " << skimRecord -> entry_
+                  << " or " << (skimReader -> numEventsRead() - 1) << " entry in skim file"
+                  << " (" << eventInfo
+                  << ") (" << selectedEntries << " Entries selected)\n";
+      }
+    } else if ( inputTree -> canReport(reportEvery) ) {
       std::cout << "processing Entry " << inputTree -> getCurrentMaxEventIdx()
                 << " or " << inputTree -> getCurrentEventIdx() << " entry in #"
                 << (inputTree -> getProcessedFileCount() - 1)
                 << " (" << eventInfo
                 << ") file (" << selectedEntries << " Entries selected)\n";
     }
+    const Long64_t selEntryIdx = ( skimRecord ) ? skimRecord->entry_ : inputTree->getCurrentMaxEventIdx();
+
     ++analyzedEntries;
     histogram_analyzedEntries->Fill(0.);
 
     if ( isDEBUG ) {
-      std::cout << "event #" << inputTree -> getCurrentMaxEventIdx() << ' ' << eventInfo << '\n';
+      std::cout << "event #" << selEntryIdx << ' ' << eventInfo << '\n';
     }
 
+    MEMbbwwScopedTimer timer_inputReading(&timingManager, "input reading");
     double evtWeight = 1.;
     if ( apply_genWeight ) evtWeight *= boost::math::sign(eventInfo.genWeight);
-    lheInfoReader->read();
-    evtWeight *= lheInfoReader->getWeight_scale(kLHE_scale_central);
+    double lheWeight_scale_central;
+    if ( skimRecord ) {
+      lheWeight_scale_central = skimRecord->lheWeight_scale_central_;
+    } else {
+      lheInfoReader->read();
+      lheWeight_scale_central = lheInfoReader->getWeight_scale(kLHE_scale_central);
+    }
+    evtWeight *= lheWeight_scale_central;
     evtWeight *= eventInfo.pileupWeight;
     
     if ( run_lumi_eventSelector && !(*run_lumi_eventSelector)(eventInfo) ) continue;
-    cutFlowTable.update("run:ls:event selection");
-    cutFlowHistManager->fillHistograms("run:ls:event selection", evtWeight);
+    for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+          smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+      if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+      (*smearingVariant)->cutFlowTable_.update("run:ls:event selection");
+      (*smearingVariant)->cutFlowHistManager_->fillHistograms("run:ls:event selection", evtWeight);
+    }
 
     if ( run_lumi_eventSelector ) {
-      std::cout << "processing Entry #" << inputTree->getCumulativeMaxEventCount() << ": " << eventInfo << std::endl;
-      if ( inputTree -> isOpen() ) {
+      std::cout << "processing Entry #" << ( inputTree ? inputTree->getCumulativeMaxEventCount() : selEntryIdx + 1 ) << ": " << eventInfo << std::endl;
+      if ( inputTree && inputTree -> isOpen() ) {
         std::cout << "input File = " << inputTree->getCurrentFileName() << std::endl;
       }
     }
 
+    genLeptons.clear();
+    genNeutrinos.clear();
+    genParticlesFromHiggs.clear();
+    genLeptonsFromTop.clear();
+    genNeutrinosFromTop.clear();
+    genBQuarksFromTop.clear();
+    genLeptonsForMatching.clear();
+    genBJetsForMatching.clear();
+    genJets.clear();
+    genElectrons.clear();
+    genMuons.clear();
+    double genMEtPx = 0.;
+    double genMEtPy = 0.;
+    if ( skimRecord ) {
+//--- take generator-level leptons, b-quarks and jets from the skim file,
+//    which contains only events that pass the generator-level selection
+      getGenLeptons(skimRecord->genLeptons_, skimRecord->numGenLeptons_, genLeptonsForMatching);
+      getGenJets(skimRecord->genBJets_, skimRecord->numGenBJets_, genBJetsForMatching);
+      getGenJets(skimRecord->genJets_, skimRecord->numGenJets_, genJets);
+      genMEtPx = skimRecord->genMEtPx_;
+      genMEtPy = skimRecord->genMEtPy_;
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (1)", evtWeight);
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (2)", evtWeight);
+      }
+    } else {
 //--- build collections of generator level particles (before any cuts are applied, to check distributions in unbiased event samples)
-    std::vector<GenLepton> genLeptons;
-    std::vector<GenLepton> genElectrons;
-    std::vector<GenLepton> genMuons;
-    if ( genLeptonReader ) {
-      genLeptons = genLeptonReader->read();
-      for ( std::vector<GenLepton>::const_iterator genLepton = genLeptons.begin();
-	    genLepton != genLeptons.end(); ++genLepton ) {
-	int abs_pdgId = std::abs(genLepton->pdgId());
-	if      ( abs_pdgId == 11 ) genElectrons.push_back(*genLepton);
-	else if ( abs_pdgId == 13 ) genMuons.push_back(*genLepton);
+      if ( genLeptonReader ) {
+        genLeptons = genLeptonReader->read();
+        for ( std::vector<GenLepton>::const_iterator genLepton = genLeptons.begin();
+              genLepton != genLeptons.end(); ++genLepton ) {
+          int abs_pdgId = std::abs(genLepton->pdgId());
+          if      ( abs_pdgId == 11 ) genElectrons.push_back(*genLepton);
+          else if ( abs_pdgId == 13 ) genMuons.push_back(*genLepton);
+        }
+      }
+      if ( genNeutrinoReader ) {
+        genNeutrinos = genNeutrinoReader->read();
+      }
+      if ( genJetReader ) {
+        genJets = genJetReader->read();
+      }
+      if ( isDEBUG ) {
+        printCollection("genLeptons", genLeptons);
+        printCollection("genNeutrinos", genNeutrinos);
+        printCollection("genJets", genJets);
       }
-    }
-    std::vector<GenParticle> genNeutrinos;
-    if ( genNeutrinoReader ) {
-      genNeutrinos = genNeutrinoReader->read();
-    }
-    std::vector<GenJet> genJets;
-    if ( genJetReader ) {
-      genJets = genJetReader->read();
-    }
-    if ( isDEBUG ) {
-      printCollection("genLeptons", genLeptons);
-      printCollection("genNeutrinos", genNeutrinos);
-      printCollection("genJets", genJets);
-    }
 
-    genEvtHistManager_beforeCuts->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) || !fillGenHistograms ) continue;
+        (*smearingVariant)->genEvtHistManager_beforeCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
+      }
 
-    std::vector<GenParticle> genParticlesFromHiggs;
-    if ( isSignal ) {
-      genParticlesFromHiggs = genParticleFromHiggsReader->read();
-      if ( isDEBUG ) {
-	printCollection("genParticlesFromHiggs", genParticlesFromHiggs);
-      }
-      if ( !(genParticlesFromHiggs.size() == 4) ) {
-	if ( run_lumi_eventSelector ) {
-	  std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	  std::cout << "#genParticlesFromHiggs = " << genParticlesFromHiggs.size() << std::endl;
-	}
-	continue;
-      }
-    } 
-    std::vector<GenLepton> genLeptonsFromTop;
-    std::vector<GenParticle> genNeutrinosFromTop;
-    std::vector<GenParticle> genBQuarksFromTop;
-    if ( !isSignal ) {
-      genLeptonsFromTop = genLeptonFromTopReader->read();
-      genNeutrinosFromTop = genNeutrinoFromTopReader->read();
-      genBQuarksFromTop = genBQuarksFromTopReader->read();
-      if ( isDEBUG ) {
-	printCollection("genLeptonsFromTop", genLeptonsFromTop);
-	printCollection("genNeutrinosFromTop", genNeutrinosFromTop);
-	printCollection("genBQuarksFromTop", genBQuarksFromTop);	
-      }
-      if ( !(genLeptonsFromTop.size() == 2 && genNeutrinosFromTop.size() == 2 && genBQuarksFromTop.size() == 2) ) {
-	if ( run_lumi_eventSelector ) {
-	  std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	  std::cout << "#genLeptonsFromTop = " << genLeptonsFromTop.size() << std::endl;
-	  std::cout << "#genNeutrinosFromTop = " << genNeutrinosFromTop.size() << std::endl;
-	  std::cout << "#genBQuarksFromTop = " << genBQuarksFromTop.size() << std::endl;
-	}
-	continue;
+      if ( isSignal ) {
+        genParticlesFromHiggs = genParticleFromHiggsReader->read();
+        if ( isDEBUG ) {
+          printCollection("genParticlesFromHiggs", genParticlesFromHiggs);
+        }
+        if ( !(genParticlesFromHiggs.size() == 4) ) {
+          if ( run_lumi_eventSelector ) {
+            std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+            std::cout << "#genParticlesFromHiggs = " << genParticlesFromHiggs.size() << std::endl;
+          }
+          continue;
+        }
+      } 
+      if ( !isSignal ) {
+        genLeptonsFromTop = genLeptonFromTopReader->read();
+        genNeutrinosFromTop = genNeutrinoFromTopReader->read();
+        genBQuarksFromTop = genBQuarksFromTopReader->read();
+        if ( isDEBUG ) {
+          printCollection("genLeptonsFromTop", genLeptonsFromTop);
+          printCollection("genNeutrinosFromTop", genNeutrinosFromTop);
+          printCollection("genBQuarksFromTop", genBQuarksFromTop);	
+        }
+        if ( !(genLeptonsFromTop.size() == 2 && genNeutrinosFromTop.size() == 2 && genBQuarksFromTop.size() == 2) ) {
+          if ( run_lumi_eventSelector ) {
+            std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+            std::cout << "#genLeptonsFromTop = " << genLeptonsFromTop.size() << std::endl;
+            std::cout << "#genNeutrinosFromTop = " << genNeutrinosFromTop.size() << std::endl;
+            std::cout << "#genBQuarksFromTop = " << genBQuarksFromTop.size() << std::endl;
+          }
+          continue;
+        }
       }
-    }
-    cutFlowTable.update("generator-level selection (1)", evtWeight);
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (1)", evtWeight);
+      }
+      timer_inputReading.stop();
+
+      MEMbbwwScopedTimer timer_genMatching(&timingManager, "gen matching, cleaning and selection");
 
 //--- select leptons and b-jets from H->WW->lnulnu and H->bb decays (signal)
 //    and from tt->bWbW->blnu blnu decays (background)
-    std::vector<GenLepton> genLeptonsForMatching;
-    std::vector<GenJet> genBJetsForMatching;
-    double genMEtPx = 0.;
-    double genMEtPy = 0.;
-    if ( isSignal ) {
-      const GenParticle* genBQuark      = nullptr;
-      const GenParticle* genAntiBQuark  = nullptr;
-      const GenParticle* genWBosonPlus  = nullptr;
-      const GenParticle* genWBosonMinus = nullptr;
-      for ( std::vector<GenParticle>::const_iterator genParticle = genParticlesFromHiggs.begin();
-	    genParticle != genParticlesFromHiggs.end(); ++genParticle ) {
-	if      ( genParticle->pdgId() ==  +5 ) genBQuark      = &(*genParticle);
-	else if ( genParticle->pdgId() ==  -5 ) genAntiBQuark  = &(*genParticle);
-	else if ( genParticle->pdgId() == +24 ) genWBosonPlus  = &(*genParticle);
-	else if ( genParticle->pdgId() == -24 ) genWBosonMinus = &(*genParticle);
-      }
-      if ( genBQuark && genAntiBQuark ) {
-	genBJetsForMatching.push_back(GenJet(
-          genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
-        genBJetsForMatching.push_back(GenJet(
-          genAntiBQuark->pt(), genAntiBQuark->eta(), genAntiBQuark->phi(), mem::bottomQuarkMass, genAntiBQuark->pdgId()));	
-      }
-      if ( genWBosonPlus && genWBosonMinus ) {
-	std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonPlus =
-          findGenLepton_and_NeutrinoFromWBoson(*genWBosonPlus, genLeptons, genNeutrinos);
-	const GenLepton* genLeptonPlus = genLepton_and_NeutrinoFromWBosonPlus.first;
-	const GenParticle* genNeutrino = genLepton_and_NeutrinoFromWBosonPlus.second;
-	std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonMinus =
-          findGenLepton_and_NeutrinoFromWBoson(*genWBosonMinus, genLeptons, genNeutrinos);
-	const GenLepton* genLeptonMinus = genLepton_and_NeutrinoFromWBosonMinus.first;
-	const GenParticle* genAntiNeutrino = genLepton_and_NeutrinoFromWBosonMinus.second;
-	if ( !(genLeptonPlus && genNeutrino && genLeptonMinus && genAntiNeutrino) ) continue;
-	genLeptonsForMatching.push_back(*genLeptonPlus);
-	genLeptonsForMatching.push_back(*genLeptonMinus);
-	genMEtPx = genNeutrino->p4().px() + genAntiNeutrino->p4().px();
-	genMEtPy = genNeutrino->p4().py() + genAntiNeutrino->p4().py();
+      if ( isSignal ) {
+        const GenParticle* genBQuark      = nullptr;
+        const GenParticle* genAntiBQuark  = nullptr;
+        const GenParticle* genWBosonPlus  = nullptr;
+        const GenParticle* genWBosonMinus = nullptr;
+        for ( std::vector<GenParticle>::const_iterator genParticle = genParticlesFromHiggs.begin();
+              genParticle != genParticlesFromHiggs.end(); ++genParticle ) {
+          if      ( genParticle->pdgId() ==  +5 ) genBQuark      = &(*genParticle);
+          else if ( genParticle->pdgId() ==  -5 ) genAntiBQuark  = &(*genParticle);
+          else if ( genParticle->pdgId() == +24 ) genWBosonPlus  = &(*genParticle);
+          else if ( genParticle->pdgId() == -24 ) genWBosonMinus = &(*genParticle);
+        }
+        if ( genBQuark && genAntiBQuark ) {
+          genBJetsForMatching.push_back(GenJet(
+            genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
+          genBJetsForMatching.push_back(GenJet(
+            genAntiBQuark->pt(), genAntiBQuark->eta(), genAntiBQuark->phi(), mem::bottomQuarkMass, genAntiBQuark->pdgId()));	
+        }
+        if ( genWBosonPlus && genWBosonMinus ) {
+          std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonPlus =
+            findGenLepton_and_NeutrinoFromWBoson(*genWBosonPlus, genLeptons, genNeutrinos);
+          const GenLepton* genLeptonPlus = genLepton_and_NeutrinoFromWBosonPlus.first;
+          const GenParticle* genNeutrino = genLepton_and_NeutrinoFromWBosonPlus.second;
+          std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonMinus =
+            findGenLepton_and_NeutrinoFromWBoson(*genWBosonMinus, genLeptons, genNeutrinos);
+          const GenLepton* genLeptonMinus = genLepton_and_NeutrinoFromWBosonMinus.first;
+          const GenParticle* genAntiNeutrino = genLepton_and_NeutrinoFromWBosonMinus.second;
+          if ( !(genLeptonPlus && genNeutrino && genLeptonMinus && genAntiNeutrino) ) continue;
+          genLeptonsForMatching.push_back(*genLeptonPlus);
+          genLeptonsForMatching.push_back(*genLeptonMinus);
+          genMEtPx = genNeutrino->p4().px() + genAntiNeutrino->p4().px();
+          genMEtPy = genNeutrino->p4().py() + genAntiNeutrino->p4().py();
+        }
+      } else {
+        genLeptonsForMatching = genLeptonsFromTop;
+        assert(genNeutrinosFromTop.size() == 2);
+        genMEtPx = genNeutrinosFromTop[0].p4().px() + genNeutrinosFromTop[1].p4().px();
+        genMEtPy = genNeutrinosFromTop[0].p4().py() + genNeutrinosFromTop[1].p4().py();
+        for ( std::vector<GenParticle>::const_iterator genBQuark = genBQuarksFromTop.begin();
+              genBQuark != genBQuarksFromTop.end(); ++genBQuark ) {
+          genBJetsForMatching.push_back(GenJet(
+            genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
+        }
       }
-    } else {
-      genLeptonsForMatching = genLeptonsFromTop;
-      assert(genNeutrinosFromTop.size() == 2);
-      genMEtPx = genNeutrinosFromTop[0].p4().px() + genNeutrinosFromTop[1].p4().px();
-      genMEtPy = genNeutrinosFromTop[0].p4().py() + genNeutrinosFromTop[1].p4().py();
-      for ( std::vector<GenParticle>::const_iterator genBQuark = genBQuarksFromTop.begin();
-	    genBQuark != genBQuarksFromTop.end(); ++genBQuark ) {
-	genBJetsForMatching.push_back(GenJet(
-          genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
+      if ( !(genLeptonsForMatching.size() == 2 && genBJetsForMatching.size() == 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+          std::cout << "#genLeptonsForMatching = " << genLeptonsForMatching.size() << std::endl;
+          std::cout << "#genBJetsForMatching = " << genBJetsForMatching.size() << std::endl;
+        }
+        continue;
       }
-    }
-    if ( !(genLeptonsForMatching.size() == 2 && genBJetsForMatching.size() == 2) ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	std::cout << "#genLeptonsForMatching = " << genLeptonsForMatching.size() << std::endl;
-	std::cout << "#genBJetsForMatching = " << genBJetsForMatching.size() << std::endl;
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (2)", evtWeight);
       }
-      continue;
     }
-    cutFlowTable.update("generator-level selection (2)", evtWeight);
+    timer_inputReading.stop();
 
 //--- apply pT and eta cuts to generator-level leptons and b-jets,
 //    clean collection of generator-level b-jets with respect to leptons
-    std::vector<const GenLepton*> genLeptonsForMatching_ptrs = convert_to_ptrs(genLeptonsForMatching);
-    std::vector<const GenLepton*> selGenLeptons = genLeptonSelector(genLeptonsForMatching_ptrs, isHigherPt);
-
-    std::vector<const GenJet*> genBJetsForMatching_ptrs = convert_to_ptrs(genBJetsForMatching);
-    std::vector<const GenJet*> cleanedGenBJets = genJetCleaner(genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs);
-    std::vector<const GenJet*> selGenBJets = genJetSelector(cleanedGenBJets, isHigherPt);
-
-    std::vector<const GenJet*> genJets_ptrs = convert_to_ptrs(genJets);
-    std::vector<const GenJet*> cleanedGenJets = genJetCleaner(genJets_ptrs, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs);
-    std::vector<const GenJet*> selGenJets = genJetSelector(cleanedGenJets, isHigherPt);
-    std::set<size_t> usedGenJets;
+    MEMbbwwScopedTimer timer_genSelection(&timingManager, "gen matching, cleaning and selection");
+    convert_to_ptrs(genLeptonsForMatching, genLeptonsForMatching_ptrs);
+    selectCollection(genLeptonsForMatching_ptrs, genLeptonSelector.getSelector(), isHigherPt, selGenLeptons);
+
+    convert_to_ptrs(genBJetsForMatching, genBJetsForMatching_ptrs);
+    cleanCollection(genBJetsForMatching_ptrs, genJetCleaning_dRmin, cleanedGenBJets, genLeptonsForMatching_ptrs);
+    selectCollection(cleanedGenBJets, genJetSelector.getSelector(), isHigherPt, selGenBJets);
+
+    convert_to_ptrs(genJets, genJets_ptrs);
+    cleanCollection(genJets_ptrs, genJetCleaning_dRmin, cleanedGenJets, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs);
+    selectCollection(cleanedGenJets, genJetSelector.getSelector(), isHigherPt, selGenJets);
+    timer_genSelection.stop();
+
+    if ( selEntryIndexFile || skimWriter ) {
+      if ( selEntryIndexFile ) {
+        selEntryIndexFile->write(reinterpret_cast<const char*>(&selEntryIdx), sizeof(selEntryIdx));
+      }
+      if ( skimWriter ) {
+        skimWriter->set(selEntryIdx, eventInfo, lheWeight_scale_central, genMEtPx, genMEtPy);
+        skimWriter->setGenLeptons(genLeptonsForMatching);
+        skimWriter->setGenBJets(genBJetsForMatching);
+        skimWriter->setGenJets(selGenJets);
+        skimWriter->write();
+      }
+      continue;
+    }
 
     GenMEt genMEt(genMEtPx, genMEtPy);
 
+//--- run the smearing, the event selection and the MEM computation for each smearing variant;
+//    the random numbers depend only on (seed, run, lumi, event, object index),
+//    so each variant selects the same fake b-jets and events as a job that runs this variant alone
+    bool isSelected = false;
+    for ( std::vector<smearingVariantType*>::iterator smearingVariant_it = smearingVariants.begin();
+          smearingVariant_it != smearingVariants.end(); ++smearingVariant_it ) {
+      smearingVariantType* smearingVariant = *smearingVariant_it;
+      if ( smearingVariant->isDone(maxSelEvents) ) continue;
+      cutFlowTableType& cutFlowTable = smearingVariant->cutFlowTable_;
+      CutFlowTableHistManager* cutFlowHistManager = smearingVariant->cutFlowHistManager_;
+      usedGenJets.clear();
+
 //--- apply pT smearing to generator-level b-jets (and other jets)
-    std::vector<GenJet> selGenBJets_smeared;
-    bool selGenBJet_lead_isFake = false;
-    bool selGenBJet_sublead_isFake = false;
-    for ( size_t idxGenBJet = 0; idxGenBJet < selGenBJets.size(); ++idxGenBJet ) {
-      const GenJet* selGenBJet = selGenBJets[idxGenBJet];
-      const GenJet* genJet = nullptr;
-      bool genJet_isFake;
-      double u = rnd.Uniform();
-      assert(u >= 0. && u <= 1.);
-      if ( u > genBJet_pFake ) {
-	genJet = selGenBJet;
-        genJet_isFake = false;
-      } else if ( selGenJets.size() > usedGenJets.size() ) {
-        int idxGenJet = -1;
-        while ( idxGenJet == -1 ) {
-          int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenJets.size() - 0.5));
-          if ( usedGenJets.find(idxGenJet_tmp) == usedGenJets.end() ) {
-            idxGenJet = idxGenJet_tmp;
-            usedGenJets.insert(idxGenJet); 
+      MEMbbwwScopedTimer timer_smearing(&timingManager, "smearing");
+      selGenBJets_smeared.clear();
+      bool selGenBJet_lead_isFake = false;
+      bool selGenBJet_sublead_isFake = false;
+      for ( size_t idxGenBJet = 0; idxGenBJet < selGenBJets.size(); ++idxGenBJet ) {
+        const GenJet* selGenBJet = selGenBJets[idxGenBJet];
+        const GenJet* genJet = nullptr;
+        bool genJet_isFake;
+        CounterBasedRandom rnd(randomSeed, eventInfo.run, eventInfo.lumi, eventInfo.event, 1 + idxGenBJet);
+        double u = rnd.Uniform();
+        assert(u >= 0. && u <= 1.);
+        if ( u > genBJet_pFake ) {
+          genJet = selGenBJet;
+          genJet_isFake = false;
+        } else if ( selGenJets.size() > usedGenJets.size() ) {
+          int idxGenJet = -1;
+          while ( idxGenJet == -1 ) {
+            int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenJets.size() - 0.5));
+            if ( std::find(usedGenJets.begin(), usedGenJets.end(), (size_t)idxGenJet_tmp) == usedGenJets.end() ) {
+              idxGenJet = idxGenJet_tmp;
+              usedGenJets.push_back(idxGenJet);
+            }
           }
+          assert(idxGenJet >= 0 && idxGenJet < (int)selGenJets.size());
+          genJet = selGenJets[idxGenJet];
+          genJet_isFake = true;
+        }
+        if ( genJet ) {
+          double genJetPt_smeared;
+          if ( smearingVariant->apply_jetSmearing_ ) genJetPt_smeared = genJetSmearer(*genJet, eventInfo, idxGenBJet).pt();
+          else genJetPt_smeared = genJet->pt();
+          if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
+            selGenBJets_smeared.push_back(GenJet(
+              genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
+          }
+          if      ( idxGenBJet == 0 ) selGenBJet_lead_isFake = genJet_isFake;
+          else if ( idxGenBJet == 1 ) selGenBJet_sublead_isFake = genJet_isFake;
+          else assert(0);
         }
-        assert(idxGenJet >= 0 && idxGenJet < (int)selGenJets.size());
-	genJet = selGenJets[idxGenJet];
-	genJet_isFake = true;
-      }
-      if ( genJet ) {
-	double genJetPt_smeared;
-	if ( apply_jetSmearing ) genJetPt_smeared = genJetSmearer(*genJet).pt();
-	else genJetPt_smeared = genJet->pt();
-	if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
-  	  selGenBJets_smeared.push_back(GenJet(
-	    genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
-	}
-	if      ( idxGenBJet == 0 ) selGenBJet_lead_isFake = genJet_isFake;
-	else if ( idxGenBJet == 1 ) selGenBJet_sublead_isFake = genJet_isFake;
-	else assert(0);
       }
-    }
     
 //--- apply pX, pY smearing to generator-level missing transverse momentum (MET)
-    GenMEt genMEt_smeared;
-    if ( apply_metSmearing ) {
-      genMEt_smeared = genMEtSmearer(genMEt);
-    } else {
-      genMEt_smeared = genMEt;
-    }
+      GenMEt genMEt_smeared;
+      if ( smearingVariant->apply_metSmearing_ ) {
+        genMEt_smeared = genMEtSmearer(genMEt, eventInfo);
+      } else {
+        genMEt_smeared = genMEt;
+      }
+      timer_smearing.stop();
 
-    // require at least two generator-level leptons 
-    if ( !(selGenLeptons.size() >= 2) ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS selGenLeptons selection." << std::endl;
-        printCollection("selGenLeptons", selGenLeptons);
+      // require at least two generator-level leptons 
+      if ( !(selGenLeptons.size() >= 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS selGenLeptons selection." << std::endl;
+          printCollection("selGenLeptons", selGenLeptons);
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update(">= 2 gen leptons", evtWeight);
-    cutFlowHistManager->fillHistograms(">= 2 gen leptons", evtWeight);
-    const GenLepton* selGenLepton_lead = selGenLeptons[0];
-    const GenLepton* selGenLepton_sublead = selGenLeptons[1];
+      cutFlowTable.update(">= 2 gen leptons", evtWeight);
+      cutFlowHistManager->fillHistograms(">= 2 gen leptons", evtWeight);
+      const GenLepton* selGenLepton_lead = selGenLeptons[0];
+      const GenLepton* selGenLepton_sublead = selGenLeptons[1];
     
-    const double minPt_lepton_lead = 25.;
-    const double minPt_lepton_sublead = 15.;
-    const double maxAbsEta_lepton = 2.4;
-    if ( !(selGenLepton_lead->pt()    > minPt_lepton_lead    && selGenLepton_lead->absEta()    < maxAbsEta_lepton &&
-	   selGenLepton_sublead->pt() > minPt_lepton_sublead && selGenLepton_sublead->absEta() < maxAbsEta_lepton) ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS lepton pT selection." << std::endl;
-        std::cout << " leading selGenLepton: pT = " << selGenLepton_lead->pt() << ", eta = " << selGenLepton_lead->eta() << " "
-		  << "(minPt_lead = " << minPt_lepton_lead <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
-	std::cout << " subleading selGenLepton: pT = " << selGenLepton_sublead->pt() << ", eta = " << selGenLepton_sublead->eta() << " "
-		  << "(minPt_lead = " << minPt_lepton_sublead <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
+      const double minPt_lepton_lead = 25.;
+      const double minPt_lepton_sublead = 15.;
+      const double maxAbsEta_lepton = 2.4;
+      if ( !(selGenLepton_lead->pt()    > minPt_lepton_lead    && selGenLepton_lead->absEta()    < maxAbsEta_lepton &&
+             selGenLepton_sublead->pt() > minPt_lepton_sublead && selGenLepton_sublead->absEta() < maxAbsEta_lepton) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS lepton pT selection." << std::endl;
+          std::cout << " leading selGenLepton: pT = " << selGenLepton_lead->pt() << ", eta = " << selGenLepton_lead->eta() << " "
+                    << "(minPt_lead = " << minPt_lepton_lead <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
+          std::cout << " subleading selGenLepton: pT = " << selGenLepton_sublead->pt() << ", eta = " << selGenLepton_sublead->eta() << " "
+                    << "(minPt_lead = " << minPt_lepton_sublead <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update("lead gen lepton pT > 25 GeV && sublead gen lepton pT > 15 GeV", evtWeight);
-    cutFlowHistManager->fillHistograms("lead gen lepton pT > 25 GeV && sublead gen lepton pT > 15 GeV", evtWeight);
-
-    if ( selGenLepton_lead->charge()*selGenLepton_sublead->charge() > 0 ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS lepton charge selection." << std::endl;
-        std::cout << " (leading selGenLepton charge = " << selGenLepton_lead->charge()
-                  << ", subleading selGenLepton charge = " << selGenLepton_sublead->charge() << ")" << std::endl;
+      cutFlowTable.update("lead gen lepton pT > 25 GeV && sublead gen lepton pT > 15 GeV", evtWeight);
+      cutFlowHistManager->fillHistograms("lead gen lepton pT > 25 GeV && sublead gen lepton pT > 15 GeV", evtWeight);
+
+      if ( selGenLepton_lead->charge()*selGenLepton_sublead->charge() > 0 ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS lepton charge selection." << std::endl;
+          std::cout << " (leading selGenLepton charge = " << selGenLepton_lead->charge()
+                    << ", subleading selGenLepton charge = " << selGenLepton_sublead->charge() << ")" << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update("gen lepton-pair OS charge", evtWeight);
-    cutFlowHistManager->fillHistograms("gen lepton-pair OS charge", evtWeight);
-
-    if ( !(selGenBJets_smeared.size() == 2) ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS gen smeared b-jets selection." << std::endl;
-	std::cout << "#cleanedGenBJets = " << cleanedGenBJets.size() << std::endl;
-	std::cout << "#selGenBJets = " << selGenBJets.size() << std::endl;
-	std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;
-	std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
-	std::cout << "#selGenBJets_smeared = " << selGenBJets_smeared.size() << std::endl;
+      cutFlowTable.update("gen lepton-pair OS charge", evtWeight);
+      cutFlowHistManager->fillHistograms("gen lepton-pair OS charge", evtWeight);
+
+      if ( !(selGenBJets_smeared.size() == 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS gen smeared b-jets selection." << std::endl;
+          std::cout << "#cleanedGenBJets = " << cleanedGenBJets.size() << std::endl;
+          std::cout << "#selGenBJets = " << selGenBJets.size() << std::endl;
+          std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;
+          std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
+          std::cout << "#selGenBJets_smeared = " << selGenBJets_smeared.size() << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update(">= 2 gen b-jets", evtWeight);
-    cutFlowHistManager->fillHistograms(">= 2 gen b-jets", evtWeight);
-    const GenJet* selGenBJet_lead = &selGenBJets_smeared[0];
-    const GenJet* selGenBJet_sublead = &selGenBJets_smeared[1];
-
-    if ( !((selGenLepton_lead->p4() + selGenLepton_sublead->p4()).mass() < 76.) ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS m_ll < 76 GeV cut." << std::endl;
+      cutFlowTable.update(">= 2 gen b-jets", evtWeight);
+      cutFlowHistManager->fillHistograms(">= 2 gen b-jets", evtWeight);
+      const GenJet* selGenBJet_lead = &selGenBJets_smeared[0];
+      const GenJet* selGenBJet_sublead = &selGenBJets_smeared[1];
+
+      if ( !((selGenLepton_lead->p4() + selGenLepton_sublead->p4()).mass() < 76.) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS m_ll < 76 GeV cut." << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update("m(ll) < 76 GeV", evtWeight);
-    cutFlowHistManager->fillHistograms("m(ll) < 76 GeV", evtWeight);
+      cutFlowTable.update("m(ll) < 76 GeV", evtWeight);
+      cutFlowHistManager->fillHistograms("m(ll) < 76 GeV", evtWeight);
 
-    if ( (selGenLepton_lead->p4() + selGenLepton_sublead->p4()).mass() < 12. ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS low mass lepton pair veto." << std::endl;
+      if ( (selGenLepton_lead->p4() + selGenLepton_sublead->p4()).mass() < 12. ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS low mass lepton pair veto." << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update("m(ll) > 12 GeV", evtWeight);
-    cutFlowHistManager->fillHistograms("m(ll) > 12 GeV", evtWeight);
+      cutFlowTable.update("m(ll) > 12 GeV", evtWeight);
+      cutFlowHistManager->fillHistograms("m(ll) > 12 GeV", evtWeight);
     
-    //---------------------------------------------------------------------------
-    // CV: Skip running matrix element method (MEM) computation for the first 'skipSelEvents' events.
-    //     This feature allows to process the HH signal samples in chunks of 'maxSelEvents' events per job.
-    ++skippedEntries;
-    if ( skippedEntries < skipSelEvents ) continue;
-    //---------------------------------------------------------------------------
-
-    //---------------------------------------------------------------------------
-    // CV: Compute MEM likelihood ratio of HH signal and ttbar background hypotheses
+      //---------------------------------------------------------------------------
+      // CV: Compute MEM likelihood ratio of HH signal and ttbar background hypotheses
 
-    if ( isDEBUG ) {
-      std::cout << "selGenLepton_lead: pT = " << selGenLepton_lead->pt() << "," 
-                << " eta = " << selGenLepton_lead->eta() << ", phi = " << selGenLepton_lead->phi() << std::endl;
-      std::cout << "selGenLepton_sublead: pT = " << selGenLepton_sublead->pt() << "," 
-                << " eta = " << selGenLepton_sublead->eta() << ", phi = " << selGenLepton_sublead->phi() << std::endl;
-      std::cout << "selGenBJet_lead: pT = " << selGenBJet_lead->pt() << "," 
-                << " eta = " << selGenBJet_lead->eta() << ", phi = " << selGenBJet_lead->phi() 
-	        << " (isFake = " << selGenBJet_lead_isFake << ")" << std::endl;
-      std::cout << "selGenBJet_sublead: pT = " << selGenBJet_sublead->pt() << "," 
-                << " eta = " << selGenBJet_sublead->eta() << ", phi = " << selGenBJet_sublead->phi() 
-	        << " (isFake = " << selGenBJet_sublead_isFake << ")" << std::endl;
-    }
+      if ( isDEBUG ) {
+        std::cout << "selGenLepton_lead: pT = " << selGenLepton_lead->pt() << "," 
+                  << " eta = " << selGenLepton_lead->eta() << ", phi = " << selGenLepton_lead->phi() << std::endl;
+        std::cout << "selGenLepton_sublead: pT = " << selGenLepton_sublead->pt() << "," 
+                  << " eta = " << selGenLepton_sublead->eta() << ", phi = " << selGenLepton_sublead->phi() << std::endl;
+        std::cout << "selGenBJet_lead: pT = " << selGenBJet_lead->pt() << "," 
+                  << " eta = " << selGenBJet_lead->eta() << ", phi = " << selGenBJet_lead->phi() 
+                  << " (isFake = " << selGenBJet_lead_isFake << ")" << std::endl;
+        std::cout << "selGenBJet_sublead: pT = " << selGenBJet_sublead->pt() << "," 
+                  << " eta = " << selGenBJet_sublead->eta() << ", phi = " << selGenBJet_sublead->phi() 
+                  << " (isFake = " << selGenBJet_sublead_isFake << ")" << std::endl;
+      }
 
-    int memLeptonType_lead;   
-    double memLeptonMass_lead;   
-    if ( selGenLepton_lead->is_electron() ) {
-      memLeptonType_lead = mem::MeasuredParticle::kElectron;
-      memLeptonMass_lead = mem::electronMass;
-    } else if ( selGenLepton_lead->is_muon() ) {
-      memLeptonType_lead = mem::MeasuredParticle::kMuon;
-      memLeptonMass_lead = mem::muonMass;
-    } else assert(0);
-    int memLeptonType_sublead;   
-    double memLeptonMass_sublead;   
-    if ( selGenLepton_sublead->is_electron() ) {
-      memLeptonType_sublead = mem::MeasuredParticle::kElectron;
-      memLeptonMass_sublead = mem::electronMass;
-    } else if ( selGenLepton_sublead->is_muon() ) {
-      memLeptonType_sublead = mem::MeasuredParticle::kMuon;
-      memLeptonMass_sublead = mem::muonMass;
-    } else assert(0);
-
-    mem::MeasuredParticle memMeasuredLepton_lead(memLeptonType_lead, 
-      selGenLepton_lead->pt(), selGenLepton_lead->eta(), selGenLepton_lead->phi(), 
-      memLeptonMass_lead, selGenLepton_lead->charge());
-    mem::MeasuredParticle memMeasuredLepton_sublead(memLeptonType_sublead, 
-      selGenLepton_sublead->pt(), selGenLepton_sublead->eta(), selGenLepton_sublead->phi(), 
-      memLeptonMass_sublead, selGenLepton_sublead->charge());
-    mem::MeasuredParticle memMeasuredBJet_lead(mem::MeasuredParticle::kBJet,
-      selGenBJet_lead->pt(), selGenBJet_lead->eta(), selGenBJet_lead->phi(), 
-      mem::bottomQuarkMass);
-    mem::MeasuredParticle memMeasuredBJet_sublead(mem::MeasuredParticle::kBJet,
-      selGenBJet_sublead->pt(), selGenBJet_sublead->eta(), selGenBJet_sublead->phi(), 
-      mem::bottomQuarkMass);
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles;
-    memMeasuredParticles.push_back(memMeasuredLepton_lead);
-    memMeasuredParticles.push_back(memMeasuredLepton_sublead);
-    memMeasuredParticles.push_back(memMeasuredBJet_lead);
-    memMeasuredParticles.push_back(memMeasuredBJet_sublead);
+      int memLeptonType_lead;   
+      double memLeptonMass_lead;   
+      if ( selGenLepton_lead->is_electron() ) {
+        memLeptonType_lead = mem::MeasuredParticle::kElectron;
+        memLeptonMass_lead = mem::electronMass;
+      } else if ( selGenLepton_lead->is_muon() ) {
+        memLeptonType_lead = mem::MeasuredParticle::kMuon;
+        memLeptonMass_lead = mem::muonMass;
+      } else assert(0);
+      int memLeptonType_sublead;   
+      double memLeptonMass_sublead;   
+      if ( selGenLepton_sublead->is_electron() ) {
+        memLeptonType_sublead = mem::MeasuredParticle::kElectron;
+        memLeptonMass_sublead = mem::electronMass;
+      } else if ( selGenLepton_sublead->is_muon() ) {
+        memLeptonType_sublead = mem::MeasuredParticle::kMuon;
+        memLeptonMass_sublead = mem::muonMass;
+      } else assert(0);
+
+      // the MEMEvent_dilepton objects store copies of the particle kinematics,
+      // while the measured particles used by the MEM integration are owned by the memTask object
+      memTaskType* memTask = nullptr;
+      if ( !memTasks_free.empty() ) {
+        memTask = memTasks_free.back();
+        memTasks_free.pop_back();
+      } else {
+        memTask = new memTaskType(memAlgoPool, memProcessPool);
+      }
+      memTask->smearingVariant_ = smearingVariant;
+      memTask->measuredMEtPx_ = genMEt_smeared.px();
+      memTask->measuredMEtPy_ = genMEt_smeared.py();
+      memTask->evtWeight_ = evtWeight;
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles = memTask->memMeasuredParticles_;
+      memMeasuredParticles.push_back(mem::MeasuredParticle(memLeptonType_lead, 
+        selGenLepton_lead->pt(), selGenLepton_lead->eta(), selGenLepton_lead->phi(), 
+        memLeptonMass_lead, selGenLepton_lead->charge()));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(memLeptonType_sublead, 
+        selGenLepton_sublead->pt(), selGenLepton_sublead->eta(), selGenLepton_sublead->phi(), 
+        memLeptonMass_sublead, selGenLepton_sublead->charge()));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        selGenBJet_lead->pt(), selGenBJet_lead->eta(), selGenBJet_lead->phi(), 
+        mem::bottomQuarkMass));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        selGenBJet_sublead->pt(), selGenBJet_sublead->eta(), selGenBJet_sublead->phi(), 
+        mem::bottomQuarkMass));
+      const mem::MeasuredParticle& memMeasuredLepton_lead = memMeasuredParticles[0];
+      const mem::MeasuredParticle& memMeasuredLepton_sublead = memMeasuredParticles[1];
+      const mem::MeasuredParticle& memMeasuredBJet_lead = memMeasuredParticles[2];
+      const mem::MeasuredParticle& memMeasuredBJet_sublead = memMeasuredParticles[3];
     
-    MEMEvent_dilepton memEvent(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      &memMeasuredBJet_lead, &memMeasuredBJet_sublead, 
-      &memMeasuredLepton_lead, &memMeasuredLepton_sublead,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_dilepton(memEvent, genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBJet;
-    memMeasuredParticles_missingBJet.push_back(memMeasuredLepton_lead);
-    memMeasuredParticles_missingBJet.push_back(memMeasuredLepton_sublead);
-    const mem::MeasuredParticle* memMeasuredBJet_missingBJet = nullptr;
-    bool selGenBJet_isFake_missingBJet;
-    double u = rnd.Uniform();
-    assert(u >= 0. && u <= 1.);
-    if ( u > 0.50 ) {
-      memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_lead);
-      memMeasuredBJet_missingBJet = &memMeasuredBJet_lead;
-      selGenBJet_isFake_missingBJet = selGenBJet_lead_isFake;
-    } else {
-      memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_sublead);
-      memMeasuredBJet_missingBJet = &memMeasuredBJet_sublead;
-      selGenBJet_isFake_missingBJet = selGenBJet_sublead_isFake;
-    }
-
-    MEMEvent_dilepton memEvent_missingBJet(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      memMeasuredBJet_missingBJet, nullptr,
-      &memMeasuredLepton_lead, &memMeasuredLepton_sublead,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_dilepton(memEvent_missingBJet, genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    const double sqrtS = 13.e+3;
-    const std::string pdfName = "MSTW2008lo68cl";
-    const std::string madgraphFileName_signal     = "hhAnalysis/bbwwMEM/data/param_hh_SM.dat";
-    const std::string madgraphFileName_background = "hhAnalysis/bbwwMEM/data/param_ttbar.dat";
-    const bool applyOnshellWmassConstraint_signal = false;
-    const int memAlgo_verbosity = 0;
-    //const int maxObjFunctionCalls_signal = 2500;
-    //const int maxObjFunctionCalls_background = 25000;
-    const int maxObjFunctionCalls_signal = 1000;
-    const int maxObjFunctionCalls_background = 10000;
-
-    clock.Reset();
-    clock.Start("memAlgo");
-    MEMbbwwAlgoDilepton memAlgo(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo.setBJet1TF(&bjetTF);
-    memAlgo.setBJet2TF(&bjetTF);
-    memAlgo.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo.setIntMode(MEMbbwwAlgoDilepton::kVAMP);
-    memAlgo.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo.integrate(memMeasuredParticles, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultDilepton memResult = memAlgo.getResult();
-    clock.Stop("memAlgo");
-
-    double memCpuTime = clock.GetCpuTime("memAlgo");
-    if ( isDEBUG ) {
-      std::cout << "MEM:"
-	        << " probability for signal hypothesis = " << memResult.getProb_signal() 
-                << " +/- " << memResult.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult.getProb_background() 
-                << " +/- " << memResult.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult.getLikelihoodRatio() 
-                << " +/- " << memResult.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime << ")" << std::endl;
-    }
+      memTask->memEvent_ = MEMEvent_dilepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        &memMeasuredBJet_lead, &memMeasuredBJet_sublead, 
+        &memMeasuredLepton_lead, &memMeasuredLepton_sublead,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_dilepton(memTask->memEvent_, genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles_missingBJet = memTask->memMeasuredParticles_missingBJet_;
+      memMeasuredParticles_missingBJet.push_back(memMeasuredLepton_lead);
+      memMeasuredParticles_missingBJet.push_back(memMeasuredLepton_sublead);
+      const mem::MeasuredParticle* memMeasuredBJet_missingBJet = nullptr;
+      bool selGenBJet_isFake_missingBJet;
+      CounterBasedRandom rnd(randomSeed, eventInfo.run, eventInfo.lumi, eventInfo.event);
+      double u = rnd.Uniform();
+      assert(u >= 0. && u <= 1.);
+      if ( u > 0.50 ) {
+        memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_lead);
+        memMeasuredBJet_missingBJet = &memMeasuredBJet_lead;
+        selGenBJet_isFake_missingBJet = selGenBJet_lead_isFake;
+      } else {
+        memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_sublead);
+        memMeasuredBJet_missingBJet = &memMeasuredBJet_sublead;
+        selGenBJet_isFake_missingBJet = selGenBJet_sublead_isFake;
+      }
 
-    (const_cast<MEMEvent_dilepton*>(&memEvent))->set_memResult(memResult);
-    (const_cast<MEMEvent_dilepton*>(&memEvent))->set_memCpuTime(memCpuTime);
-
-    mem_ntuple->read(memEvent);
-    mem_ntuple->fill();
-
-    clock.Reset();
-    clock.Start("memAlgo_missingBJet");
-    MEMbbwwAlgoDilepton memAlgo_missingBJet(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo_missingBJet.setBJet1TF(&bjetTF);
-    memAlgo_missingBJet.setBJet2TF(&bjetTF);
-    memAlgo_missingBJet.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo_missingBJet.setIntMode(MEMbbwwAlgoDilepton::kVAMP);
-    memAlgo_missingBJet.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo_missingBJet.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo_missingBJet.integrate(memMeasuredParticles_missingBJet, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultDilepton memResult_missingBJet = memAlgo_missingBJet.getResult();
-    clock.Stop("memAlgo_missingBJet");
-    
-    double memCpuTime_missingBJet = clock.GetCpuTime("memAlgo_missingBJet");
-    if ( isDEBUG ) {
-      std::cout << "MEM (missing b-jet case):" 
-	        << " probability for signal hypothesis = " << memResult_missingBJet.getProb_signal() 
-                << " +/- " << memResult_missingBJet.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult_missingBJet.getProb_background() 
-                << " +/- " << memResult_missingBJet.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult_missingBJet.getLikelihoodRatio() 
-                << " +/- " << memResult_missingBJet.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime_missingBJet << ")" << std::endl;
-    }
+      memTask->memEvent_missingBJet_ = MEMEvent_dilepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        memMeasuredBJet_missingBJet, nullptr,
+        &memMeasuredLepton_lead, &memMeasuredLepton_sublead,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_dilepton(memTask->memEvent_missingBJet_, genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      int numGenuineBJets = 0;
+      if ( !selGenBJet_lead_isFake    ) ++numGenuineBJets;
+      if ( !selGenBJet_sublead_isFake ) ++numGenuineBJets;
+      memTask->numGenuineBJets_ = numGenuineBJets;
+      memTask->numGenuineBJets_missingBJet_ = ( !selGenBJet_isFake_missingBJet ) ? 1 : 0;
+      memTask->mbb_ = (memMeasuredBJet_lead.p4() + memMeasuredBJet_sublead.p4()).mass();
+      memTask->mll_ = (memMeasuredLepton_lead.p4() + memMeasuredLepton_sublead.p4()).mass();
+
+      memTask->memRequest_.add("MEM integration", memTask->memMeasuredParticles_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_, memTask->memStats_);
+      if ( parallelHypotheses ) memTask->memRequest_.submit();
+      memTask->memRequest_.add("MEM integration (missing b-jet)", memTask->memMeasuredParticles_missingBJet_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_missingBJet_, memTask->memStats_missingBJet_);
+      memTask->memRequest_.submit();
+      memTasks.push_back(memTask);
+      writeMEMTasks(maxMemTasks);
+      //---------------------------------------------------------------------------
+
+      MEMbbwwScopedTimer timer_filling(&timingManager, "ntuple and histogram filling");
+      selHistManagerType* selHistManager = smearingVariant->selHistManager_;
+      if ( fillGenHistograms ) {
+        selHistManager->genEvtHistManager_afterCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
+        selHistManager->lheInfoHistManager_afterCuts_->fillHistograms(*lheInfoReader, evtWeight);
+      }
+      selHistManager->weights_->fillHistograms("genWeight", eventInfo.genWeight);
+      selHistManager->weights_->fillHistograms("pileupWeight", eventInfo.pileupWeight);
 
-    (const_cast<MEMEvent_dilepton*>(&memEvent_missingBJet))->set_memResult(memResult_missingBJet);
-    (const_cast<MEMEvent_dilepton*>(&memEvent_missingBJet))->set_memCpuTime(memCpuTime_missingBJet);
-
-    mem_ntuple_missingBJet->read(memEvent_missingBJet);
-    mem_ntuple_missingBJet->fill();
-    //---------------------------------------------------------------------------
-
-    int numGenuineBJets = 0;
-    if ( !selGenBJet_lead_isFake    ) ++numGenuineBJets;
-    if ( !selGenBJet_sublead_isFake ) ++numGenuineBJets;
-    double mbb = (memMeasuredBJet_lead.p4() + memMeasuredBJet_sublead.p4()).mass();
-    double mll = (memMeasuredLepton_lead.p4() + memMeasuredLepton_sublead.p4()).mass();
-    if ( numGenuineBJets == 2 ) {
-      selHistManager->mem_2genuineBJets_->fillHistograms(memResult, memCpuTime, evtWeight);
-      selHistManager->evt_2genuineBJets_->fillHistograms(mbb, mll, evtWeight);
-    } else if ( numGenuineBJets == 1 ) {
-      selHistManager->mem_1genuineBJet_->fillHistograms(memResult, memCpuTime, evtWeight);
-      selHistManager->evt_1genuineBJets_->fillHistograms(mbb, mll, evtWeight);
-    } else {
-      selHistManager->mem_0genuineBJets_->fillHistograms(memResult, memCpuTime, evtWeight);
-      selHistManager->evt_0genuineBJets_->fillHistograms(mbb, mll, evtWeight);
-    }
-    int numGenuineBJets_missingBJet = ( !selGenBJet_isFake_missingBJet ) ? 1 : 0;
-    if ( numGenuineBJets_missingBJet == 1 ) {
-      selHistManager->mem_missingBJet_genuineBJet_->fillHistograms(memResult_missingBJet, memCpuTime_missingBJet, evtWeight);
-    } else {
-      selHistManager->mem_missingBJet_fakeBJet_->fillHistograms(memResult_missingBJet, memCpuTime_missingBJet, evtWeight);
+      ++smearingVariant->selectedEntries_;
+      smearingVariant->selectedEntries_weighted_ += evtWeight;
+      isSelected = true;
     }
-    selHistManager->genEvtHistManager_afterCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
-    selHistManager->lheInfoHistManager_afterCuts_->fillHistograms(*lheInfoReader, evtWeight);
-    selHistManager->weights_->fillHistograms("genWeight", eventInfo.genWeight);
-    selHistManager->weights_->fillHistograms("pileupWeight", eventInfo.pileupWeight);
+    if ( !isSelected ) continue;
 
+    MEMbbwwScopedTimer timer_filling(&timingManager, "ntuple and histogram filling");
     if ( selEventsFile ) {
       (*selEventsFile) << eventInfo.run << ':' << eventInfo.lumi << ':' << eventInfo.event << '\n';
     }
@@ -830,34 +1248,102 @@ int main(int argc, char* argv[])
     ++selectedEntries;
     selectedEntries_weighted += evtWeight;
     histogram_selectedEntries->Fill(0.);
+    timer_filling.stop();
+
+    if ( checkpointManager.isDue(selectedEntries) ) {
+      MEMbbwwScopedTimer timer_checkpoint(&timingManager, "checkpointing");
+      // wait for MEM integrations that are still running,
+      // so that the output of all events preceding the next entry is stored in the checkpoint
+      writeMEMTasks(0);
+      MEMbbwwCheckpointState checkpointState;
+      checkpointState.nextEntry_ = selEntryIdx + 1;
+      checkpointState.analyzedEntries_ = analyzedEntries;
+      checkpointState.selectedEntries_ = selectedEntries;
+      checkpointState.selectedEntries_weighted_ = selectedEntries_weighted;
+      for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        checkpointState.selectedEntries_variant_.push_back((*smearingVariant)->selectedEntries_);
+        checkpointState.selectedEntries_weighted_variant_.push_back((*smearingVariant)->selectedEntries_weighted_);
+      }
+      if ( selEventsFile ) {
+        selEventsFile->flush();
+        checkpointState.selEventsFileSize_ = selEventsFile->tellp();
+      }
+      if ( selEntryIndexFile ) {
+        selEntryIndexFile->flush();
+        checkpointState.selEntryIndexFileSize_ = selEntryIndexFile->tellp();
+      }
+      timingManager.getTotals(checkpointState.timingPhases_, checkpointState.timingNumCalls_,
+        checkpointState.timingWallTimes_, checkpointState.timingCpuTimes_);
+      checkpointManager.write(fs.file(), checkpointState);
+    }
   }
 
-  std::cout << "max num. Entries = " << inputTree -> getCumulativeMaxEventCount()
-            << " (limited by " << maxEvents << ") processed in "
-            << inputTree -> getProcessedFileCount() << " file(s) (out of "
-            << inputTree -> getFileCount() << ")\n"
-            << " analyzed = " << analyzedEntries << '\n'
-            << " selected = " << selectedEntries << " (weighted = " << selectedEntries_weighted << ")\n\n"
-            << "cut-flow table" << std::endl;
-  cutFlowTable.print(std::cout);
-  std::cout << std::endl;
+//--- wait for MEM integrations that are still running
+  writeMEMTasks(0);
+  for ( std::vector<memTaskType*>::iterator memTask = memTasks_free.begin();
+        memTask != memTasks_free.end(); ++memTask ) {
+    delete (*memTask);
+  }
+
+  timingManager.print(std::cout);
+  if ( memResultCache ) memResultCache->print(std::cout);
+  timingManager.writeTree(fs);
+  checkpointManager.finish(fs.file());
+
+  if ( inputTree ) {
+    std::cout << "max num. Entries = " << inputTree -> getCumulativeMaxEventCount()
+              << " (limited by " << maxEvents << ") processed in "
+              << inputTree -> getProcessedFileCount() << " file(s) (out of "
+              << inputTree -> getFileCount() << ")\n";
+  } else {
+    std::cout << "num. Entries = " << skimReader -> numEventsRead()
+              << " (limited by " << maxEvents << ") read from skim file = " << skimFileName_input << '\n';
+  }
+  std::cout << " analyzed = " << analyzedEntries << '\n'
+            << " selected = " << selectedEntries << " (weighted = " << selectedEntries_weighted << ")\n" << std::endl;
+  for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+        smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+    std::cout << "smearing variant " << (*smearingVariant)->histogramDir_ << ":\n"
+              << " selected = " << (*smearingVariant)->selectedEntries_ << " (weighted = " << (*smearingVariant)->selectedEntries_weighted_ << ")\n\n"
+              << "cut-flow table";
+    if ( checkpointManager.isResumed() ) {
+      // the cut-flow table cannot be restored from the checkpoint, in contrast to the cut-flow histograms stored in the output file
+      std::cout << " (covering only the entries >= " << checkpointState_resumed.nextEntry_ << " processed after resuming from the last checkpoint;"
+                << " the cut-flow histograms in the output file cover all entries)";
+    }
+    std::cout << std::endl;
+    (*smearingVariant)->cutFlowTable_.print(std::cout);
+    std::cout << std::endl;
+  }
 
   delete run_lumi_eventSelector;
 
   delete selEventsFile;
+  delete selEntryIndexFile;
+  delete skimWriter;
+  // the skim file is renamed first, as the jobs reading the skim file are waiting for the index file
+  if ( skimFileName_output != "" ) commitOutputFile(skimFileName_output);
+  if ( makeSelEntryIndex ) commitOutputFile(selEntryIndexFileName);
+  delete skimReader;
 
   delete genLeptonReader;
   delete genNeutrinoReader;
   delete genJetReader;
   delete lheInfoReader;
 
-  delete genEvtHistManager_beforeCuts;
-
-  delete mem_ntuple;
-  delete mem_ntuple_missingBJet;
+  for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+        smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+    delete (*smearingVariant)->genEvtHistManager_beforeCuts_;
+    delete (*smearingVariant)->mem_ntuple_;
+    delete (*smearingVariant)->mem_ntuple_missingBJet_;
+    delete (*smearingVariant);
+  }
 
   delete inputTree;
 
+  delete memResultCache;
+
   clock.Show("analyze_hh_bbwwMEM_dilepton");
 
   return EXIT_SUCCESS;
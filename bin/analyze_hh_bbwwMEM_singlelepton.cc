@@ -16,7 +16,6 @@
 #include <TBenchmark.h> // TBenchmark
 #include <TString.h> // TString, Form
 #include <TError.h> // gErrorAbortLevel, kError
-#include <TRandom3.h> // TRandom3
 #include <TLorentzVector.h> // TLorentzVector 
 #include <TMatrixD.h> // TMatrixD
 
@@ -30,8 +29,6 @@
 #include "tthAnalysis/HiggsToTauTau/interface/GenJetCollectionSelector.h" // GenJetCollectionSelector
 #include "tthAnalysis/HiggsToTauTau/interface/LHEInfoReader.h" // LHEInfoReader
 #include "tthAnalysis/HiggsToTauTau/interface/EventInfoReader.h" // EventInfoReader
-#include "tthAnalysis/HiggsToTauTau/interface/convert_to_ptrs.h" // convert_to_ptrs
-#include "tthAnalysis/HiggsToTauTau/interface/ParticleCollectionCleaner.h" // GenJetCollectionCleaner
 #include "tthAnalysis/HiggsToTauTau/interface/RunLumiEventSelector.h" // RunLumiEventSelector
 #include "tthAnalysis/HiggsToTauTau/interface/CutFlowTableHistManager.h" // CutFlowTableHistManager
 #include "tthAnalysis/HiggsToTauTau/interface/WeightHistManager.h" // WeightHistManager
@@ -41,7 +38,6 @@
 #include "tthAnalysis/HiggsToTauTau/interface/analysisAuxFunctions.h" // isHigherPt, isMatched, contains, findFile
 #include "tthAnalysis/HiggsToTauTau/interface/generalAuxFunctions.h" // format_vstring
 #include "tthAnalysis/HiggsToTauTau/interface/cutFlowTable.h" // cutFlowTableType
-#include "tthAnalysis/HiggsToTauTau/interface/TTreeWrapper.h" // TTreeWrapper
 #include "tthAnalysis/HiggsToTauTau/interface/hltFilter.h" // hltFilter()
 
 #include <boost/math/special_functions/sign.hpp> // boost::math::sign()
@@ -50,12 +46,20 @@
 #include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoSingleLepton.h"
 #include "hhAnalysis/bbwwMEM/interface/MeasuredParticle.h" // MeasuredParticle
 #include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h"
-#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/BJetTF_toy.h" // BJetTF_toy
-#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/HadWJetTF_toy.h" // HadWJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwAlgoPool.h" // MEMbbwwAlgoPoolSingleLepton
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwProcessPool.h" // MEMbbwwProcessPool
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwTimingManager.h" // MEMbbwwTimingManager, MEMbbwwScopedTimer
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwCheckpointManager.h" // MEMbbwwCheckpointManager, MEMbbwwCheckpointState
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwResultCache.h" // MEMbbwwResultCache
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenEventSkim.h" // GenEventSkimReader, GenEventSkimWriter
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwInputTree.h" // MEMbbwwInputTree
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/selEntryIndexAuxFunctions.h" // getSelEntryRange, commitOutputFile
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/eventLoopAuxFunctions.h" // convert_to_ptrs, cleanCollection, selectCollection
 #include "hhAnalysis/bbww/interface/genMatchingAuxFunctions.h" // findGenLepton_and_NeutrinoFromWBoson
 #include "tthAnalysis/HiggsToTauTau/interface/histogramAuxFunctions.h" // fillWithOverFlow()
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenJetSmearer.h" // GenJetSmearer
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenMEtSmearer.h" // GenMEtSmearer
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/CounterBasedRandom.h" // CounterBasedRandom
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent_singlelepton.h" // MEMEvent_singlelepton
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwNtupleManager_singlelepton.h" // MEMbbwwNtupleManager_singlelepton
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/memNtupleAuxFunctions_singlelepton.h" // addGenMatches_singlelepton
@@ -67,6 +71,8 @@
 #include <vector> // std::vector<>
 #include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
 #include <fstream> // std::ofstream
+#include <deque> // std::deque<>
+#include <algorithm> // std::max(), std::find()
 #include <assert.h> // assert
 
 typedef math::PtEtaPhiMLorentzVector LV;
@@ -105,9 +111,10 @@ int main(int argc, char* argv[])
 
 //--- parse command-line arguments
   if ( argc < 2 ) {
-    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    std::cout << "Usage: " << argv[0] << " [parameters.py] [--resume]" << std::endl;
     return EXIT_FAILURE;
   }
+  bool resume = ( argc >= 3 && std::string(argv[2]) == "--resume" );
 
   std::cout << "<analyze_hh_bbwwMEM_singlelepton>:" << std::endl;
 
@@ -154,10 +161,6 @@ int main(int argc, char* argv[])
   double jetSmearing_coeff = cfg_analyze.getParameter<double>("jetSmearing_coeff");
   GenJetSmearer genJetSmearer;
   genJetSmearer.set_coeff(jetSmearing_coeff);
-  mem::BJetTF_toy bjetTF;
-  bjetTF.set_coeff(jetSmearing_coeff);
-  mem::HadWJetTF_toy hadWJetTF;
-  hadWJetTF.set_coeff(jetSmearing_coeff);
 
   bool apply_metSmearing = cfg_analyze.getParameter<bool>("apply_metSmearing");
   double metSmearing_sigmaX = cfg_analyze.getParameter<double>("metSmearing_sigmaX");
@@ -165,16 +168,33 @@ int main(int argc, char* argv[])
   GenMEtSmearer genMEtSmearer;
   genMEtSmearer.set_sigmaX(metSmearing_sigmaX);
   genMEtSmearer.set_sigmaY(metSmearing_sigmaY);
+
+  // random numbers are computed from (seed, run, lumi, event, object index),
+  // so that the result of the smearing and of the choice of fake b-jets does not depend on how events are split into jobs;
+  // different seeds are used for jet smearing, MET smearing and for choosing fake b-jets, so that these random numbers are uncorrelated
+  unsigned randomSeed = cfg_analyze.getParameter<unsigned>("randomSeed");
+  genJetSmearer.set_seed(randomSeed + 1);
+  genMEtSmearer.set_seed(randomSeed + 2);
+
+//--- process several smearing variants (e.g. jet and MET smearing enabled or disabled) in the same job,
+//    so that the input files are read and the generator-level selection is run only once per event.
+//    Each variant has its own histogram directory and MEM ntuples.
+//    If no variants are configured, the smearing is applied according to apply_jetSmearing and apply_metSmearing
+  edm::VParameterSet cfg_smearingVariants = cfg_analyze.getParameter<edm::VParameterSet>("smearingVariants");
+  if ( cfg_smearingVariants.empty() ) {
+    edm::ParameterSet cfg_smearingVariant;
+    cfg_smearingVariant.addParameter<bool>("apply_jetSmearing", apply_jetSmearing);
+    cfg_smearingVariant.addParameter<bool>("apply_metSmearing", apply_metSmearing);
+    cfg_smearingVariant.addParameter<std::string>("histogramDir", histogramDir);
+    cfg_smearingVariants.push_back(cfg_smearingVariant);
+  }
+
   TMatrixD metCov(2,2);
   metCov[0][0] = mem::square(metSmearing_sigmaX);
   metCov[1][0] = 0.;
   metCov[0][1] = 0.;
   metCov[1][1] = mem::square(metSmearing_sigmaY);
 
-  // random number generator for choosing fake b-jets
-  TRandom3 rnd;
-  rnd.SetSeed(12345);
-
   const std::string central_or_shift = "central";
   bool hasLHE = cfg_analyze.getParameter<bool>("hasLHE");
   bool apply_genWeight = cfg_analyze.getParameter<bool>("apply_genWeight");
@@ -197,77 +217,154 @@ int main(int argc, char* argv[])
   fwlite::InputSource inputFiles(cfg);
   int maxEvents = inputFiles.maxEvents();
   std::cout << " maxEvents = " << maxEvents << std::endl;
-  int skipSelEvents = cfg_analyze.getParameter<int>("skipSelEvents");
-  std::cout << " skipSelEvents = " << skipSelEvents << std::endl;
   int maxSelEvents = cfg_analyze.getParameter<int>("maxSelEvents");
   std::cout << " maxSelEvents = " << maxSelEvents << std::endl;
-  unsigned reportEvery = inputFiles.reportAfter();
+
+  // process only the range [firstSelEntry, lastSelEntry) of entries in the input files:
+  // the range boundaries are taken from the index of entries passing the generator-level selection,
+  // which is written by running the analyzer with makeSelEntryIndex = True.
+  // In case selEntryRangeIdx >= 0, the range is read from the index file at the start of the job
+  // and contains the selected entries selEntryRangeIdx*maxSelEvents, ..., (selEntryRangeIdx + 1)*maxSelEvents - 1.
+  // Entries outside of the range are not read at all (see MEMbbwwInputTree::setFirstEntry and GenEventSkimReader::setFirstEntry)
+  Long64_t firstSelEntry = cfg_analyze.getParameter<int>("firstSelEntry");
+  Long64_t lastSelEntry = cfg_analyze.getParameter<int>("lastSelEntry");
+  bool makeSelEntryIndex = cfg_analyze.getParameter<bool>("makeSelEntryIndex");
+  std::string selEntryIndexFileName = cfg_analyze.getParameter<std::string>("selEntryIndexFileName");
+  std::cout << " makeSelEntryIndex = " << makeSelEntryIndex << " (selEntryIndexFileName = " << selEntryIndexFileName << ")" << std::endl;
+  int selEntryRangeIdx = cfg_analyze.getParameter<int>("selEntryRangeIdx");
+  std::cout << " selEntryRangeIdx = " << selEntryRangeIdx << std::endl;
+  if ( selEntryRangeIdx >= 0 ) {
+    if ( makeSelEntryIndex || selEntryIndexFileName == "" || maxSelEvents <= 0 )
+      throw cms::Exception("analyze_hh_bbwwMEM_singlelepton")
+        << "Configuration parameter 'selEntryRangeIdx' requires 'selEntryIndexFileName' and 'maxSelEvents' > 0, and cannot be used together with 'makeSelEntryIndex' !!\n";
+    getSelEntryRange(selEntryIndexFileName, selEntryRangeIdx, maxSelEvents, firstSelEntry, lastSelEntry);
+  }
+  std::cout << " firstSelEntry = " << firstSelEntry << std::endl;
+  std::cout << " lastSelEntry = " << lastSelEntry << std::endl;
+  if ( lastSelEntry >= 0 && (maxEvents < 0 || lastSelEntry < maxEvents) ) {
+    maxEvents = lastSelEntry;
+  }
 
   fwlite::OutputFiles outputFile(cfg);
+
+  // write a checkpoint every 'checkpointInterval' selected events, so that a pre-empted job can be resumed
+  // by running the analyzer again with the option --resume on the command-line
+  int checkpointInterval = cfg_analyze.getParameter<int>("checkpointInterval");
+  std::cout << " checkpointInterval = " << checkpointInterval << " (resume = " << resume << ")" << std::endl;
+  MEMbbwwCheckpointManager checkpointManager(outputFile.file(), checkpointInterval, resume);
+  const MEMbbwwCheckpointState & checkpointState_resumed = checkpointManager.getState_resumed();
+  if ( checkpointManager.isResumed() && checkpointState_resumed.nextEntry_ > firstSelEntry ) {
+    firstSelEntry = checkpointState_resumed.nextEntry_;
+  }
+
+  // the index and skim files are written under a temporary name and renamed at the end of the job (see commitOutputFile)
+  std::ofstream* selEntryIndexFile = nullptr;
+  if ( makeSelEntryIndex ) {
+    if ( selEntryIndexFileName == "" )
+      throw cms::Exception("analyze_hh_bbwwMEM_singlelepton")
+        << "Configuration parameter 'selEntryIndexFileName' not defined !!\n";
+    selEntryIndexFile = checkpointManager.openOutputFile(selEntryIndexFileName + ".tmp", std::ios::out | std::ios::binary, checkpointState_resumed.selEntryIndexFileSize_);
+  }
+
+//--- write the generator-level objects, weights and event identifiers of events passing the generator-level selection
+//    to a compact skim file, which can be read instead of the Ntuples by running the analyzer with skimFileName_input
+  std::string skimFileName_output = cfg_analyze.getParameter<std::string>("skimFileName_output");
+  std::cout << " skimFileName_output = " << skimFileName_output << std::endl;
+  GenEventSkimWriter* skimWriter = nullptr;
+  if ( skimFileName_output != "" ) {
+    skimWriter = new GenEventSkimWriter(skimFileName_output + ".tmp");
+  }
+  std::string skimFileName_input = cfg_analyze.getParameter<std::string>("skimFileName_input");
+  std::cout << " skimFileName_input = " << skimFileName_input << std::endl;
+  if ( skimFileName_input != "" && (skimWriter || selEntryIndexFile) )
+    throw cms::Exception("analyze_hh_bbwwMEM_singlelepton")
+      << "Configuration parameter 'skimFileName_input' cannot be used together with 'skimFileName_output' or 'makeSelEntryIndex' !!\n";
+  // the histograms of generator-level particles and LHE weights need the full collections of generator-level particles and the LHE weights,
+  // which are read from the Ntuples and are not stored in the skim file
+  bool fillGenHistograms = cfg_analyze.getParameter<bool>("fillGenHistograms");
+  std::cout << " fillGenHistograms = " << fillGenHistograms << std::endl;
+  if ( skimFileName_input != "" && fillGenHistograms )
+    throw cms::Exception("analyze_hh_bbwwMEM_singlelepton")
+      << "Histograms of generator-level particles and LHE weights cannot be filled from skim file = " << skimFileName_input << ","
+      << " set configuration parameter 'fillGenHistograms' to False !!\n";
+  unsigned reportEvery = inputFiles.reportAfter();
+
   fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
 
-  TTreeWrapper* inputTree = new TTreeWrapper(treeName.data(), inputFiles.files(), maxEvents);
-  std::cout << "Loaded " << inputTree->getFileCount() << " file(s)." << std::endl;
+  // the Ntuples are not opened in case the events are read from a skim file
+  MEMbbwwInputTree* inputTree = nullptr;
+  if ( skimFileName_input == "" ) {
+    inputTree = new MEMbbwwInputTree(treeName.data(), inputFiles.files(), maxEvents);
+    inputTree->setFirstEntry(firstSelEntry);
+    std::cout << "Loaded " << inputTree->getFileCount() << " file(s)." << std::endl;
+  }
 
 //--- declare event-level variables
   EventInfo eventInfo(analysisConfig);
   EventInfoReader eventInfoReader(&eventInfo);
-  inputTree->registerReader(&eventInfoReader);
+  GenEventSkimReader* skimReader = nullptr;
+  if ( inputTree ) {
+    inputTree->registerReader(&eventInfoReader);
+  } else {
+    skimReader = new GenEventSkimReader(skimFileName_input, maxEvents, &eventInfo);
+    skimReader->setFirstEntry(firstSelEntry);
+    std::cout << "Loaded " << skimReader->numEvents() << " event(s) from skim file." << std::endl;
+  }
 
 //--- declare collections of generator-level particles
   GenLeptonReader* genLeptonReader = nullptr;
   if ( branchName_genLeptons != "" ) {
     genLeptonReader = new GenLeptonReader(branchName_genLeptons);
-    inputTree->registerReader(genLeptonReader);
+    if ( inputTree ) inputTree->registerReader(genLeptonReader);
   }
   GenParticleReader* genNeutrinoReader = nullptr;
   if ( branchName_genNeutrinos != "" ) {
     genNeutrinoReader = new GenParticleReader(branchName_genNeutrinos);
-    inputTree->registerReader(genNeutrinoReader);
+    if ( inputTree ) inputTree->registerReader(genNeutrinoReader);
   }
   GenJetReader* genJetReader = nullptr;
   if ( branchName_genJets != "" ) {
     genJetReader = new GenJetReader(branchName_genJets);
-    inputTree->registerReader(genJetReader);
+    if ( inputTree ) inputTree->registerReader(genJetReader);
   }
     
   // collections specific to HH signal
   GenParticleReader* genParticleFromHiggsReader = nullptr;
   if ( branchName_genParticlesFromHiggs != "" ) {
     genParticleFromHiggsReader = new GenParticleReader(branchName_genParticlesFromHiggs);
-    inputTree->registerReader(genParticleFromHiggsReader);
+    if ( inputTree ) inputTree->registerReader(genParticleFromHiggsReader);
   }
   GenParticleReader* genWBosonReader = nullptr;
   if ( branchName_genWBosons != "" ) {
     genWBosonReader = new GenParticleReader(branchName_genWBosons);
-    inputTree->registerReader(genWBosonReader);
+    if ( inputTree ) inputTree->registerReader(genWBosonReader);
   }
   GenParticleReader* genWJetReader = nullptr;
   if ( branchName_genWJets != "" ) {
     genWJetReader = new GenParticleReader(branchName_genWJets);
-    inputTree->registerReader(genWJetReader);
+    if ( inputTree ) inputTree->registerReader(genWJetReader);
   }
 
   // collections specific to ttbar background
   GenLeptonReader* genLeptonFromTopReader = nullptr;  
   if ( branchName_genLeptonsFromTop != "" ) {
     genLeptonFromTopReader = new GenLeptonReader(branchName_genLeptonsFromTop);
-    inputTree->registerReader(genLeptonFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genLeptonFromTopReader);
   }
   GenParticleReader* genNeutrinoFromTopReader = nullptr;
   if ( branchName_genNeutrinosFromTop != "" ) {
     genNeutrinoFromTopReader = new GenParticleReader(branchName_genNeutrinosFromTop);
-    inputTree->registerReader(genNeutrinoFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genNeutrinoFromTopReader);
   }
   GenParticleReader* genBQuarksFromTopReader = nullptr;
   if ( branchName_genBQuarksFromTop != "" ) {
     genBQuarksFromTopReader = new GenParticleReader(branchName_genBQuarksFromTop);
-    inputTree->registerReader(genBQuarksFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genBQuarksFromTopReader);
   }
   GenParticleReader* genWJetsFromTopReader = nullptr;
   if ( branchName_genWJetsFromTop != "" ) {
     genWJetsFromTopReader = new GenParticleReader(branchName_genWJetsFromTop);
-    inputTree->registerReader(genWJetsFromTopReader);
+    if ( inputTree ) inputTree->registerReader(genWJetsFromTopReader);
   }
 
   GenLeptonCollectionSelector genLeptonSelector(era, -1, isDEBUG);
@@ -277,24 +374,18 @@ int main(int argc, char* argv[])
   GenJetCollectionSelector genJetSelector(era, -1, isDEBUG);
   genJetSelector.getSelector().set_min_pt(20.);
   genJetSelector.getSelector().set_max_absEta(2.4);
-  GenJetCollectionCleaner genJetCleaner(0.4, isDEBUG);
+  // generator-level jets are required to be separated by dR >= 0.4 from the generator-level leptons, b-jets and W-jets
+  const double genJetCleaning_dRmin = 0.4;
 
 //--- declare other generator level information
   LHEInfoReader* lheInfoReader = new LHEInfoReader(hasLHE);
-  inputTree->registerReader(lheInfoReader);
+  if ( inputTree ) inputTree->registerReader(lheInfoReader);
 
 //--- open output file containing run:lumi:event numbers of events passing final event selection criteria
-  std::ostream* selEventsFile = ( selEventsFileName_output != "" ) ? new std::ofstream(selEventsFileName_output.data(), std::ios::out) : 0;
+  std::ostream* selEventsFile = ( selEventsFileName_output != "" ) ? checkpointManager.openOutputFile(selEventsFileName_output, std::ios::out, checkpointState_resumed.selEventsFileSize_) : 0;
   std::cout << "selEventsFileName_output = " << selEventsFileName_output << std::endl;
 
 //--- declare histograms
-  GenEvtHistManager* genEvtHistManager_beforeCuts = new GenEvtHistManager(makeHistManager_cfg(process_string,
-    Form("%s/unbiased/genEvt", histogramDir.data()), era_string, central_or_shift));
-  genEvtHistManager_beforeCuts->bookHistograms(fs);
-  LHEInfoHistManager* lheInfoHistManager_beforeCuts = new LHEInfoHistManager(makeHistManager_cfg(process_string,
-    Form("%s/unbiased/lheInfo", histogramDir.data()), era_string, central_or_shift));
-  lheInfoHistManager_beforeCuts->bookHistograms(fs);
-  
   struct selHistManagerType
   {
     MEMbbwwHistManagerSingleLepton* mem_2genuineBJets_2genuineWJets_;
@@ -313,77 +404,30 @@ int main(int argc, char* argv[])
     LHEInfoHistManager* lheInfoHistManager_afterCuts_;
     WeightHistManager* weights_;
   };
-  selHistManagerType* selHistManager = new selHistManagerType();
-  selHistManager->mem_2genuineBJets_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_2genuineBJets_2genuineWJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_2genuineBJets_2genuineWJets_->bookHistograms(fs);
-  selHistManager->mem_1genuineBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_1genuineBJet_2genuineWJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_1genuineBJet_2genuineWJets_->bookHistograms(fs);
-  selHistManager->mem_2genuineBJets_1genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_2genuineBJets_1genuineWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_2genuineBJets_1genuineWJet_->bookHistograms(fs);
-  selHistManager->mem_1genuineBJet_1genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_1genuineBJet_1genuineWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_1genuineBJet_1genuineWJet_->bookHistograms(fs);
-  selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBJet_genuineBJet_2genuineWJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_->bookHistograms(fs);
-  selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBJet_fakeBJet_2genuineWJets", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_->bookHistograms(fs);
-  selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingWJet_2genuineBJets_genuineWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_->bookHistograms(fs);
-  selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingWJet_2genuineBJets_fakeWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_->bookHistograms(fs);
-  selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBnWJet_genuineBJet_genuineWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_->bookHistograms(fs);
-  selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBnWJet_fakeBJet_genuineWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_->bookHistograms(fs);
-  selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBnWJet_genuineBJet_fakeWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_->bookHistograms(fs);
-  selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
-    Form("%s/sel/mem_missingBnWJet_fakeBJet_fakeWJet", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_->bookHistograms(fs);
-  selHistManager->genEvtHistManager_afterCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/genEvt", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->genEvtHistManager_afterCuts_->bookHistograms(fs);
-  selHistManager->lheInfoHistManager_afterCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/lheInfo", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->lheInfoHistManager_afterCuts_->bookHistograms(fs);
-  selHistManager->weights_ = new WeightHistManager(makeHistManager_cfg(process_string,
-    Form("%s/sel/weights", histogramDir.data()), era_string, central_or_shift));
-  selHistManager->weights_->bookHistograms(fs, { "genWeight", "pileupWeight" });
 
-  std::string ntupleDir = Form("%s/ntuples/%s", histogramDir.data(), process_string.data());
-  MEMbbwwNtupleManager_singlelepton* mem_ntuple = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem");
-  mem_ntuple->makeTree(fs);
-  mem_ntuple->initializeBranches();
-  MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingBJet = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingBJet");
-  mem_ntuple_missingBJet->makeTree(fs);
-  mem_ntuple_missingBJet->initializeBranches();
-  MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingWJet = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingWJet");
-  mem_ntuple_missingWJet->makeTree(fs);
-  mem_ntuple_missingWJet->initializeBranches();
-  MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingBnWJet = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingBnWJet");
-  mem_ntuple_missingBnWJet->makeTree(fs);
-  mem_ntuple_missingBnWJet->initializeBranches();
-
-  int analyzedEntries = 0;
-  int skippedEntries = 0;
-  int selectedEntries = 0;
-  double selectedEntries_weighted = 0.;
-  TH1* histogram_analyzedEntries = fs.make<TH1D>("analyzedEntries", "analyzedEntries", 1, -0.5, +0.5);
-  TH1* histogram_selectedEntries = fs.make<TH1D>("selectedEntries", "selectedEntries", 1, -0.5, +0.5);
-  cutFlowTableType cutFlowTable;
-  const edm::ParameterSet cutFlowTableCfg = makeHistManager_cfg(
-    process_string, Form("%s/sel/cutFlow", histogramDir.data()), era_string, central_or_shift
-  );
+  struct smearingVariantType
+  {
+    // return true once maxSelEvents events have been selected for this variant
+    bool isDone(int maxSelEvents) const
+    {
+      return maxSelEvents >= 0 && selectedEntries_ >= maxSelEvents;
+    }
+    bool apply_jetSmearing_;
+    bool apply_metSmearing_;
+    std::string histogramDir_;
+    GenEvtHistManager* genEvtHistManager_beforeCuts_;
+    LHEInfoHistManager* lheInfoHistManager_beforeCuts_;
+    selHistManagerType* selHistManager_;
+    MEMbbwwNtupleManager_singlelepton* mem_ntuple_;
+    MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingBJet_;
+    MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingWJet_;
+    MEMbbwwNtupleManager_singlelepton* mem_ntuple_missingBnWJet_;
+    cutFlowTableType cutFlowTable_;
+    CutFlowTableHistManager* cutFlowHistManager_;
+    int selectedEntries_;
+    double selectedEntries_weighted_;
+  };
+
   const std::vector<std::string> cuts = {
     "run:ls:event selection",
     ">= 1 gen lepton",
@@ -392,743 +436,1123 @@ int main(int argc, char* argv[])
     ">= 2 gen b-jets",
     ">= 2 gen jets from W->jj"
   };
-  CutFlowTableHistManager * cutFlowHistManager = new CutFlowTableHistManager(cutFlowTableCfg, cuts);
-  cutFlowHistManager->bookHistograms(fs);
-  while ( inputTree->hasNextEvent() && (! run_lumi_eventSelector || (run_lumi_eventSelector && ! run_lumi_eventSelector -> areWeDone())) && selectedEntries < maxSelEvents ) {
-    if ( inputTree -> canReport(reportEvery) ) {
+
+  if ( checkpointManager.isResumed() && checkpointState_resumed.selectedEntries_variant_.size() != cfg_smearingVariants.size() )
+    throw cms::Exception("analyze_hh_bbwwMEM_singlelepton")
+      << "Number of smearing variants stored in checkpoint = " << checkpointState_resumed.selectedEntries_variant_.size()
+      << " does not match number of smearing variants in configuration = " << cfg_smearingVariants.size() << " !!\n";
+
+  MEMbbwwNtupleWriteOptions memNtupleWriteOptions(cfg_analyze.getParameter<edm::ParameterSet>("memNtupleWriteOptions"));
+  bool useSparseHistograms = cfg_analyze.getParameter<bool>("useSparseHistograms");
+
+  std::vector<smearingVariantType*> smearingVariants;
+  for ( size_t idxVariant = 0; idxVariant < cfg_smearingVariants.size(); ++idxVariant ) {
+    const edm::ParameterSet& cfg_smearingVariant = cfg_smearingVariants[idxVariant];
+    smearingVariantType* smearingVariant = new smearingVariantType();
+    smearingVariant->apply_jetSmearing_ = cfg_smearingVariant.getParameter<bool>("apply_jetSmearing");
+    smearingVariant->apply_metSmearing_ = cfg_smearingVariant.getParameter<bool>("apply_metSmearing");
+    smearingVariant->histogramDir_ = cfg_smearingVariant.getParameter<std::string>("histogramDir");
+    std::cout << " smearing variant #" << idxVariant << ": apply_jetSmearing = " << smearingVariant->apply_jetSmearing_ << ","
+              << " apply_metSmearing = " << smearingVariant->apply_metSmearing_ << " (histogramDir = " << smearingVariant->histogramDir_ << ")" << std::endl;
+
+    smearingVariant->genEvtHistManager_beforeCuts_ = nullptr;
+    smearingVariant->lheInfoHistManager_beforeCuts_ = nullptr;
+    if ( fillGenHistograms ) {
+      smearingVariant->genEvtHistManager_beforeCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
+        Form("%s/unbiased/genEvt", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      smearingVariant->genEvtHistManager_beforeCuts_->bookHistograms(fs);
+      smearingVariant->lheInfoHistManager_beforeCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
+        Form("%s/unbiased/lheInfo", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      smearingVariant->lheInfoHistManager_beforeCuts_->bookHistograms(fs);
+    }
+
+    selHistManagerType* selHistManager = new selHistManagerType();
+    selHistManager->mem_2genuineBJets_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_2genuineBJets_2genuineWJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_2genuineBJets_2genuineWJets_->bookHistograms(fs);
+    selHistManager->mem_1genuineBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_1genuineBJet_2genuineWJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_1genuineBJet_2genuineWJets_->bookHistograms(fs);
+    selHistManager->mem_2genuineBJets_1genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_2genuineBJets_1genuineWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_2genuineBJets_1genuineWJet_->bookHistograms(fs);
+    selHistManager->mem_1genuineBJet_1genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_1genuineBJet_1genuineWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_1genuineBJet_1genuineWJet_->bookHistograms(fs);
+    selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBJet_genuineBJet_2genuineWJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_->bookHistograms(fs);
+    selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBJet_fakeBJet_2genuineWJets", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_->bookHistograms(fs);
+    selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingWJet_2genuineBJets_genuineWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_->bookHistograms(fs);
+    selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingWJet_2genuineBJets_fakeWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_->bookHistograms(fs);
+    selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBnWJet_genuineBJet_genuineWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_->bookHistograms(fs);
+    selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBnWJet_fakeBJet_genuineWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_->bookHistograms(fs);
+    selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBnWJet_genuineBJet_fakeWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_->bookHistograms(fs);
+    selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_ = new MEMbbwwHistManagerSingleLepton(makeHistManager_cfg(process_string,
+      Form("%s/sel/mem_missingBnWJet_fakeBJet_fakeWJet", smearingVariant->histogramDir_.data()), era_string, central_or_shift), useSparseHistograms);
+    selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_->bookHistograms(fs);
+    selHistManager->genEvtHistManager_afterCuts_ = nullptr;
+    selHistManager->lheInfoHistManager_afterCuts_ = nullptr;
+    if ( fillGenHistograms ) {
+      selHistManager->genEvtHistManager_afterCuts_ = new GenEvtHistManager(makeHistManager_cfg(process_string,
+        Form("%s/sel/genEvt", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      selHistManager->genEvtHistManager_afterCuts_->bookHistograms(fs);
+      selHistManager->lheInfoHistManager_afterCuts_ = new LHEInfoHistManager(makeHistManager_cfg(process_string,
+        Form("%s/sel/lheInfo", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+      selHistManager->lheInfoHistManager_afterCuts_->bookHistograms(fs);
+    }
+    selHistManager->weights_ = new WeightHistManager(makeHistManager_cfg(process_string,
+      Form("%s/sel/weights", smearingVariant->histogramDir_.data()), era_string, central_or_shift));
+    selHistManager->weights_->bookHistograms(fs, { "genWeight", "pileupWeight" });
+    smearingVariant->selHistManager_ = selHistManager;
+
+    std::string ntupleDir = Form("%s/ntuples/%s", smearingVariant->histogramDir_.data(), process_string.data());
+    smearingVariant->mem_ntuple_ = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem");
+    smearingVariant->mem_ntuple_->makeTree(fs);
+    smearingVariant->mem_ntuple_->initializeBranches(memNtupleWriteOptions);
+    smearingVariant->mem_ntuple_missingBJet_ = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingBJet");
+    smearingVariant->mem_ntuple_missingBJet_->makeTree(fs);
+    smearingVariant->mem_ntuple_missingBJet_->initializeBranches(memNtupleWriteOptions);
+    smearingVariant->mem_ntuple_missingWJet_ = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingWJet");
+    smearingVariant->mem_ntuple_missingWJet_->makeTree(fs);
+    smearingVariant->mem_ntuple_missingWJet_->initializeBranches(memNtupleWriteOptions);
+    smearingVariant->mem_ntuple_missingBnWJet_ = new MEMbbwwNtupleManager_singlelepton(ntupleDir, "mem_missingBnWJet");
+    smearingVariant->mem_ntuple_missingBnWJet_->makeTree(fs);
+    smearingVariant->mem_ntuple_missingBnWJet_->initializeBranches(memNtupleWriteOptions);
+
+    const edm::ParameterSet cutFlowTableCfg = makeHistManager_cfg(
+      process_string, Form("%s/sel/cutFlow", smearingVariant->histogramDir_.data()), era_string, central_or_shift
+    );
+    smearingVariant->cutFlowHistManager_ = new CutFlowTableHistManager(cutFlowTableCfg, cuts);
+    smearingVariant->cutFlowHistManager_->bookHistograms(fs);
+
+    if ( checkpointManager.isResumed() ) {
+      smearingVariant->selectedEntries_ = checkpointState_resumed.selectedEntries_variant_[idxVariant];
+      smearingVariant->selectedEntries_weighted_ = checkpointState_resumed.selectedEntries_weighted_variant_[idxVariant];
+    } else {
+      smearingVariant->selectedEntries_ = 0;
+      smearingVariant->selectedEntries_weighted_ = 0.;
+    }
+    smearingVariants.push_back(smearingVariant);
+  }
+
+  // the timing information is stored once per job, in the ntuple directory of the job-level histogramDir
+  std::string ntupleDir = Form("%s/ntuples/%s", histogramDir.data(), process_string.data());
+
+//--- create MEM algorithm instances once per job (instead of once per event)
+  MEMbbwwAlgoConfig memAlgoConfig;
+  memAlgoConfig.sqrtS_ = 13.e+3;
+  memAlgoConfig.pdfName_ = "MSTW2008lo68cl";
+  memAlgoConfig.madgraphFileName_signal_ = "hhAnalysis/bbwwMEM/data/param_hh_SM.dat";
+  memAlgoConfig.madgraphFileName_background_ = "hhAnalysis/bbwwMEM/data/param_ttbar.dat";
+  memAlgoConfig.applyOnshellWmassConstraint_signal_ = false;
+  memAlgoConfig.intMode_ = MEMbbwwAlgoSingleLepton::kVAMP;
+  memAlgoConfig.maxObjFunctionCalls_signal_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal");
+  memAlgoConfig.maxObjFunctionCalls_background_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background");
+  memAlgoConfig.maxObjFunctionCalls_inactive_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_inactive");
+  memAlgoConfig.memLRerrTarget_ = cfg_analyze.getParameter<double>("memLRerrTarget");
+  memAlgoConfig.maxObjFunctionCalls_signal_initial_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal_initial");
+  memAlgoConfig.maxObjFunctionCalls_background_initial_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background_initial");
+  memAlgoConfig.maxObjFunctionCalls_signal_max_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_signal_max");
+  memAlgoConfig.maxObjFunctionCalls_background_max_ = cfg_analyze.getParameter<int>("maxObjFunctionCalls_background_max");
+  std::cout << " maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_ << ","
+            << " background = " << memAlgoConfig.maxObjFunctionCalls_background_ << std::endl;
+  if ( memAlgoConfig.memLRerrTarget_ > 0. ) {
+    std::cout << " adaptive integration: memLRerrTarget = " << memAlgoConfig.memLRerrTarget_ << ","
+              << " initial maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_initial_ << ","
+              << " background = " << memAlgoConfig.maxObjFunctionCalls_background_initial_ << ","
+              << " max. maxObjFunctionCalls: signal = " << memAlgoConfig.maxObjFunctionCalls_signal_max_ << ","
+              << " background = " << memAlgoConfig.maxObjFunctionCalls_background_max_ << std::endl;
+  }
+  memAlgoConfig.jetSmearing_coeff_ = jetSmearing_coeff;
+  memAlgoConfig.verbosity_ = 0;
+  MEMbbwwAlgoPoolSingleLepton memAlgoPool(memAlgoConfig);
+
+//--- measure wall-clock and CPU time spent in the different phases of the event processing
+  MEMbbwwTimingManager timingManager(ntupleDir, "timing");
+  memAlgoPool.setTimingManager(&timingManager);
+  if ( checkpointManager.isResumed() ) {
+    // add the times spent before the last checkpoint, so that the timing summary covers the whole job
+    for ( size_t idxPhase = 0; idxPhase < checkpointState_resumed.timingPhases_.size(); ++idxPhase ) {
+      timingManager.addTotals(checkpointState_resumed.timingPhases_[idxPhase].data(), checkpointState_resumed.timingNumCalls_[idxPhase],
+        checkpointState_resumed.timingWallTimes_[idxPhase], checkpointState_resumed.timingCpuTimes_[idxPhase]);
+    }
+  }
+
+//--- take MEM results from an on-disk cache in case the same inputs have been integrated by a previous job
+  std::string memResultCacheDir = cfg_analyze.getParameter<std::string>("memResultCacheDir");
+  std::cout << " memResultCacheDir = " << memResultCacheDir << std::endl;
+  MEMbbwwResultCache* memResultCache = nullptr;
+  if ( memResultCacheDir != "" ) {
+    memResultCache = new MEMbbwwResultCache(memResultCacheDir);
+    memAlgoPool.setResultCache(memResultCache);
+  }
+
+//--- run MEM integrations in numProcesses worker processes, while events are read and selected by the main process.
+//    The MEM ntuples and histograms are filled by the main process, in the order in which the events are read.
+//    The MEM algorithms share global state between instances, so integrations can only run concurrently in separate processes.
+//    The worker processes are forked when the MEMbbwwProcessPool is created,
+//    so the pool needs to be created once the MEM algorithm pool, the timing manager and the result cache are set up.
+//    Use test/checkProcessInvariance.sh to check that the output does not depend on the number of processes.
+//    If parallelHypotheses is enabled, the integrations for the different hypotheses (full, missing jet cases)
+//    of the same event are sent to different worker processes, which reduces the wall-clock time per event in case there are idle cores.
+  unsigned numProcesses = cfg_analyze.getParameter<unsigned>("numProcesses");
+  std::cout << " numProcesses = " << numProcesses << std::endl;
+  bool parallelHypotheses = cfg_analyze.getParameter<bool>("parallelHypotheses");
+  std::cout << " parallelHypotheses = " << parallelHypotheses << std::endl;
+  MEMbbwwProcessPool memProcessPool(numProcesses, [&memAlgoPool](const std::string & request, std::string & response) {
+    memAlgoPool.process<MEMbbwwResultSingleLepton>(request, response);
+  }, &timingManager);
+  const size_t maxMemTasks = std::max(1u, 4*memProcessPool.numProcesses());
+
+  struct memTaskType
+  {
+    memTaskType(MEMbbwwAlgoPoolSingleLepton & memAlgoPool, MEMbbwwProcessPool & memProcessPool)
+      : smearingVariant_(nullptr)
+      , measuredMEtPx_(0.)
+      , measuredMEtPy_(0.)
+      , numGenuineBJets_(0)
+      , numGenuineWJets_(0)
+      , numGenuineBJets_missingBJet_(0)
+      , numGenuineWJets_missingWJet_(0)
+      , numGenuineBJets_missingBnWJet_(0)
+      , numGenuineWJets_missingBnWJet_(0)
+      , evtWeight_(1.)
+      , memRequest_(memAlgoPool, memProcessPool)
+    {}
+    // reset the task for the next event, keeping the memory of its collections and of its MEM request
+    void clear()
+    {
+      smearingVariant_ = nullptr;
+      memMeasuredParticles_.clear();
+      memEvent_ = MEMEvent_singlelepton();
+      memResult_ = MEMbbwwResultSingleLepton();
+      memStats_ = MEMbbwwIntegrationStats();
+      memMeasuredParticles_missingBJet_.clear();
+      memEvent_missingBJet_ = MEMEvent_singlelepton();
+      memResult_missingBJet_ = MEMbbwwResultSingleLepton();
+      memStats_missingBJet_ = MEMbbwwIntegrationStats();
+      memMeasuredParticles_missingWJet_.clear();
+      memEvent_missingWJet_ = MEMEvent_singlelepton();
+      memResult_missingWJet_ = MEMbbwwResultSingleLepton();
+      memStats_missingWJet_ = MEMbbwwIntegrationStats();
+      memMeasuredParticles_missingBnWJet_.clear();
+      memEvent_missingBnWJet_ = MEMEvent_singlelepton();
+      memResult_missingBnWJet_ = MEMbbwwResultSingleLepton();
+      memStats_missingBnWJet_ = MEMbbwwIntegrationStats();
+      measuredMEtPx_ = 0.;
+      measuredMEtPy_ = 0.;
+      numGenuineBJets_ = 0;
+      numGenuineWJets_ = 0;
+      numGenuineBJets_missingBJet_ = 0;
+      numGenuineWJets_missingWJet_ = 0;
+      numGenuineBJets_missingBnWJet_ = 0;
+      numGenuineWJets_missingBnWJet_ = 0;
+      evtWeight_ = 1.;
+      memRequest_.clear();
+    }
+    smearingVariantType* smearingVariant_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_;
+    MEMEvent_singlelepton memEvent_;
+    MEMbbwwResultSingleLepton memResult_;
+    MEMbbwwIntegrationStats memStats_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBJet_;
+    MEMEvent_singlelepton memEvent_missingBJet_;
+    MEMbbwwResultSingleLepton memResult_missingBJet_;
+    MEMbbwwIntegrationStats memStats_missingBJet_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingWJet_;
+    MEMEvent_singlelepton memEvent_missingWJet_;
+    MEMbbwwResultSingleLepton memResult_missingWJet_;
+    MEMbbwwIntegrationStats memStats_missingWJet_;
+    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBnWJet_;
+    MEMEvent_singlelepton memEvent_missingBnWJet_;
+    MEMbbwwResultSingleLepton memResult_missingBnWJet_;
+    MEMbbwwIntegrationStats memStats_missingBnWJet_;
+    double measuredMEtPx_;
+    double measuredMEtPy_;
+    int numGenuineBJets_;
+    int numGenuineWJets_;
+    int numGenuineBJets_missingBJet_;
+    int numGenuineWJets_missingWJet_;
+    int numGenuineBJets_missingBnWJet_;
+    int numGenuineWJets_missingBnWJet_;
+    double evtWeight_;
+    MEMbbwwIntegrationRequest<MEMbbwwAlgoSingleLepton, MEMbbwwResultSingleLepton> memRequest_;
+  };
+  std::deque<memTaskType*> memTasks;
+  // tasks whose output has been written are reused for the following events,
+  // so that the memory of their collections and of their MEM requests is allocated only once
+  std::vector<memTaskType*> memTasks_free;
+
+  // fill MEM ntuples and histograms for finished events, 
+  // waiting for the oldest event in case more than maxMemTasks events are in flight
+  auto writeMEMTasks = [&](size_t maxMemTasks_inFlight) {
+    while ( !memTasks.empty() ) {
+      memTaskType* memTask = memTasks.front();
+      if ( memTasks.size() <= maxMemTasks_inFlight && !memTask->memRequest_.isReady() ) break;
+      {
+        MEMbbwwScopedTimer timer(&timingManager, "waiting for MEM integration");
+        memTask->memRequest_.receive();
+      }
+      memTasks.pop_front();
+      MEMbbwwScopedTimer timer(&timingManager, "ntuple and histogram filling");
+      smearingVariantType* smearingVariant = memTask->smearingVariant_;
+      selHistManagerType* selHistManager = smearingVariant->selHistManager_;
+
+      if ( isDEBUG ) {
+        std::cout << "MEM:"
+                  << " probability for signal hypothesis = " << memTask->memResult_.getProb_signal() 
+                  << " +/- " << memTask->memResult_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_.getProb_background() 
+                  << " +/- " << memTask->memResult_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_.cpuTime_ << ")" << std::endl;
+        std::cout << "MEM (missing b-jet case):" 
+                  << " probability for signal hypothesis = " << memTask->memResult_missingBJet_.getProb_signal() 
+                  << " +/- " << memTask->memResult_missingBJet_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_missingBJet_.getProb_background() 
+                  << " +/- " << memTask->memResult_missingBJet_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_missingBJet_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_missingBJet_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_missingBJet_.cpuTime_ << ")" << std::endl;
+        std::cout << "MEM (missing jet from W->jj case):" 
+                  << " probability for signal hypothesis = " << memTask->memResult_missingWJet_.getProb_signal() 
+                  << " +/- " << memTask->memResult_missingWJet_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_missingWJet_.getProb_background() 
+                  << " +/- " << memTask->memResult_missingWJet_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_missingWJet_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_missingWJet_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_missingWJet_.cpuTime_ << ")" << std::endl;
+        std::cout << "MEM (missing b-jet && jet from W->jj case):" 
+                  << " probability for signal hypothesis = " << memTask->memResult_missingBnWJet_.getProb_signal() 
+                  << " +/- " << memTask->memResult_missingBnWJet_.getProbErr_signal() << ","
+                  << " probability for background hypothesis = " << memTask->memResult_missingBnWJet_.getProb_background() 
+                  << " +/- " << memTask->memResult_missingBnWJet_.getProbErr_background() << " " 
+                  << "--> likelihood ratio = " << memTask->memResult_missingBnWJet_.getLikelihoodRatio() 
+                  << " +/- " << memTask->memResult_missingBnWJet_.getLikelihoodRatioErr() 
+                  << " (CPU time = " << memTask->memStats_missingBnWJet_.cpuTime_ << ")" << std::endl;
+      }
+
+      memTask->memEvent_.set_memResult(memTask->memResult_);
+      memTask->memEvent_.set_memCpuTime(memTask->memStats_.cpuTime_);
+      memTask->memEvent_.set_memIntegrationStats(memTask->memStats_);
+      smearingVariant->mem_ntuple_->read(memTask->memEvent_);
+      smearingVariant->mem_ntuple_->fill();
+
+      memTask->memEvent_missingBJet_.set_memResult(memTask->memResult_missingBJet_);
+      memTask->memEvent_missingBJet_.set_memCpuTime(memTask->memStats_missingBJet_.cpuTime_);
+      memTask->memEvent_missingBJet_.set_memIntegrationStats(memTask->memStats_missingBJet_);
+      smearingVariant->mem_ntuple_missingBJet_->read(memTask->memEvent_missingBJet_);
+      smearingVariant->mem_ntuple_missingBJet_->fill();
+
+      memTask->memEvent_missingWJet_.set_memResult(memTask->memResult_missingWJet_);
+      memTask->memEvent_missingWJet_.set_memCpuTime(memTask->memStats_missingWJet_.cpuTime_);
+      memTask->memEvent_missingWJet_.set_memIntegrationStats(memTask->memStats_missingWJet_);
+      smearingVariant->mem_ntuple_missingWJet_->read(memTask->memEvent_missingWJet_);
+      smearingVariant->mem_ntuple_missingWJet_->fill();
+
+      memTask->memEvent_missingBnWJet_.set_memResult(memTask->memResult_missingBnWJet_);
+      memTask->memEvent_missingBnWJet_.set_memCpuTime(memTask->memStats_missingBnWJet_.cpuTime_);
+      memTask->memEvent_missingBnWJet_.set_memIntegrationStats(memTask->memStats_missingBnWJet_);
+      smearingVariant->mem_ntuple_missingBnWJet_->read(memTask->memEvent_missingBnWJet_);
+      smearingVariant->mem_ntuple_missingBnWJet_->fill();
+
+      double evtWeight = memTask->evtWeight_;
+      int numGenuineBJets = memTask->numGenuineBJets_;
+      int numGenuineWJets = memTask->numGenuineWJets_;
+      if ( numGenuineBJets == 2 && numGenuineWJets == 2 ) {
+        selHistManager->mem_2genuineBJets_2genuineWJets_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+      } else if ( numGenuineBJets == 1 && numGenuineWJets == 2 ) {
+        selHistManager->mem_1genuineBJet_2genuineWJets_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+      } else if ( numGenuineBJets == 2 && numGenuineWJets == 1 ) {
+        selHistManager->mem_2genuineBJets_1genuineWJet_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+      } else if ( numGenuineBJets == 1 && numGenuineWJets == 1 ) {
+        selHistManager->mem_1genuineBJet_1genuineWJet_->fillHistograms(memTask->memResult_, memTask->memStats_, evtWeight);
+      } 
+      int numGenuineBJets_missingBJet = memTask->numGenuineBJets_missingBJet_;
+      if ( numGenuineBJets_missingBJet == 1 && numGenuineWJets == 2 ) {
+        selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_->fillHistograms(memTask->memResult_missingBJet_, memTask->memStats_missingBJet_, evtWeight);
+      } else if ( numGenuineBJets_missingBJet == 0 && numGenuineWJets == 2 ) {
+        selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_->fillHistograms(memTask->memResult_missingBJet_, memTask->memStats_missingBJet_, evtWeight);
+      }
+      int numGenuineWJets_missingWJet = memTask->numGenuineWJets_missingWJet_;
+      if ( numGenuineBJets == 2 && numGenuineWJets_missingWJet == 1 ) {
+        selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_->fillHistograms(memTask->memResult_missingWJet_, memTask->memStats_missingWJet_, evtWeight);
+      } else if ( numGenuineBJets == 2 && numGenuineWJets_missingWJet == 0 ) {
+        selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_->fillHistograms(memTask->memResult_missingWJet_, memTask->memStats_missingWJet_, evtWeight);
+      }
+      int numGenuineBJets_missingBnWJet = memTask->numGenuineBJets_missingBnWJet_;
+      int numGenuineWJets_missingBnWJet = memTask->numGenuineWJets_missingBnWJet_;
+      if ( numGenuineBJets_missingBnWJet == 1 && numGenuineWJets_missingBnWJet == 1 ) {
+        selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_->fillHistograms(memTask->memResult_missingBnWJet_, memTask->memStats_missingBnWJet_, evtWeight);
+      } else if ( numGenuineBJets_missingBnWJet == 0 && numGenuineWJets_missingBnWJet == 1 ) {
+        selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_->fillHistograms(memTask->memResult_missingBnWJet_, memTask->memStats_missingBnWJet_, evtWeight);
+      } else if ( numGenuineBJets_missingBnWJet == 1 && numGenuineWJets_missingBnWJet == 0 ) {
+        selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_->fillHistograms(memTask->memResult_missingBnWJet_, memTask->memStats_missingBnWJet_, evtWeight);
+      } else if ( numGenuineBJets_missingBnWJet == 0 && numGenuineWJets_missingBnWJet == 0 ) {
+        selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_->fillHistograms(memTask->memResult_missingBnWJet_, memTask->memStats_missingBnWJet_, evtWeight);
+      }
+
+      memTask->clear();
+      memTasks_free.push_back(memTask);
+    }
+  };
+
+  // selectedEntries counts the events that are selected in at least one smearing variant
+  int analyzedEntries = checkpointState_resumed.analyzedEntries_;
+  int selectedEntries = checkpointState_resumed.selectedEntries_;
+  double selectedEntries_weighted = checkpointState_resumed.selectedEntries_weighted_;
+  TH1* histogram_analyzedEntries = fs.make<TH1D>("analyzedEntries", "analyzedEntries", 1, -0.5, +0.5);
+  TH1* histogram_selectedEntries = fs.make<TH1D>("selectedEntries", "selectedEntries", 1, -0.5, +0.5);
+
+//--- in case the job is resumed, add the histograms and ntuple entries of the events processed before the last checkpoint
+  checkpointManager.restore(fs.file());
+  auto hasNextEvent = [&]() {
+    MEMbbwwScopedTimer timer(&timingManager, "input reading");
+    if ( skimReader ) return skimReader->hasNextEvent();
+    return inputTree->hasNextEvent();
+  };
+  // stop reading the input files once maxSelEvents events have been selected for each smearing variant
+  auto isDone = [&]() {
+    for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+          smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+      if ( !(*smearingVariant)->isDone(maxSelEvents) ) return false;
+    }
+    return true;
+  };
+  // collections of generator-level particles, declared outside of the event loop so that their memory is reused for each event
+  // (the collections returned by the tthAnalysis readers and by findGenJetsFromWBoson are still allocated for each event)
+  std::vector<GenLepton> genLeptons;
+  std::vector<GenParticle> genNeutrinos;
+  std::vector<GenParticle> genParticlesFromHiggs;
+  std::vector<GenParticle> genWBosons;
+  std::vector<GenParticle> genWJets;
+  std::vector<GenLepton> genLeptonsFromTop;
+  std::vector<GenParticle> genNeutrinosFromTop;
+  std::vector<GenParticle> genBQuarksFromTop;
+  std::vector<GenParticle> genWJetsFromTop;
+  std::vector<GenLepton> genLeptonsForMatching;
+  std::vector<GenJet> genWJetsForMatching;
+  std::vector<GenJet> genBJetsForMatching;
+  std::vector<GenJet> genJets;
+  std::vector<GenLepton> genElectrons;
+  std::vector<GenLepton> genMuons;
+  std::vector<GenJet> genWJets_tmp;
+  std::vector<const GenJet*> genWJetsForMatching_tmp;
+  std::vector<const GenLepton*> genLeptonsForMatching_ptrs;
+  std::vector<const GenLepton*> selGenLeptons;
+  std::vector<const GenJet*> genBJetsForMatching_ptrs;
+  std::vector<const GenJet*> cleanedGenBJets;
+  std::vector<const GenJet*> selGenBJets;
+  std::vector<const GenJet*> genWJetsForMatching_ptrs;
+  std::vector<const GenJet*> cleanedGenWJets;
+  std::vector<const GenJet*> selGenWJets;
+  std::vector<const GenJet*> genJets_ptrs;
+  std::vector<const GenJet*> cleanedGenJets;
+  std::vector<const GenJet*> selGenJets;
+  std::vector<size_t> usedGenWJets;
+  std::vector<size_t> usedGenJets;
+  std::vector<GenJet> selGenBJets_smeared;
+  std::vector<GenJet> selGenWJets_smeared;
+  while ( hasNextEvent() && (! run_lumi_eventSelector || (run_lumi_eventSelector && ! run_lumi_eventSelector -> areWeDone())) && !isDone() ) {
+    const GenEventSkimRecord* skimRecord = ( skimReader ) ? &skimReader->getEvent() : nullptr;
+    if ( skimRecord ) {
+      if ( skimReader -> canReport(reportEvery) ) {
+        std::cout << "processing Entry " << skimRecord -> entry_
+                  << " or " << (skimReader -> numEventsRead() - 1) << " entry in skim file"
+                  << " (" << eventInfo
+                  << ") (" << selectedEntries << " Entries selected)\n";
+      }
+    } else if ( inputTree -> canReport(reportEvery) ) {
       std::cout << "processing Entry " << inputTree -> getCurrentMaxEventIdx()
                 << " or " << inputTree -> getCurrentEventIdx() << " entry in #"
                 << (inputTree -> getProcessedFileCount() - 1)
                 << " (" << eventInfo
                 << ") file (" << selectedEntries << " Entries selected)\n";
     }
+    const Long64_t selEntryIdx = ( skimRecord ) ? skimRecord->entry_ : inputTree->getCurrentMaxEventIdx();
+
     ++analyzedEntries;
     histogram_analyzedEntries->Fill(0.);
 
     if ( isDEBUG ) {
-      std::cout << "event #" << inputTree -> getCurrentMaxEventIdx() << ' ' << eventInfo << '\n';
+      std::cout << "event #" << selEntryIdx << ' ' << eventInfo << '\n';
     }
 
+    MEMbbwwScopedTimer timer_inputReading(&timingManager, "input reading");
     double evtWeight = 1.;
     if ( apply_genWeight ) evtWeight *= boost::math::sign(eventInfo.genWeight);
-    lheInfoReader->read();
-    evtWeight *= lheInfoReader->getWeight_scale(kLHE_scale_central);
+    double lheWeight_scale_central;
+    if ( skimRecord ) {
+      lheWeight_scale_central = skimRecord->lheWeight_scale_central_;
+    } else {
+      lheInfoReader->read();
+      lheWeight_scale_central = lheInfoReader->getWeight_scale(kLHE_scale_central);
+    }
+    evtWeight *= lheWeight_scale_central;
     evtWeight *= eventInfo.pileupWeight;
     
     if ( run_lumi_eventSelector && !(*run_lumi_eventSelector)(eventInfo) ) continue;
-    cutFlowTable.update("run:ls:event selection");
-    cutFlowHistManager->fillHistograms("run:ls:event selection", evtWeight);
+    for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+          smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+      if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+      (*smearingVariant)->cutFlowTable_.update("run:ls:event selection");
+      (*smearingVariant)->cutFlowHistManager_->fillHistograms("run:ls:event selection", evtWeight);
+    }
 
     if ( run_lumi_eventSelector ) {
-      std::cout << "processing Entry #" << inputTree->getCumulativeMaxEventCount() << ": " << eventInfo << std::endl;
-      if ( inputTree -> isOpen() ) {
+      std::cout << "processing Entry #" << ( inputTree ? inputTree->getCumulativeMaxEventCount() : selEntryIdx + 1 ) << ": " << eventInfo << std::endl;
+      if ( inputTree && inputTree -> isOpen() ) {
         std::cout << "input File = " << inputTree->getCurrentFileName() << std::endl;
       }
     }
 
+    genLeptons.clear();
+    genNeutrinos.clear();
+    genParticlesFromHiggs.clear();
+    genWBosons.clear();
+    genWJets.clear();
+    genLeptonsFromTop.clear();
+    genNeutrinosFromTop.clear();
+    genBQuarksFromTop.clear();
+    genWJetsFromTop.clear();
+    genLeptonsForMatching.clear();
+    genWJetsForMatching.clear();
+    genBJetsForMatching.clear();
+    genJets.clear();
+    genElectrons.clear();
+    genMuons.clear();
+    double genMEtPx = 0.;
+    double genMEtPy = 0.;
+    if ( skimRecord ) {
+//--- take generator-level lepton, light quarks, b-quarks and jets from the skim file,
+//    which contains only events that pass the generator-level selection
+      getGenLeptons(skimRecord->genLeptons_, skimRecord->numGenLeptons_, genLeptonsForMatching);
+      getGenJets(skimRecord->genWJets_, skimRecord->numGenWJets_, genWJetsForMatching);
+      getGenJets(skimRecord->genBJets_, skimRecord->numGenBJets_, genBJetsForMatching);
+      getGenJets(skimRecord->genJets_, skimRecord->numGenJets_, genJets);
+      genMEtPx = skimRecord->genMEtPx_;
+      genMEtPy = skimRecord->genMEtPy_;
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (1)", evtWeight);
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (2)", evtWeight);
+      }
+    } else {
 //--- build collections of generator level particles (before any cuts are applied, to check distributions in unbiased event samples)
-    std::vector<GenLepton> genLeptons;
-    std::vector<GenLepton> genElectrons;
-    std::vector<GenLepton> genMuons;
-    if ( genLeptonReader ) {
-      genLeptons = genLeptonReader->read();
-      for ( std::vector<GenLepton>::const_iterator genLepton = genLeptons.begin();
-	    genLepton != genLeptons.end(); ++genLepton ) {
-	int abs_pdgId = std::abs(genLepton->pdgId());
-	if      ( abs_pdgId == 11 ) genElectrons.push_back(*genLepton);
-	else if ( abs_pdgId == 13 ) genMuons.push_back(*genLepton);
+      if ( genLeptonReader ) {
+        genLeptons = genLeptonReader->read();
+        for ( std::vector<GenLepton>::const_iterator genLepton = genLeptons.begin();
+              genLepton != genLeptons.end(); ++genLepton ) {
+          int abs_pdgId = std::abs(genLepton->pdgId());
+          if      ( abs_pdgId == 11 ) genElectrons.push_back(*genLepton);
+          else if ( abs_pdgId == 13 ) genMuons.push_back(*genLepton);
+        }
       }
-    }
-    std::vector<GenParticle> genNeutrinos;
-    if ( genNeutrinoReader ) {
-      genNeutrinos = genNeutrinoReader->read();
-    }
-    std::vector<GenJet> genJets;
-    if ( genJetReader ) {
-      genJets = genJetReader->read();
-    }
-    if ( isDEBUG ) {
-      printCollection("genLeptons", genLeptons);
-      printCollection("genNeutrinos", genNeutrinos);
-      printCollection("genJets", genJets);
-    }
-
-    genEvtHistManager_beforeCuts->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
-
-    std::vector<GenParticle> genParticlesFromHiggs;
-    std::vector<GenParticle> genWBosons;
-    std::vector<GenParticle> genWJets;
-    if ( isSignal ) {
-      genParticlesFromHiggs = genParticleFromHiggsReader->read();
-      genWBosons = genWBosonReader->read();
-      genWJets = genWJetReader->read();
-      if ( isDEBUG ) {
-	printCollection("genParticlesFromHiggs", genParticlesFromHiggs);
-        printCollection("genWBosons", genWBosons);
-        printCollection("genWJets", genWJets);
+      if ( genNeutrinoReader ) {
+        genNeutrinos = genNeutrinoReader->read();
       }
-      if ( !(genParticlesFromHiggs.size() == 4 && genWBosons.size() == 2 && genWJets.size() == 2) ) {
-	if ( run_lumi_eventSelector ) {
-	  std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	  std::cout << "#genParticlesFromHiggs = " << genParticlesFromHiggs.size() << std::endl;
-          std::cout << "#genWBosons = " << genWBosons.size() << std::endl;
-          std::cout << "#genWJets = " << genWJets.size() << std::endl;
-	}
-	continue;
+      if ( genJetReader ) {
+        genJets = genJetReader->read();
       }
-    } 
-    std::vector<GenLepton> genLeptonsFromTop;
-    std::vector<GenParticle> genNeutrinosFromTop;
-    std::vector<GenParticle> genBQuarksFromTop;
-    std::vector<GenParticle> genWJetsFromTop;
-    if ( !isSignal ) {
-      genLeptonsFromTop = genLeptonFromTopReader->read();
-      genNeutrinosFromTop = genNeutrinoFromTopReader->read();
-      genBQuarksFromTop = genBQuarksFromTopReader->read();
-      genWJetsFromTop = genWJetsFromTopReader->read();
       if ( isDEBUG ) {
-	printCollection("genLeptonsFromTop", genLeptonsFromTop);
-	printCollection("genNeutrinosFromTop", genNeutrinosFromTop);
-	printCollection("genBQuarksFromTop", genBQuarksFromTop);
-        printCollection("genWJetsFromTop", genWJetsFromTop);
+        printCollection("genLeptons", genLeptons);
+        printCollection("genNeutrinos", genNeutrinos);
+        printCollection("genJets", genJets);
       }
-      if ( !(genLeptonsFromTop.size() == 1 && genNeutrinosFromTop.size() == 1 && genBQuarksFromTop.size() == 2 && genWJetsFromTop.size() == 2) ) {
-	if ( run_lumi_eventSelector ) {
-	  std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	  std::cout << "#genLeptonsFromTop = " << genLeptonsFromTop.size() << std::endl;
-	  std::cout << "#genNeutrinosFromTop = " << genNeutrinosFromTop.size() << std::endl;
-	  std::cout << "#genBQuarksFromTop = " << genBQuarksFromTop.size() << std::endl;
-          std::cout << "#genWJetsFromTop = " << genWJetsFromTop.size() << std::endl;
-	}
-	continue;
+
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) || !fillGenHistograms ) continue;
+        (*smearingVariant)->genEvtHistManager_beforeCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
       }
-    }
-    cutFlowTable.update("generator-level selection (1)", evtWeight);
 
-//--- select lepton, light-quark jets, and b-jets from from H->WW->lnuqq and H->bb decays (signal)
-//    and from tt->bWbW->blnu bqq decays (background)
-    std::vector<GenLepton> genLeptonsForMatching;
-    std::vector<GenJet> genWJetsForMatching;
-    std::vector<GenJet> genBJetsForMatching;
-    double genMEtPx = 0.;
-    double genMEtPy = 0.;
-    if ( isSignal ) {
-      const GenParticle* genBQuark      = nullptr;
-      const GenParticle* genAntiBQuark  = nullptr;
-      const GenParticle* genWBosonPlus  = nullptr;
-      const GenParticle* genWBosonMinus = nullptr;
-      for ( std::vector<GenParticle>::const_iterator genParticle = genParticlesFromHiggs.begin();
-	    genParticle != genParticlesFromHiggs.end(); ++genParticle ) {
-	if      ( genParticle->pdgId() ==  +5 ) genBQuark      = &(*genParticle);
-	else if ( genParticle->pdgId() ==  -5 ) genAntiBQuark  = &(*genParticle);
-	else if ( genParticle->pdgId() == +24 ) genWBosonPlus  = &(*genParticle);
-	else if ( genParticle->pdgId() == -24 ) genWBosonMinus = &(*genParticle);
+      if ( isSignal ) {
+        genParticlesFromHiggs = genParticleFromHiggsReader->read();
+        genWBosons = genWBosonReader->read();
+        genWJets = genWJetReader->read();
+        if ( isDEBUG ) {
+          printCollection("genParticlesFromHiggs", genParticlesFromHiggs);
+          printCollection("genWBosons", genWBosons);
+          printCollection("genWJets", genWJets);
+        }
+        if ( !(genParticlesFromHiggs.size() == 4 && genWBosons.size() == 2 && genWJets.size() == 2) ) {
+          if ( run_lumi_eventSelector ) {
+            std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+            std::cout << "#genParticlesFromHiggs = " << genParticlesFromHiggs.size() << std::endl;
+            std::cout << "#genWBosons = " << genWBosons.size() << std::endl;
+            std::cout << "#genWJets = " << genWJets.size() << std::endl;
+          }
+          continue;
+        }
+      } 
+      if ( !isSignal ) {
+        genLeptonsFromTop = genLeptonFromTopReader->read();
+        genNeutrinosFromTop = genNeutrinoFromTopReader->read();
+        genBQuarksFromTop = genBQuarksFromTopReader->read();
+        genWJetsFromTop = genWJetsFromTopReader->read();
+        if ( isDEBUG ) {
+          printCollection("genLeptonsFromTop", genLeptonsFromTop);
+          printCollection("genNeutrinosFromTop", genNeutrinosFromTop);
+          printCollection("genBQuarksFromTop", genBQuarksFromTop);
+          printCollection("genWJetsFromTop", genWJetsFromTop);
+        }
+        if ( !(genLeptonsFromTop.size() == 1 && genNeutrinosFromTop.size() == 1 && genBQuarksFromTop.size() == 2 && genWJetsFromTop.size() == 2) ) {
+          if ( run_lumi_eventSelector ) {
+            std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+            std::cout << "#genLeptonsFromTop = " << genLeptonsFromTop.size() << std::endl;
+            std::cout << "#genNeutrinosFromTop = " << genNeutrinosFromTop.size() << std::endl;
+            std::cout << "#genBQuarksFromTop = " << genBQuarksFromTop.size() << std::endl;
+            std::cout << "#genWJetsFromTop = " << genWJetsFromTop.size() << std::endl;
+          }
+          continue;
+        }
       }
-      if ( genBQuark && genAntiBQuark ) {
-	genBJetsForMatching.push_back(GenJet(
-          genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
-        genBJetsForMatching.push_back(GenJet(
-          genAntiBQuark->pt(), genAntiBQuark->eta(), genAntiBQuark->phi(), mem::bottomQuarkMass, genAntiBQuark->pdgId()));	
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (1)", evtWeight);
       }
-      if ( genWBosonPlus && genWBosonMinus ) {
-        const GenParticle* genHadWBoson = nullptr;
-	std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonPlus =
-          findGenLepton_and_NeutrinoFromWBoson(*genWBosonPlus, genLeptons, genNeutrinos);
-        if ( genLepton_and_NeutrinoFromWBosonPlus.first && genLepton_and_NeutrinoFromWBosonPlus.second ) {
-          genLeptonsForMatching.push_back(*genLepton_and_NeutrinoFromWBosonPlus.first);
-          genMEtPx += genLepton_and_NeutrinoFromWBosonPlus.second->p4().px();
-          genMEtPy += genLepton_and_NeutrinoFromWBosonPlus.second->p4().py();
-          genHadWBoson = genWBosonMinus;
+      timer_inputReading.stop();
+
+      MEMbbwwScopedTimer timer_genMatching(&timingManager, "gen matching, cleaning and selection");
+
+//--- select lepton, light-quark jets, and b-jets from from H->WW->lnuqq and H->bb decays (signal)
+//    and from tt->bWbW->blnu bqq decays (background)
+      if ( isSignal ) {
+        const GenParticle* genBQuark      = nullptr;
+        const GenParticle* genAntiBQuark  = nullptr;
+        const GenParticle* genWBosonPlus  = nullptr;
+        const GenParticle* genWBosonMinus = nullptr;
+        for ( std::vector<GenParticle>::const_iterator genParticle = genParticlesFromHiggs.begin();
+              genParticle != genParticlesFromHiggs.end(); ++genParticle ) {
+          if      ( genParticle->pdgId() ==  +5 ) genBQuark      = &(*genParticle);
+          else if ( genParticle->pdgId() ==  -5 ) genAntiBQuark  = &(*genParticle);
+          else if ( genParticle->pdgId() == +24 ) genWBosonPlus  = &(*genParticle);
+          else if ( genParticle->pdgId() == -24 ) genWBosonMinus = &(*genParticle);
         }
-	std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonMinus =
-          findGenLepton_and_NeutrinoFromWBoson(*genWBosonMinus, genLeptons, genNeutrinos);
-        if ( genLepton_and_NeutrinoFromWBosonMinus.first && genLepton_and_NeutrinoFromWBosonMinus.second ) {
-          genLeptonsForMatching.push_back(*genLepton_and_NeutrinoFromWBosonMinus.first);
-          genMEtPx += genLepton_and_NeutrinoFromWBosonMinus.second->p4().px();
-          genMEtPy += genLepton_and_NeutrinoFromWBosonMinus.second->p4().py();
-          genHadWBoson = genWBosonPlus;
+        if ( genBQuark && genAntiBQuark ) {
+          genBJetsForMatching.push_back(GenJet(
+            genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
+          genBJetsForMatching.push_back(GenJet(
+            genAntiBQuark->pt(), genAntiBQuark->eta(), genAntiBQuark->phi(), mem::bottomQuarkMass, genAntiBQuark->pdgId()));	
         }
-        // CV: skip events for which matching of generator-level lepton+neutrino to W boson is ambiguous
-        if ( genLeptonsForMatching.size() != 1 ) continue;
-        std::vector<GenJet> genWJets_tmp;
-        for ( std::vector<GenParticle>::const_iterator genWJet = genWJets.begin();
-              genWJet != genWJets.end(); ++genWJet ) {
-          genWJets_tmp.push_back(GenJet(
-            genWJet->pt(), genWJet->eta(), genWJet->phi(), genWJet->mass(), genWJet->pdgId()));
+        if ( genWBosonPlus && genWBosonMinus ) {
+          const GenParticle* genHadWBoson = nullptr;
+          std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonPlus =
+            findGenLepton_and_NeutrinoFromWBoson(*genWBosonPlus, genLeptons, genNeutrinos);
+          if ( genLepton_and_NeutrinoFromWBosonPlus.first && genLepton_and_NeutrinoFromWBosonPlus.second ) {
+            genLeptonsForMatching.push_back(*genLepton_and_NeutrinoFromWBosonPlus.first);
+            genMEtPx += genLepton_and_NeutrinoFromWBosonPlus.second->p4().px();
+            genMEtPy += genLepton_and_NeutrinoFromWBosonPlus.second->p4().py();
+            genHadWBoson = genWBosonMinus;
+          }
+          std::pair<const GenLepton*, const GenParticle*> genLepton_and_NeutrinoFromWBosonMinus =
+            findGenLepton_and_NeutrinoFromWBoson(*genWBosonMinus, genLeptons, genNeutrinos);
+          if ( genLepton_and_NeutrinoFromWBosonMinus.first && genLepton_and_NeutrinoFromWBosonMinus.second ) {
+            genLeptonsForMatching.push_back(*genLepton_and_NeutrinoFromWBosonMinus.first);
+            genMEtPx += genLepton_and_NeutrinoFromWBosonMinus.second->p4().px();
+            genMEtPy += genLepton_and_NeutrinoFromWBosonMinus.second->p4().py();
+            genHadWBoson = genWBosonPlus;
+          }
+          // CV: skip events for which matching of generator-level lepton+neutrino to W boson is ambiguous
+          if ( genLeptonsForMatching.size() != 1 ) continue;
+          genWJets_tmp.clear();
+          for ( std::vector<GenParticle>::const_iterator genWJet = genWJets.begin();
+                genWJet != genWJets.end(); ++genWJet ) {
+            genWJets_tmp.push_back(GenJet(
+              genWJet->pt(), genWJet->eta(), genWJet->phi(), genWJet->mass(), genWJet->pdgId()));
+          }
+          assert(genHadWBoson);
+          genWJetsForMatching_tmp = findGenJetsFromWBoson(*genHadWBoson, genWJets_tmp);
+          std::sort(genWJetsForMatching_tmp.begin(), genWJetsForMatching_tmp.end(), isHigherPt);
+          for ( std::vector<const GenJet*>::const_iterator genWJet = genWJetsForMatching_tmp.begin();
+                genWJet != genWJetsForMatching_tmp.end(); ++genWJet ) {
+            genWJetsForMatching.push_back(**genWJet);
+          }
         }
-        assert(genHadWBoson);
-        std::vector<const GenJet*> genWJetsForMatching_tmp = findGenJetsFromWBoson(*genHadWBoson, genWJets_tmp);        
-        std::sort(genWJetsForMatching_tmp.begin(), genWJetsForMatching_tmp.end(), isHigherPt);
-        for ( std::vector<const GenJet*>::const_iterator genWJet = genWJetsForMatching_tmp.begin();
-              genWJet != genWJetsForMatching_tmp.end(); ++genWJet ) {
-          genWJetsForMatching.push_back(**genWJet);
+      } else {
+        genLeptonsForMatching = genLeptonsFromTop;
+        assert(genNeutrinosFromTop.size() == 1);
+        genMEtPx = genNeutrinosFromTop[0].p4().px();
+        genMEtPy = genNeutrinosFromTop[0].p4().py();
+        for ( std::vector<GenParticle>::const_iterator genBQuark = genBQuarksFromTop.begin();
+              genBQuark != genBQuarksFromTop.end(); ++genBQuark ) {
+          genBJetsForMatching.push_back(GenJet(
+            genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
         }
+        for ( std::vector<GenParticle>::const_iterator genWJet = genWJetsFromTop.begin();
+              genWJet != genWJetsFromTop.end(); ++genWJet ) {
+          genWJetsForMatching.push_back(GenJet(
+            genWJet->pt(), genWJet->eta(), genWJet->phi(), genWJet->mass(), genWJet->pdgId()));
+        }
+        std::sort(genWJetsForMatching.begin(), genWJetsForMatching.end(), isHigherPtT<GenJet>);
       }
-    } else {
-      genLeptonsForMatching = genLeptonsFromTop;
-      assert(genNeutrinosFromTop.size() == 1);
-      genMEtPx = genNeutrinosFromTop[0].p4().px();
-      genMEtPy = genNeutrinosFromTop[0].p4().py();
-      for ( std::vector<GenParticle>::const_iterator genBQuark = genBQuarksFromTop.begin();
-	    genBQuark != genBQuarksFromTop.end(); ++genBQuark ) {
-	genBJetsForMatching.push_back(GenJet(
-          genBQuark->pt(), genBQuark->eta(), genBQuark->phi(), mem::bottomQuarkMass, genBQuark->pdgId()));
+      if ( !(genLeptonsForMatching.size() == 1 && genWJetsForMatching.size() == 2 && genBJetsForMatching.size() == 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
+          std::cout << "#genLeptonsForMatching = " << genLeptonsForMatching.size() << std::endl;
+          std::cout << "#genWJetsForMatching = " << genWJetsForMatching.size() << std::endl;
+          std::cout << "#genBJetsForMatching = " << genBJetsForMatching.size() << std::endl;
+        }
+        continue;
       }
-      for ( std::vector<GenParticle>::const_iterator genWJet = genWJetsFromTop.begin();
-            genWJet != genWJetsFromTop.end(); ++genWJet ) {
-        genWJetsForMatching.push_back(GenJet(
-          genWJet->pt(), genWJet->eta(), genWJet->phi(), genWJet->mass(), genWJet->pdgId()));
+      for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        if ( (*smearingVariant)->isDone(maxSelEvents) ) continue;
+        (*smearingVariant)->cutFlowTable_.update("generator-level selection (2)", evtWeight);
       }
-      std::sort(genWJetsForMatching.begin(), genWJetsForMatching.end(), isHigherPtT<GenJet>);
     }
-    if ( !(genLeptonsForMatching.size() == 1 && genWJetsForMatching.size() == 2 && genBJetsForMatching.size() == 2) ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS generator-level selection." << std::endl;
-	std::cout << "#genLeptonsForMatching = " << genLeptonsForMatching.size() << std::endl;
-        std::cout << "#genWJetsForMatching = " << genWJetsForMatching.size() << std::endl;
-	std::cout << "#genBJetsForMatching = " << genBJetsForMatching.size() << std::endl;
-      }
-      continue;
-    }
-    cutFlowTable.update("generator-level selection (2)", evtWeight);
+    timer_inputReading.stop();
 
 //--- apply pT and eta cuts to generator-level lepton, light-quark jets, and b-jets,
 //    clean collection of generator-level b-jets with respect to leptons,
 //    and collection of generator-level light-quark jets with respect to leptons and b-jets
-    std::vector<const GenLepton*> genLeptonsForMatching_ptrs = convert_to_ptrs(genLeptonsForMatching);
-    std::vector<const GenLepton*> selGenLeptons = genLeptonSelector(genLeptonsForMatching_ptrs, isHigherPt);
-
-    std::vector<const GenJet*> genBJetsForMatching_ptrs = convert_to_ptrs(genBJetsForMatching);
-    std::vector<const GenJet*> cleanedGenBJets = genJetCleaner(genBJetsForMatching_ptrs, genLeptonsForMatching_ptrs);
-    std::vector<const GenJet*> selGenBJets = genJetSelector(cleanedGenBJets, isHigherPt);
-
-    std::vector<const GenJet*> genWJetsForMatching_ptrs = convert_to_ptrs(genWJetsForMatching);
-    std::vector<const GenJet*> cleanedGenWJets = genJetCleaner(genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs);
-    std::vector<const GenJet*> selGenWJets = genJetSelector(cleanedGenWJets, isHigherPt);
-    std::set<size_t> usedGenWJets;
-
-    std::vector<const GenJet*> genJets_ptrs = convert_to_ptrs(genJets);
-    std::vector<const GenJet*> cleanedGenJets = genJetCleaner(genJets_ptrs, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs);
-    std::vector<const GenJet*> selGenJets = genJetSelector(cleanedGenJets, isHigherPt);
-    std::set<size_t> usedGenJets;
+    MEMbbwwScopedTimer timer_genSelection(&timingManager, "gen matching, cleaning and selection");
+    convert_to_ptrs(genLeptonsForMatching, genLeptonsForMatching_ptrs);
+    selectCollection(genLeptonsForMatching_ptrs, genLeptonSelector.getSelector(), isHigherPt, selGenLeptons);
+
+    convert_to_ptrs(genBJetsForMatching, genBJetsForMatching_ptrs);
+    cleanCollection(genBJetsForMatching_ptrs, genJetCleaning_dRmin, cleanedGenBJets, genLeptonsForMatching_ptrs);
+    selectCollection(cleanedGenBJets, genJetSelector.getSelector(), isHigherPt, selGenBJets);
+
+    convert_to_ptrs(genWJetsForMatching, genWJetsForMatching_ptrs);
+    cleanCollection(genWJetsForMatching_ptrs, genJetCleaning_dRmin, cleanedGenWJets, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs);
+    selectCollection(cleanedGenWJets, genJetSelector.getSelector(), isHigherPt, selGenWJets);
+
+    convert_to_ptrs(genJets, genJets_ptrs);
+    cleanCollection(genJets_ptrs, genJetCleaning_dRmin, cleanedGenJets, genLeptonsForMatching_ptrs, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs);
+    selectCollection(cleanedGenJets, genJetSelector.getSelector(), isHigherPt, selGenJets);
+    timer_genSelection.stop();
+
+    if ( selEntryIndexFile || skimWriter ) {
+      if ( selEntryIndexFile ) {
+        selEntryIndexFile->write(reinterpret_cast<const char*>(&selEntryIdx), sizeof(selEntryIdx));
+      }
+      if ( skimWriter ) {
+        skimWriter->set(selEntryIdx, eventInfo, lheWeight_scale_central, genMEtPx, genMEtPy);
+        skimWriter->setGenLeptons(genLeptonsForMatching);
+        skimWriter->setGenBJets(genBJetsForMatching);
+        skimWriter->setGenWJets(genWJetsForMatching);
+        skimWriter->setGenJets(selGenJets);
+        skimWriter->write();
+      }
+      continue;
+    }
 
     GenMEt genMEt(genMEtPx, genMEtPy);
 
     //std::cout << "#selGenBJets = " << selGenBJets.size() << std::endl;
     //std::cout << "#selGenWJets = " << selGenWJets.size() << std::endl;
     //std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
+
+//--- run the smearing, the event selection and the MEM computation for each smearing variant;
+//    the random numbers depend only on (seed, run, lumi, event, object index),
+//    so each variant selects the same fake jets and events as a job that runs this variant alone
+    bool isSelected = false;
+    for ( std::vector<smearingVariantType*>::iterator smearingVariant_it = smearingVariants.begin();
+          smearingVariant_it != smearingVariants.end(); ++smearingVariant_it ) {
+      smearingVariantType* smearingVariant = *smearingVariant_it;
+      if ( smearingVariant->isDone(maxSelEvents) ) continue;
+      cutFlowTableType& cutFlowTable = smearingVariant->cutFlowTable_;
+      CutFlowTableHistManager* cutFlowHistManager = smearingVariant->cutFlowHistManager_;
+      usedGenWJets.clear();
+      usedGenJets.clear();
     
 //--- apply pT smearing to generator-level b-jets (and other jets)
-    const double genBJet_pFake = 0.10;
-    std::vector<GenJet> selGenBJets_smeared;
-    bool selGenBJet_lead_isFake = false;
-    bool selGenBJet_sublead_isFake = false;
-    for ( size_t idxGenBJet = 0; idxGenBJet < selGenBJets.size(); ++idxGenBJet ) {
-      const GenJet* selGenBJet = selGenBJets[idxGenBJet];
-      const GenJet* genJet = nullptr;
-      bool genJet_isFake;
-      double u = rnd.Uniform();
-      assert(u >= 0. && u <= 1.);
-      if ( u > genBJet_pFake ) {
-	genJet = selGenBJet;
-        genJet_isFake = false;
-      } else if ( (selGenWJets.size() + selGenJets.size()) > (usedGenWJets.size() + usedGenJets.size()) ) {
-        int idxGenWJet = -1;
-        int idxGenJet = -1;
-        while ( idxGenWJet == -1 && idxGenJet == -1 ) {
-          int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenWJets.size() + selGenJets.size() - 0.5));
-          if ( idxGenJet_tmp < (int)selGenWJets.size() ) {
-            if ( usedGenWJets.find(idxGenJet_tmp) == usedGenWJets.end() ) {
-              idxGenWJet = idxGenJet_tmp;
-              usedGenWJets.insert(idxGenWJet); 
-            }
-          } else {
-            idxGenJet_tmp -= selGenWJets.size();
-            if ( usedGenJets.find(idxGenJet_tmp) == usedGenJets.end() ) {
-              idxGenJet = idxGenJet_tmp;
-              usedGenJets.insert(idxGenJet); 
+      MEMbbwwScopedTimer timer_smearing(&timingManager, "smearing");
+      const double genBJet_pFake = 0.10;
+      selGenBJets_smeared.clear();
+      bool selGenBJet_lead_isFake = false;
+      bool selGenBJet_sublead_isFake = false;
+      for ( size_t idxGenBJet = 0; idxGenBJet < selGenBJets.size(); ++idxGenBJet ) {
+        const GenJet* selGenBJet = selGenBJets[idxGenBJet];
+        const GenJet* genJet = nullptr;
+        bool genJet_isFake;
+        CounterBasedRandom rnd(randomSeed, eventInfo.run, eventInfo.lumi, eventInfo.event, 1 + idxGenBJet);
+        double u = rnd.Uniform();
+        assert(u >= 0. && u <= 1.);
+        if ( u > genBJet_pFake ) {
+          genJet = selGenBJet;
+          genJet_isFake = false;
+        } else if ( (selGenWJets.size() + selGenJets.size()) > (usedGenWJets.size() + usedGenJets.size()) ) {
+          int idxGenWJet = -1;
+          int idxGenJet = -1;
+          while ( idxGenWJet == -1 && idxGenJet == -1 ) {
+            int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenWJets.size() + selGenJets.size() - 0.5));
+            if ( idxGenJet_tmp < (int)selGenWJets.size() ) {
+              if ( std::find(usedGenWJets.begin(), usedGenWJets.end(), (size_t)idxGenJet_tmp) == usedGenWJets.end() ) {
+                idxGenWJet = idxGenJet_tmp;
+                usedGenWJets.push_back(idxGenWJet);
+              }
+            } else {
+              idxGenJet_tmp -= selGenWJets.size();
+              if ( std::find(usedGenJets.begin(), usedGenJets.end(), (size_t)idxGenJet_tmp) == usedGenJets.end() ) {
+                idxGenJet = idxGenJet_tmp;
+                usedGenJets.push_back(idxGenJet);
+              }
             }
           }
+          if ( idxGenWJet >= 0 && idxGenWJet < (int)selGenWJets.size() ) {
+            genJet = selGenWJets[idxGenWJet];
+            genJet_isFake = true;
+          } else if ( idxGenJet >= 0 && idxGenJet < (int)selGenJets.size() ) {
+            genJet = selGenJets[idxGenJet];
+            genJet_isFake = true;
+          } else assert(0);
+        }
+        if ( genJet ) {
+          double genJetPt_smeared;
+          if ( smearingVariant->apply_jetSmearing_ ) genJetPt_smeared = genJetSmearer(*genJet, eventInfo, idxGenBJet).pt();
+          else genJetPt_smeared = genJet->pt();
+          if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
+            selGenBJets_smeared.push_back(GenJet(
+              genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
+          }
+          if      ( idxGenBJet == 0 ) selGenBJet_lead_isFake = genJet_isFake;
+          else if ( idxGenBJet == 1 ) selGenBJet_sublead_isFake = genJet_isFake;
+          else assert(0);
         }
-        if ( idxGenWJet >= 0 && idxGenWJet < (int)selGenWJets.size() ) {
-          genJet = selGenWJets[idxGenWJet];
-	  genJet_isFake = true;
-        } else if ( idxGenJet >= 0 && idxGenJet < (int)selGenJets.size() ) {
-          genJet = selGenJets[idxGenJet];
-	  genJet_isFake = true;
-        } else assert(0);
-      }
-      if ( genJet ) {
-	double genJetPt_smeared;
-	if ( apply_jetSmearing ) genJetPt_smeared = genJetSmearer(*genJet).pt();
-	else genJetPt_smeared = genJet->pt();
-	if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
-  	  selGenBJets_smeared.push_back(GenJet(
-	    genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
-	}
-	if      ( idxGenBJet == 0 ) selGenBJet_lead_isFake = genJet_isFake;
-	else if ( idxGenBJet == 1 ) selGenBJet_sublead_isFake = genJet_isFake;
-	else assert(0);
       }
-    }
 
 //--- apply pT smearing to generator-level light-quark jets (and other jets)
-    const double genWJet_lead_pFake = 0.10;
-    const double genWJet_sublead_pFake = 0.30;
-    std::vector<GenJet> selGenWJets_smeared;
-    bool selGenWJet_lead_isFake = false;
-    bool selGenWJet_sublead_isFake = false;
-    for ( size_t idxGenWJet = 0; idxGenWJet < selGenWJets.size(); ++idxGenWJet ) {
-      const GenJet* selGenWJet = selGenWJets[idxGenWJet];
-      const GenJet* genJet = nullptr;
-      bool genJet_isFake;
-      double u = rnd.Uniform();
-      assert(u >= 0. && u <= 1.);
-      double genWJet_pFake = ( idxGenWJet == 0 ) ? genWJet_lead_pFake : genWJet_sublead_pFake;
-      if ( u > genWJet_pFake && usedGenWJets.find(idxGenWJet) == usedGenWJets.end() ) {
-	genJet = selGenWJet;
-        genJet_isFake = false;
-      } else if ( selGenJets.size() > usedGenJets.size() ) {
-        int idxGenJet = -1;
-        while ( idxGenJet == -1 ) {
-          int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenJets.size() - 0.5));
-          if ( usedGenJets.find(idxGenJet_tmp) == usedGenJets.end() ) {
-            idxGenJet = idxGenJet_tmp;
-            usedGenJets.insert(idxGenJet); 
+      const double genWJet_lead_pFake = 0.10;
+      const double genWJet_sublead_pFake = 0.30;
+      selGenWJets_smeared.clear();
+      bool selGenWJet_lead_isFake = false;
+      bool selGenWJet_sublead_isFake = false;
+      for ( size_t idxGenWJet = 0; idxGenWJet < selGenWJets.size(); ++idxGenWJet ) {
+        const GenJet* selGenWJet = selGenWJets[idxGenWJet];
+        const GenJet* genJet = nullptr;
+        bool genJet_isFake;
+        CounterBasedRandom rnd(randomSeed, eventInfo.run, eventInfo.lumi, eventInfo.event, 3 + idxGenWJet);
+        double u = rnd.Uniform();
+        assert(u >= 0. && u <= 1.);
+        double genWJet_pFake = ( idxGenWJet == 0 ) ? genWJet_lead_pFake : genWJet_sublead_pFake;
+        if ( u > genWJet_pFake && std::find(usedGenWJets.begin(), usedGenWJets.end(), (size_t)idxGenWJet) == usedGenWJets.end() ) {
+          genJet = selGenWJet;
+          genJet_isFake = false;
+        } else if ( selGenJets.size() > usedGenJets.size() ) {
+          int idxGenJet = -1;
+          while ( idxGenJet == -1 ) {
+            int idxGenJet_tmp = TMath::Nint(rnd.Uniform(-0.5, selGenJets.size() - 0.5));
+            if ( std::find(usedGenJets.begin(), usedGenJets.end(), (size_t)idxGenJet_tmp) == usedGenJets.end() ) {
+              idxGenJet = idxGenJet_tmp;
+              usedGenJets.push_back(idxGenJet);
+            }
           }
+          assert(idxGenJet >= 0 && idxGenJet < (int)selGenJets.size());
+          genJet = selGenJets[idxGenJet];
+          genJet_isFake = true;
         }
-        assert(idxGenJet >= 0 && idxGenJet < (int)selGenJets.size());
-        genJet = selGenJets[idxGenJet];
-	genJet_isFake = true;
-      }
-      if ( genJet ) {
-	double genJetPt_smeared;
-	if ( apply_jetSmearing ) genJetPt_smeared = genJetSmearer(*genJet).pt();
-	else genJetPt_smeared = genJet->pt();
-	if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
-  	  selGenWJets_smeared.push_back(GenJet(
-	    genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
-	}
-	if      ( idxGenWJet == 0 ) selGenWJet_lead_isFake = genJet_isFake;
-	else if ( idxGenWJet == 1 ) selGenWJet_sublead_isFake = genJet_isFake;
-	else assert(0);
-      }
-    }    
+        if ( genJet ) {
+          double genJetPt_smeared;
+          if ( smearingVariant->apply_jetSmearing_ ) genJetPt_smeared = genJetSmearer(*genJet, eventInfo, 2 + idxGenWJet).pt();
+          else genJetPt_smeared = genJet->pt();
+          if ( genJetPt_smeared > genJetSelector.getSelector().get_min_pt() ) {
+            selGenWJets_smeared.push_back(GenJet(
+              genJetPt_smeared, genJet->eta(), genJet->phi(), genJet->mass(), genJet->pdgId()));
+          }
+          if      ( idxGenWJet == 0 ) selGenWJet_lead_isFake = genJet_isFake;
+          else if ( idxGenWJet == 1 ) selGenWJet_sublead_isFake = genJet_isFake;
+          else assert(0);
+        }
+      }    
     
 //--- apply pX, pY smearing to generator-level missing transverse momentum (MET)
-    GenMEt genMEt_smeared;
-    if ( apply_metSmearing ) {
-      genMEt_smeared = genMEtSmearer(genMEt);
-    } else {
-      genMEt_smeared = genMEt;
-    }
+      GenMEt genMEt_smeared;
+      if ( smearingVariant->apply_metSmearing_ ) {
+        genMEt_smeared = genMEtSmearer(genMEt, eventInfo);
+      } else {
+        genMEt_smeared = genMEt;
+      }
+      timer_smearing.stop();
 
-    // require one or more generator-level leptons 
-    if ( !(selGenLeptons.size() >= 1) ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS selGenLeptons selection." << std::endl;
-        printCollection("selGenLeptons", selGenLeptons);
+      // require one or more generator-level leptons 
+      if ( !(selGenLeptons.size() >= 1) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS selGenLeptons selection." << std::endl;
+          printCollection("selGenLeptons", selGenLeptons);
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update(">= 1 gen lepton", evtWeight);
-    cutFlowHistManager->fillHistograms(">= 1 gen lepton", evtWeight);
-    const GenLepton* selGenLepton = selGenLeptons[0];
+      cutFlowTable.update(">= 1 gen lepton", evtWeight);
+      cutFlowHistManager->fillHistograms(">= 1 gen lepton", evtWeight);
+      const GenLepton* selGenLepton = selGenLeptons[0];
     
-    //const double minPt_lepton = ( TMath::Abs(selGenLepton->pdgId()) == 11 ) ? 32. : 25.;
-    const double minPt_lepton = 25.;
-    const double maxAbsEta_lepton = 2.4;
-    if ( !(selGenLepton->pt() > minPt_lepton && selGenLepton->absEta() < maxAbsEta_lepton) ) {
-      if ( run_lumi_eventSelector ) {
-        std::cout << "event " << eventInfo.str() << " FAILS lepton pT selection." << std::endl;
-        std::cout << " selGenLepton: pT = " << selGenLepton->pt() << ", eta = " << selGenLepton->eta() << " "
-		  << "(minPt = " << minPt_lepton <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
+      //const double minPt_lepton = ( TMath::Abs(selGenLepton->pdgId()) == 11 ) ? 32. : 25.;
+      const double minPt_lepton = 25.;
+      const double maxAbsEta_lepton = 2.4;
+      if ( !(selGenLepton->pt() > minPt_lepton && selGenLepton->absEta() < maxAbsEta_lepton) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS lepton pT selection." << std::endl;
+          std::cout << " selGenLepton: pT = " << selGenLepton->pt() << ", eta = " << selGenLepton->eta() << " "
+                    << "(minPt = " << minPt_lepton <<  ", maxAbsEta = " << maxAbsEta_lepton << ")" << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    //cutFlowTable.update("gen electron (muon) pT > 32 (25) GeV", evtWeight);
-    //cutFlowHistManager->fillHistograms("gen electron (muon) pT > 32 (25) GeV", evtWeight);
-    cutFlowTable.update("gen lepton pT > 25 GeV", evtWeight);
-    cutFlowHistManager->fillHistograms("gen lepton pT > 25 GeV", evtWeight);
-
-    if ( !(selGenBJets_smeared.size() == 2) ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS gen smeared b-jets selection." << std::endl;
-	std::cout << "#cleanedGenBJets = " << cleanedGenBJets.size() << std::endl;
-	std::cout << "#selGenBJets = " << selGenBJets.size() << std::endl;
-        std::cout << "#cleanedGenWJets = " << cleanedGenWJets.size() << std::endl;
-	std::cout << "#selGenWJets = " << selGenWJets.size() << std::endl;
-	std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;
-	std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
-	std::cout << "#selGenBJets_smeared = " << selGenBJets_smeared.size() << std::endl;
+      //cutFlowTable.update("gen electron (muon) pT > 32 (25) GeV", evtWeight);
+      //cutFlowHistManager->fillHistograms("gen electron (muon) pT > 32 (25) GeV", evtWeight);
+      cutFlowTable.update("gen lepton pT > 25 GeV", evtWeight);
+      cutFlowHistManager->fillHistograms("gen lepton pT > 25 GeV", evtWeight);
+
+      if ( !(selGenBJets_smeared.size() == 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS gen smeared b-jets selection." << std::endl;
+          std::cout << "#cleanedGenBJets = " << cleanedGenBJets.size() << std::endl;
+          std::cout << "#selGenBJets = " << selGenBJets.size() << std::endl;
+          std::cout << "#cleanedGenWJets = " << cleanedGenWJets.size() << std::endl;
+          std::cout << "#selGenWJets = " << selGenWJets.size() << std::endl;
+          std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;
+          std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
+          std::cout << "#selGenBJets_smeared = " << selGenBJets_smeared.size() << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update(">= 2 gen b-jets", evtWeight);
-    cutFlowHistManager->fillHistograms(">= 2 gen b-jets", evtWeight);
-    const GenJet* selGenBJet_lead = &selGenBJets_smeared[0];
-    const GenJet* selGenBJet_sublead = &selGenBJets_smeared[1];
-
-    if ( !(selGenWJets_smeared.size() == 2) ) {
-      if ( run_lumi_eventSelector ) {
-	std::cout << "event " << eventInfo.str() << " FAILS gen smeared jets from W->jj selection." << std::endl;
-        std::cout << "#cleanedGenWJets = " << cleanedGenWJets.size() << std::endl;
-	std::cout << "#selGenWJets = " << selGenWJets.size() << std::endl;
-	std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;        
-	std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
-	std::cout << "#selGenWJets_smeared = " << selGenWJets_smeared.size() << std::endl;
+      cutFlowTable.update(">= 2 gen b-jets", evtWeight);
+      cutFlowHistManager->fillHistograms(">= 2 gen b-jets", evtWeight);
+      const GenJet* selGenBJet_lead = &selGenBJets_smeared[0];
+      const GenJet* selGenBJet_sublead = &selGenBJets_smeared[1];
+
+      if ( !(selGenWJets_smeared.size() == 2) ) {
+        if ( run_lumi_eventSelector ) {
+          std::cout << "event " << eventInfo.str() << " FAILS gen smeared jets from W->jj selection." << std::endl;
+          std::cout << "#cleanedGenWJets = " << cleanedGenWJets.size() << std::endl;
+          std::cout << "#selGenWJets = " << selGenWJets.size() << std::endl;
+          std::cout << "#cleanedGenJets = " << cleanedGenJets.size() << std::endl;        
+          std::cout << "#selGenJets = " << selGenJets.size() << std::endl;
+          std::cout << "#selGenWJets_smeared = " << selGenWJets_smeared.size() << std::endl;
+        }
+        continue;
       }
-      continue;
-    }
-    cutFlowTable.update(">= 2 gen jets from W->jj", evtWeight);
-    cutFlowHistManager->fillHistograms(">= 2 gen jets from W->jj", evtWeight);
-    const GenJet* selGenWJet_lead = &selGenWJets_smeared[0];
-    const GenJet* selGenWJet_sublead = &selGenWJets_smeared[1];
+      cutFlowTable.update(">= 2 gen jets from W->jj", evtWeight);
+      cutFlowHistManager->fillHistograms(">= 2 gen jets from W->jj", evtWeight);
+      const GenJet* selGenWJet_lead = &selGenWJets_smeared[0];
+      const GenJet* selGenWJet_sublead = &selGenWJets_smeared[1];
     
-    //---------------------------------------------------------------------------
-    // CV: Skip running matrix element method (MEM) computation for the first 'skipSelEvents' events.
-    //     This feature allows to process the HH signal samples in chunks of 'maxSelEvents' events per job.
-    ++skippedEntries;
-    if ( skippedEntries < skipSelEvents ) continue;
-    //---------------------------------------------------------------------------
+      //---------------------------------------------------------------------------
+      // CV: Compute MEM likelihood ratio of HH signal and ttbar background hypotheses
 
-    //---------------------------------------------------------------------------
-    // CV: Compute MEM likelihood ratio of HH signal and ttbar background hypotheses
-
-    if ( isDEBUG ) {
-      std::cout << "selGenLepton: pT = " << selGenLepton->pt() << "," 
-                << " eta = " << selGenLepton->eta() << ", phi = " << selGenLepton->phi() << std::endl;
-      std::cout << "selGenBJet_lead: pT = " << selGenBJet_lead->pt() << "," 
-                << " eta = " << selGenBJet_lead->eta() << ", phi = " << selGenBJet_lead->phi() 
-	        << " (isFake = " << selGenBJet_lead_isFake << ")" << std::endl;
-      std::cout << "selGenBJet_sublead: pT = " << selGenBJet_sublead->pt() << "," 
-                << " eta = " << selGenBJet_sublead->eta() << ", phi = " << selGenBJet_sublead->phi() 
-	        << " (isFake = " << selGenBJet_sublead_isFake << ")" << std::endl;
-      std::cout << "selGenWJet_lead: pT = " << selGenWJet_lead->pt() << "," 
-                << " eta = " << selGenWJet_lead->eta() << ", phi = " << selGenWJet_lead->phi() 
-	        << " (isFake = " << selGenWJet_lead_isFake << ")" << std::endl;
-      std::cout << "selGenWJet_sublead: pT = " << selGenWJet_sublead->pt() << "," 
-                << " eta = " << selGenWJet_sublead->eta() << ", phi = " << selGenWJet_sublead->phi() 
-	        << " (isFake = " << selGenWJet_sublead_isFake << ")" << std::endl;
-    }
-
-    int memLeptonType;
-    double memLeptonMass;
-    if ( selGenLepton->is_electron() ) {
-      memLeptonType = mem::MeasuredParticle::kElectron;
-      memLeptonMass = mem::electronMass;
-    } else if ( selGenLepton->is_muon() ) {
-      memLeptonType = mem::MeasuredParticle::kMuon;
-      memLeptonMass = mem::muonMass;
-    } else assert(0);
-
-    mem::MeasuredParticle memMeasuredLepton(memLeptonType, 
-      selGenLepton->pt(), selGenLepton->eta(), selGenLepton->phi(), 
-      memLeptonMass, selGenLepton->charge());
-    mem::MeasuredParticle memMeasuredBJet_lead(mem::MeasuredParticle::kBJet,
-      selGenBJet_lead->pt(), selGenBJet_lead->eta(), selGenBJet_lead->phi(), 
-      mem::bottomQuarkMass);
-    mem::MeasuredParticle memMeasuredBJet_sublead(mem::MeasuredParticle::kBJet,
-      selGenBJet_sublead->pt(), selGenBJet_sublead->eta(), selGenBJet_sublead->phi(), 
-      mem::bottomQuarkMass);
-    mem::MeasuredParticle memMeasuredWJet_lead(mem::MeasuredParticle::kHadWJet,
-      selGenWJet_lead->pt(), selGenWJet_lead->eta(), selGenWJet_lead->phi(), 
-      selGenWJet_lead->mass());
-    mem::MeasuredParticle memMeasuredWJet_sublead(mem::MeasuredParticle::kHadWJet,
-      selGenWJet_sublead->pt(), selGenWJet_sublead->eta(), selGenWJet_sublead->phi(), 
-      selGenWJet_sublead->mass());
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles;
-    memMeasuredParticles.push_back(memMeasuredLepton);
-    memMeasuredParticles.push_back(memMeasuredBJet_lead);
-    memMeasuredParticles.push_back(memMeasuredBJet_sublead);
-    memMeasuredParticles.push_back(memMeasuredWJet_lead);
-    memMeasuredParticles.push_back(memMeasuredWJet_sublead);
-    
-    MEMEvent_singlelepton memEvent(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      &memMeasuredBJet_lead, &memMeasuredBJet_sublead,
-      &memMeasuredWJet_lead, &memMeasuredWJet_sublead,
-      &memMeasuredLepton,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_singlelepton(memEvent, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBJet;
-    memMeasuredParticles_missingBJet.push_back(memMeasuredLepton);
-    const mem::MeasuredParticle* memMeasuredBJet_missingBJet = nullptr;
-    bool selGenBJet_isFake_missingBJet;
-    double u1 = rnd.Uniform();
-    assert(u1 >= 0. && u1 <= 1.);
-    if ( u1 > 0.50 ) {
-      memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_lead);
-      memMeasuredBJet_missingBJet = &memMeasuredBJet_lead;
-      selGenBJet_isFake_missingBJet = selGenBJet_lead_isFake;
-    } else {
-      memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_sublead);
-      memMeasuredBJet_missingBJet = &memMeasuredBJet_sublead;
-      selGenBJet_isFake_missingBJet = selGenBJet_sublead_isFake;
-    }
-    memMeasuredParticles_missingBJet.push_back(memMeasuredWJet_lead);
-    memMeasuredParticles_missingBJet.push_back(memMeasuredWJet_sublead);
-
-    MEMEvent_singlelepton memEvent_missingBJet(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      memMeasuredBJet_missingBJet, nullptr,
-      &memMeasuredWJet_lead, &memMeasuredWJet_sublead,
-      &memMeasuredLepton,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_singlelepton(memEvent_missingBJet, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingWJet;
-    memMeasuredParticles_missingWJet.push_back(memMeasuredLepton);
-    memMeasuredParticles_missingWJet.push_back(memMeasuredBJet_lead);
-    memMeasuredParticles_missingWJet.push_back(memMeasuredBJet_sublead);
-    const mem::MeasuredParticle* memMeasuredWJet_missingWJet = nullptr;
-    bool selGenWJet_isFake_missingWJet;
-    double u2 = rnd.Uniform();
-    assert(u2 >= 0. && u2 <= 1.);
-    if ( u2 > 0.50 ) {
-      memMeasuredParticles_missingWJet.push_back(memMeasuredWJet_lead);
-      memMeasuredWJet_missingWJet = &memMeasuredWJet_lead;
-      selGenWJet_isFake_missingWJet = selGenWJet_lead_isFake;
-    } else {
-      memMeasuredParticles_missingWJet.push_back(memMeasuredWJet_sublead);
-      memMeasuredWJet_missingWJet = &memMeasuredWJet_sublead;
-      selGenWJet_isFake_missingWJet = selGenWJet_sublead_isFake;
-    }
-
-    MEMEvent_singlelepton memEvent_missingWJet(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      &memMeasuredBJet_lead, &memMeasuredBJet_sublead,
-      memMeasuredWJet_missingWJet, nullptr,
-      &memMeasuredLepton,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_singlelepton(memEvent_missingWJet, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    std::vector<mem::MeasuredParticle> memMeasuredParticles_missingBnWJet;
-    memMeasuredParticles_missingBnWJet.push_back(memMeasuredLepton);
-    const mem::MeasuredParticle* memMeasuredBJet_missingBnWJet = nullptr;
-    bool selGenBJet_isFake_missingBnWJet;
-    double u3 = rnd.Uniform();
-    assert(u3 >= 0. && u3 <= 1.);
-    if ( u3 > 0.50 ) {
-      memMeasuredParticles_missingBnWJet.push_back(memMeasuredBJet_lead);
-      memMeasuredBJet_missingBnWJet = &memMeasuredBJet_lead;
-      selGenBJet_isFake_missingBnWJet = selGenBJet_lead_isFake;
-    } else {
-      memMeasuredParticles_missingBnWJet.push_back(memMeasuredBJet_sublead);
-      memMeasuredBJet_missingBnWJet = &memMeasuredBJet_sublead;
-      selGenBJet_isFake_missingBnWJet = selGenBJet_sublead_isFake;
-    }
-    const mem::MeasuredParticle* memMeasuredWJet_missingBnWJet = nullptr;
-    bool selGenWJet_isFake_missingBnWJet;
-    double u4 = rnd.Uniform();
-    assert(u4 >= 0. && u4 <= 1.);
-    if ( u4 > 0.50 ) {
-      memMeasuredParticles_missingBnWJet.push_back(memMeasuredWJet_lead);
-      memMeasuredWJet_missingBnWJet = &memMeasuredWJet_lead;
-      selGenWJet_isFake_missingBnWJet = selGenWJet_lead_isFake;
-    } else {
-      memMeasuredParticles_missingBnWJet.push_back(memMeasuredWJet_sublead);
-      memMeasuredWJet_missingBnWJet = &memMeasuredWJet_sublead;
-      selGenWJet_isFake_missingBnWJet = selGenWJet_sublead_isFake;
-    }
-
-    MEMEvent_singlelepton memEvent_missingBnWJet(
-      { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
-      memMeasuredBJet_missingBnWJet, nullptr,
-      memMeasuredWJet_missingBnWJet, nullptr,
-      &memMeasuredLepton,
-      genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    addGenMatches_singlelepton(memEvent_missingBnWJet, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
-
-    const double sqrtS = 13.e+3;
-    const std::string pdfName = "MSTW2008lo68cl";
-    const std::string madgraphFileName_signal     = "hhAnalysis/bbwwMEM/data/param_hh_SM.dat";
-    const std::string madgraphFileName_background = "hhAnalysis/bbwwMEM/data/param_ttbar.dat";
-    const bool applyOnshellWmassConstraint_signal = false;
-    const int memAlgo_verbosity = 0;
-    //const int maxObjFunctionCalls_signal = 2500;
-    //const int maxObjFunctionCalls_background = 25000;
-    const int maxObjFunctionCalls_signal = 1000;
-    const int maxObjFunctionCalls_background = 10000;
-
-    clock.Reset();
-    clock.Start("memAlgo");
-    MEMbbwwAlgoSingleLepton memAlgo(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo.setBJet1TF(&bjetTF);
-    memAlgo.setBJet2TF(&bjetTF);
-    memAlgo.setHadWJet1TF(&hadWJetTF);
-    memAlgo.setHadWJet2TF(&hadWJetTF);
-    memAlgo.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo.setIntMode(MEMbbwwAlgoSingleLepton::kVAMP);
-    memAlgo.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo.integrate(memMeasuredParticles, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultSingleLepton memResult = memAlgo.getResult();
-    clock.Stop("memAlgo");
-
-    double memCpuTime = clock.GetCpuTime("memAlgo");
-    if ( isDEBUG ) {
-      std::cout << "MEM:"
-	        << " probability for signal hypothesis = " << memResult.getProb_signal() 
-                << " +/- " << memResult.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult.getProb_background() 
-                << " +/- " << memResult.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult.getLikelihoodRatio() 
-                << " +/- " << memResult.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime << ")" << std::endl;
-    }
+      if ( isDEBUG ) {
+        std::cout << "selGenLepton: pT = " << selGenLepton->pt() << "," 
+                  << " eta = " << selGenLepton->eta() << ", phi = " << selGenLepton->phi() << std::endl;
+        std::cout << "selGenBJet_lead: pT = " << selGenBJet_lead->pt() << "," 
+                  << " eta = " << selGenBJet_lead->eta() << ", phi = " << selGenBJet_lead->phi() 
+                  << " (isFake = " << selGenBJet_lead_isFake << ")" << std::endl;
+        std::cout << "selGenBJet_sublead: pT = " << selGenBJet_sublead->pt() << "," 
+                  << " eta = " << selGenBJet_sublead->eta() << ", phi = " << selGenBJet_sublead->phi() 
+                  << " (isFake = " << selGenBJet_sublead_isFake << ")" << std::endl;
+        std::cout << "selGenWJet_lead: pT = " << selGenWJet_lead->pt() << "," 
+                  << " eta = " << selGenWJet_lead->eta() << ", phi = " << selGenWJet_lead->phi() 
+                  << " (isFake = " << selGenWJet_lead_isFake << ")" << std::endl;
+        std::cout << "selGenWJet_sublead: pT = " << selGenWJet_sublead->pt() << "," 
+                  << " eta = " << selGenWJet_sublead->eta() << ", phi = " << selGenWJet_sublead->phi() 
+                  << " (isFake = " << selGenWJet_sublead_isFake << ")" << std::endl;
+      }
 
-    (const_cast<MEMEvent_singlelepton*>(&memEvent))->set_memResult(memResult);
-    (const_cast<MEMEvent_singlelepton*>(&memEvent))->set_memCpuTime(memCpuTime);
-
-    mem_ntuple->read(memEvent);
-    mem_ntuple->fill();
-
-    clock.Reset();
-    clock.Start("memAlgo_missingBJet");
-    MEMbbwwAlgoSingleLepton memAlgo_missingBJet(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo_missingBJet.setBJet1TF(&bjetTF);
-    memAlgo_missingBJet.setBJet2TF(&bjetTF);
-    memAlgo_missingBJet.setHadWJet1TF(&hadWJetTF);
-    memAlgo_missingBJet.setHadWJet2TF(&hadWJetTF);
-    memAlgo_missingBJet.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo_missingBJet.setIntMode(MEMbbwwAlgoSingleLepton::kVAMP);
-    memAlgo_missingBJet.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo_missingBJet.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo_missingBJet.integrate(memMeasuredParticles_missingBJet, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultSingleLepton memResult_missingBJet = memAlgo_missingBJet.getResult();
-    clock.Stop("memAlgo_missingBJet");
+      int memLeptonType;
+      double memLeptonMass;
+      if ( selGenLepton->is_electron() ) {
+        memLeptonType = mem::MeasuredParticle::kElectron;
+        memLeptonMass = mem::electronMass;
+      } else if ( selGenLepton->is_muon() ) {
+        memLeptonType = mem::MeasuredParticle::kMuon;
+        memLeptonMass = mem::muonMass;
+      } else assert(0);
+
+      // the MEMEvent_singlelepton objects store copies of the particle kinematics,
+      // while the measured particles used by the MEM integration are owned by the memTask object
+      memTaskType* memTask = nullptr;
+      if ( !memTasks_free.empty() ) {
+        memTask = memTasks_free.back();
+        memTasks_free.pop_back();
+      } else {
+        memTask = new memTaskType(memAlgoPool, memProcessPool);
+      }
+      memTask->smearingVariant_ = smearingVariant;
+      memTask->measuredMEtPx_ = genMEt_smeared.px();
+      memTask->measuredMEtPy_ = genMEt_smeared.py();
+      memTask->evtWeight_ = evtWeight;
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles = memTask->memMeasuredParticles_;
+      memMeasuredParticles.push_back(mem::MeasuredParticle(memLeptonType, 
+        selGenLepton->pt(), selGenLepton->eta(), selGenLepton->phi(), 
+        memLeptonMass, selGenLepton->charge()));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        selGenBJet_lead->pt(), selGenBJet_lead->eta(), selGenBJet_lead->phi(), 
+        mem::bottomQuarkMass));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        selGenBJet_sublead->pt(), selGenBJet_sublead->eta(), selGenBJet_sublead->phi(), 
+        mem::bottomQuarkMass));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kHadWJet,
+        selGenWJet_lead->pt(), selGenWJet_lead->eta(), selGenWJet_lead->phi(), 
+        selGenWJet_lead->mass()));
+      memMeasuredParticles.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kHadWJet,
+        selGenWJet_sublead->pt(), selGenWJet_sublead->eta(), selGenWJet_sublead->phi(), 
+        selGenWJet_sublead->mass()));
+      const mem::MeasuredParticle& memMeasuredLepton = memMeasuredParticles[0];
+      const mem::MeasuredParticle& memMeasuredBJet_lead = memMeasuredParticles[1];
+      const mem::MeasuredParticle& memMeasuredBJet_sublead = memMeasuredParticles[2];
+      const mem::MeasuredParticle& memMeasuredWJet_lead = memMeasuredParticles[3];
+      const mem::MeasuredParticle& memMeasuredWJet_sublead = memMeasuredParticles[4];
     
-    double memCpuTime_missingBJet = clock.GetCpuTime("memAlgo_missingBJet");
-    if ( isDEBUG ) {
-      std::cout << "MEM (missing b-jet case):" 
-	        << " probability for signal hypothesis = " << memResult_missingBJet.getProb_signal() 
-                << " +/- " << memResult_missingBJet.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult_missingBJet.getProb_background() 
-                << " +/- " << memResult_missingBJet.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult_missingBJet.getLikelihoodRatio() 
-                << " +/- " << memResult_missingBJet.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime_missingBJet << ")" << std::endl;
-    }
+      memTask->memEvent_ = MEMEvent_singlelepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        &memMeasuredBJet_lead, &memMeasuredBJet_sublead,
+        &memMeasuredWJet_lead, &memMeasuredWJet_sublead,
+        &memMeasuredLepton,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_singlelepton(memTask->memEvent_, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles_missingBJet = memTask->memMeasuredParticles_missingBJet_;
+      memMeasuredParticles_missingBJet.push_back(memMeasuredLepton);
+      const mem::MeasuredParticle* memMeasuredBJet_missingBJet = nullptr;
+      bool selGenBJet_isFake_missingBJet;
+      CounterBasedRandom rnd(randomSeed, eventInfo.run, eventInfo.lumi, eventInfo.event);
+      double u1 = rnd.Uniform();
+      assert(u1 >= 0. && u1 <= 1.);
+      if ( u1 > 0.50 ) {
+        memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_lead);
+        memMeasuredBJet_missingBJet = &memMeasuredBJet_lead;
+        selGenBJet_isFake_missingBJet = selGenBJet_lead_isFake;
+      } else {
+        memMeasuredParticles_missingBJet.push_back(memMeasuredBJet_sublead);
+        memMeasuredBJet_missingBJet = &memMeasuredBJet_sublead;
+        selGenBJet_isFake_missingBJet = selGenBJet_sublead_isFake;
+      }
+      memMeasuredParticles_missingBJet.push_back(memMeasuredWJet_lead);
+      memMeasuredParticles_missingBJet.push_back(memMeasuredWJet_sublead);
+
+      memTask->memEvent_missingBJet_ = MEMEvent_singlelepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        memMeasuredBJet_missingBJet, nullptr,
+        &memMeasuredWJet_lead, &memMeasuredWJet_sublead,
+        &memMeasuredLepton,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_singlelepton(memTask->memEvent_missingBJet_, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles_missingWJet = memTask->memMeasuredParticles_missingWJet_;
+      memMeasuredParticles_missingWJet.push_back(memMeasuredLepton);
+      memMeasuredParticles_missingWJet.push_back(memMeasuredBJet_lead);
+      memMeasuredParticles_missingWJet.push_back(memMeasuredBJet_sublead);
+      const mem::MeasuredParticle* memMeasuredWJet_missingWJet = nullptr;
+      bool selGenWJet_isFake_missingWJet;
+      double u2 = rnd.Uniform();
+      assert(u2 >= 0. && u2 <= 1.);
+      if ( u2 > 0.50 ) {
+        memMeasuredParticles_missingWJet.push_back(memMeasuredWJet_lead);
+        memMeasuredWJet_missingWJet = &memMeasuredWJet_lead;
+        selGenWJet_isFake_missingWJet = selGenWJet_lead_isFake;
+      } else {
+        memMeasuredParticles_missingWJet.push_back(memMeasuredWJet_sublead);
+        memMeasuredWJet_missingWJet = &memMeasuredWJet_sublead;
+        selGenWJet_isFake_missingWJet = selGenWJet_sublead_isFake;
+      }
 
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingBJet))->set_memResult(memResult_missingBJet);
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingBJet))->set_memCpuTime(memCpuTime_missingBJet);
-
-    mem_ntuple_missingBJet->read(memEvent_missingBJet);
-    mem_ntuple_missingBJet->fill();
-
-    clock.Reset();
-    clock.Start("memAlgo_missingWJet");
-    MEMbbwwAlgoSingleLepton memAlgo_missingWJet(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo_missingWJet.setBJet1TF(&bjetTF);
-    memAlgo_missingWJet.setBJet2TF(&bjetTF);
-    memAlgo_missingWJet.setHadWJet1TF(&hadWJetTF);
-    memAlgo_missingWJet.setHadWJet2TF(&hadWJetTF);
-    memAlgo_missingWJet.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo_missingWJet.setIntMode(MEMbbwwAlgoSingleLepton::kVAMP);
-    memAlgo_missingWJet.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo_missingWJet.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo_missingWJet.integrate(memMeasuredParticles_missingWJet, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultSingleLepton memResult_missingWJet = memAlgo_missingWJet.getResult();
-    clock.Stop("memAlgo_missingWJet");
-    
-    double memCpuTime_missingWJet = clock.GetCpuTime("memAlgo_missingWJet");
-    if ( isDEBUG ) {
-      std::cout << "MEM (missing jet from W->jj case):" 
-	        << " probability for signal hypothesis = " << memResult_missingWJet.getProb_signal() 
-                << " +/- " << memResult_missingWJet.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult_missingWJet.getProb_background() 
-                << " +/- " << memResult_missingWJet.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult_missingWJet.getLikelihoodRatio() 
-                << " +/- " << memResult_missingWJet.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime_missingWJet << ")" << std::endl;
-    }
+      memTask->memEvent_missingWJet_ = MEMEvent_singlelepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        &memMeasuredBJet_lead, &memMeasuredBJet_sublead,
+        memMeasuredWJet_missingWJet, nullptr,
+        &memMeasuredLepton,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_singlelepton(memTask->memEvent_missingWJet_, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      std::vector<mem::MeasuredParticle>& memMeasuredParticles_missingBnWJet = memTask->memMeasuredParticles_missingBnWJet_;
+      memMeasuredParticles_missingBnWJet.push_back(memMeasuredLepton);
+      const mem::MeasuredParticle* memMeasuredBJet_missingBnWJet = nullptr;
+      bool selGenBJet_isFake_missingBnWJet;
+      double u3 = rnd.Uniform();
+      assert(u3 >= 0. && u3 <= 1.);
+      if ( u3 > 0.50 ) {
+        memMeasuredParticles_missingBnWJet.push_back(memMeasuredBJet_lead);
+        memMeasuredBJet_missingBnWJet = &memMeasuredBJet_lead;
+        selGenBJet_isFake_missingBnWJet = selGenBJet_lead_isFake;
+      } else {
+        memMeasuredParticles_missingBnWJet.push_back(memMeasuredBJet_sublead);
+        memMeasuredBJet_missingBnWJet = &memMeasuredBJet_sublead;
+        selGenBJet_isFake_missingBnWJet = selGenBJet_sublead_isFake;
+      }
+      const mem::MeasuredParticle* memMeasuredWJet_missingBnWJet = nullptr;
+      bool selGenWJet_isFake_missingBnWJet;
+      double u4 = rnd.Uniform();
+      assert(u4 >= 0. && u4 <= 1.);
+      if ( u4 > 0.50 ) {
+        memMeasuredParticles_missingBnWJet.push_back(memMeasuredWJet_lead);
+        memMeasuredWJet_missingBnWJet = &memMeasuredWJet_lead;
+        selGenWJet_isFake_missingBnWJet = selGenWJet_lead_isFake;
+      } else {
+        memMeasuredParticles_missingBnWJet.push_back(memMeasuredWJet_sublead);
+        memMeasuredWJet_missingBnWJet = &memMeasuredWJet_sublead;
+        selGenWJet_isFake_missingBnWJet = selGenWJet_sublead_isFake;
+      }
 
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingWJet))->set_memResult(memResult_missingWJet);
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingWJet))->set_memCpuTime(memCpuTime_missingWJet);
-
-    mem_ntuple_missingWJet->read(memEvent_missingWJet);
-    mem_ntuple_missingWJet->fill();
-
-    clock.Reset();
-    clock.Start("memAlgo_missingBnWJet");
-    MEMbbwwAlgoSingleLepton memAlgo_missingBnWJet(sqrtS, pdfName, findFile(madgraphFileName_signal), findFile(madgraphFileName_background), memAlgo_verbosity);
-    memAlgo_missingBnWJet.setBJet1TF(&bjetTF);
-    memAlgo_missingBnWJet.setBJet2TF(&bjetTF);
-    memAlgo_missingBnWJet.setHadWJet1TF(&hadWJetTF);
-    memAlgo_missingBnWJet.setHadWJet2TF(&hadWJetTF);
-    memAlgo_missingBnWJet.applyOnshellWmassConstraint_signal(applyOnshellWmassConstraint_signal);
-    memAlgo_missingBnWJet.setIntMode(MEMbbwwAlgoSingleLepton::kVAMP);
-    memAlgo_missingBnWJet.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
-    memAlgo_missingBnWJet.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
-    memAlgo_missingBnWJet.integrate(memMeasuredParticles_missingBnWJet, genMEt_smeared.px(), genMEt_smeared.py(), metCov);
-    MEMbbwwResultSingleLepton memResult_missingBnWJet = memAlgo_missingBnWJet.getResult();
-    clock.Stop("memAlgo_missingBnWJet");
-    
-    double memCpuTime_missingBnWJet = clock.GetCpuTime("memAlgo_missingBnWJet");
-    if ( isDEBUG ) {
-      std::cout << "MEM (missing b-jet && jet from W->jj case):" 
-	        << " probability for signal hypothesis = " << memResult_missingBnWJet.getProb_signal() 
-                << " +/- " << memResult_missingBnWJet.getProbErr_signal() << ","
-	        << " probability for background hypothesis = " << memResult_missingBnWJet.getProb_background() 
-                << " +/- " << memResult_missingBnWJet.getProbErr_background() << " " 
-	        << "--> likelihood ratio = " << memResult_missingBnWJet.getLikelihoodRatio() 
-                << " +/- " << memResult_missingBnWJet.getLikelihoodRatioErr() 
-	        << " (CPU time = " << memCpuTime_missingBnWJet << ")" << std::endl;
-    }
+      memTask->memEvent_missingBnWJet_ = MEMEvent_singlelepton(
+        { eventInfo.run, eventInfo.lumi, eventInfo.event, eventInfo.genWeight }, isSignal, 
+        memMeasuredBJet_missingBnWJet, nullptr,
+        memMeasuredWJet_missingBnWJet, nullptr,
+        &memMeasuredLepton,
+        genMEt_smeared.px(), genMEt_smeared.py(), metCov);
+      addGenMatches_singlelepton(memTask->memEvent_missingBnWJet_, genBJetsForMatching_ptrs, genWJetsForMatching_ptrs, genLeptonsForMatching_ptrs, genMEtPx, genMEtPy);
+
+      int numGenuineBJets = 0;
+      if ( !selGenBJet_lead_isFake    ) ++numGenuineBJets;
+      if ( !selGenBJet_sublead_isFake ) ++numGenuineBJets;
+      int numGenuineWJets = 0;
+      if ( !selGenWJet_lead_isFake    ) ++numGenuineWJets;
+      if ( !selGenWJet_sublead_isFake ) ++numGenuineWJets;
+      memTask->numGenuineBJets_ = numGenuineBJets;
+      memTask->numGenuineWJets_ = numGenuineWJets;
+      memTask->numGenuineBJets_missingBJet_ = ( !selGenBJet_isFake_missingBJet ) ? 1 : 0;
+      memTask->numGenuineWJets_missingWJet_ = ( !selGenWJet_isFake_missingWJet ) ? 1 : 0;
+      memTask->numGenuineBJets_missingBnWJet_ = ( !selGenBJet_isFake_missingBnWJet ) ? 1 : 0;
+      memTask->numGenuineWJets_missingBnWJet_ = ( !selGenWJet_isFake_missingBnWJet ) ? 1 : 0;
+
+      memTask->memRequest_.add("MEM integration", memTask->memMeasuredParticles_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_, memTask->memStats_);
+      if ( parallelHypotheses ) memTask->memRequest_.submit();
+      memTask->memRequest_.add("MEM integration (missing b-jet)", memTask->memMeasuredParticles_missingBJet_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_missingBJet_, memTask->memStats_missingBJet_);
+      if ( parallelHypotheses ) memTask->memRequest_.submit();
+      memTask->memRequest_.add("MEM integration (missing W-jet)", memTask->memMeasuredParticles_missingWJet_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_missingWJet_, memTask->memStats_missingWJet_);
+      if ( parallelHypotheses ) memTask->memRequest_.submit();
+      memTask->memRequest_.add("MEM integration (missing b-jet and W-jet)", memTask->memMeasuredParticles_missingBnWJet_,
+        memTask->measuredMEtPx_, memTask->measuredMEtPy_, metCov, memTask->memResult_missingBnWJet_, memTask->memStats_missingBnWJet_);
+      memTask->memRequest_.submit();
+      memTasks.push_back(memTask);
+      writeMEMTasks(maxMemTasks);
+      //---------------------------------------------------------------------------
+
+      MEMbbwwScopedTimer timer_filling(&timingManager, "ntuple and histogram filling");
+      selHistManagerType* selHistManager = smearingVariant->selHistManager_;
+      if ( fillGenHistograms ) {
+        selHistManager->genEvtHistManager_afterCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
+        selHistManager->lheInfoHistManager_afterCuts_->fillHistograms(*lheInfoReader, evtWeight);
+      }
+      selHistManager->weights_->fillHistograms("genWeight", eventInfo.genWeight);
+      selHistManager->weights_->fillHistograms("pileupWeight", eventInfo.pileupWeight);
 
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingBnWJet))->set_memResult(memResult_missingBnWJet);
-    (const_cast<MEMEvent_singlelepton*>(&memEvent_missingBnWJet))->set_memCpuTime(memCpuTime_missingBnWJet);
-
-    mem_ntuple_missingBnWJet->read(memEvent_missingBnWJet);
-    mem_ntuple_missingBnWJet->fill();
-    //---------------------------------------------------------------------------
-
-    int numGenuineBJets = 0;
-    if ( !selGenBJet_lead_isFake    ) ++numGenuineBJets;
-    if ( !selGenBJet_sublead_isFake ) ++numGenuineBJets;
-    int numGenuineWJets = 0;
-    if ( !selGenWJet_lead_isFake    ) ++numGenuineWJets;
-    if ( !selGenWJet_sublead_isFake ) ++numGenuineWJets;
-    if ( numGenuineBJets == 2 && numGenuineWJets == 2 ) {
-      selHistManager->mem_2genuineBJets_2genuineWJets_->fillHistograms(memResult, memCpuTime, evtWeight);
-    } else if ( numGenuineBJets == 1 && numGenuineWJets == 2 ) {
-      selHistManager->mem_1genuineBJet_2genuineWJets_->fillHistograms(memResult, memCpuTime, evtWeight);
-    } else if ( numGenuineBJets == 2 && numGenuineWJets == 1 ) {
-      selHistManager->mem_2genuineBJets_1genuineWJet_->fillHistograms(memResult, memCpuTime, evtWeight);
-    } else if ( numGenuineBJets == 1 && numGenuineWJets == 1 ) {
-      selHistManager->mem_1genuineBJet_1genuineWJet_->fillHistograms(memResult, memCpuTime, evtWeight);
-    } 
-    int numGenuineBJets_missingBJet = ( !selGenBJet_isFake_missingBJet ) ? 1 : 0;
-    if ( numGenuineBJets_missingBJet == 1 && numGenuineWJets == 2 ) {
-      selHistManager->mem_missingBJet_genuineBJet_2genuineWJets_->fillHistograms(memResult_missingBJet, memCpuTime_missingBJet, evtWeight);
-    } else if ( numGenuineBJets_missingBJet == 0 && numGenuineWJets == 2 ) {
-      selHistManager->mem_missingBJet_fakeBJet_2genuineWJets_->fillHistograms(memResult_missingBJet, memCpuTime_missingBJet, evtWeight);
-    }
-    int numGenuineWJets_missingWJet = ( !selGenWJet_isFake_missingWJet ) ? 1 : 0;
-    if ( numGenuineBJets == 2 && numGenuineWJets_missingWJet == 1 ) {
-      selHistManager->mem_missingWJet_2genuineBJets_genuineWJet_->fillHistograms(memResult_missingWJet, memCpuTime_missingWJet, evtWeight);
-    } else if ( numGenuineBJets == 2 && numGenuineWJets_missingWJet == 0 ) {
-      selHistManager->mem_missingWJet_2genuineBJets_fakeWJet_->fillHistograms(memResult_missingWJet, memCpuTime_missingWJet, evtWeight);
-    }
-    int numGenuineBJets_missingBnWJet = ( !selGenBJet_isFake_missingBnWJet ) ? 1 : 0;
-    int numGenuineWJets_missingBnWJet = ( !selGenWJet_isFake_missingBnWJet ) ? 1 : 0;
-    if ( numGenuineBJets_missingBnWJet == 1 && numGenuineWJets_missingBnWJet == 1 ) {
-      selHistManager->mem_missingBnWJet_genuineBJet_genuineWJet_->fillHistograms(memResult_missingBnWJet, memCpuTime_missingBnWJet, evtWeight);
-    } else if ( numGenuineBJets_missingBnWJet == 0 && numGenuineWJets_missingBnWJet == 1 ) {
-      selHistManager->mem_missingBnWJet_fakeBJet_genuineWJet_->fillHistograms(memResult_missingBnWJet, memCpuTime_missingBnWJet, evtWeight);
-    } else if ( numGenuineBJets_missingBnWJet == 1 && numGenuineWJets_missingBnWJet == 0 ) {
-      selHistManager->mem_missingBnWJet_genuineBJet_fakeWJet_->fillHistograms(memResult_missingBnWJet, memCpuTime_missingBnWJet, evtWeight);
-    } else if ( numGenuineBJets_missingBnWJet == 0 && numGenuineWJets_missingBnWJet == 0 ) {
-      selHistManager->mem_missingBnWJet_fakeBJet_fakeWJet_->fillHistograms(memResult_missingBnWJet, memCpuTime_missingBnWJet, evtWeight);
+      ++smearingVariant->selectedEntries_;
+      smearingVariant->selectedEntries_weighted_ += evtWeight;
+      isSelected = true;
     }
-    selHistManager->genEvtHistManager_afterCuts_->fillHistograms(genElectrons, genMuons, {}, {}, genJets, evtWeight);
-    selHistManager->lheInfoHistManager_afterCuts_->fillHistograms(*lheInfoReader, evtWeight);
-    selHistManager->weights_->fillHistograms("genWeight", eventInfo.genWeight);
-    selHistManager->weights_->fillHistograms("pileupWeight", eventInfo.pileupWeight);
+    if ( !isSelected ) continue;
 
+    MEMbbwwScopedTimer timer_filling(&timingManager, "ntuple and histogram filling");
     if ( selEventsFile ) {
       (*selEventsFile) << eventInfo.run << ':' << eventInfo.lumi << ':' << eventInfo.event << '\n';
     }
@@ -1136,36 +1560,104 @@ int main(int argc, char* argv[])
     ++selectedEntries;
     selectedEntries_weighted += evtWeight;
     histogram_selectedEntries->Fill(0.);
+    timer_filling.stop();
+
+    if ( checkpointManager.isDue(selectedEntries) ) {
+      MEMbbwwScopedTimer timer_checkpoint(&timingManager, "checkpointing");
+      // wait for MEM integrations that are still running,
+      // so that the output of all events preceding the next entry is stored in the checkpoint
+      writeMEMTasks(0);
+      MEMbbwwCheckpointState checkpointState;
+      checkpointState.nextEntry_ = selEntryIdx + 1;
+      checkpointState.analyzedEntries_ = analyzedEntries;
+      checkpointState.selectedEntries_ = selectedEntries;
+      checkpointState.selectedEntries_weighted_ = selectedEntries_weighted;
+      for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+            smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+        checkpointState.selectedEntries_variant_.push_back((*smearingVariant)->selectedEntries_);
+        checkpointState.selectedEntries_weighted_variant_.push_back((*smearingVariant)->selectedEntries_weighted_);
+      }
+      if ( selEventsFile ) {
+        selEventsFile->flush();
+        checkpointState.selEventsFileSize_ = selEventsFile->tellp();
+      }
+      if ( selEntryIndexFile ) {
+        selEntryIndexFile->flush();
+        checkpointState.selEntryIndexFileSize_ = selEntryIndexFile->tellp();
+      }
+      timingManager.getTotals(checkpointState.timingPhases_, checkpointState.timingNumCalls_,
+        checkpointState.timingWallTimes_, checkpointState.timingCpuTimes_);
+      checkpointManager.write(fs.file(), checkpointState);
+    }
+  }
+
+//--- wait for MEM integrations that are still running
+  writeMEMTasks(0);
+  for ( std::vector<memTaskType*>::iterator memTask = memTasks_free.begin();
+        memTask != memTasks_free.end(); ++memTask ) {
+    delete (*memTask);
   }
 
-  std::cout << "max num. Entries = " << inputTree -> getCumulativeMaxEventCount()
-            << " (limited by " << maxEvents << ") processed in "
-            << inputTree -> getProcessedFileCount() << " file(s) (out of "
-            << inputTree -> getFileCount() << ")\n"
-            << " analyzed = " << analyzedEntries << '\n'
-            << " selected = " << selectedEntries << " (weighted = " << selectedEntries_weighted << ")\n\n"
-            << "cut-flow table" << std::endl;
-  cutFlowTable.print(std::cout);
-  std::cout << std::endl;
+  timingManager.print(std::cout);
+  if ( memResultCache ) memResultCache->print(std::cout);
+  timingManager.writeTree(fs);
+  checkpointManager.finish(fs.file());
+
+  if ( inputTree ) {
+    std::cout << "max num. Entries = " << inputTree -> getCumulativeMaxEventCount()
+              << " (limited by " << maxEvents << ") processed in "
+              << inputTree -> getProcessedFileCount() << " file(s) (out of "
+              << inputTree -> getFileCount() << ")\n";
+  } else {
+    std::cout << "num. Entries = " << skimReader -> numEventsRead()
+              << " (limited by " << maxEvents << ") read from skim file = " << skimFileName_input << '\n';
+  }
+  std::cout << " analyzed = " << analyzedEntries << '\n'
+            << " selected = " << selectedEntries << " (weighted = " << selectedEntries_weighted << ")\n" << std::endl;
+  for ( std::vector<smearingVariantType*>::const_iterator smearingVariant = smearingVariants.begin();
+        smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+    std::cout << "smearing variant " << (*smearingVariant)->histogramDir_ << ":\n"
+              << " selected = " << (*smearingVariant)->selectedEntries_ << " (weighted = " << (*smearingVariant)->selectedEntries_weighted_ << ")\n\n"
+              << "cut-flow table";
+    if ( checkpointManager.isResumed() ) {
+      // the cut-flow table cannot be restored from the checkpoint, in contrast to the cut-flow histograms stored in the output file
+      std::cout << " (covering only the entries >= " << checkpointState_resumed.nextEntry_ << " processed after resuming from the last checkpoint;"
+                << " the cut-flow histograms in the output file cover all entries)";
+    }
+    std::cout << std::endl;
+    (*smearingVariant)->cutFlowTable_.print(std::cout);
+    std::cout << std::endl;
+  }
 
   delete run_lumi_eventSelector;
 
   delete selEventsFile;
+  delete selEntryIndexFile;
+  delete skimWriter;
+  // the skim file is renamed first, as the jobs reading the skim file are waiting for the index file
+  if ( skimFileName_output != "" ) commitOutputFile(skimFileName_output);
+  if ( makeSelEntryIndex ) commitOutputFile(selEntryIndexFileName);
+  delete skimReader;
 
   delete genLeptonReader;
   delete genNeutrinoReader;
   delete genJetReader;
   delete lheInfoReader;
 
-  delete genEvtHistManager_beforeCuts;
-
-  delete mem_ntuple;
-  delete mem_ntuple_missingBJet;
-  delete mem_ntuple_missingWJet;
-  delete mem_ntuple_missingBnWJet;
+  for ( std::vector<smearingVariantType*>::iterator smearingVariant = smearingVariants.begin();
+        smearingVariant != smearingVariants.end(); ++smearingVariant ) {
+    delete (*smearingVariant)->genEvtHistManager_beforeCuts_;
+    delete (*smearingVariant)->mem_ntuple_;
+    delete (*smearingVariant)->mem_ntuple_missingBJet_;
+    delete (*smearingVariant)->mem_ntuple_missingWJet_;
+    delete (*smearingVariant)->mem_ntuple_missingBnWJet_;
+    delete (*smearingVariant);
+  }
 
   delete inputTree;
 
+  delete memResultCache;
+
   clock.Show("analyze_hh_bbwwMEM_singlelepton");
 
   return EXIT_SUCCESS;
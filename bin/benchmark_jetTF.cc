@@ -0,0 +1,170 @@
+#include "DataFormats/Math/interface/LorentzVector.h" // math::PtEtaPhiMLorentzVector
+
+#include <TBenchmark.h> // TBenchmark
+#include <TError.h> // gErrorAbortLevel, kError
+#include <TRandom3.h> // TRandom3
+
+#include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::LorentzVector, mem::bottomQuarkMass
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/BJetTF_toy.h" // mem::BJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/HadWJetTF_toy.h" // mem::HadWJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/JetTF_kernels.h" // mem::BJetTF_kernel, mem::HadWJetTF_kernel, mem::jetTF::Kernel
+
+#include <iostream> // std::cout
+#include <iomanip> // std::setprecision()
+#include <string> // std::string
+#include <vector> // std::vector<>
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE, std::atoi
+#include <chrono> // std::chrono::steady_clock
+#include <algorithm> // std::max()
+#include <cmath> // std::fabs
+
+namespace
+{
+  /**
+   * @brief Time the scalar and batch versions of the Eval method of one transfer function
+   *
+   *        The scalar version is called through a pointer to the base class, as done by the MEM integrand.
+   */
+  template <class T_base, class T_tf>
+  void
+  benchmark(const std::string & label, const T_base* tf_base, const T_tf& tf,
+            const std::vector<double>& trueEn, int numRepetitions)
+  {
+    const size_t numPoints = trueEn.size();
+    std::vector<double> prob_scalar(numPoints);
+    std::vector<double> prob_batch(numPoints);
+
+    double sum_scalar = 0.;
+    std::chrono::steady_clock::time_point start_scalar = std::chrono::steady_clock::now();
+    for ( int idxRepetition = 0; idxRepetition < numRepetitions; ++idxRepetition ) {
+      for ( size_t idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+        prob_scalar[idxPoint] = tf_base->Eval(trueEn[idxPoint]);
+      }
+      sum_scalar += prob_scalar[idxRepetition % numPoints];
+    }
+    std::chrono::duration<double> time_scalar = std::chrono::steady_clock::now() - start_scalar;
+
+    double sum_batch = 0.;
+    std::chrono::steady_clock::time_point start_batch = std::chrono::steady_clock::now();
+    for ( int idxRepetition = 0; idxRepetition < numRepetitions; ++idxRepetition ) {
+      tf.Eval(trueEn.data(), prob_batch.data(), numPoints);
+      sum_batch += prob_batch[idxRepetition % numPoints];
+    }
+    std::chrono::duration<double> time_batch = std::chrono::steady_clock::now() - start_batch;
+
+    double maxRelDiff = 0.;
+    for ( size_t idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+      const double prob_max = std::max(std::fabs(prob_scalar[idxPoint]), std::fabs(prob_batch[idxPoint]));
+      if ( prob_max > 0. ) {
+        maxRelDiff = std::max(maxRelDiff, std::fabs(prob_scalar[idxPoint] - prob_batch[idxPoint])/prob_max);
+      }
+    }
+
+    const double numEvals = static_cast<double>(numPoints)*numRepetitions;
+    std::cout << label << ":" << std::endl;
+    std::cout << " scalar: " << std::setprecision(3) << 1.e+9*time_scalar.count()/numEvals << " ns/call" << std::endl;
+    std::cout << " batch:  " << std::setprecision(3) << 1.e+9*time_batch.count()/numEvals << " ns/call" << std::endl;
+    std::cout << " speed-up = " << std::setprecision(3) << time_scalar.count()/time_batch.count() << std::endl;
+    std::cout << " max. relative difference between scalar and batch results = " << maxRelDiff << std::endl;
+    // print checksums, so that the compiler cannot drop the loops
+    std::cout << " (checksums: scalar = " << sum_scalar << ", batch = " << sum_batch << ")" << std::endl;
+  }
+
+  /**
+   * @brief Time the scalar Eval method of a transfer function kernel that is bound at compile time (no virtual function call)
+   */
+  template <class T_kernel>
+  void
+  benchmark_static(const std::string & label, const T_kernel& kernel,
+                   const std::vector<double>& trueEn, int numRepetitions)
+  {
+    const size_t numPoints = trueEn.size();
+    std::vector<double> prob_static(numPoints);
+
+    double sum_static = 0.;
+    std::chrono::steady_clock::time_point start_static = std::chrono::steady_clock::now();
+    for ( int idxRepetition = 0; idxRepetition < numRepetitions; ++idxRepetition ) {
+      for ( size_t idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+        prob_static[idxPoint] = kernel.Eval(trueEn[idxPoint]);
+      }
+      sum_static += prob_static[idxRepetition % numPoints];
+    }
+    std::chrono::duration<double> time_static = std::chrono::steady_clock::now() - start_static;
+
+    const double numEvals = static_cast<double>(numPoints)*numRepetitions;
+    std::cout << label << ":" << std::endl;
+    std::cout << " static: " << std::setprecision(3) << 1.e+9*time_static.count()/numEvals << " ns/call" << std::endl;
+    std::cout << " (checksum = " << sum_static << ")" << std::endl;
+  }
+}
+
+/**
+ * @brief Compare the CPU cost of the scalar and batch versions of the b-jet and W->jj jet transfer functions,
+ *        and of calling the transfer functions through the mem::BJetTF interface or statically bound.
+ */
+int main(int argc, char* argv[])
+{
+//--- throw an exception in case ROOT encounters an error
+  gErrorAbortLevel = kError;
+
+//--- parse command-line arguments
+  if ( argc > 3 ) {
+    std::cout << "Usage: " << argv[0] << " [numPoints] [numRepetitions]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const int numPoints = ( argc > 1 ) ? std::atoi(argv[1]) : 1024;
+  const int numRepetitions = ( argc > 2 ) ? std::atoi(argv[2]) : 10000;
+  if ( !(numPoints > 0 && numRepetitions > 0) ) {
+    std::cout << "Invalid command-line arguments: numPoints = " << numPoints << ", numRepetitions = " << numRepetitions << " !!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "<benchmark_jetTF>:" << std::endl;
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("benchmark_jetTF");
+
+  std::cout << " numPoints = " << numPoints << ", numRepetitions = " << numRepetitions << std::endl;
+
+//--- measured jet with typical kinematics; true energies spread around the measured energy,
+//    including a few values below the b-quark mass, for which the TF is zero
+  const double measuredPt = 50.;
+  const double measuredEta = 1.2;
+  const math::PtEtaPhiMLorentzVector measuredP4_ptEtaPhiM(measuredPt, measuredEta, 0., mem::bottomQuarkMass);
+  const mem::LorentzVector measuredP4(measuredP4_ptEtaPhiM);
+
+  TRandom3 rnd(12345);
+  std::vector<double> trueEn(numPoints);
+  for ( int idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    trueEn[idxPoint] = rnd.Uniform(0., 3.*measuredP4.energy());
+  }
+
+  mem::BJetTF_toy bjetTF;
+  bjetTF.setInputs(measuredP4);
+  benchmark("BJetTF_toy", static_cast<const mem::BJetTF*>(&bjetTF), bjetTF, trueEn, numRepetitions);
+
+  mem::HadWJetTF_toy hadWJetTF;
+  hadWJetTF.setInputs(measuredP4);
+  benchmark("HadWJetTF_toy", static_cast<const mem::HadWJetTF*>(&hadWJetTF), hadWJetTF, trueEn, numRepetitions);
+
+//--- compare the run-time polymorphic adapters with the statically bound kernels
+  mem::BJetTF_kernel<mem::BJetTFKernel_toy> bjetTF_sqrtPt;
+  bjetTF_sqrtPt.setInputs(measuredP4);
+  benchmark("BJetTF_kernel<sqrt(pT) resolution, b-quark>", static_cast<const mem::BJetTF*>(&bjetTF_sqrtPt), bjetTF_sqrtPt, trueEn, numRepetitions);
+  benchmark_static("jetTF::Kernel<sqrt(pT) resolution, b-quark>", bjetTF_sqrtPt.kernel(), trueEn, numRepetitions);
+
+  mem::BJetTF_kernel<mem::BJetTFKernel_doubleGaussian> bjetTF_doubleGaussian;
+  bjetTF_doubleGaussian.setInputs(measuredP4);
+  benchmark("BJetTF_kernel<double-Gaussian resolution, b-quark>", static_cast<const mem::BJetTF*>(&bjetTF_doubleGaussian), bjetTF_doubleGaussian, trueEn, numRepetitions);
+  benchmark_static("jetTF::Kernel<double-Gaussian resolution, b-quark>", bjetTF_doubleGaussian.kernel(), trueEn, numRepetitions);
+
+  mem::HadWJetTF_kernel<mem::HadWJetTFKernel_toy> hadWJetTF_invSqrtPt;
+  hadWJetTF_invSqrtPt.setInputs(measuredP4);
+  benchmark("HadWJetTF_kernel<1/sqrt(pT) resolution, b-quark>", static_cast<const mem::HadWJetTF*>(&hadWJetTF_invSqrtPt), hadWJetTF_invSqrtPt, trueEn, numRepetitions);
+  benchmark_static("jetTF::Kernel<1/sqrt(pT) resolution, b-quark>", hadWJetTF_invSqrtPt.kernel(), trueEn, numRepetitions);
+
+  clock.Show("benchmark_jetTF");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,543 @@
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TBenchmark.h> // TBenchmark
+#include <TError.h> // gErrorAbortLevel, kError
+#include <TFile.h> // TFile
+#include <TMatrixD.h> // TMatrixD
+#include <TString.h> // Form
+#include <TTree.h> // TTree
+
+#include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoDilepton.h" // MEMbbwwAlgoDilepton
+#include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoSingleLepton.h" // MEMbbwwAlgoSingleLepton
+#include "hhAnalysis/bbwwMEM/interface/MeasuredParticle.h" // mem::MeasuredParticle
+#include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::bottomQuarkMass, mem::electronMass, mem::muonMass
+
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwAlgoPool.h" // MEMbbwwAlgoConfig, MEMbbwwAlgoPool, MEMbbwwIntegrationRequest
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwIntegrationStats.h" // MEMbbwwIntegrationStats
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwNtupleSchema.h" // MEMbbwwNtupleBranches, MEMBBWW_NTUPLE_ROW
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwROCCurve.h" // MEMbbwwScoreDistribution, compAUC, compAUC_bootstrap
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwProcessPool.h" // MEMbbwwProcessPool
+
+#include <iostream> // std::cout
+#include <iomanip> // std::setw(), std::setprecision()
+#include <string> // std::string
+#include <vector> // std::vector<>
+#include <type_traits> // std::decay
+#include <utility> // std::declval
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE, std::atoi
+#include <chrono> // std::chrono::steady_clock
+#include <algorithm> // std::sort(), std::min()
+#include <cmath> // std::isfinite, std::abs
+
+namespace
+{
+  /**
+   * @brief Inputs to the MEM computation for one event of the fixed event sample
+   */
+  struct benchmarkEvent
+  {
+    benchmarkEvent()
+      : run_(0)
+      , ls_(0)
+      , event_(0)
+      , isSignal_(false)
+      , genWeight_(1.)
+      , measuredMEtPx_(0.)
+      , measuredMEtPy_(0.)
+      , measuredMEtCov_(2,2)
+      , memLR_ntuple_(0.)
+    {}
+
+    UInt_t run_;
+    UInt_t ls_;
+    ULong64_t event_;
+    bool isSignal_;
+    double genWeight_;
+    std::vector<mem::MeasuredParticle> measuredParticles_;
+    double measuredMEtPx_;
+    double measuredMEtPy_;
+    TMatrixD measuredMEtCov_;
+    double memLR_ntuple_; ///< likelihood ratio stored in the input ntuple, computed with the budget used for production
+  };
+
+  /**
+   * @brief Point of the grid in number of integrand evaluations and integration mode
+   */
+  struct budgetScanPoint
+  {
+    int intMode_;
+    int maxObjFunctionCalls_signal_;
+    int maxObjFunctionCalls_background_;
+  };
+
+  /// MEM result and CPU time for one event and one grid point
+  struct budgetScanEventResult
+  {
+    int idxPoint_;
+    const benchmarkEvent * event_;
+    double memLR_;
+    double memLRerr_;
+    MEMbbwwIntegrationStats memStats_;
+  };
+
+  /// summary of all events for one grid point
+  struct budgetScanResult
+  {
+    int idxPoint_;
+    budgetScanPoint point_;
+    int numEvents_signal_;
+    int numEvents_background_;
+    int numEvents_failed_;          ///< number of events with undefined likelihood ratio
+    double cpuTime_mean_;           ///< CPU time per event, averaged over signal and background events (in units of seconds)
+    double cpuTime_signal_mean_;    ///< CPU time per event spent on the signal hypothesis
+    double cpuTime_background_mean_;
+    double numCalls_signal_mean_;   ///< number of integrand evaluations per event used for the signal hypothesis (differs from the budget in case of adaptive integration)
+    double numCalls_background_mean_;
+    double wallTime_;               ///< wall-clock time spent on all events (in units of seconds)
+    double memLRerr_rel_mean_;      ///< mean, median and 90% quantile of memLRerr/memLR
+    double memLRerr_rel_median_;
+    double memLRerr_rel_q90_;
+    double auc_;
+    double aucErr_;                 ///< uncertainty on the AUC, estimated by bootstrap
+    bool isPareto_;                 ///< flag indicating that no other grid point reaches the same AUC with less CPU time
+  };
+
+#define BENCHMARK_MEMBUDGETSCAN_POINT_COLUMNS(COLUMN)                                                        \
+  COLUMN(idxPoint,                       Int_t,     -1,    src.idxPoint_)                                    \
+  COLUMN(intMode,                        Int_t,     -1,    src.point_.intMode_)                              \
+  COLUMN(maxObjFunctionCalls_signal,     Int_t,     0,     src.point_.maxObjFunctionCalls_signal_)           \
+  COLUMN(maxObjFunctionCalls_background, Int_t,     0,     src.point_.maxObjFunctionCalls_background_)       \
+  COLUMN(numEvents_signal,               Int_t,     0,     src.numEvents_signal_)                            \
+  COLUMN(numEvents_background,           Int_t,     0,     src.numEvents_background_)                        \
+  COLUMN(numEvents_failed,               Int_t,     0,     src.numEvents_failed_)                            \
+  COLUMN(cpuTime,                        Float_t,   -1.,   src.cpuTime_mean_)                                \
+  COLUMN(cpuTime_signal,                 Float_t,   -1.,   src.cpuTime_signal_mean_)                         \
+  COLUMN(cpuTime_background,             Float_t,   -1.,   src.cpuTime_background_mean_)                     \
+  COLUMN(numCalls_signal,                Float_t,   -1.,   src.numCalls_signal_mean_)                        \
+  COLUMN(numCalls_background,            Float_t,   -1.,   src.numCalls_background_mean_)                    \
+  COLUMN(wallTime,                       Float_t,   -1.,   src.wallTime_)                                    \
+  COLUMN(memLRerr_rel_mean,              Float_t,   -1.,   src.memLRerr_rel_mean_)                           \
+  COLUMN(memLRerr_rel_median,            Float_t,   -1.,   src.memLRerr_rel_median_)                         \
+  COLUMN(memLRerr_rel_q90,               Float_t,   -1.,   src.memLRerr_rel_q90_)                            \
+  COLUMN(auc,                            Float_t,   -1.,   src.auc_)                                         \
+  COLUMN(aucErr,                         Float_t,   -1.,   src.aucErr_)                                      \
+  COLUMN(isPareto,                       Bool_t,    false, src.isPareto_)
+  MEMBBWW_NTUPLE_ROW(budgetScanPointRow, BENCHMARK_MEMBUDGETSCAN_POINT_COLUMNS);
+  MEMBBWW_NTUPLE_DEFINE_READ(budgetScanPointRow, BENCHMARK_MEMBUDGETSCAN_POINT_COLUMNS, budgetScanResult)
+
+#define BENCHMARK_MEMBUDGETSCAN_EVENT_COLUMNS(COLUMN)                                                        \
+  COLUMN(idxPoint,                       Int_t,     -1,    src.idxPoint_)                                    \
+  COLUMN(run,                            UInt_t,    0,     src.event_->run_)                                 \
+  COLUMN(ls,                             UInt_t,    0,     src.event_->ls_)                                  \
+  COLUMN(event,                          ULong64_t, 0,     src.event_->event_)                               \
+  COLUMN(isSignal,                       Bool_t,    false, src.event_->isSignal_)                            \
+  COLUMN(genWeight,                      Float_t,   0.,    src.event_->genWeight_)                           \
+  COLUMN(memLR,                          Double_t,  0.,    src.memLR_)                                       \
+  COLUMN(memLRerr,                       Double_t,  0.,    src.memLRerr_)                                    \
+  COLUMN(memLR_ntuple,                   Double_t,  0.,    src.event_->memLR_ntuple_)                        \
+  COLUMN(memCpuTime,                     Float_t,   -1.,   src.memStats_.cpuTime_)                           \
+  COLUMN(memCpuTime_signal,              Float_t,   -1.,   src.memStats_.cpuTime_signal_)                    \
+  COLUMN(memCpuTime_background,          Float_t,   -1.,   src.memStats_.cpuTime_background_)                \
+  COLUMN(memNumCalls_signal,             Int_t,     0,     src.memStats_.numCalls_signal_)                   \
+  COLUMN(memNumCalls_background,         Int_t,     0,     src.memStats_.numCalls_background_)
+  MEMBBWW_NTUPLE_ROW(budgetScanEventRow, BENCHMARK_MEMBUDGETSCAN_EVENT_COLUMNS);
+  MEMBBWW_NTUPLE_DEFINE_READ(budgetScanEventRow, BENCHMARK_MEMBUDGETSCAN_EVENT_COLUMNS, budgetScanEventResult)
+
+  /**
+   * @brief Grid of signal/background budgets, including the 1000/10000 used for production and the 2500/25000 used previously,
+   *        each of which is run in VEGAS and VAMP integration mode
+   */
+  std::vector<budgetScanPoint>
+  getBudgetScanGrid()
+  {
+    const int budgets[][2] = {
+      {  250,  2500 },
+      {  500,  5000 },
+      { 1000, 10000 },
+      { 2500, 25000 },
+      { 5000, 50000 }
+    };
+    const int intModes[] = { MEMbbwwAlgoBase::kVEGAS, MEMbbwwAlgoBase::kVAMP };
+    std::vector<budgetScanPoint> grid;
+    for ( int intMode : intModes ) {
+      for ( const int (&budget)[2] : budgets ) {
+        grid.push_back({ intMode, budget[0], budget[1] });
+      }
+    }
+    return grid;
+  }
+
+  std::string
+  getIntModeName(int intMode)
+  {
+    if      ( intMode == MEMbbwwAlgoBase::kVEGAS ) return "VEGAS";
+    else if ( intMode == MEMbbwwAlgoBase::kVAMP  ) return "VAMP";
+    else assert(0);
+    return "";
+  }
+
+  mem::MeasuredParticle
+  makeMeasuredLepton(const MEMbbwwNtupleMeasuredLeptonRow & lepton)
+  {
+    // pdgId > 0 for negatively charged leptons, as in getMeasuredLeptonPdgId
+    const int charge = ( lepton.pdgId > 0 ) ? -1 : +1;
+    if      ( std::abs(lepton.pdgId) == 11 ) return mem::MeasuredParticle(mem::MeasuredParticle::kElectron, lepton.pt, lepton.eta, lepton.phi, mem::electronMass, charge);
+    else if ( std::abs(lepton.pdgId) == 13 ) return mem::MeasuredParticle(mem::MeasuredParticle::kMuon,     lepton.pt, lepton.eta, lepton.phi, mem::muonMass,     charge);
+    else throw cms::Exception("makeMeasuredLepton")
+      << "Invalid pdgId = " << lepton.pdgId << " !!\n";
+  }
+
+  /**
+   * @brief Read the first numEvents events with all measured particles present from the MEM ntuple written by analyze_hh_bbwwMEM_dilepton
+   *        or analyze_hh_bbwwMEM_singlelepton
+   *
+   *        The events are read in the order in which they are stored in the ntuple, so that the event sample does not change
+   *        from one job to the next. The MEM inputs are taken from the measured (smeared) particles and MET stored in the ntuple,
+   *        in the same order in which the analyzers pass them to the MEM algorithm.
+   */
+  std::vector<benchmarkEvent>
+  loadEvents(const std::string & channel, const std::string & inputFileName, const std::string & treeName,
+             bool isSignal, int numEvents)
+  {
+    TFile * inputFile = TFile::Open(inputFileName.data(), "READ");
+    if ( !inputFile || inputFile->IsZombie() )
+      throw cms::Exception("loadEvents")
+        << "Failed to open input file = " << inputFileName << " !!\n";
+    TTree * tree = dynamic_cast<TTree *>(inputFile->Get(treeName.data()));
+    if ( !tree )
+      throw cms::Exception("loadEvents")
+        << "Failed to load tree = " << treeName << " from file = " << inputFileName << " !!\n";
+
+    MEMbbwwNtupleBranches<MEMbbwwNtupleEventRow> eventBranches;
+    eventBranches.setBranchAddresses(tree);
+    MEMbbwwNtupleMEMResultReader memResultReader;
+    memResultReader.setBranchAddresses(tree);
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> bjet1("bjet1");
+    bjet1.setBranchAddresses(tree);
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> bjet2("bjet2");
+    bjet2.setBranchAddresses(tree);
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMEtRow> met("met");
+    met.setBranchAddresses(tree);
+    // the leptons are named lepton1 and lepton2 in the dilepton channel and lepton in the single lepton channel
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredLeptonRow> lepton1(( channel == "dilepton" ) ? "lepton1" : "lepton");
+    lepton1.setBranchAddresses(tree);
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredLeptonRow> lepton2("lepton2");
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> wjet1("wjet1");
+    MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> wjet2("wjet2");
+    if ( channel == "dilepton" ) {
+      lepton2.setBranchAddresses(tree);
+    } else {
+      wjet1.setBranchAddresses(tree);
+      wjet2.setBranchAddresses(tree);
+    }
+
+    std::vector<benchmarkEvent> events;
+    const Long64_t numEntries = tree->GetEntries();
+    for ( Long64_t idxEntry = 0; idxEntry < numEntries && (int)events.size() < numEvents; ++idxEntry ) {
+      tree->GetEntry(idxEntry);
+
+      // skip events in which one of the particles is missing, e.g. entries for the MEM computation with missing b-jet
+      if ( !(bjet1.row().pt > 0. && bjet2.row().pt > 0. && lepton1.row().pt > 0.) ) continue;
+      if (  channel == "dilepton" && !(lepton2.row().pt > 0.) ) continue;
+      if ( channel != "dilepton" && !(wjet1.row().pt > 0. && wjet2.row().pt > 0.) ) continue;
+
+      benchmarkEvent event;
+      event.run_ = eventBranches.row().run;
+      event.ls_ = eventBranches.row().ls;
+      event.event_ = eventBranches.row().event;
+      event.isSignal_ = isSignal;
+      event.genWeight_ = eventBranches.row().genWeight;
+      event.memLR_ntuple_ = memResultReader.row().memLR;
+      event.measuredParticles_.push_back(makeMeasuredLepton(lepton1.row()));
+      if ( channel == "dilepton" ) {
+        event.measuredParticles_.push_back(makeMeasuredLepton(lepton2.row()));
+      }
+      event.measuredParticles_.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        bjet1.row().pt, bjet1.row().eta, bjet1.row().phi, mem::bottomQuarkMass));
+      event.measuredParticles_.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kBJet,
+        bjet2.row().pt, bjet2.row().eta, bjet2.row().phi, mem::bottomQuarkMass));
+      if ( channel != "dilepton" ) {
+        event.measuredParticles_.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kHadWJet,
+          wjet1.row().pt, wjet1.row().eta, wjet1.row().phi, wjet1.row().mass));
+        event.measuredParticles_.push_back(mem::MeasuredParticle(mem::MeasuredParticle::kHadWJet,
+          wjet2.row().pt, wjet2.row().eta, wjet2.row().phi, wjet2.row().mass));
+      }
+      event.measuredMEtPx_ = met.row().px;
+      event.measuredMEtPy_ = met.row().py;
+      event.measuredMEtCov_[0][0] = met.row().cov00;
+      event.measuredMEtCov_[0][1] = met.row().cov01;
+      event.measuredMEtCov_[1][0] = met.row().cov01;
+      event.measuredMEtCov_[1][1] = met.row().cov11;
+      events.push_back(event);
+    }
+    std::cout << "Read " << events.size() << " events from tree = " << treeName << " in file = " << inputFileName << std::endl;
+
+    delete inputFile;
+    return events;
+  }
+
+  /// quantile of a distribution given by a sorted vector
+  double
+  getQuantile(const std::vector<double> & values_sorted, double quantile)
+  {
+    if ( values_sorted.empty() ) return -1.;
+    const size_t idx = std::min(values_sorted.size() - 1, (size_t)(quantile*(values_sorted.size() - 1) + 0.5));
+    return values_sorted[idx];
+  }
+
+  /**
+   * @brief Compute the MEM for all events of the sample with the budget and integration mode of one grid point
+   *
+   *        The events are distributed to numProcesses worker processes, each with its own algorithm instance.
+   *        The CPU time of each event is measured by the worker process, so that it does not depend on the number of processes.
+   */
+  template <class T>
+  budgetScanResult
+  runBudgetScanPoint(int idxPoint, const budgetScanPoint & point, const MEMbbwwAlgoConfig & cfg_default,
+                     const std::vector<benchmarkEvent> & events, unsigned numProcesses,
+                     std::vector<budgetScanEventResult> & eventResults)
+  {
+    MEMbbwwAlgoConfig cfg = cfg_default;
+    cfg.intMode_ = point.intMode_;
+    cfg.maxObjFunctionCalls_signal_ = point.maxObjFunctionCalls_signal_;
+    cfg.maxObjFunctionCalls_background_ = point.maxObjFunctionCalls_background_;
+    MEMbbwwAlgoPool<T> memAlgoPool(cfg);
+
+    eventResults.resize(events.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+      typedef typename std::decay<decltype(std::declval<T>().getResult())>::type resultType;
+      // the worker processes are forked from the current process, so they see the algorithm pool created above
+      MEMbbwwProcessPool processPool(numProcesses, [&memAlgoPool](const std::string & request, std::string & response) {
+        memAlgoPool.template process<resultType>(request, response);
+      });
+      std::vector<resultType> memResults(events.size());
+      // each event is sent to the worker processes as a separate request
+      MEMbbwwIntegrationRequest<T, resultType> memRequest(memAlgoPool, processPool);
+      for ( size_t idxEvent = 0; idxEvent < events.size(); ++idxEvent ) {
+        const benchmarkEvent & event = events[idxEvent];
+        budgetScanEventResult & eventResult = eventResults[idxEvent];
+        eventResult.idxPoint_ = idxPoint;
+        eventResult.event_ = &event;
+        memRequest.add("MEM integration", event.measuredParticles_, event.measuredMEtPx_, event.measuredMEtPy_, event.measuredMEtCov_,
+          memResults[idxEvent], eventResult.memStats_);
+        memRequest.submit();
+      }
+      memRequest.receive();
+      for ( size_t idxEvent = 0; idxEvent < events.size(); ++idxEvent ) {
+        eventResults[idxEvent].memLR_ = memResults[idxEvent].getLikelihoodRatio();
+        eventResults[idxEvent].memLRerr_ = memResults[idxEvent].getLikelihoodRatioErr();
+      }
+    }
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - start;
+
+    budgetScanResult result;
+    result.idxPoint_ = idxPoint;
+    result.point_ = point;
+    result.numEvents_signal_ = 0;
+    result.numEvents_background_ = 0;
+    result.numEvents_failed_ = 0;
+    result.wallTime_ = wallTime.count();
+    result.isPareto_ = false;
+    double sumCpuTime = 0.;
+    double sumCpuTime_signal = 0.;
+    double sumCpuTime_background = 0.;
+    double sumNumCalls_signal = 0.;
+    double sumNumCalls_background = 0.;
+    std::vector<double> memLRerr_rel;
+    MEMbbwwScoreDistribution scores_signal;
+    MEMbbwwScoreDistribution scores_background;
+    for ( const budgetScanEventResult & eventResult : eventResults ) {
+      if ( eventResult.event_->isSignal_ ) ++result.numEvents_signal_;
+      else                                 ++result.numEvents_background_;
+      sumCpuTime += eventResult.memStats_.cpuTime_;
+      sumCpuTime_signal += eventResult.memStats_.cpuTime_signal_;
+      sumCpuTime_background += eventResult.memStats_.cpuTime_background_;
+      sumNumCalls_signal += eventResult.memStats_.numCalls_signal_;
+      sumNumCalls_background += eventResult.memStats_.numCalls_background_;
+      if ( !std::isfinite(eventResult.memLR_) ) {
+        ++result.numEvents_failed_;
+        continue;
+      }
+      if ( eventResult.memLR_ > 0. ) memLRerr_rel.push_back(eventResult.memLRerr_/eventResult.memLR_);
+      // the likelihood ratio is used as score, as the AUC does not change under monotonic transformations of the score
+      if ( eventResult.event_->isSignal_ ) scores_signal.fill(eventResult.memLR_, eventResult.event_->genWeight_);
+      else                                 scores_background.fill(eventResult.memLR_, eventResult.event_->genWeight_);
+    }
+    const double numEvents = std::max((size_t)1, eventResults.size());
+    result.cpuTime_mean_ = sumCpuTime/numEvents;
+    result.cpuTime_signal_mean_ = sumCpuTime_signal/numEvents;
+    result.cpuTime_background_mean_ = sumCpuTime_background/numEvents;
+    result.numCalls_signal_mean_ = sumNumCalls_signal/numEvents;
+    result.numCalls_background_mean_ = sumNumCalls_background/numEvents;
+    std::sort(memLRerr_rel.begin(), memLRerr_rel.end());
+    double sumMemLRerr_rel = 0.;
+    for ( double value : memLRerr_rel ) {
+      sumMemLRerr_rel += value;
+    }
+    result.memLRerr_rel_mean_ = ( !memLRerr_rel.empty() ) ? sumMemLRerr_rel/memLRerr_rel.size() : -1.;
+    result.memLRerr_rel_median_ = getQuantile(memLRerr_rel, 0.5);
+    result.memLRerr_rel_q90_ = getQuantile(memLRerr_rel, 0.9);
+    result.auc_ = -1.;
+    result.aucErr_ = -1.;
+    if ( scores_signal.getNumEntries() > 0. && scores_background.getNumEntries() > 0. ) {
+      result.auc_ = compAUC(scores_signal, scores_background);
+      double auc_mean;
+      // the bootstrap replicas are computed by as many threads as there are worker processes for the MEM integrations
+      compAUC_bootstrap(scores_signal, scores_background, 100, 12345, auc_mean, result.aucErr_, numProcesses);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Flag the grid points on the Pareto front, i.e. the points for which no other point has a higher AUC
+   *        for the same or a lower CPU time per event
+   */
+  void
+  markParetoFront(std::vector<budgetScanResult> & results)
+  {
+    for ( budgetScanResult & result : results ) {
+      result.isPareto_ = true;
+      for ( const budgetScanResult & other : results ) {
+        if ( &other == &result ) continue;
+        if ( other.cpuTime_mean_ <= result.cpuTime_mean_ && other.auc_ >= result.auc_ &&
+             (other.cpuTime_mean_ < result.cpuTime_mean_ || other.auc_ > result.auc_) ) {
+          result.isPareto_ = false;
+          break;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Run the MEM algorithm T for all grid points, print one line per grid point and fill the TTrees
+   */
+  template <class T>
+  void
+  runBudgetScan(const std::vector<budgetScanPoint> & grid, const MEMbbwwAlgoConfig & cfg_default,
+                const std::vector<benchmarkEvent> & events, unsigned numProcesses,
+                TTree * tree_points, TTree * tree_events)
+  {
+    MEMbbwwNtupleBranches<budgetScanEventRow> eventBranches;
+    eventBranches.initializeBranches(tree_events);
+    std::vector<budgetScanResult> results;
+    for ( size_t idxPoint = 0; idxPoint < grid.size(); ++idxPoint ) {
+      std::cout << "processing grid point #" << idxPoint << ": intMode = " << getIntModeName(grid[idxPoint].intMode_) << ","
+                << " maxObjFunctionCalls: signal = " << grid[idxPoint].maxObjFunctionCalls_signal_ << ","
+                << " background = " << grid[idxPoint].maxObjFunctionCalls_background_ << std::endl;
+      std::vector<budgetScanEventResult> eventResults;
+      results.push_back(runBudgetScanPoint<T>(idxPoint, grid[idxPoint], cfg_default, events, numProcesses, eventResults));
+      for ( const budgetScanEventResult & eventResult : eventResults ) {
+        eventBranches.read(eventResult);
+        tree_events->Fill();
+      }
+    }
+    markParetoFront(results);
+
+//--- reference: AUC of the likelihood ratio stored in the input ntuples
+    MEMbbwwScoreDistribution scores_signal_ntuple;
+    MEMbbwwScoreDistribution scores_background_ntuple;
+    for ( const benchmarkEvent & event : events ) {
+      if ( !std::isfinite(event.memLR_ntuple_) ) continue;
+      if ( event.isSignal_ ) scores_signal_ntuple.fill(event.memLR_ntuple_, event.genWeight_);
+      else                   scores_background_ntuple.fill(event.memLR_ntuple_, event.genWeight_);
+    }
+
+    MEMbbwwNtupleBranches<budgetScanPointRow> pointBranches;
+    pointBranches.initializeBranches(tree_points);
+    std::cout << std::setw(6) << "mode" << std::setw(8) << "calls_S" << std::setw(8) << "calls_B"
+              << std::setw(12) << "CPU [s/evt]" << std::setw(12) << "CPU_S" << std::setw(12) << "CPU_B"
+              << std::setw(10) << "LRerr50" << std::setw(10) << "LRerr90" << std::setw(8) << "failed"
+              << std::setw(18) << "AUC" << std::setw(8) << "Pareto" << std::endl;
+    for ( const budgetScanResult & result : results ) {
+      pointBranches.read(result);
+      tree_points->Fill();
+      std::cout << std::setw(6) << getIntModeName(result.point_.intMode_)
+                << std::setw(8) << result.point_.maxObjFunctionCalls_signal_
+                << std::setw(8) << result.point_.maxObjFunctionCalls_background_
+                << std::setprecision(3)
+                << std::setw(12) << result.cpuTime_mean_
+                << std::setw(12) << result.cpuTime_signal_mean_
+                << std::setw(12) << result.cpuTime_background_mean_
+                << std::setw(10) << result.memLRerr_rel_median_
+                << std::setw(10) << result.memLRerr_rel_q90_
+                << std::setw(8) << result.numEvents_failed_
+                << std::setw(9) << result.auc_ << " +/- " << std::setw(4) << result.aucErr_
+                << std::setw(8) << ( result.isPareto_ ? "*" : "" ) << std::endl;
+    }
+    if ( scores_signal_ntuple.getNumEntries() > 0. && scores_background_ntuple.getNumEntries() > 0. ) {
+      std::cout << "AUC of memLR stored in the input ntuples = " << std::setprecision(3)
+                << compAUC(scores_signal_ntuple, scores_background_ntuple) << std::endl;
+    }
+  }
+}
+
+/**
+ * @brief Rerun the MEM computation on a fixed event sample for a grid of signal/background integration budgets
+ *        (maxObjFunctionCalls) and integration modes, and report for each grid point the CPU time per event,
+ *        the distribution of the relative uncertainty memLRerr/memLR and the AUC of the likelihood ratio.
+ *
+ *        The event sample is taken from the MEM ntuples of one signal and one background sample,
+ *        written by analyze_hh_bbwwMEM_dilepton or analyze_hh_bbwwMEM_singlelepton.
+ *        The results are printed as a table and stored in the TTrees "budgetScan" (one entry per grid point)
+ *        and "events" (one entry per grid point and event) of the output file.
+ */
+int main(int argc, char* argv[])
+{
+//--- throw an exception in case ROOT encounters an error
+  gErrorAbortLevel = kError;
+
+//--- parse command-line arguments
+  if ( argc < 6 || argc > 9 ) {
+    std::cout << "Usage: " << argv[0] << " dilepton|singlelepton inputFile_signal treeName_signal inputFile_background treeName_background"
+              << " [numEvents] [numProcesses] [outputFile]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string channel = argv[1];
+  const std::string inputFileName_signal = argv[2];
+  const std::string treeName_signal = argv[3];
+  const std::string inputFileName_background = argv[4];
+  const std::string treeName_background = argv[5];
+  const int numEvents = ( argc > 6 ) ? std::atoi(argv[6]) : 500;
+  const int numProcesses = ( argc > 7 ) ? std::atoi(argv[7]) : 1;
+  const std::string outputFileName = ( argc > 8 ) ? argv[8] : Form("benchmark_memBudgetScan_%s.root", channel.data());
+  if ( !((channel == "dilepton" || channel == "singlelepton") && numEvents > 0 && numProcesses >= 0) ) {
+    std::cout << "Invalid command-line arguments: channel = " << channel << ", numEvents = " << numEvents << ", numProcesses = " << numProcesses << " !!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "<benchmark_memBudgetScan>:" << std::endl;
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("benchmark_memBudgetScan");
+
+  std::cout << " channel = " << channel << ", numEvents = " << numEvents << " (per sample), numProcesses = " << numProcesses << std::endl;
+
+  std::vector<benchmarkEvent> events = loadEvents(channel, inputFileName_signal, treeName_signal, true, numEvents);
+  std::vector<benchmarkEvent> events_background = loadEvents(channel, inputFileName_background, treeName_background, false, numEvents);
+  events.insert(events.end(), events_background.begin(), events_background.end());
+
+//--- use the default settings of analyze_hh_bbwwMEM_dilepton and analyze_hh_bbwwMEM_singlelepton (without adaptive integration),
+//    except for the integration mode and budgets, which are set per grid point
+  MEMbbwwAlgoConfig cfg_default;
+  const std::vector<budgetScanPoint> grid = getBudgetScanGrid();
+
+  TFile * outputFile = new TFile(outputFileName.data(), "RECREATE");
+  TTree * tree_points = new TTree("budgetScan", "budgetScan");
+  TTree * tree_events = new TTree("events", "events");
+
+  if ( channel == "dilepton" ) {
+    runBudgetScan<MEMbbwwAlgoDilepton>(grid, cfg_default, events, numProcesses, tree_points, tree_events);
+  } else {
+    runBudgetScan<MEMbbwwAlgoSingleLepton>(grid, cfg_default, events, numProcesses, tree_points, tree_events);
+  }
+
+  outputFile->Write();
+  std::cout << "Results written to file = " << outputFileName << std::endl;
+  delete outputFile;
+
+  clock.Show("benchmark_memBudgetScan");
+
+  return EXIT_SUCCESS;
+}
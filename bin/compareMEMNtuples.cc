@@ -0,0 +1,186 @@
+#include <TFile.h> // TFile
+#include <TDirectory.h> // TDirectory
+#include <TKey.h> // TKey
+#include <TList.h> // TList, TIter
+#include <TTree.h> // TTree, TLeaf
+#include <TError.h> // gErrorAbortLevel, kError
+
+#include <iostream> // std::cout
+#include <iomanip> // std::setprecision()
+#include <map> // std::map<>
+#include <string> // std::string
+#include <vector> // std::vector<>
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE, std::atof
+#include <cmath> // std::fabs
+#include <algorithm> // std::max()
+
+namespace
+{
+  /**
+   * @brief Collect all TTrees stored in the directory and its subdirectories, indexed by their full path
+   */
+  void
+  findTrees(TDirectory* dir, const std::string & path, std::map<std::string, TTree*> & trees)
+  {
+    TIter next(dir->GetListOfKeys());
+    while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+      TObject* object = key->ReadObj();
+      const std::string objectPath = path + "/" + key->GetName();
+      if ( TTree* tree = dynamic_cast<TTree*>(object) ) {
+        trees[objectPath] = tree;
+      } else if ( TDirectory* subdir = dynamic_cast<TDirectory*>(object) ) {
+        findTrees(subdir, objectPath, trees);
+      }
+    }
+  }
+
+  /**
+   * @brief Leaves that are compared: all leaves except the CPU time, which is different in every job
+   */
+  std::vector<TLeaf*>
+  getLeavesToCompare(TTree* tree)
+  {
+    std::vector<TLeaf*> leaves;
+    TIter next(tree->GetListOfLeaves());
+    while ( TLeaf* leaf = dynamic_cast<TLeaf*>(next()) ) {
+      if ( std::string(leaf->GetName()).find("memCpuTime") == 0 ) continue;
+      leaves.push_back(leaf);
+    }
+    return leaves;
+  }
+
+  bool
+  isCompatible(double value1, double value2, double maxRelDiff)
+  {
+    if ( value1 == value2 ) return true;
+    if ( value1 != value1 && value2 != value2 ) return true; // both NaN
+    return std::fabs(value1 - value2) <= maxRelDiff*std::max(std::fabs(value1), std::fabs(value2));
+  }
+
+  /**
+   * @brief Compare two trees entry by entry
+   * @return Number of entries with at least one difference (-1 if the trees have different structure)
+   */
+  long long
+  compareTrees(const std::string & path, TTree* tree1, TTree* tree2, double maxRelDiff)
+  {
+    if ( tree1->GetEntries() != tree2->GetEntries() ) {
+      std::cout << path << ": number of entries differ (" << tree1->GetEntries() << " vs " << tree2->GetEntries() << ") !!" << std::endl;
+      return -1;
+    }
+    std::vector<TLeaf*> leaves1 = getLeavesToCompare(tree1);
+    std::vector<TLeaf*> leaves2;
+    for ( std::vector<TLeaf*>::const_iterator leaf1 = leaves1.begin();
+          leaf1 != leaves1.end(); ++leaf1 ) {
+      TLeaf* leaf2 = tree2->GetLeaf((*leaf1)->GetName());
+      if ( !leaf2 ) {
+        std::cout << path << ": leaf '" << (*leaf1)->GetName() << "' missing in second file !!" << std::endl;
+        return -1;
+      }
+      leaves2.push_back(leaf2);
+    }
+    if ( getLeavesToCompare(tree2).size() != leaves1.size() ) {
+      std::cout << path << ": number of leaves differ !!" << std::endl;
+      return -1;
+    }
+
+    long long numEntries_different = 0;
+    const long long numEntries = tree1->GetEntries();
+    for ( long long idxEntry = 0; idxEntry < numEntries; ++idxEntry ) {
+      tree1->GetEntry(idxEntry);
+      tree2->GetEntry(idxEntry);
+      bool isDifferent = false;
+      for ( size_t idxLeaf = 0; idxLeaf < leaves1.size(); ++idxLeaf ) {
+        const int length = leaves1[idxLeaf]->GetLen();
+        if ( leaves2[idxLeaf]->GetLen() != length ) {
+          isDifferent = true;
+          break;
+        }
+        for ( int idxValue = 0; idxValue < length; ++idxValue ) {
+          const double value1 = leaves1[idxLeaf]->GetValue(idxValue);
+          const double value2 = leaves2[idxLeaf]->GetValue(idxValue);
+          if ( !isCompatible(value1, value2, maxRelDiff) ) {
+            if ( numEntries_different < 10 ) {
+              std::cout << path << ": entry #" << idxEntry << ", leaf '" << leaves1[idxLeaf]->GetName() << "'[" << idxValue << "]:"
+                        << " " << std::setprecision(12) << value1 << " vs " << value2 << std::endl;
+            }
+            isDifferent = true;
+          }
+        }
+      }
+      if ( isDifferent ) ++numEntries_different;
+    }
+    return numEntries_different;
+  }
+}
+
+/**
+ * @brief Check that two output files of the MEM analyzers contain the same ntuples.
+ *
+ *        Used to validate that the MEM results do not depend on the number of worker processes (numProcesses):
+ *        any state that the MEM algorithms carry from one integration to the next,
+ *        or any difference in the inputs received by the worker processes, shows up as a difference between the ntuples.
+ *        All TTrees of the two files are compared entry by entry, except for the CPU time columns.
+ */
+int main(int argc, char* argv[])
+{
+//--- throw an exception in case ROOT encounters an error
+  gErrorAbortLevel = kError;
+
+  if ( argc < 3 ) {
+    std::cout << "Usage: " << argv[0] << " inputFile1 inputFile2 [maxRelDiff]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string inputFileName1 = argv[1];
+  const std::string inputFileName2 = argv[2];
+  const double maxRelDiff = ( argc > 3 ) ? std::atof(argv[3]) : 0.;
+
+  TFile* inputFile1 = TFile::Open(inputFileName1.data());
+  TFile* inputFile2 = TFile::Open(inputFileName2.data());
+  if ( !inputFile1 || inputFile1->IsZombie() || !inputFile2 || inputFile2->IsZombie() ) {
+    std::cout << "Failed to open input files '" << inputFileName1 << "' and '" << inputFileName2 << "' !!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::map<std::string, TTree*> trees1;
+  findTrees(inputFile1, "", trees1);
+  std::map<std::string, TTree*> trees2;
+  findTrees(inputFile2, "", trees2);
+
+  bool isIdentical = true;
+  if ( trees1.empty() ) {
+    std::cout << "No TTree found in '" << inputFileName1 << "' !!" << std::endl;
+    isIdentical = false;
+  }
+  for ( std::map<std::string, TTree*>::const_iterator tree1 = trees1.begin();
+        tree1 != trees1.end(); ++tree1 ) {
+    std::map<std::string, TTree*>::const_iterator tree2 = trees2.find(tree1->first);
+    if ( tree2 == trees2.end() ) {
+      std::cout << tree1->first << ": missing in '" << inputFileName2 << "' !!" << std::endl;
+      isIdentical = false;
+      continue;
+    }
+    const long long numEntries_different = compareTrees(tree1->first, tree1->second, tree2->second, maxRelDiff);
+    std::cout << tree1->first << ": " << tree1->second->GetEntries() << " entries";
+    if ( numEntries_different == 0 ) {
+      std::cout << ", identical" << std::endl;
+    } else {
+      std::cout << ", DIFFERENT";
+      if ( numEntries_different > 0 ) std::cout << " (" << numEntries_different << " entries)";
+      std::cout << std::endl;
+      isIdentical = false;
+    }
+  }
+  for ( std::map<std::string, TTree*>::const_iterator tree2 = trees2.begin();
+        tree2 != trees2.end(); ++tree2 ) {
+    if ( !trees1.count(tree2->first) ) {
+      std::cout << tree2->first << ": missing in '" << inputFileName1 << "' !!" << std::endl;
+      isIdentical = false;
+    }
+  }
+
+  delete inputFile1;
+  delete inputFile2;
+
+  return ( isIdentical ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,6 +4,8 @@
 #include "hhAnalysis/bbwwMEM/interface/BJetTF.h" // mem::BJetTF
 #include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::LorentzVector
 
+#include <cstddef> // size_t
+
 namespace mem
 {
   
@@ -22,10 +24,16 @@ class BJetTF_toy : public BJetTF
   /// evaluate transfer function (TF)
   double Eval(double) const;
 
+  /// evaluate transfer function (TF) for n values of the true b-quark energy (out[i] = Eval(trueEn[i]))
+  void Eval(const double* trueEn, double* out, size_t n) const;
+
  protected:  
   /// measured b-jet pT
   double measuredPt_;
 
+  /// cosh of measured pseudo-rapidity (computed once per call to setInputs instead of once per call to Eval)
+  double measuredCoshEta_;
+
   /// jet pT resolution parameter
   double coeff_;
 };
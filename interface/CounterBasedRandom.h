@@ -0,0 +1,41 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_CounterBasedRandom_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_CounterBasedRandom_h
+
+#include <Rtypes.h> // UInt_t, ULong64_t
+
+/**
+ * @brief Counter-based random number generator
+ *
+ *        The n-th random number is computed by hashing the key (seed, run, lumi, event, object index) together with n,
+ *        i.e. there is no state that is carried over from one event (or object) to the next.
+ *        The random numbers used for a given object in a given event are hence the same,
+ *        irrespective of the order in which events are processed, of the thread that processes them,
+ *        and of how the input files are split into jobs.
+ */
+class CounterBasedRandom
+{
+ public:
+  CounterBasedRandom(ULong64_t seed, UInt_t run, UInt_t lumi, ULong64_t event, UInt_t idxObject = 0);
+  ~CounterBasedRandom();
+
+  /**
+   * @brief Return uniformly distributed random number in the interval ]0,1[
+   */
+  double Uniform();
+
+  /**
+   * @brief Return uniformly distributed random number in the interval ]x1,x2[
+   */
+  double Uniform(double x1, double x2);
+
+  /**
+   * @brief Return Gaussian distributed random number with given mean and standard deviation
+   */
+  double Gaus(double mean, double sigma);
+
+ protected:
+  ULong64_t key_;
+  ULong64_t counter_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_CounterBasedRandom_h
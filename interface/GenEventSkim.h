@@ -0,0 +1,183 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_GenEventSkim_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_GenEventSkim_h
+
+#include "tthAnalysis/HiggsToTauTau/interface/GenLepton.h" // GenLepton
+#include "tthAnalysis/HiggsToTauTau/interface/GenJet.h"    // GenJet
+#include "tthAnalysis/HiggsToTauTau/interface/EventInfo.h" // EventInfo
+
+#include <Rtypes.h> // Int_t, UInt_t, ULong64_t, Long64_t
+
+#include <fstream>     // std::ofstream
+#include <string>      // std::string
+#include <vector>      // std::vector<>
+#include <type_traits> // std::is_trivially_copyable
+
+/**
+ * @brief Generator-level particle, as stored in the skim file
+ *
+ *        The four-vector is stored in double precision, so that the MEM results obtained from the skim file
+ *        are identical to the MEM results obtained from the Ntuples.
+ */
+struct GenEventSkimParticle
+{
+  double pt_;
+  double eta_;
+  double phi_;
+  double mass_;
+  Int_t  pdgId_;
+  Int_t  padding_;
+};
+
+/**
+ * @brief Generator-level objects, weights and event identifiers of one event that passes the generator-level selection
+ *
+ *        All records have the same size, so that the i-th event in the skim file can be accessed without reading the preceding events.
+ *        The jets are stored after the cleaning with respect to the leptons and b-quarks and after the pT and eta cuts,
+ *        in order of decreasing pT.
+ */
+struct GenEventSkimRecord
+{
+  static const unsigned maxGenLeptons = 2;
+  static const unsigned maxGenBJets = 2;
+  static const unsigned maxGenWJets = 2;
+  static const unsigned maxGenJets = 20;
+
+  Long64_t  entry_; ///< index of the event in the Ntuples
+  ULong64_t event_;
+  UInt_t    run_;
+  UInt_t    lumi_;
+  double    genWeight_;
+  double    pileupWeight_;
+  double    lheWeight_scale_central_;
+  double    genMEtPx_; ///< sum of neutrino momenta
+  double    genMEtPy_;
+  UInt_t    numGenLeptons_;
+  UInt_t    numGenBJets_;
+  UInt_t    numGenWJets_;
+  UInt_t    numGenJets_;
+  GenEventSkimParticle genLeptons_[maxGenLeptons]; ///< leptons from W boson decays
+  GenEventSkimParticle genBJets_[maxGenBJets];     ///< b-quarks from H or top quark decays
+  GenEventSkimParticle genWJets_[maxGenWJets];     ///< quarks from hadronic W boson decay (single lepton channel only)
+  GenEventSkimParticle genJets_[maxGenJets];
+};
+
+static_assert(std::is_trivially_copyable<GenEventSkimRecord>::value,
+              "GenEventSkimRecord needs to be copyable bytewise");
+
+/**
+ * @brief Write generator-level skim file
+ *
+ *        The file consists of a header, followed by one GenEventSkimRecord per event.
+ *        The number of events is not stored in the header, but is given by the size of the file.
+ */
+class GenEventSkimWriter
+{
+ public:
+  GenEventSkimWriter(const std::string & fileName);
+  ~GenEventSkimWriter();
+
+  /**
+   * @brief Set event identifiers, weights and generator-level MET
+   */
+  void
+  set(Long64_t entry, const EventInfo & eventInfo, double lheWeight_scale_central, double genMEtPx, double genMEtPy);
+
+  /**
+   * @brief Set generator-level objects (objects exceeding the capacity of the record are dropped with a warning)
+   */
+  void
+  setGenLeptons(const std::vector<GenLepton> & genLeptons);
+  void
+  setGenBJets(const std::vector<GenJet> & genBJets);
+  void
+  setGenWJets(const std::vector<GenJet> & genWJets);
+  void
+  setGenJets(const std::vector<const GenJet *> & genJets);
+
+  /**
+   * @brief Append record to the file
+   */
+  void
+  write();
+
+  /**
+   * @brief Number of events written
+   */
+  Long64_t
+  numEvents() const;
+
+ private:
+  std::string fileName_;
+  std::ofstream * file_;
+  GenEventSkimRecord record_;
+  Long64_t numEvents_;
+};
+
+/**
+ * @brief Read generator-level skim file
+ *
+ *        The file is mapped into memory and the records are accessed in place,
+ *        so no memory is allocated per event.
+ */
+class GenEventSkimReader
+{
+ public:
+  /**
+   * @param maxEntry Only events with entry index < maxEntry are read (all events are read if maxEntry < 0)
+   * @param eventInfo Event identifiers and weights are copied to eventInfo for each event that is read
+   */
+  GenEventSkimReader(const std::string & fileName, Long64_t maxEntry, EventInfo * eventInfo);
+  ~GenEventSkimReader();
+
+  /**
+   * @brief Start reading at the first event with entry index >= firstEntry;
+   *        needs to be called before the first call to hasNextEvent
+   */
+  void
+  setFirstEntry(Long64_t firstEntry);
+
+  /**
+   * @brief Advance to next event
+   * @return false if there are no more events
+   */
+  bool
+  hasNextEvent();
+
+  /**
+   * @brief Return record of current event
+   */
+  const GenEventSkimRecord &
+  getEvent() const;
+
+  /**
+   * @brief Number of events in the file, and number of events read so far
+   */
+  Long64_t
+  numEvents() const;
+  Long64_t
+  numEventsRead() const;
+
+  bool
+  canReport(unsigned reportEvery) const;
+
+ private:
+  std::string fileName_;
+  int fd_;
+  size_t fileSize_;
+  const char * data_;
+  const GenEventSkimRecord * records_;
+  Long64_t numEvents_;
+  Long64_t maxEntry_;
+  Long64_t currentEvent_;
+  EventInfo * eventInfo_;
+};
+
+/**
+ * @brief Convert generator-level particles stored in the skim file back to GenLepton and GenJet objects
+ */
+void
+getGenLeptons(const GenEventSkimParticle * particles, unsigned numParticles, std::vector<GenLepton> & genLeptons);
+void
+getGenJets(const GenEventSkimParticle * particles, unsigned numParticles, std::vector<GenJet> & genJets);
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_GenEventSkim_h
@@ -2,8 +2,9 @@
 #define tthAnalysis_HiggsToTauTau_GenJetSmearer_h
 
 #include "tthAnalysis/HiggsToTauTau/interface/GenJet.h" // GenJet
+#include "tthAnalysis/HiggsToTauTau/interface/EventInfo.h" // EventInfo
 
-#include <TRandom3.h> // TRandom3
+#include <Rtypes.h> // UInt_t, ULong64_t
 
 class GenJetSmearer
 {
@@ -21,16 +22,26 @@ class GenJetSmearer
    */
   double get_coeff() const;
 
+  /**
+   * @brief Set seed of random number generator
+   */
+  void set_seed(ULong64_t seed);
+
   /**
    * @brief Smear generator-level jet 
+   * @param jet Generator-level jet
+   * @param eventInfo Run, lumi and event number of the event
+   * @param idxObject Index that identifies the jet within the event
    * @return Smeared jet
+   *
+   *        The smearing depends only on the seed, on the run, lumi and event number and on idxObject,
+   *        so that events can be smeared in any order and on any thread.
    */
-
-  GenJet operator()(const GenJet&) const;
+  GenJet operator()(const GenJet& jet, const EventInfo& eventInfo, UInt_t idxObject) const;
 
  protected:
   double coeff_;
-  mutable TRandom3 rnd_;
+  ULong64_t seed_;
 };
 
 #endif // hhAnalysis_bbwwMEMPerformanceStudies_GenJetSmearer_h
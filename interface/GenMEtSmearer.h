@@ -2,8 +2,9 @@
 #define tthAnalysis_HiggsToTauTau_GenMEtSmearer_h
 
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenMEt.h" // GenMEt
+#include "tthAnalysis/HiggsToTauTau/interface/EventInfo.h" // EventInfo
 
-#include <TRandom3.h> // TRandom3
+#include <Rtypes.h> // ULong64_t
 
 class GenMEtSmearer
 {
@@ -23,16 +24,26 @@ class GenMEtSmearer
   double get_sigmaX() const;
   double get_sigmaY() const;
 
+  /**
+   * @brief Set seed of random number generator
+   */
+  void set_seed(ULong64_t seed);
+
   /**
    * @brief Smear generator-level missing transverse momentum (MET)
+   * @param met Generator-level MET
+   * @param eventInfo Run, lumi and event number of the event
    * @return Smeared MET
+   *
+   *        The smearing depends only on the seed and on the run, lumi and event number,
+   *        so that events can be smeared in any order and on any thread.
    */
-  GenMEt operator()(const GenMEt&) const;
+  GenMEt operator()(const GenMEt& met, const EventInfo& eventInfo) const;
 
  protected:
   double sigmaX_;
   double sigmaY_;
-  mutable TRandom3 rnd_;
+  ULong64_t seed_;
 };
 
 #endif // hhAnalysis_bbwwMEMPerformanceStudies_GenMEtSmearer_h
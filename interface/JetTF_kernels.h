@@ -0,0 +1,247 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_JetTF_kernels_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_JetTF_kernels_h
+
+#include "hhAnalysis/bbwwMEM/interface/BJetTF.h"          // mem::BJetTF
+#include "hhAnalysis/bbwwMEM/interface/HadWJetTF.h"       // mem::HadWJetTF
+#include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::LorentzVector, mem::bottomQuarkMass
+
+#include <TMath.h> // TMath::Pi, TMath::CosH
+
+#include <algorithm> // std::max
+#include <cmath>     // std::sqrt, std::exp
+#include <cstddef>   // size_t
+
+namespace mem
+{
+
+/**
+ * @brief Jet transfer functions (TF) with the resolution model and the quark mass chosen at compile time.
+ *
+ *        The kernel class jetTF::Kernel<T_resolution, T_quark> is not derived from mem::BJetTF or mem::HadWJetTF,
+ *        so that calls to its Eval method can be inlined into the integrand.
+ *        The adapters BJetTF_kernel<T_kernel> and HadWJetTF_kernel<T_kernel> wrap a kernel in the interface
+ *        that is expected by MEMbbwwAlgoDilepton and MEMbbwwAlgoSingleLepton.
+ *        BJetTFKernel_toy and HadWJetTFKernel_toy compute the same values as BJetTF_toy and HadWJetTF_toy
+ *        (checked by test/testJetTFKernels.cc). The kernels are so far used only by bin/benchmark_jetTF.cc;
+ *        the analyzers and MEMbbwwAlgoPool still use BJetTF_toy and HadWJetTF_toy.
+ */
+namespace jetTF
+{
+  /// mass of the quark that initiates the jet, which sets the lower limit on the true energy
+  struct BottomQuark
+  {
+    static double mass()  { return mem::bottomQuarkMass; }
+    static double mass2() { return mem::bottomQuarkMass2; }
+  };
+
+  struct LightQuark
+  {
+    static double mass()  { return 0.; }
+    static double mass2() { return 0.; }
+  };
+
+  inline double
+  gaussian(double x, double mu, double sigma)
+  {
+    const double norm = 1./std::sqrt(2.*TMath::Pi());
+    const double pull = (x - mu)/sigma;
+    return norm*std::exp(-0.5*pull*pull)/sigma;
+  }
+
+  /// Gaussian pT resolution with sigma = coeff*sqrt(pT), as used by BJetTF_toy
+  struct ResolutionSqrtPt
+  {
+    ResolutionSqrtPt(double coeff = 1.00)
+      : coeff_(coeff)
+    {}
+    double pdf(double measuredPt, double truePt) const
+    {
+      return gaussian(measuredPt, truePt, coeff_*std::sqrt(std::max(1., truePt)));
+    }
+    double coeff_;
+  };
+
+  /// Gaussian pT resolution with sigma = coeff/sqrt(pT), as used by HadWJetTF_toy
+  struct ResolutionInvSqrtPt
+  {
+    ResolutionInvSqrtPt(double coeff = 1.00)
+      : coeff_(coeff)
+    {}
+    double pdf(double measuredPt, double truePt) const
+    {
+      return gaussian(measuredPt, truePt, coeff_/std::sqrt(std::max(1., truePt)));
+    }
+    double coeff_;
+  };
+
+  /// Gaussian pT resolution with sigma = relSigma*pT
+  struct ResolutionConstRel
+  {
+    ResolutionConstRel(double relSigma = 0.15)
+      : relSigma_(relSigma)
+    {}
+    double pdf(double measuredPt, double truePt) const
+    {
+      return gaussian(measuredPt, truePt, relSigma_*std::max(1., truePt));
+    }
+    double relSigma_;
+  };
+
+  /// sum of a core and a tail Gaussian, with sigma = relSigma*pT for each and a fraction tailFraction of the tail Gaussian
+  struct ResolutionDoubleGaussian
+  {
+    ResolutionDoubleGaussian(double relSigma_core = 0.10, double relSigma_tail = 0.30, double tailFraction = 0.20)
+      : relSigma_core_(relSigma_core)
+      , relSigma_tail_(relSigma_tail)
+      , tailFraction_(tailFraction)
+    {}
+    double pdf(double measuredPt, double truePt) const
+    {
+      const double pt = std::max(1., truePt);
+      return (1. - tailFraction_)*gaussian(measuredPt, truePt, relSigma_core_*pt)
+        + tailFraction_*gaussian(measuredPt, truePt, relSigma_tail_*pt);
+    }
+    double relSigma_core_;
+    double relSigma_tail_;
+    double tailFraction_;
+  };
+
+  template <class T_resolution, class T_quark>
+  class Kernel
+  {
+   public:
+    typedef T_resolution resolutionType;
+    typedef T_quark quarkType;
+
+    Kernel(const T_resolution & resolution = T_resolution())
+      : resolution_(resolution)
+      , measuredPt_(0.)
+      , measuredCoshEta_(1.)
+    {}
+
+    /// set measured jet pT and pseudo-rapidity
+    void setInputs(double measuredPt, double measuredEta)
+    {
+      measuredPt_ = measuredPt;
+      measuredCoshEta_ = TMath::CosH(measuredEta);
+    }
+
+    /// evaluate transfer function (TF)
+    double Eval(double trueEn) const
+    {
+      if ( !(trueEn > T_quark::mass()) ) return 0.;
+      // formulae taken from https://en.wikipedia.org/wiki/Pseudorapidity
+      const double truePt = std::sqrt(trueEn*trueEn - T_quark::mass2())/measuredCoshEta_;
+      return resolution_.pdf(measuredPt_, truePt);
+    }
+
+    /// evaluate transfer function (TF) for n values of the true quark energy (out[i] = Eval(trueEn[i]))
+    void Eval(const double* trueEn, double* out, size_t n) const
+    {
+      for ( size_t idx = 0; idx < n; ++idx ) {
+        const double trueEn_i = trueEn[idx];
+        const double truePt = std::sqrt(std::max(0., trueEn_i*trueEn_i - T_quark::mass2()))/measuredCoshEta_;
+        const double prob = resolution_.pdf(measuredPt_, truePt);
+        out[idx] = ( trueEn_i > T_quark::mass() ) ? prob : 0.;
+      }
+    }
+
+    T_resolution & resolution() { return resolution_; }
+    const T_resolution & resolution() const { return resolution_; }
+
+   private:
+    T_resolution resolution_;
+    double measuredPt_;
+    double measuredCoshEta_;
+  };
+}
+
+/**
+ * @brief Run-time polymorphic adapter for existing callers that expect a mem::BJetTF
+ */
+template <class T_kernel>
+class BJetTF_kernel final : public BJetTF
+{
+ public:
+  BJetTF_kernel(const T_kernel & kernel = T_kernel(), int verbosity = 0)
+    : BJetTF(verbosity)
+    , kernel_(kernel)
+  {}
+  ~BJetTF_kernel()
+  {}
+
+  void setInputs(const mem::LorentzVector& measuredP4)
+  {
+    BJetTF::setInputs(measuredP4);
+    kernel_.setInputs(measuredP4.pt(), measuredEta_);
+  }
+
+  double Eval(double trueEn) const
+  {
+    return kernel_.Eval(trueEn);
+  }
+
+  void Eval(const double* trueEn, double* out, size_t n) const
+  {
+    kernel_.Eval(trueEn, out, n);
+  }
+
+  T_kernel & kernel() { return kernel_; }
+  const T_kernel & kernel() const { return kernel_; }
+
+ private:
+  T_kernel kernel_;
+};
+
+/**
+ * @brief Run-time polymorphic adapter for existing callers that expect a mem::HadWJetTF
+ */
+template <class T_kernel>
+class HadWJetTF_kernel final : public HadWJetTF
+{
+ public:
+  HadWJetTF_kernel(const T_kernel & kernel = T_kernel(), int verbosity = 0)
+    : HadWJetTF(verbosity)
+    , kernel_(kernel)
+  {}
+  ~HadWJetTF_kernel()
+  {}
+
+  void setInputs(const mem::LorentzVector& measuredP4)
+  {
+    HadWJetTF::setInputs(measuredP4);
+    kernel_.setInputs(measuredP4.pt(), measuredEta_);
+  }
+
+  double Eval(double trueEn) const
+  {
+    return kernel_.Eval(trueEn);
+  }
+
+  void Eval(const double* trueEn, double* out, size_t n) const
+  {
+    kernel_.Eval(trueEn, out, n);
+  }
+
+  T_kernel & kernel() { return kernel_; }
+  const T_kernel & kernel() const { return kernel_; }
+
+ private:
+  T_kernel kernel_;
+};
+
+// same resolution models and quark masses as BJetTF_toy and HadWJetTF_toy;
+// note that HadWJetTF_toy takes the b-quark mass also for the quarks from W->qq decays
+typedef jetTF::Kernel<jetTF::ResolutionSqrtPt,         jetTF::BottomQuark> BJetTFKernel_toy;
+typedef jetTF::Kernel<jetTF::ResolutionInvSqrtPt,      jetTF::BottomQuark> HadWJetTFKernel_toy;
+
+typedef jetTF::Kernel<jetTF::ResolutionSqrtPt,         jetTF::BottomQuark> BJetTFKernel_sqrtPt;
+typedef jetTF::Kernel<jetTF::ResolutionConstRel,       jetTF::BottomQuark> BJetTFKernel_constRel;
+typedef jetTF::Kernel<jetTF::ResolutionDoubleGaussian, jetTF::BottomQuark> BJetTFKernel_doubleGaussian;
+typedef jetTF::Kernel<jetTF::ResolutionSqrtPt,         jetTF::LightQuark>  HadWJetTFKernel_sqrtPt;
+typedef jetTF::Kernel<jetTF::ResolutionConstRel,       jetTF::LightQuark>  HadWJetTFKernel_constRel;
+typedef jetTF::Kernel<jetTF::ResolutionDoubleGaussian, jetTF::LightQuark>  HadWJetTFKernel_doubleGaussian;
+
+}
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_JetTF_kernels_h
@@ -1,25 +1,34 @@
 #ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMEvent_h
 #define hhAnalysis_bbwwMEMPerformanceStudies_MEMEvent_h
 
-#include "tthAnalysis/HiggsToTauTau/interface/EventInfo.h" // EventInfo
-#include "tthAnalysis/HiggsToTauTau/interface/GenJet.h"    // GenJet
+#include "DataFormats/Math/interface/LorentzVector.h" // math::PtEtaPhiMLorentzVector
+
+#include "tthAnalysis/HiggsToTauTau/interface/GenParticle.h" // GenParticle
 
 #include "hhAnalysis/bbwwMEM/interface/MeasuredParticle.h" // MeasuredParticle
 #include "hhAnalysis/bbwwMEM/interface/MEMResult.h"        // MEMResultBase
 
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwIntegrationStats.h" // MEMbbwwIntegrationStats
+
 #include <TMatrixD.h> // TMatrixD
 
+#include <type_traits> // std::is_trivially_copyable
+
 class MEMEventInfo
 {
  public:
+  MEMEventInfo()
+    : run_(0)
+    , lumi_(0)
+    , event_(0)
+    , genWeight_(0.)
+  {}
   MEMEventInfo(UInt_t run, UInt_t lumi, ULong64_t event, Float_t genWeight)
     : run_(run)
     , lumi_(lumi)
     , event_(event)
     , genWeight_(genWeight)
   {}
-  ~MEMEventInfo()
-  {}
 
   UInt_t    run()       const { return run_;       }
   UInt_t    lumi()      const { return lumi_;      }
@@ -33,16 +42,95 @@ class MEMEventInfo
   Float_t   genWeight_; ///< generator-level weight (only if MC)
 };
 
+/**
+ * @brief Kinematics of a measured or generator-level particle, stored by value in the MEMEvent
+ *
+ *        Particles that are absent (e.g. the second b-jet in the missing b-jet case, or measured particles without generator-level match)
+ *        are represented by objects for which isValid() returns false.
+ */
+class MEMEventParticle
+{
+ public:
+  MEMEventParticle();
+  explicit MEMEventParticle(const mem::MeasuredParticle* measuredParticle);
+  explicit MEMEventParticle(const GenParticle* genParticle);
+
+  bool isValid() const { return isValid_; }
+
+  double pt()   const { return pt_;   }
+  double eta()  const { return eta_;  }
+  double phi()  const { return phi_;  }
+  double mass() const { return mass_; }
+  math::PtEtaPhiMLorentzVector p4() const;
+
+  /**
+   * @brief Type and charge of measured particles (mem::MeasuredParticle::kBJet, kElectron, ...), PDG id of generator-level particles
+   */
+  int type()   const { return type_;   }
+  int charge() const { return charge_; }
+  int pdgId()  const { return pdgId_;  }
+
+  /**
+   * @brief Convert measured particle back to mem::MeasuredParticle object
+   */
+  mem::MeasuredParticle measuredParticle() const;
+
+ private:
+  double pt_;
+  double eta_;
+  double phi_;
+  double mass_;
+  Int_t  type_;
+  Int_t  charge_;
+  Int_t  pdgId_;
+  bool   isValid_;
+};
+
+/**
+ * @brief Covariance matrix of the missing transverse momentum (2x2, symmetric)
+ */
+struct MEMEventMEtCov
+{
+  MEMEventMEtCov();
+  explicit MEMEventMEtCov(const TMatrixD& cov);
+
+  double cov00_;
+  double cov01_;
+  double cov11_;
+};
+
+/**
+ * @brief Probabilities for signal and background hypotheses and likelihood ratio computed by the MEM
+ */
+struct MEMEventResult
+{
+  MEMEventResult();
+  explicit MEMEventResult(const MEMResultBase& memResult);
+
+  double prob_signal_;
+  double probErr_signal_;
+  double prob_background_;
+  double probErr_background_;
+  double likelihoodRatio_;
+  double likelihoodRatioErr_;
+};
+
+/**
+ * @brief Measured and generator-level particles, MET and MEM result of one event, written to the MEM ntuples
+ *
+ *        The kinematics of all particles are copied into the MEMEvent object when the object is constructed or when the generator-level matches are set,
+ *        so the MEMEvent does not refer to any other object and can be copied bytewise, e.g. to pass it from one thread to another.
+ */
 class MEMEvent
 {
  public:
+  MEMEvent();
   MEMEvent(const MEMEventInfo & eventInfo, bool isSignal,
            const mem::MeasuredParticle* measuredBJet1, const mem::MeasuredParticle* measuredBJet2,
            double measuredMEtPx, double measuredMEtPy, const TMatrixD& measuredMEtCov);
-  ~MEMEvent();
 
-  void set_genBJet1(const GenJet* genBJet1);
-  void set_genBJet2(const GenJet* genBJet2);
+  void set_genBJet1(const GenParticle* genBJet1);
+  void set_genBJet2(const GenParticle* genBJet2);
   void set_numGenBJets(int numGenBJets);
 
   void set_isBoosted_Hbb(bool isBoosted_Hbb);
@@ -55,16 +143,17 @@ class MEMEvent
 
   void set_memResult(const MEMResultBase& memResult);
   void set_memCpuTime(double memCpuTime);
+  void set_memIntegrationStats(const MEMbbwwIntegrationStats& memIntegrationStats);
 
   void set_barcode(int barcode);
 
   const MEMEventInfo & eventInfo() const;
   bool isSignal() const;
 
-  const mem::MeasuredParticle* measuredBJet1() const;
-  const GenJet* genBJet1() const;
-  const mem::MeasuredParticle* measuredBJet2() const;
-  const GenJet* genBJet2() const;
+  const MEMEventParticle & measuredBJet1() const;
+  const MEMEventParticle & genBJet1() const;
+  const MEMEventParticle & measuredBJet2() const;
+  const MEMEventParticle & genBJet2() const;
   bool isBoosted_Hbb() const;
   int numMeasuredBJets() const;
   int numGenBJets() const;
@@ -76,10 +165,11 @@ class MEMEvent
   double genMEtPx() const;
   double measuredMEtPy() const;
   double genMEtPy() const;
-  const TMatrixD & measuredMEtCov() const;
+  const MEMEventMEtCov & measuredMEtCov() const;
 
-  const MEMResultBase & memResult() const;
+  const MEMEventResult & memResult() const;
   double memCpuTime() const;
+  const MEMbbwwIntegrationStats & memIntegrationStats() const;
 
   int barcode() const;
 
@@ -90,10 +180,10 @@ class MEMEvent
   MEMEventInfo eventInfo_;
   bool isSignal_;
 
-  const mem::MeasuredParticle* measuredBJet1_;
-  const GenJet* genBJet1_;
-  const mem::MeasuredParticle* measuredBJet2_;
-  const GenJet* genBJet2_;
+  MEMEventParticle measuredBJet1_;
+  MEMEventParticle genBJet1_;
+  MEMEventParticle measuredBJet2_;
+  MEMEventParticle genBJet2_;
   bool isBoosted_Hbb_;
   int numMeasuredBJets_;
   int numGenBJets_;
@@ -105,13 +195,16 @@ class MEMEvent
   double genMEtPx_;
   double measuredMEtPy_;
   double genMEtPy_;
-  TMatrixD measuredMEtCov_;
+  MEMEventMEtCov measuredMEtCov_;
 
-  MEMResultBase memResult_;
+  MEMEventResult memResult_;
   double memCpuTime_;
+  MEMbbwwIntegrationStats memIntegrationStats_;
 
   mutable int barcode_;
 };
 
-#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMEvent_h
+static_assert(std::is_trivially_copyable<MEMEvent>::value,
+              "MEMEvent needs to be copyable bytewise");
 
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMEvent_h
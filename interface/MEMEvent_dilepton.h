@@ -3,25 +3,25 @@
 
 #include "tthAnalysis/HiggsToTauTau/interface/GenLepton.h"           // GenLepton
 
-#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent.h" // MEMEvent, MEMEventInfo
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent.h" // MEMEvent, MEMEventInfo, MEMEventParticle
 
 class MEMEvent_dilepton : public MEMEvent
 {
  public:
+  MEMEvent_dilepton();
   MEMEvent_dilepton(const MEMEventInfo & eventInfo, bool isSignal,
                     const mem::MeasuredParticle* measuredBJet1, const mem::MeasuredParticle* measuredBJet2, 
                     const mem::MeasuredParticle* measuredLepton1, const mem::MeasuredParticle* measuredLepton2, 
                     double measuredMEtPx, double measuredMEtPy, const TMatrixD& measuredMEtCov);
-  ~MEMEvent_dilepton();
 
-  void set_genLepton1(const GenLepton* genLepton1);
-  void set_genLepton2(const GenLepton* genLepton2);
+  void set_genLepton1(const GenParticle* genLepton1);
+  void set_genLepton2(const GenParticle* genLepton2);
   void set_numGenLeptons(int numGenLeptons);
 
-  const mem::MeasuredParticle* measuredLepton1() const;
-  const GenLepton* genLepton1() const;
-  const mem::MeasuredParticle* measuredLepton2() const;
-  const GenLepton* genLepton2() const;
+  const MEMEventParticle & measuredLepton1() const;
+  const MEMEventParticle & genLepton1() const;
+  const MEMEventParticle & measuredLepton2() const;
+  const MEMEventParticle & genLepton2() const;
   int numMeasuredLeptons() const;
   int numGenLeptons() const;
 
@@ -29,13 +29,16 @@ class MEMEvent_dilepton : public MEMEvent
   void countMeasuredLeptons();
   void countGenLeptons();
 
-  const mem::MeasuredParticle* measuredLepton1_;
-  const GenLepton* genLepton1_;
-  const mem::MeasuredParticle* measuredLepton2_;
-  const GenLepton* genLepton2_; 
+  MEMEventParticle measuredLepton1_;
+  MEMEventParticle genLepton1_;
+  MEMEventParticle measuredLepton2_;
+  MEMEventParticle genLepton2_;
   int numMeasuredLeptons_;
   int numGenLeptons_;
 };
 
+static_assert(std::is_trivially_copyable<MEMEvent_dilepton>::value,
+              "MEMEvent_dilepton needs to be copyable bytewise");
+
 #endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMEvent_dilepton_h
 
@@ -0,0 +1,782 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwAlgoPool_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwAlgoPool_h
+
+#include "FWCore/Utilities/interface/Exception.h"                         // cms::Exception
+
+#include "tthAnalysis/HiggsToTauTau/interface/analysisAuxFunctions.h"      // findFile
+
+#include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoDilepton.h"              // MEMbbwwAlgoDilepton
+#include "hhAnalysis/bbwwMEM/interface/MEMbbwwAlgoSingleLepton.h"          // MEMbbwwAlgoSingleLepton
+
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/BJetTF_toy.h"    // mem::BJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/HadWJetTF_toy.h" // mem::HadWJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwIntegrationStats.h" // MEMbbwwIntegrationStats
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwProcessPool.h" // MEMbbwwProcessPool
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwResultCache.h" // MEMbbwwResultCache
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwTimingManager.h" // MEMbbwwTimingManager, MEMbbwwScopedTimer, getThreadCpuTime
+
+#include <TMatrixD.h> // TMatrixD
+
+#include <algorithm> // std::min, std::max
+#include <cmath>     // std::sqrt, std::pow, std::ceil
+#include <cstring>   // std::strlen
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+/**
+ * @brief Settings that are common to all MEM algorithm instances of one job
+ */
+struct MEMbbwwAlgoConfig
+{
+  MEMbbwwAlgoConfig()
+    : sqrtS_(13.e+3)
+    , pdfName_("MSTW2008lo68cl")
+    , madgraphFileName_signal_("hhAnalysis/bbwwMEM/data/param_hh_SM.dat")
+    , madgraphFileName_background_("hhAnalysis/bbwwMEM/data/param_ttbar.dat")
+    , applyOnshellWmassConstraint_signal_(false)
+    , intMode_(MEMbbwwAlgoBase::kVAMP)
+    , maxObjFunctionCalls_signal_(1000)
+    , maxObjFunctionCalls_background_(10000)
+    , maxObjFunctionCalls_inactive_(100)
+    , memLRerrTarget_(-1.)
+    , maxObjFunctionCalls_signal_initial_(250)
+    , maxObjFunctionCalls_background_initial_(2500)
+    , maxObjFunctionCalls_signal_max_(16000)
+    , maxObjFunctionCalls_background_max_(160000)
+    , jetSmearing_coeff_(1.00)
+    , verbosity_(0)
+  {}
+
+  double sqrtS_;
+  std::string pdfName_;
+  std::string madgraphFileName_signal_;
+  std::string madgraphFileName_background_;
+  bool applyOnshellWmassConstraint_signal_;
+  int intMode_;
+  int maxObjFunctionCalls_signal_;
+  int maxObjFunctionCalls_background_;
+  int maxObjFunctionCalls_inactive_; ///< number of integrand evaluations of the hypothesis whose result is discarded (see MEMbbwwAlgoPool::integrate)
+  double memLRerrTarget_; ///< target relative uncertainty on the likelihood ratio (adaptive integration is disabled if <= 0)
+  int maxObjFunctionCalls_signal_initial_;     ///< number of integrand evaluations of the first iteration of the adaptive integration
+  int maxObjFunctionCalls_background_initial_;
+  int maxObjFunctionCalls_signal_max_;         ///< total number of integrand evaluations, summed over all iterations of the adaptive integration
+  int maxObjFunctionCalls_background_max_;
+  double jetSmearing_coeff_; ///< resolution parameter of the b-jet and W->jj jet transfer functions
+  int verbosity_;
+};
+
+namespace mem_algo_pool
+{
+  /**
+   * @brief Inverse-variance weighted mean of independent estimates of the same quantity
+   *
+   *        Estimates with zero uncertainty (e.g. a probability of zero) cannot be weighted by their inverse variance;
+   *        in case any such estimate is added, all estimates are instead weighted by the number of integrand evaluations
+   *        they are based on.
+   */
+  class InverseVarianceMean
+  {
+   public:
+    InverseVarianceMean()
+      : sumWeights_(0.)
+      , sumWeightedValues_(0.)
+      , sumWeights_numCalls_(0.)
+      , sumWeightedValues_numCalls_(0.)
+      , sumWeightedErr2_numCalls_(0.)
+      , hasZeroErr_(false)
+    {}
+
+    void
+    add(double value, double err, double numCalls)
+    {
+      if ( err > 0. ) {
+        const double weight = 1./(err*err);
+        sumWeights_ += weight;
+        sumWeightedValues_ += weight*value;
+      } else {
+        hasZeroErr_ = true;
+      }
+      sumWeights_numCalls_ += numCalls;
+      sumWeightedValues_numCalls_ += numCalls*value;
+      sumWeightedErr2_numCalls_ += (numCalls*err)*(numCalls*err);
+    }
+
+    double
+    value() const
+    {
+      if ( hasZeroErr_ ) return ( sumWeights_numCalls_ > 0. ) ? sumWeightedValues_numCalls_/sumWeights_numCalls_ : 0.;
+      return sumWeightedValues_/sumWeights_;
+    }
+    double
+    err() const
+    {
+      if ( hasZeroErr_ ) return ( sumWeights_numCalls_ > 0. ) ? std::sqrt(sumWeightedErr2_numCalls_)/sumWeights_numCalls_ : 0.;
+      return 1./std::sqrt(sumWeights_);
+    }
+
+   private:
+    double sumWeights_;
+    double sumWeightedValues_;
+    double sumWeights_numCalls_;
+    double sumWeightedValues_numCalls_;
+    double sumWeightedErr2_numCalls_;
+    bool hasZeroErr_;
+  };
+
+  /**
+   * @brief Set likelihood ratio Ps/(Ps + Pb) and its uncertainty from the probabilities Ps and Pb of signal and background hypotheses
+   *
+   *        Same definition as in hhAnalysis/bbwwMEM/interface/MEMResult.h and in the macros that recompute the likelihood ratio
+   *        from the memProbS and memProbB branches of the MEM ntuples (the likelihood ratio is zero in case Ps + Pb = 0).
+   *        The uncertainty is propagated from the uncertainties on Ps and Pb, which are independent.
+   */
+  template <class T_result>
+  void
+  setLikelihoodRatio(T_result & memResult)
+  {
+    const double prob_signal = memResult.getProb_signal();
+    const double prob_background = memResult.getProb_background();
+    const double prob_SplusB = prob_signal + prob_background;
+    if ( prob_SplusB > 0. ) {
+      // dLR/dPs = Pb/(Ps + Pb)^2, dLR/dPb = -Ps/(Ps + Pb)^2
+      const double errTerm_signal = prob_background*memResult.getProbErr_signal();
+      const double errTerm_background = prob_signal*memResult.getProbErr_background();
+      memResult.setLikelihoodRatio(prob_signal/prob_SplusB);
+      memResult.setLikelihoodRatioErr(std::sqrt(errTerm_signal*errTerm_signal + errTerm_background*errTerm_background)/(prob_SplusB*prob_SplusB));
+    } else {
+      memResult.setLikelihoodRatio(0.);
+      memResult.setLikelihoodRatioErr(0.);
+    }
+  }
+
+  /**
+   * @brief Subtract the CPU time spent on the hypothesis that is integrated with maxObjFunctionCalls_inactive evaluations only
+   *        from the CPU times measured for the integration of the signal and of the background hypothesis
+   *
+   *        The CPU time of each hypothesis is assumed to be proportional to its number of evaluations, so that
+   *          cpuTime_signal_measured     = cpuTime_signal     + numCalls_inactive/numCalls_background*cpuTime_background
+   *          cpuTime_background_measured = cpuTime_background + numCalls_inactive/numCalls_signal*cpuTime_signal,
+   *        which is solved for cpuTime_signal and cpuTime_background.
+   */
+  inline void
+  subtractInactiveHypothesis(double cpuTime_signal_measured, double cpuTime_background_measured,
+                             int numCalls_signal, int numCalls_background, int numCalls_inactive,
+                             double & cpuTime_signal, double & cpuTime_background)
+  {
+    const double fraction_background = static_cast<double>(numCalls_inactive)/numCalls_background;
+    const double fraction_signal = static_cast<double>(numCalls_inactive)/numCalls_signal;
+    const double determinant = 1. - fraction_background*fraction_signal;
+    if ( determinant > 0. ) {
+      cpuTime_signal = std::max(0., (cpuTime_signal_measured - fraction_background*cpuTime_background_measured)/determinant);
+      cpuTime_background = std::max(0., (cpuTime_background_measured - fraction_signal*cpuTime_signal_measured)/determinant);
+    } else {
+      cpuTime_signal = cpuTime_signal_measured;
+      cpuTime_background = cpuTime_background_measured;
+    }
+  }
+
+  /// create transfer function for jets from W->jj decays (not needed in the dilepton channel)
+  inline mem::HadWJetTF_toy*
+  makeHadWJetTF(MEMbbwwAlgoSingleLepton* memAlgo, double coeff)
+  {
+    mem::HadWJetTF_toy* hadWJetTF = new mem::HadWJetTF_toy();
+    hadWJetTF->set_coeff(coeff);
+    memAlgo->setHadWJet1TF(hadWJetTF);
+    memAlgo->setHadWJet2TF(hadWJetTF);
+    return hadWJetTF;
+  }
+
+  inline mem::HadWJetTF_toy*
+  makeHadWJetTF(MEMbbwwAlgoDilepton*, double)
+  {
+    return nullptr;
+  }
+
+  /**
+   * @brief Append the inputs of one MEM computation to a byte string (used to send them to the worker processes of a MEMbbwwProcessPool)
+   *
+   *        The measured particles are stored by their type, pT, eta, phi, mass and charge, from which decodeInputs rebuilds them.
+   */
+  inline void
+  encodeInputs(const std::vector<mem::MeasuredParticle> & measuredParticles,
+               double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+               std::string & message)
+  {
+    MEMbbwwResultCache::appendValue(message, static_cast<int>(measuredParticles.size()));
+    for ( std::vector<mem::MeasuredParticle>::const_iterator measuredParticle = measuredParticles.begin();
+          measuredParticle != measuredParticles.end(); ++measuredParticle ) {
+      MEMbbwwResultCache::appendValue(message, static_cast<int>(measuredParticle->type()));
+      MEMbbwwResultCache::appendValue(message, static_cast<double>(measuredParticle->pt()));
+      MEMbbwwResultCache::appendValue(message, static_cast<double>(measuredParticle->eta()));
+      MEMbbwwResultCache::appendValue(message, static_cast<double>(measuredParticle->phi()));
+      MEMbbwwResultCache::appendValue(message, static_cast<double>(measuredParticle->mass()));
+      MEMbbwwResultCache::appendValue(message, static_cast<int>(measuredParticle->charge()));
+    }
+    MEMbbwwResultCache::appendValue(message, measuredMEtPx);
+    MEMbbwwResultCache::appendValue(message, measuredMEtPy);
+    MEMbbwwResultCache::appendValue(message, measuredMEtCov(0,0));
+    MEMbbwwResultCache::appendValue(message, measuredMEtCov(0,1));
+    MEMbbwwResultCache::appendValue(message, measuredMEtCov(1,0));
+    MEMbbwwResultCache::appendValue(message, measuredMEtCov(1,1));
+  }
+
+  /**
+   * @brief Read the inputs written by encodeInputs and advance data to the next value
+   * @param measuredMEtCov matrix of size 2x2
+   */
+  inline void
+  decodeInputs(const char * & data,
+               std::vector<mem::MeasuredParticle> & measuredParticles,
+               double & measuredMEtPx, double & measuredMEtPy, TMatrixD & measuredMEtCov)
+  {
+    measuredParticles.clear();
+    const int numParticles = MEMbbwwResultCache::readValue<int>(data);
+    for ( int idxParticle = 0; idxParticle < numParticles; ++idxParticle ) {
+      const int type = MEMbbwwResultCache::readValue<int>(data);
+      const double pt = MEMbbwwResultCache::readValue<double>(data);
+      const double eta = MEMbbwwResultCache::readValue<double>(data);
+      const double phi = MEMbbwwResultCache::readValue<double>(data);
+      const double mass = MEMbbwwResultCache::readValue<double>(data);
+      const int charge = MEMbbwwResultCache::readValue<int>(data);
+      measuredParticles.push_back(mem::MeasuredParticle(type, pt, eta, phi, mass, charge));
+    }
+    measuredMEtPx = MEMbbwwResultCache::readValue<double>(data);
+    measuredMEtPy = MEMbbwwResultCache::readValue<double>(data);
+    measuredMEtCov(0,0) = MEMbbwwResultCache::readValue<double>(data);
+    measuredMEtCov(0,1) = MEMbbwwResultCache::readValue<double>(data);
+    measuredMEtCov(1,0) = MEMbbwwResultCache::readValue<double>(data);
+    measuredMEtCov(1,1) = MEMbbwwResultCache::readValue<double>(data);
+  }
+
+  /// channel of the MEM algorithm, which identifies the type of the MEM result in the keys of the MEMbbwwResultCache
+  inline std::string
+  getChannel(const MEMbbwwAlgoSingleLepton*)
+  {
+    return "singlelepton";
+  }
+
+  inline std::string
+  getChannel(const MEMbbwwAlgoDilepton*)
+  {
+    return "dilepton";
+  }
+}
+
+/**
+ * @brief Pool of fully configured MEM algorithm instances.
+ *
+ *        Constructing MEMbbwwAlgoDilepton/MEMbbwwAlgoSingleLepton resolves the MadGraph parameter cards
+ *        and initializes the PDF set, which for small integration budgets costs more than the integration itself.
+ *        The pool creates instances on demand and hands them out again once they are returned,
+ *        so that the instances and their transfer functions are long-lived.
+ *        The integrate method of the MEM algorithms starts from scratch on every call,
+ *        so an instance carries no state from one event to the next.
+ *        The MEM algorithms share global state between instances, so the pool must only be used by one thread;
+ *        MEM integrations are run concurrently by the worker processes of a MEMbbwwProcessPool
+ *        (see MEMbbwwIntegrationRequest), each of which uses its own copy of the pool.
+ */
+template <class T>
+class MEMbbwwAlgoPool
+{
+ public:
+  MEMbbwwAlgoPool(const MEMbbwwAlgoConfig & cfg)
+    : cfg_(cfg)
+    , madgraphFileName_signal_(findFile(cfg.madgraphFileName_signal_))
+    , madgraphFileName_background_(findFile(cfg.madgraphFileName_background_))
+    , timingManager_(nullptr)
+    , resultCache_(nullptr)
+    , measuredMEtCov_(2,2)
+  {
+    if ( !(cfg_.maxObjFunctionCalls_signal_ > 0 && cfg_.maxObjFunctionCalls_background_ > 0 && cfg_.maxObjFunctionCalls_inactive_ > 0) )
+      throw cms::Exception("MEMbbwwAlgoPool")
+        << "Invalid configuration parameters:"
+        << " maxObjFunctionCalls_signal = " << cfg_.maxObjFunctionCalls_signal_ << ","
+        << " maxObjFunctionCalls_background = " << cfg_.maxObjFunctionCalls_background_ << ","
+        << " maxObjFunctionCalls_inactive = " << cfg_.maxObjFunctionCalls_inactive_ << " !!\n";
+    if ( cfg_.memLRerrTarget_ > 0. &&
+         !(cfg_.maxObjFunctionCalls_signal_initial_     > 0 && cfg_.maxObjFunctionCalls_signal_initial_     <= cfg_.maxObjFunctionCalls_signal_max_ &&
+           cfg_.maxObjFunctionCalls_background_initial_ > 0 && cfg_.maxObjFunctionCalls_background_initial_ <= cfg_.maxObjFunctionCalls_background_max_) )
+      throw cms::Exception("MEMbbwwAlgoPool")
+        << "Invalid configuration parameters for adaptive integration:"
+        << " maxObjFunctionCalls_signal_initial = " << cfg_.maxObjFunctionCalls_signal_initial_ << ","
+        << " maxObjFunctionCalls_signal_max = " << cfg_.maxObjFunctionCalls_signal_max_ << ","
+        << " maxObjFunctionCalls_background_initial = " << cfg_.maxObjFunctionCalls_background_initial_ << ","
+        << " maxObjFunctionCalls_background_max = " << cfg_.maxObjFunctionCalls_background_max_ << " !!\n";
+  }
+  ~MEMbbwwAlgoPool()
+  {
+    for ( typename std::vector<entryType*>::iterator entry = entries_.begin();
+          entry != entries_.end(); ++entry ) {
+      delete (*entry)->memAlgo_;
+      delete (*entry)->bjetTF_;
+      delete (*entry)->hadWJetTF_;
+      delete (*entry);
+    }
+  }
+
+  struct entryType
+  {
+    T* memAlgo_;
+    mem::BJetTF_toy* bjetTF_;
+    mem::HadWJetTF_toy* hadWJetTF_;
+  };
+
+  /// take an algorithm instance from the pool (a new instance is created in case all existing ones are in use)
+  entryType*
+  checkout()
+  {
+    if ( available_.empty() ) {
+      MEMbbwwScopedTimer timer(timingManager_, "MEM algorithm construction");
+      entryType* entry = new entryType();
+      entry->memAlgo_ = new T(cfg_.sqrtS_, cfg_.pdfName_, madgraphFileName_signal_, madgraphFileName_background_, cfg_.verbosity_);
+      entry->bjetTF_ = new mem::BJetTF_toy();
+      entry->bjetTF_->set_coeff(cfg_.jetSmearing_coeff_);
+      entry->memAlgo_->setBJet1TF(entry->bjetTF_);
+      entry->memAlgo_->setBJet2TF(entry->bjetTF_);
+      entry->hadWJetTF_ = mem_algo_pool::makeHadWJetTF(entry->memAlgo_, cfg_.jetSmearing_coeff_);
+      entry->memAlgo_->applyOnshellWmassConstraint_signal(cfg_.applyOnshellWmassConstraint_signal_);
+      entry->memAlgo_->setIntMode(cfg_.intMode_);
+      entry->memAlgo_->setMaxObjFunctionCalls_signal(cfg_.maxObjFunctionCalls_signal_);
+      entry->memAlgo_->setMaxObjFunctionCalls_background(cfg_.maxObjFunctionCalls_background_);
+      entries_.push_back(entry);
+      return entry;
+    }
+    entryType* entry = available_.back();
+    available_.pop_back();
+    return entry;
+  }
+
+  /// return algorithm instance to the pool
+  void
+  release(entryType* entry)
+  {
+    available_.push_back(entry);
+  }
+
+  /// number of algorithm instances created so far
+  size_t
+  size() const
+  {
+    return entries_.size();
+  }
+
+  /**
+   * @brief Compute MEM for one event
+   *
+   *        The MEM algorithms integrate signal and background hypotheses within one call to their integrate method.
+   *        In order to measure the CPU time of each hypothesis on its own, the hypotheses are integrated in two separate calls:
+   *        the first call uses the configured number of evaluations for the signal hypothesis
+   *        and maxObjFunctionCalls_inactive evaluations for the background hypothesis, whose result is discarded,
+   *        and the second call vice versa. The small CPU time spent on the discarded integrations is subtracted from the CPU times
+   *        of the two hypotheses (see mem_algo_pool::subtractInactiveHypothesis), but is included in the total CPU time.
+   *        The likelihood ratio is computed from the probabilities of the two hypotheses (see mem_algo_pool::setLikelihoodRatio).
+   *        In case a target uncertainty (memLRerrTarget) is configured, the integration starts with
+   *        maxObjFunctionCalls_signal_initial and maxObjFunctionCalls_background_initial integrand evaluations.
+   *        The integrate method of the MEM algorithms does not allow to resume a previous integration,
+   *        so further iterations are run as independent integrations, whose probabilities for signal and background hypotheses
+   *        are combined with the previous ones by inverse-variance weighting; the likelihood ratio and its uncertainty
+   *        are then computed from the combined probabilities (see mem_algo_pool::setLikelihoodRatio). The number of evaluations of each further iteration is chosen such that,
+   *        assuming the uncertainty to scale with one over the square-root of the total number of evaluations,
+   *        the combined relative uncertainty on the likelihood ratio reaches the target.
+   *        The iterations stop once the target is reached or once the total number of evaluations would exceed
+   *        maxObjFunctionCalls_signal_max and maxObjFunctionCalls_background_max.
+   *        The CPU times and the numbers of integrand evaluations stored in memStats include all iterations.
+   * @param memStats CPU time spent by the calling thread on the integration (in units of seconds),
+   *                 and CPU time and number of integrand evaluations used for the signal and for the background hypothesis
+   */
+  template <class T_result>
+  void
+  compute(const std::vector<mem::MeasuredParticle> & measuredParticles,
+          double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+          T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    handle memAlgo(*this);
+    const double cpuTime_start = getThreadCpuTime();
+    memStats = MEMbbwwIntegrationStats();
+    memStats.cpuTime_signal_ = 0.;
+    memStats.cpuTime_background_ = 0.;
+    const bool isAdaptive = cfg_.memLRerrTarget_ > 0.;
+    int maxObjFunctionCalls_signal = ( isAdaptive ) ? cfg_.maxObjFunctionCalls_signal_initial_ : cfg_.maxObjFunctionCalls_signal_;
+    int maxObjFunctionCalls_background = ( isAdaptive ) ? cfg_.maxObjFunctionCalls_background_initial_ : cfg_.maxObjFunctionCalls_background_;
+    int sumObjFunctionCalls_signal = 0;
+    int sumObjFunctionCalls_background = 0;
+    mem_algo_pool::InverseVarianceMean prob_signal;
+    mem_algo_pool::InverseVarianceMean prob_background;
+    while ( true ) {
+      T_result memResult_signal;
+      T_result memResult_background;
+      double cpuTime_signal_measured = 0.;
+      double cpuTime_background_measured = 0.;
+      cpuTime_signal_measured = integrateOnce(*memAlgo, "MEM integration (signal hypothesis)", maxObjFunctionCalls_signal, cfg_.maxObjFunctionCalls_inactive_,
+        measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov, memResult_signal);
+      cpuTime_background_measured = integrateOnce(*memAlgo, "MEM integration (background hypothesis)", cfg_.maxObjFunctionCalls_inactive_, maxObjFunctionCalls_background,
+        measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov, memResult_background);
+      ++memStats.numIntegrations_;
+      sumObjFunctionCalls_signal += maxObjFunctionCalls_signal;
+      sumObjFunctionCalls_background += maxObjFunctionCalls_background;
+      double cpuTime_signal = 0.;
+      double cpuTime_background = 0.;
+      mem_algo_pool::subtractInactiveHypothesis(cpuTime_signal_measured, cpuTime_background_measured,
+        maxObjFunctionCalls_signal, maxObjFunctionCalls_background, cfg_.maxObjFunctionCalls_inactive_, cpuTime_signal, cpuTime_background);
+      memStats.cpuTime_signal_ += cpuTime_signal;
+      memStats.cpuTime_background_ += cpuTime_background;
+
+      prob_signal.add(memResult_signal.getProb_signal(), memResult_signal.getProbErr_signal(), maxObjFunctionCalls_signal);
+      prob_background.add(memResult_background.getProb_background(), memResult_background.getProbErr_background(), maxObjFunctionCalls_background);
+      memResult = T_result();
+      memResult.setProb_signal(prob_signal.value());
+      memResult.setProbErr_signal(prob_signal.err());
+      memResult.setProb_background(prob_background.value());
+      memResult.setProbErr_background(prob_background.err());
+      mem_algo_pool::setLikelihoodRatio(memResult);
+      if ( !isAdaptive ) break;
+
+      const double memLR = memResult.getLikelihoodRatio();
+      const double memLRerr = memResult.getLikelihoodRatioErr();
+      if ( !(memLR > 0.) || memLRerr < cfg_.memLRerrTarget_*memLR ) break;
+      const int maxObjFunctionCalls_signal_remaining = cfg_.maxObjFunctionCalls_signal_max_ - sumObjFunctionCalls_signal;
+      const int maxObjFunctionCalls_background_remaining = cfg_.maxObjFunctionCalls_background_max_ - sumObjFunctionCalls_background;
+      if ( maxObjFunctionCalls_signal_remaining     < cfg_.maxObjFunctionCalls_signal_initial_ ||
+           maxObjFunctionCalls_background_remaining < cfg_.maxObjFunctionCalls_background_initial_ ) break;
+      // total number of evaluations needed to reach the target, minus the evaluations done so far
+      const double numCallsFactor = std::pow(memLRerr/(cfg_.memLRerrTarget_*memLR), 2) - 1.;
+      maxObjFunctionCalls_signal = static_cast<int>(std::min<double>(maxObjFunctionCalls_signal_remaining,
+        std::max<double>(cfg_.maxObjFunctionCalls_signal_initial_, std::ceil(numCallsFactor*sumObjFunctionCalls_signal))));
+      maxObjFunctionCalls_background = static_cast<int>(std::min<double>(maxObjFunctionCalls_background_remaining,
+        std::max<double>(cfg_.maxObjFunctionCalls_background_initial_, std::ceil(numCallsFactor*sumObjFunctionCalls_background))));
+    }
+    memStats.cpuTime_ = getThreadCpuTime() - cpuTime_start;
+    memStats.numCalls_signal_ = sumObjFunctionCalls_signal;
+    memStats.numCalls_background_ = sumObjFunctionCalls_background;
+  }
+
+  /**
+   * @brief Read MEM result and integration statistics from the MEMbbwwResultCache
+   * @return true if a cache is set and contains a result for the same inputs and settings
+   */
+  template <class T_result>
+  bool
+  lookup(const std::vector<mem::MeasuredParticle> & measuredParticles,
+         double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+         T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    if ( !resultCache_ ) return false;
+    MEMbbwwScopedTimer timer(timingManager_, "MEM result cache lookup");
+    makeCacheKey(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov);
+    return resultCache_->get(cacheKey_, memResult, memStats);
+  }
+
+  /// store MEM result and integration statistics in the MEMbbwwResultCache (in case a cache is set)
+  template <class T_result>
+  void
+  store(const std::vector<mem::MeasuredParticle> & measuredParticles,
+        double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+        const T_result & memResult, const MEMbbwwIntegrationStats & memStats)
+  {
+    if ( !resultCache_ ) return;
+    MEMbbwwScopedTimer timer(timingManager_, "MEM result cache writing");
+    makeCacheKey(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov);
+    resultCache_->put(cacheKey_, memResult, memStats);
+  }
+
+  /**
+   * @brief Compute MEM for one event in the calling process
+   *
+   *        In case a MEMbbwwResultCache is set, the result is taken from the cache if the cache contains a result
+   *        for the same inputs and settings, and is stored in the cache otherwise.
+   */
+  template <class T_result>
+  void
+  integrate(const std::vector<mem::MeasuredParticle> & measuredParticles,
+            double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+            T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    if ( lookup(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov, memResult, memStats) ) return;
+    compute(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov, memResult, memStats);
+    store(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov, memResult, memStats);
+  }
+
+  /**
+   * @brief Compute MEM for the inputs encoded in a request by MEMbbwwIntegrationRequest
+   *        and append the results to the response (handler function of the MEMbbwwProcessPool)
+   *
+   *        A request contains one or more sets of inputs, each preceded by the phase under which its computation is timed.
+   */
+  template <class T_result>
+  void
+  process(const std::string & request, std::string & response)
+  {
+    const char * data = request.data();
+    const char * data_end = data + request.size();
+    T_result memResult;
+    MEMbbwwIntegrationStats memStats;
+    while ( data < data_end ) {
+      // the phase is encoded including its terminating null character
+      const char * phase = data;
+      data += std::strlen(phase) + 1;
+      double measuredMEtPx = 0.;
+      double measuredMEtPy = 0.;
+      mem_algo_pool::decodeInputs(data, measuredParticles_, measuredMEtPx, measuredMEtPy, measuredMEtCov_);
+      MEMbbwwScopedTimer timer(timingManager_, phase);
+      compute(measuredParticles_, measuredMEtPx, measuredMEtPy, measuredMEtCov_, memResult, memStats);
+      MEMbbwwResultCache::encode(memResult, memStats, response);
+    }
+  }
+
+  /// measure time spent on the construction of algorithm instances, on the cache and on the integration of each hypothesis (nullptr to disable)
+  void
+  setTimingManager(MEMbbwwTimingManager* timingManager)
+  {
+    timingManager_ = timingManager;
+  }
+
+  /**
+   * @brief Read MEM results from and write them to an on-disk cache (nullptr to disable)
+   *
+   *        The part of the cache key that depends on the settings of the MEM algorithm,
+   *        including the content of the MadGraph parameter cards, is computed once in this function.
+   */
+  void
+  setResultCache(MEMbbwwResultCache* resultCache)
+  {
+    resultCache_ = resultCache;
+    cacheKey_cfg_ = MEMbbwwResultCache::Key();
+    if ( !resultCache_ ) return;
+    cacheKey_cfg_.add(mem_algo_pool::getChannel(static_cast<const T*>(nullptr)))
+                 .add(MEMbbwwResultCache::getMEMVersion())
+                 .add(std::string("BJetTF_toy"))
+                 .add(std::string("HadWJetTF_toy"))
+                 .add(cfg_.jetSmearing_coeff_)
+                 .add(cfg_.sqrtS_)
+                 .add(cfg_.pdfName_)
+                 .addFile(madgraphFileName_signal_)
+                 .addFile(madgraphFileName_background_)
+                 .add(static_cast<int>(cfg_.applyOnshellWmassConstraint_signal_))
+                 .add(cfg_.intMode_)
+                 .add(cfg_.maxObjFunctionCalls_signal_)
+                 .add(cfg_.maxObjFunctionCalls_background_)
+                 .add(cfg_.maxObjFunctionCalls_inactive_)
+                 .add(cfg_.memLRerrTarget_)
+                 .add(cfg_.maxObjFunctionCalls_signal_initial_)
+                 .add(cfg_.maxObjFunctionCalls_background_initial_)
+                 .add(cfg_.maxObjFunctionCalls_signal_max_)
+                 .add(cfg_.maxObjFunctionCalls_background_max_);
+  }
+
+  const MEMbbwwAlgoConfig &
+  cfg() const
+  {
+    return cfg_;
+  }
+
+  /**
+   * @brief Algorithm instance checked out from the pool for the lifetime of the handle
+   */
+  class handle
+  {
+   public:
+    handle(MEMbbwwAlgoPool<T> & pool)
+      : pool_(pool)
+      , entry_(pool.checkout())
+    {}
+    ~handle()
+    {
+      pool_.release(entry_);
+    }
+
+    T* operator->() const { return entry_->memAlgo_; }
+    T& operator*()  const { return *entry_->memAlgo_; }
+
+   private:
+    handle(const handle &) = delete;
+    handle & operator=(const handle &) = delete;
+
+    MEMbbwwAlgoPool<T> & pool_;
+    entryType* entry_;
+  };
+
+ private:
+  /// set cacheKey_ to the key of the MEMbbwwResultCache for the given inputs
+  void
+  makeCacheKey(const std::vector<mem::MeasuredParticle> & measuredParticles,
+               double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov)
+  {
+    cacheKey_ = cacheKey_cfg_;
+    for ( std::vector<mem::MeasuredParticle>::const_iterator measuredParticle = measuredParticles.begin();
+          measuredParticle != measuredParticles.end(); ++measuredParticle ) {
+      cacheKey_.add(measuredParticle->type())
+               .add(measuredParticle->pt()).add(measuredParticle->eta()).add(measuredParticle->phi()).add(measuredParticle->mass())
+               .add(measuredParticle->charge());
+    }
+    cacheKey_.add(measuredMEtPx).add(measuredMEtPy);
+    cacheKey_.add(measuredMEtCov(0,0)).add(measuredMEtCov(0,1)).add(measuredMEtCov(1,0)).add(measuredMEtCov(1,1));
+  }
+
+  /**
+   * @brief Call the integrate method of the MEM algorithm once, with the given numbers of evaluations for signal and background hypotheses
+   *
+   *        The call is timed by the timing manager as the given phase.
+   * @return CPU time spent by the calling thread (in units of seconds)
+   */
+  template <class T_result>
+  double
+  integrateOnce(T & memAlgo, const char * phase, int maxObjFunctionCalls_signal, int maxObjFunctionCalls_background,
+                const std::vector<mem::MeasuredParticle> & measuredParticles,
+                double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+                T_result & memResult)
+  {
+    MEMbbwwScopedTimer timer(timingManager_, phase);
+    const double cpuTime_start = getThreadCpuTime();
+    memAlgo.setMaxObjFunctionCalls_signal(maxObjFunctionCalls_signal);
+    memAlgo.setMaxObjFunctionCalls_background(maxObjFunctionCalls_background);
+    memAlgo.integrate(measuredParticles, measuredMEtPx, measuredMEtPy, measuredMEtCov);
+    memResult = memAlgo.getResult();
+    return getThreadCpuTime() - cpuTime_start;
+  }
+
+  MEMbbwwAlgoConfig cfg_;
+  std::string madgraphFileName_signal_;
+  std::string madgraphFileName_background_;
+  MEMbbwwTimingManager* timingManager_;
+  MEMbbwwResultCache* resultCache_;
+  MEMbbwwResultCache::Key cacheKey_cfg_;
+  MEMbbwwResultCache::Key cacheKey_;
+
+  std::vector<entryType*> entries_;
+  std::vector<entryType*> available_;
+
+  // inputs decoded by the process function, kept to reuse their memory
+  std::vector<mem::MeasuredParticle> measuredParticles_;
+  TMatrixD measuredMEtCov_;
+};
+
+/**
+ * @brief MEM computations for one event (e.g. for the full and for the missing b-jet case),
+ *        which are run by the worker processes of a MEMbbwwProcessPool while the calling process continues with the next events
+ *
+ *        The calling process takes the results from the MEMbbwwResultCache in case the cache contains them,
+ *        sends the other inputs to the worker processes, and writes the results received from the workers to the cache.
+ *        The inputs added between two calls to the submit method are sent as one request, which is processed by one worker.
+ */
+template <class T, class T_result>
+class MEMbbwwIntegrationRequest
+{
+ public:
+  MEMbbwwIntegrationRequest(MEMbbwwAlgoPool<T> & memAlgoPool, MEMbbwwProcessPool & processPool)
+    : memAlgoPool_(memAlgoPool)
+    , processPool_(processPool)
+    , numInputs_submitted_(0)
+  {}
+
+  /**
+   * @brief Add the inputs of one MEM computation, which is timed as the given phase
+   *
+   *        The phase (a string literal), the inputs, the MEM result and the integration statistics need to stay valid
+   *        until the receive method has been called.
+   */
+  void
+  add(const char * phase,
+      const std::vector<mem::MeasuredParticle> & measuredParticles,
+      double measuredMEtPx, double measuredMEtPy, const TMatrixD & measuredMEtCov,
+      T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    inputs_.push_back({ phase, &measuredParticles, measuredMEtPx, measuredMEtPy, &measuredMEtCov, &memResult, &memStats, false });
+  }
+
+  /// send the inputs added since the last call, for which the cache contains no result, to the process pool as one request
+  void
+  submit()
+  {
+    request_.clear();
+    for ( size_t idxInput = numInputs_submitted_; idxInput < inputs_.size(); ++idxInput ) {
+      inputType & input = inputs_[idxInput];
+      input.isSubmitted_ = !memAlgoPool_.lookup(*input.measuredParticles_, input.measuredMEtPx_, input.measuredMEtPy_, *input.measuredMEtCov_,
+        *input.memResult_, *input.memStats_);
+      if ( !input.isSubmitted_ ) continue;
+      request_.append(input.phase_, std::strlen(input.phase_) + 1);
+      mem_algo_pool::encodeInputs(*input.measuredParticles_, input.measuredMEtPx_, input.measuredMEtPy_, *input.measuredMEtCov_, request_);
+    }
+    if ( !request_.empty() ) {
+      tickets_.push_back({ processPool_.submit(request_), numInputs_submitted_, inputs_.size() });
+    }
+    numInputs_submitted_ = inputs_.size();
+  }
+
+  /// check if the results of all submitted inputs have been received, without waiting for them
+  bool
+  isReady()
+  {
+    for ( typename std::vector<ticketType>::const_iterator ticket = tickets_.begin();
+          ticket != tickets_.end(); ++ticket ) {
+      if ( !processPool_.isReady(ticket->ticket_) ) return false;
+    }
+    return true;
+  }
+
+  /// wait for the results of all submitted inputs and write them to the cache
+  void
+  receive()
+  {
+    for ( typename std::vector<ticketType>::const_iterator ticket = tickets_.begin();
+          ticket != tickets_.end(); ++ticket ) {
+      processPool_.get(ticket->ticket_, response_);
+      const char * data = response_.data();
+      const char * data_end = data + response_.size();
+      for ( size_t idxInput = ticket->idxInput_first_; idxInput < ticket->idxInput_last_; ++idxInput ) {
+        inputType & input = inputs_[idxInput];
+        if ( !input.isSubmitted_ ) continue;
+        if ( data + MEMbbwwResultCache::payloadSize > data_end )
+          throw cms::Exception("MEMbbwwIntegrationRequest")
+            << "Response contains fewer MEM results than requested !!\n";
+        MEMbbwwResultCache::decode(data, *input.memResult_, *input.memStats_);
+        memAlgoPool_.store(*input.measuredParticles_, input.measuredMEtPx_, input.measuredMEtPy_, *input.measuredMEtCov_,
+          *input.memResult_, *input.memStats_);
+      }
+    }
+    tickets_.clear();
+  }
+
+  /// remove all inputs, keeping the allocated memory for the next event
+  void
+  clear()
+  {
+    inputs_.clear();
+    tickets_.clear();
+    numInputs_submitted_ = 0;
+  }
+
+ private:
+  MEMbbwwIntegrationRequest(const MEMbbwwIntegrationRequest &) = delete;
+  MEMbbwwIntegrationRequest & operator=(const MEMbbwwIntegrationRequest &) = delete;
+
+  struct inputType
+  {
+    const char * phase_;
+    const std::vector<mem::MeasuredParticle> * measuredParticles_;
+    double measuredMEtPx_;
+    double measuredMEtPy_;
+    const TMatrixD * measuredMEtCov_;
+    T_result * memResult_;
+    MEMbbwwIntegrationStats * memStats_;
+    bool isSubmitted_; ///< flag indicating that the result is computed by a worker process (i.e. not taken from the cache)
+  };
+  struct ticketType
+  {
+    size_t ticket_;
+    size_t idxInput_first_; ///< range of inputs sent with the request
+    size_t idxInput_last_;
+  };
+
+  MEMbbwwAlgoPool<T> & memAlgoPool_;
+  MEMbbwwProcessPool & processPool_;
+  std::vector<inputType> inputs_;
+  size_t numInputs_submitted_;
+  std::vector<ticketType> tickets_;
+  std::string request_;
+  std::string response_;
+};
+
+typedef MEMbbwwAlgoPool<MEMbbwwAlgoDilepton> MEMbbwwAlgoPoolDilepton;
+typedef MEMbbwwAlgoPool<MEMbbwwAlgoSingleLepton> MEMbbwwAlgoPoolSingleLepton;
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwAlgoPool_h
@@ -0,0 +1,116 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwCheckpointManager_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwCheckpointManager_h
+
+#include <Rtypes.h> // Long64_t
+
+#include <fstream> // std::ofstream
+#include <string>  // std::string
+#include <vector>  // std::vector<>
+
+// forward declarations
+class TFile;
+
+/**
+ * @brief Position in the input files, event counters and timing totals at the time a checkpoint is written
+ *
+ *        The random numbers used for smearing and for choosing fake b-jets are computed from (seed, run, lumi, event, object index),
+ *        so no state of the random number generators needs to be stored.
+ */
+struct MEMbbwwCheckpointState
+{
+  MEMbbwwCheckpointState()
+    : nextEntry_(0)
+    , analyzedEntries_(0)
+    , selectedEntries_(0)
+    , selectedEntries_weighted_(0.)
+    , selEventsFileSize_(0)
+    , selEntryIndexFileSize_(0)
+  {}
+
+  Long64_t nextEntry_;              ///< index of first entry in the input files that has not been processed yet
+  Long64_t analyzedEntries_;
+  Long64_t selectedEntries_;        ///< number of events selected in at least one smearing variant
+  double selectedEntries_weighted_;
+  std::vector<Long64_t> selectedEntries_variant_;         ///< event counters of the individual smearing variants
+  std::vector<double> selectedEntries_weighted_variant_;
+  Long64_t selEventsFileSize_;      ///< size of text file with run:lumi:event numbers of selected events (in bytes)
+  Long64_t selEntryIndexFileSize_;  ///< size of index of entries that pass the generator-level selection (in bytes)
+  std::vector<std::string> timingPhases_;  ///< totals accumulated by the MEMbbwwTimingManager, one element per phase
+  std::vector<Long64_t> timingNumCalls_;
+  std::vector<double> timingWallTimes_;
+  std::vector<double> timingCpuTimes_;
+};
+
+/**
+ * @brief Write checkpoints to the output file of the analyzer and resume a pre-empted job from the last checkpoint
+ *
+ *        A checkpoint consists of all histograms and TTrees in the output file, written with TTree::AutoSave,
+ *        plus a directory "checkpoint" that stores the MEMbbwwCheckpointState.
+ *        When the job is resumed, the output file of the pre-empted job is renamed to outputFileName + ".checkpoint",
+ *        its histograms are added to and its TTree entries are copied into the freshly booked histograms and TTrees,
+ *        and the processing continues from the entry that follows the last checkpoint.
+ *        The checkpoint directory and file are removed at the end of a successful job.
+ */
+class MEMbbwwCheckpointManager
+{
+public:
+  /**
+   * @param checkpointInterval Number of selected events between checkpoints (no checkpoints are written if checkpointInterval <= 0)
+   * @param resume Flag indicating whether to resume from the last checkpoint (if a checkpoint exists)
+   *
+   *        In case resume is true, the constructor needs to be called before the output file is opened by the fwlite::TFileService
+   */
+  MEMbbwwCheckpointManager(const std::string & outputFileName, int checkpointInterval, bool resume);
+  ~MEMbbwwCheckpointManager();
+
+  /**
+   * @brief Return true if job is resumed from a checkpoint
+   */
+  bool isResumed() const;
+
+  /**
+   * @brief Return state stored in the checkpoint from which the job is resumed
+   */
+  const MEMbbwwCheckpointState & getState_resumed() const;
+
+  /**
+   * @brief Open text or binary output file,
+   *        truncating it to the size it had at the time of the checkpoint in case the job is resumed
+   */
+  std::ofstream * openOutputFile(const std::string & fileName, std::ios_base::openmode mode, Long64_t size_checkpoint) const;
+
+  /**
+   * @brief Add histograms and copy TTree entries stored in the checkpoint to the histograms and TTrees booked in the output file
+   *
+   *        Needs to be called after all histograms and TTrees have been booked and before the first event is processed.
+   */
+  void restore(TFile & outputFile) const;
+
+  /**
+   * @brief Return true if a checkpoint is due after given number of selected events
+   */
+  bool isDue(Long64_t selectedEntries) const;
+
+  /**
+   * @brief Write checkpoint.
+   *
+   *        The caller needs to make sure that the output of all events preceding state.nextEntry_ has been filled
+   *        into the histograms and TTrees.
+   */
+  void write(TFile & outputFile, const MEMbbwwCheckpointState & state);
+
+  /**
+   * @brief Remove checkpoint directory from output file and checkpoint file (to be called at the end of a successful job)
+   */
+  void finish(TFile & outputFile);
+
+protected:
+  std::string outputFileName_;
+  std::string checkpointFileName_;
+  int checkpointInterval_;
+  bool isResumed_;
+  MEMbbwwCheckpointState state_resumed_;
+  int numCheckpoints_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwCheckpointManager_h
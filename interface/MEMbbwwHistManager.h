@@ -6,13 +6,20 @@
 
 #include "hhAnalysis/bbwwMEM/interface/MEMResult.h" // MEMbbwwResultDilepton, MEMbbwwResultSingleLepton
 
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwIntegrationStats.h" // MEMbbwwIntegrationStats
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwHistogram1D.h" // MEMbbwwHistogram1D
+
 template <class T>
 class MEMbbwwHistManager
   : public HistManagerBase
 {
  public:
-  MEMbbwwHistManager(const edm::ParameterSet& cfg)
+  /**
+   * @param useSparseHistograms if true, the finely binned histograms are stored as THnSparse (see MEMbbwwHistogram1D)
+   */
+  MEMbbwwHistManager(const edm::ParameterSet& cfg, bool useSparseHistograms = false)
     : HistManagerBase(cfg)
+    , useSparseHistograms_(useSparseHistograms)
   {
     central_or_shiftOptions_["log_memProb_signal"] = { "central" };
     central_or_shiftOptions_["log_memProbErr_signal"] = { "central" };
@@ -22,6 +29,10 @@ class MEMbbwwHistManager
     central_or_shiftOptions_["log_memLR_div_Err"] = { "central" };
     central_or_shiftOptions_["memScore"] = { "*" };
     central_or_shiftOptions_["memCpuTime"] = { "central" };
+    central_or_shiftOptions_["memCpuTime_signal"] = { "central" };
+    central_or_shiftOptions_["memCpuTime_background"] = { "central" };
+    central_or_shiftOptions_["memNumCalls_signal"] = { "central" };
+    central_or_shiftOptions_["memNumCalls_background"] = { "central" };
     central_or_shiftOptions_["EventCounter"] = { "*" };
   }
   ~MEMbbwwHistManager() {}
@@ -30,20 +41,24 @@ class MEMbbwwHistManager
   void
   bookHistograms(TFileDirectory& dir) override
   {
-    histogram_log_memProb_signal_        = book1D(dir, "log_memProb_signal",        2000, -100., +100.);
-    histogram_log_memProbErr_signal_     = book1D(dir, "log_memProbErr_signal",     2000, -100., +100.);
-    histogram_log_memProb_background_    = book1D(dir, "log_memProb_background",    2000, -100., +100.);
-    histogram_log_memProbErr_background_ = book1D(dir, "log_memProbErr_background", 2000, -100., +100.);
-    histogram_memLR_                     = book1D(dir, "memLR",                     3600,    0.,    1.);
-    histogram_log_memLR_div_Err_         = book1D(dir, "log_memLR_div_Err",         2000,  -10.,  +10.);
-    histogram_memScore_                  = book1D(dir, "memScore",                  3600,  -18.,  +18.);
-    histogram_memCpuTime_                = book1D(dir, "memCpuTime",                1000,    0., 1000.);
+    bookHistogram1D(dir, histogram_log_memProb_signal_,         "log_memProb_signal",        2000, -100., +100.);
+    bookHistogram1D(dir, histogram_log_memProbErr_signal_,      "log_memProbErr_signal",     2000, -100., +100.);
+    bookHistogram1D(dir, histogram_log_memProb_background_,     "log_memProb_background",    2000, -100., +100.);
+    bookHistogram1D(dir, histogram_log_memProbErr_background_,  "log_memProbErr_background", 2000, -100., +100.);
+    bookHistogram1D(dir, histogram_memLR_,                      "memLR",                     3600,    0.,    1.);
+    bookHistogram1D(dir, histogram_log_memLR_div_Err_,          "log_memLR_div_Err",         2000,  -10.,  +10.);
+    bookHistogram1D(dir, histogram_memScore_,                   "memScore",                  3600,  -18.,  +18.);
+    bookHistogram1D(dir, histogram_memCpuTime_,                 "memCpuTime",                1000,    0., 1000.);
+    bookHistogram1D(dir, histogram_memCpuTime_signal_,          "memCpuTime_signal",         1000,    0., 1000.);
+    bookHistogram1D(dir, histogram_memCpuTime_background_,      "memCpuTime_background",     1000,    0., 1000.);
+    bookHistogram1D(dir, histogram_memNumCalls_signal_,         "memNumCalls_signal",        1000,    0., 1.e+5);
+    bookHistogram1D(dir, histogram_memNumCalls_background_,     "memNumCalls_background",    1000,    0., 1.e+6);
 
     histogram_EventCounter_              = book1D(dir, "EventCounter",                 1,   -0.5,  +0.5);
   }
 
   void
-  fillHistograms(const T& memResult, double memCpuTime, double evtWeight)
+  fillHistograms(const T& memResult, const MEMbbwwIntegrationStats& memStats, double evtWeight)
   {
     const double evtWeightErr = 0.;
 
@@ -57,7 +72,11 @@ class MEMbbwwHistManager
       fillWithOverFlow_logx(histogram_log_memLR_div_Err_,       memLR_div_Err,                     evtWeight, evtWeightErr);  
     }
     fillWithOverFlow(histogram_memScore_,                       memResult.getScore(),              evtWeight, evtWeightErr);  
-    fillWithOverFlow(histogram_memCpuTime_,                     memCpuTime,                        evtWeight, evtWeightErr);            
+    fillWithOverFlow(histogram_memCpuTime_,                     memStats.cpuTime_,                 evtWeight, evtWeightErr);            
+    fillWithOverFlow(histogram_memCpuTime_signal_,              memStats.cpuTime_signal_,          evtWeight, evtWeightErr);
+    fillWithOverFlow(histogram_memCpuTime_background_,          memStats.cpuTime_background_,      evtWeight, evtWeightErr);
+    fillWithOverFlow(histogram_memNumCalls_signal_,             memStats.numCalls_signal_,         evtWeight, evtWeightErr);
+    fillWithOverFlow(histogram_memNumCalls_background_,         memStats.numCalls_background_,     evtWeight, evtWeightErr);
 
     fillWithOverFlow(histogram_EventCounter_,                   0.,                                evtWeight, evtWeightErr);
   }
@@ -69,20 +88,40 @@ class MEMbbwwHistManager
   }
 
  private:
-  void fillWithOverFlow_logx(TH1* histogram, double x, double evtWeight, double evtWeightErr = 0.)
+  void bookHistogram1D(TFileDirectory& dir, MEMbbwwHistogram1D& histogram, const std::string& distribution, int numBinsX, double xMin, double xMax)
+  {
+    histogram.book(book1D(dir, distribution, numBinsX, xMin, xMax), useSparseHistograms_);
+  }
+
+  void fillWithOverFlow(MEMbbwwHistogram1D& histogram, double x, double evtWeight, double evtWeightErr = 0.)
+  {
+    histogram.fillWithOverFlow(x, evtWeight, evtWeightErr);
+  }
+  void fillWithOverFlow(TH1* histogram, double x, double evtWeight, double evtWeightErr = 0.)
+  {
+    ::fillWithOverFlow(histogram, x, evtWeight, evtWeightErr);
+  }
+
+  void fillWithOverFlow_logx(MEMbbwwHistogram1D& histogram, double x, double evtWeight, double evtWeightErr = 0.)
   {    
     const double nonzero = 1.e-30;
     fillWithOverFlow(histogram, TMath::Log(TMath::Max(nonzero, x)), evtWeight, evtWeightErr);
   }
 
-  TH1* histogram_log_memProb_signal_;
-  TH1* histogram_log_memProbErr_signal_;
-  TH1* histogram_log_memProb_background_;
-  TH1* histogram_log_memProbErr_background_;
-  TH1* histogram_memLR_;
-  TH1* histogram_log_memLR_div_Err_;
-  TH1* histogram_memScore_;
-  TH1* histogram_memCpuTime_;
+  bool useSparseHistograms_;
+
+  MEMbbwwHistogram1D histogram_log_memProb_signal_;
+  MEMbbwwHistogram1D histogram_log_memProbErr_signal_;
+  MEMbbwwHistogram1D histogram_log_memProb_background_;
+  MEMbbwwHistogram1D histogram_log_memProbErr_background_;
+  MEMbbwwHistogram1D histogram_memLR_;
+  MEMbbwwHistogram1D histogram_log_memLR_div_Err_;
+  MEMbbwwHistogram1D histogram_memScore_;
+  MEMbbwwHistogram1D histogram_memCpuTime_;
+  MEMbbwwHistogram1D histogram_memCpuTime_signal_;
+  MEMbbwwHistogram1D histogram_memCpuTime_background_;
+  MEMbbwwHistogram1D histogram_memNumCalls_signal_;
+  MEMbbwwHistogram1D histogram_memNumCalls_background_;
 
   TH1* histogram_EventCounter_;
 };
@@ -0,0 +1,45 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogram1D_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogram1D_h
+
+#include <memory> // std::unique_ptr
+
+class TH1;
+class THnSparse;
+
+/**
+ * @brief One-dimensional histogram, stored either as TH1 or as one-dimensional THnSparse.
+ *
+ *        A THnSparse allocates memory only for bins that get filled,
+ *        which reduces the memory used by each job, the size of the output files and the time needed by hadd
+ *        for histograms with a fine binning of which most bins stay empty (e.g. memLR, memScore).
+ *        The THnSparse has the same name and binning as the TH1 it replaces and is converted to TH1 by the plotting macros,
+ *        using THnSparse::Projection.
+ */
+class MEMbbwwHistogram1D
+{
+public:
+  MEMbbwwHistogram1D();
+  ~MEMbbwwHistogram1D();
+
+  /**
+   * @brief Take over histogram booked by HistManagerBase::book1D
+   *
+   *        If useSparseHistogram is true, the TH1 is replaced in its directory by a THnSparse with the same name and binning
+   *        and the TH1 is reduced to a single bin, to release its memory.
+   *        The THnSparse is owned by the directory, like the histograms booked by HistManagerBase,
+   *        while the TH1 removed from the directory is owned by this object.
+   */
+  void book(TH1 * histogram, bool useSparseHistogram);
+
+  /**
+   * @brief Fill histogram, adding values outside of the histogram range to the first or last bin (as fillWithOverFlow for TH1)
+   */
+  void fillWithOverFlow(double x, double evtWeight, double evtWeightErr = 0.);
+
+private:
+  TH1 * histogram_;
+  THnSparse * histogram_sparse_;
+  std::unique_ptr<TH1> histogram_detached_; ///< TH1 replaced by the THnSparse in its directory
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogram1D_h
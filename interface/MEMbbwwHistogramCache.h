@@ -0,0 +1,60 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogramCache_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogramCache_h
+
+#include <map>     // std::map<>
+#include <string>  // std::string
+#include <tuple>   // std::tuple<>
+#include <utility> // std::pair<>
+
+class TFile;
+class TH1;
+
+/**
+ * @brief Cache for the histograms shown in the MEM performance plots
+ *
+ *        Each input file is opened once and kept open until the cache is deleted.
+ *        Each histogram is read from its file, converted from THnSparse to TH1 (if needed) and normalized to unit area once,
+ *        when it is requested for the first time, and is then returned from the cache by all following requests
+ *        for the same (file, directory, name).
+ *        Rebinned copies of histograms are made when they are requested for the first time and are cached as well.
+ *
+ *        All histograms returned by the cache are owned by the cache and must not be modified or deleted by the caller.
+ */
+class MEMbbwwHistogramCache
+{
+public:
+  MEMbbwwHistogramCache();
+  ~MEMbbwwHistogramCache();
+
+  /**
+   * @brief Return histogram normalized to unit area (excluding underflow and overflow bins)
+   */
+  TH1 *
+  getHistogram(const std::string & inputFileName, const std::string & directory, const std::string & histogramName);
+
+  /**
+   * @brief Return copy of histogram rebinned to numBinsX bins
+   *        (the histogram is not rebinned if numBinsX is not a divisor of the number of bins, as in rebinHistogram)
+   *
+   *        The rebinned copies are cached per (histogram, numBinsX). The histogram must stay in memory as long as the cache.
+   */
+  const TH1 *
+  getHistogram_rebinned(const TH1 * histogram, int numBinsX);
+
+  /// number of histograms read from input files and number of requests served from the cache
+  unsigned long numMisses() const;
+  unsigned long numHits() const;
+
+private:
+  TFile *
+  getFile(const std::string & inputFileName);
+
+  std::map<std::string, TFile *> inputFiles_; // key = inputFileName
+  std::map<std::tuple<std::string, std::string, std::string>, TH1 *> histograms_; // key = inputFileName, directory, histogramName
+  std::map<std::pair<const TH1 *, int>, TH1 *> histograms_rebinned_; // key = histogram, numBinsX
+
+  unsigned long numMisses_;
+  unsigned long numHits_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwHistogramCache_h
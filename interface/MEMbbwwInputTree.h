@@ -0,0 +1,95 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwInputTree_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwInputTree_h
+
+#include <Rtypes.h> // Long64_t
+
+#include <string> // std::string
+#include <vector> // std::vector<>
+
+// forward declarations
+class TFile;
+class TTree;
+class ReaderBase;
+
+/**
+ * @brief Chain of input TTrees that are read through the readers of the tthAnalysis/HiggsToTauTau package,
+ *        restricted to the range [firstEntry, maxEventCount) of entries counted over all input files
+ *
+ *        Provides the part of the TTreeWrapper interface used by the analyzers, plus the setFirstEntry method:
+ *        input files that contain only entries preceding firstEntry are not opened for reading any entry,
+ *        and within the file that contains firstEntry the reading starts directly at that entry,
+ *        so that jobs processing a range of entries far into the input files do not read the preceding entries.
+ *        Only branches to which one of the readers has bound an address are read.
+ */
+class MEMbbwwInputTree
+{
+ public:
+  /**
+   * @param maxEventCount Only entries with index < maxEventCount are read (all entries are read if maxEventCount < 0)
+   */
+  MEMbbwwInputTree(const std::string & treeName, const std::vector<std::string> & fileNames, Long64_t maxEventCount = -1);
+  ~MEMbbwwInputTree();
+
+  void
+  registerReader(ReaderBase * reader);
+
+  /**
+   * @brief Start reading at the entry with the given index (counted over all input files);
+   *        needs to be called before the first call to hasNextEvent
+   */
+  void
+  setFirstEntry(Long64_t firstEntry);
+
+  /**
+   * @brief Read next entry
+   * @return false if there are no more entries in the range
+   */
+  bool
+  hasNextEvent();
+
+  /// number of input files, and number of input files opened so far
+  int
+  getFileCount() const;
+  int
+  getProcessedFileCount() const;
+
+  /// index of the current entry, counted over all input files and within the current input file
+  Long64_t
+  getCurrentMaxEventIdx() const;
+  Long64_t
+  getCurrentEventIdx() const;
+
+  /// number of entries read so far
+  Long64_t
+  getCumulativeMaxEventCount() const;
+
+  std::string
+  getCurrentFileName() const;
+  bool
+  isOpen() const;
+  bool
+  canReport(unsigned reportEvery) const;
+
+ private:
+  /// open next input file, skipping files that contain only entries preceding firstEntry
+  bool
+  openNextFile();
+  void
+  closeFile();
+
+  std::string treeName_;
+  std::vector<std::string> fileNames_;
+  Long64_t maxEventCount_;
+  Long64_t firstEntry_;
+  std::vector<ReaderBase *> readers_;
+
+  TFile * currentFile_;
+  TTree * currentTree_;
+  int numFilesProcessed_;     ///< number of input files opened so far (the current file is fileNames_[numFilesProcessed_ - 1])
+  Long64_t currentFileOffset_; ///< number of entries contained in the input files preceding the current file
+  Long64_t currentFileEntries_;
+  Long64_t currentEventIdx_;  ///< index of the current entry within the current input file
+  Long64_t numEventsRead_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwInputTree_h
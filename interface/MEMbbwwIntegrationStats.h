@@ -0,0 +1,30 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwIntegrationStats_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwIntegrationStats_h
+
+/**
+ * @brief CPU time and number of integrand evaluations spent on the MEM computation for one event
+ *
+ *        Signal and background hypotheses are integrated in separate calls to the MEM algorithm (see MEMbbwwAlgoPool::integrate).
+ */
+struct MEMbbwwIntegrationStats
+{
+  MEMbbwwIntegrationStats()
+    : cpuTime_(-1.)
+    , cpuTime_signal_(-1.)
+    , cpuTime_background_(-1.)
+    , numCalls_signal_(0)
+    , numCalls_background_(0)
+    , numIntegrations_(0)
+    , fromCache_(false)
+  {}
+
+  double cpuTime_;            ///< CPU time spent on signal and background integration, including the discarded integrations (in units of seconds)
+  double cpuTime_signal_;     ///< CPU time spent on the integration of the signal hypothesis, summed over all iterations of the adaptive integration
+  double cpuTime_background_; ///< CPU time spent on the integration of the background hypothesis
+  int numCalls_signal_;       ///< number of integrand evaluations used for the signal hypothesis, summed over all iterations of the adaptive integration
+  int numCalls_background_;   ///< number of integrand evaluations used for the background hypothesis
+  int numIntegrations_;       ///< number of calls to the integrate method of the MEM algorithm (> 1 in case of adaptive integration)
+  bool fromCache_;            ///< flag indicating that the MEM result was read from the MEMbbwwResultCache (the other quantities then refer to the original integration)
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwIntegrationStats_h
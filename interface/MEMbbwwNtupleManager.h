@@ -2,17 +2,95 @@
 #define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleManager_h
 
 #include "CommonTools/Utils/interface/TFileDirectory.h"                // TFileDirectory
+#include "FWCore/ParameterSet/interface/ParameterSet.h"                // edm::ParameterSet
 #include "DataFormats/Math/interface/deltaR.h"                         // deltaR
+#include "DataFormats/Math/interface/LorentzVector.h"                  // math::PtEtaPhiMLorentzVector
 
-#include "tthAnalysis/HiggsToTauTau/interface/EventInfo.h"             // EventInfo
-#include "tthAnalysis/HiggsToTauTau/interface/GenJet.h"                // GenJet
-#include "tthAnalysis/HiggsToTauTau/interface/GenLepton.h"             // GenLepton
-#include "tthAnalysis/HiggsToTauTau/interface/TypeTraits.h"            // Traits<>
-
-#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent.h"   // MEMEvent
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent.h"            // MEMEvent, MEMEventParticle, MEMEventMEtCov
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwNtupleSchema.h" // MEMbbwwNtupleBranches, MEMBBWW_NTUPLE_DEFINE_READ
 
 #include <TTree.h>                                                     // TTree
-#include <TMatrixD.h>                                                  // TMatrixD
+
+#include <vector>                                                      // std::vector<>
+
+/**
+ * @brief Compression, basket size, auto-flush and encoding settings of the MEM ntuples
+ */
+struct MEMbbwwNtupleWriteOptions
+{
+  MEMbbwwNtupleWriteOptions();
+  MEMbbwwNtupleWriteOptions(const edm::ParameterSet & cfg);
+
+  /**
+   * @brief Encoding of the MEM probabilities, their uncertainties and the likelihood ratio:
+   *
+   *         kDouble:   Double_t
+   *         kDouble32: likelihood ratio and its uncertainty as Double32_t with mantissa truncated to memResultMantissaBits_,
+   *                    probabilities and their uncertainties as Double_t
+   *                    (NOTE: the exponent of Double32_t values is stored with the range of a Float_t, so values below 1.2e-38 are stored as 0,
+   *                     which would distort the log-probability histograms and the likelihood ratio recomputed from the probabilities by the macros)
+   *         kLogFloat: natural logarithm stored as Float_t, in the branches memLogProbS, memLogProbSerr, memLogProbB, memLogProbBerr, memLogLR and memLogLRerr
+   *
+   *        The macros read all encodings via MEMbbwwNtupleMEMResultReader.
+   */
+  enum MEMResultEncoding { kDouble, kDouble32, kLogFloat };
+
+  int compressionSettings_; ///< 100*algorithm + level, as defined by ROOT (-1: use compression settings of the output file)
+  int basketSize_;          ///< basket size of each branch, in units of bytes (<= 0: ROOT default)
+  Long64_t autoFlush_;      ///< cluster size of the TTree: number of entries (> 0) or number of bytes (< 0) after which the baskets are flushed (0: ROOT default)
+  MEMResultEncoding memResultEncoding_;
+  unsigned memResultMantissaBits_; ///< number of mantissa bits kept by the kDouble32 encoding
+};
+
+/**
+ * @brief Objects from which the groups of branches are read (see the accessors in MEMbbwwNtupleSchema.h)
+ */
+struct MEMbbwwNtupleParticle
+{
+  MEMbbwwNtupleParticle(const MEMEventParticle & particle, bool isGenMatched = false)
+    : particle_(particle)
+    , isGenMatched_(isGenMatched)
+  {}
+  const MEMEventParticle & particle_;
+  bool isGenMatched_;
+};
+
+struct MEMbbwwNtupleMEt
+{
+  MEMbbwwNtupleMEt(double px, double py, const MEMEventMEtCov & cov = MEMEventMEtCov())
+    : px_(px)
+    , py_(py)
+    , cov_(cov)
+  {}
+  double px_;
+  double py_;
+  MEMEventMEtCov cov_;
+};
+
+struct MEMbbwwNtupleKinematics
+{
+  MEMbbwwNtupleKinematics(const math::PtEtaPhiMLorentzVector & p4_1, const math::PtEtaPhiMLorentzVector & p4_2,
+                          const math::PtEtaPhiMLorentzVector & p4_3 = math::PtEtaPhiMLorentzVector(), double metPx = 0., double metPy = 0.);
+  math::PtEtaPhiMLorentzVector p4_1_;
+  math::PtEtaPhiMLorentzVector p4_2_;
+  math::PtEtaPhiMLorentzVector p4_3_;
+  math::PtEtaPhiMLorentzVector metP4_;
+};
+
+/**
+ * @brief PDG id of measured electron or muon, determined from its type and charge
+ */
+int getMeasuredLeptonPdgId(const MEMEventParticle & lepton);
+
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleEventRow,          MEMBBWW_NTUPLE_EVENT_COLUMNS,          MEMEvent)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleMEMResultRow,      MEMBBWW_NTUPLE_MEMRESULT_COLUMNS,      MEMEventResult)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleMEMLogResultRow,   MEMBBWW_NTUPLE_MEMLOGRESULT_COLUMNS,   MEMEventResult)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleGenJetRow,         MEMBBWW_NTUPLE_GENJET_COLUMNS,         MEMbbwwNtupleParticle)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleMeasuredJetRow,    MEMBBWW_NTUPLE_MEASUREDJET_COLUMNS,    MEMbbwwNtupleParticle)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleGenLeptonRow,      MEMBBWW_NTUPLE_GENLEPTON_COLUMNS,      MEMbbwwNtupleParticle)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleMeasuredLeptonRow, MEMBBWW_NTUPLE_MEASUREDLEPTON_COLUMNS, MEMbbwwNtupleParticle)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleMEtRow,            MEMBBWW_NTUPLE_MET_COLUMNS,            MEMbbwwNtupleMEt)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleHbbRow,            MEMBBWW_NTUPLE_HBB_COLUMNS,            MEMbbwwNtupleKinematics)
 
 class MEMbbwwNtupleManager
 {
@@ -22,242 +100,56 @@ public:
 
   void makeTree(TFileDirectory & dir);
 
-  virtual void initializeBranches();
+  /**
+   * @brief Create the branches of all groups registered in branchGroups_, using the encoding of the MEM result given by the options,
+   *        and apply the compression, basket size and auto-flush settings
+   */
+  void initializeBranches(const MEMbbwwNtupleWriteOptions & options = MEMbbwwNtupleWriteOptions());
+
   virtual void read(const MEMEvent & memEvent);
   void fill();
-  virtual void resetBranches();
+
+  void resetBranches();
 
 protected:
+  /**
+   * @brief Apply compression, basket size and auto-flush settings to the branches
+   */
+  void setWriteOptions(const MEMbbwwNtupleWriteOptions & options);
+
+  /**
+   * @brief Read group of particle branches, in case the particle exists (the branches keep their reset values otherwise)
+   */
+  template <typename T_row>
+  static void readParticle(MEMbbwwNtupleBranches<T_row> & branches, const MEMEventParticle & particle, bool isGenMatched = false)
+  {
+    if ( particle.isValid() )
+    {
+      branches.read(MEMbbwwNtupleParticle(particle, isGenMatched));
+    }
+  }
 
   std::string outputDirectoryName_;
   std::string outputTreeName_;
   TTree* tree_;
 
-  UInt_t run_;
-  UInt_t ls_;
-  ULong64_t event_;
-
-  Float_t genWeight_;
-
-  Bool_t isSignal_;
-
-  Int_t nbjets_loose_;
-  Int_t nbjets_medium_;
+  std::vector<MEMbbwwNtupleBranchGroup *> branchGroups_; ///< all groups of branches, in the order in which the branches are created
 
-  Double_t memProbS_;
-  Double_t memProbSerr_;
-  Double_t memProbB_;
-  Double_t memProbBerr_;
-  Double_t memLR_;
-  Double_t memLRerr_;
-  Float_t  memCpuTime_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleEventRow> event_;
 
-  struct genJetBranches
-  {
-    genJetBranches(const std::string & branchName)
-      : branchName_(branchName)
-    {
-      resetBranches();
-    }
-    virtual ~genJetBranches()
-    {}
-    virtual void initializeBranches(TTree * tree)
-    {
-      tree->Branch(Form("%s_pt",   branchName_.c_str()), &pt_,   Form("%s_pt/%s",   branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_eta",  branchName_.c_str()), &eta_,  Form("%s_eta/%s",  branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_phi",  branchName_.c_str()), &phi_,  Form("%s_phi/%s",  branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_mass", branchName_.c_str()), &mass_, Form("%s_mass/%s", branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-    }
-    virtual void resetBranches()
-    {
-      pt_   = 0.;
-      eta_  = 0.;
-      phi_  = 0.;
-      mass_ = 0.;
-    }
-    virtual void read(const GenJet * jet)
-    {
-      if ( jet )
-      {
-        pt_   = jet->p4().pt();
-        eta_  = jet->p4().eta();
-        phi_  = jet->p4().phi();
-        mass_ = jet->p4().mass();
-      }
-    }
-    std::string branchName_;
-    Float_t pt_;
-    Float_t eta_;
-    Float_t phi_;
-    Float_t mass_;
-  };
-  struct measuredJetBranches : public genJetBranches
-  {
-    measuredJetBranches(const std::string & branchName)
-      : genJetBranches(branchName)
-    {
-      resetBranches();
-    }
-    ~measuredJetBranches()
-    {}
-    void initializeBranches(TTree * tree)
-    {
-      genJetBranches::initializeBranches(tree);
-      tree->Branch(Form("%s_isGenMatched", branchName_.c_str()), &isGenMatched_, Form("%s_isGenMatched/%s", branchName_.c_str(), Traits<Bool_t>::TYPE_NAME));
-    }
-    void resetBranches()
-    {
-      genJetBranches::resetBranches();
-      isGenMatched_ = false;
-    }
-    void read(const mem::MeasuredParticle * jet, bool isGenMatched)
-    {
-      if ( jet )
-      {
-        pt_           = jet->pt();
-        eta_          = jet->eta();
-        phi_          = jet->phi();
-        mass_         = jet->mass();
-        isGenMatched_ = isGenMatched;
-      }
-    }
-    bool isGenMatched_;
-  };
-
-  measuredJetBranches bjet1_;
-  measuredJetBranches bjet2_;
-  Int_t nbjets_;
-  genJetBranches gen_bjet1_;
-  genJetBranches gen_bjet2_;
-  Int_t gen_nbjets_;
-
-  struct genLeptonBranches
-  {
-    genLeptonBranches(const std::string & branchName)
-      : branchName_(branchName)
-    {
-      resetBranches();
-    }
-    virtual ~genLeptonBranches()
-    {}
-    virtual void initializeBranches(TTree * tree)
-    {
-      tree->Branch(Form("%s_pt",    branchName_.c_str()), &pt_,    Form("%s_pt/%s",    branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_eta",   branchName_.c_str()), &eta_,   Form("%s_eta/%s",   branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_phi",   branchName_.c_str()), &phi_,   Form("%s_phi/%s",   branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_pdgId", branchName_.c_str()), &pdgId_, Form("%s_pdgId/%s", branchName_.c_str(), Traits<Int_t>::TYPE_NAME));
-    }
-    virtual void resetBranches()
-    {
-      pt_    = 0.;
-      eta_   = 0.;
-      phi_   = 0.;
-      pdgId_ = 0;
-    }
-    virtual void read(const GenLepton * lepton)
-    {
-      if ( lepton )
-      {
-        pt_    = lepton->p4().pt();
-        eta_   = lepton->p4().eta();
-        phi_   = lepton->p4().phi();
-        pdgId_ = lepton->pdgId();
-      }
-    }
-    std::string branchName_;
-    Float_t pt_;
-    Float_t eta_;
-    Float_t phi_;
-    Int_t pdgId_;
-  };
-  struct measuredLeptonBranches : public genLeptonBranches
-  {
-    measuredLeptonBranches(const std::string & branchName)
-      : genLeptonBranches(branchName)
-    {
-      resetBranches();
-    }
-    ~measuredLeptonBranches()
-    {}
-    void initializeBranches(TTree * tree)
-    {
-      genLeptonBranches::initializeBranches(tree);
-      tree->Branch(Form("%s_isGenMatched", branchName_.c_str()), &isGenMatched_, Form("%s_isGenMatched/%s", branchName_.c_str(), Traits<Bool_t>::TYPE_NAME));
-    }
-    void resetBranches()
-    {
-      genLeptonBranches::resetBranches();
-      isGenMatched_ = false;
-    }
-    void read(const mem::MeasuredParticle * lepton, bool isGenMatched)
-    {
-      if ( lepton )
-      {
-        pt_  = lepton->pt();
-        eta_ = lepton->eta();
-        phi_ = lepton->phi();
-        if      ( lepton->type() == mem::MeasuredParticle::kElectron && lepton->charge() < 0 ) pdgId_ = +11;
-        else if ( lepton->type() == mem::MeasuredParticle::kElectron && lepton->charge() > 0 ) pdgId_ = -11;
-        else if ( lepton->type() == mem::MeasuredParticle::kMuon     && lepton->charge() < 0 ) pdgId_ = +13;
-        else if ( lepton->type() == mem::MeasuredParticle::kMuon     && lepton->charge() > 0 ) pdgId_ = -13;
-        else assert(0);
-        isGenMatched_ = isGenMatched;
-      }
-    }
-    bool isGenMatched_;
-  };
-
-  struct metBranches
-  {
-    metBranches(const std::string & branchName)
-      : branchName_(branchName)
-    {}
-    ~metBranches()
-    {}
-    void initializeBranches(TTree * tree)
-    {
-      tree->Branch(Form("%s_px",    branchName_.c_str()), &px_,    Form("%s_px/%s",    branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_py",    branchName_.c_str()), &py_,    Form("%s_py/%s",    branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_cov00", branchName_.c_str()), &cov00_, Form("%s_cov00/%s", branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_cov01", branchName_.c_str()), &cov01_, Form("%s_cov01/%s", branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-      tree->Branch(Form("%s_cov11", branchName_.c_str()), &cov11_, Form("%s_cov11/%s", branchName_.c_str(), Traits<Float_t>::TYPE_NAME));
-    }
-    void resetBranches()
-    {
-      px_    = 0.;
-      py_    = 0.;
-      cov00_ = 0.;
-      cov01_ = 0.;
-      cov11_ = 0.;
-    }
-    void read(double metPx, double metPy, const TMatrixD * metCov = nullptr)
-    {
-      px_    = metPx;
-      py_    = metPy;
-      if ( metCov )
-      {
-        cov00_ = metCov->operator()(0, 0);
-        cov01_ = metCov->operator()(0, 1);
-        cov11_ = metCov->operator()(1, 1);
-      }
-    }
-    std::string branchName_;
-    Float_t px_;
-    Float_t py_;
-    Float_t cov00_;
-    Float_t cov01_;
-    Float_t cov11_;
-  };
+  MEMbbwwNtupleWriteOptions::MEMResultEncoding memResultEncoding_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEMResultRow> memResult_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEMLogResultRow> memLogResult_;
 
-  metBranches met_;
-  metBranches gen_met_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> bjet1_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> bjet2_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleGenJetRow> gen_bjet1_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleGenJetRow> gen_bjet2_;
 
-  int barcode_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEtRow> met_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEtRow> gen_met_;
 
-  // CV: define auxiliary variables for BDT regression training
-  Float_t ptbb_;
-  Float_t drbb_;
-  Float_t mbb_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleHbbRow> hbb_;
 };
 
 #endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleManager_h
@@ -4,37 +4,33 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwNtupleManager.h"  // MEMbbwwNtupleManager
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent_singlelepton.h" // MEMEvent_singlelepton
 
+#include "tthAnalysis/HiggsToTauTau/interface/mvaInputVariables.h" // comp_MT_met
+
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleEventRow_singlelepton, MEMBBWW_NTUPLE_EVENT_COLUMNS_SINGLELEPTON, MEMEvent_singlelepton)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleHadWRow_singlelepton,  MEMBBWW_NTUPLE_HADW_COLUMNS_SINGLELEPTON,  MEMbbwwNtupleKinematics)
+MEMBBWW_NTUPLE_DEFINE_READ(MEMbbwwNtupleHwwRow_singlelepton,   MEMBBWW_NTUPLE_HWW_COLUMNS_SINGLELEPTON,   MEMbbwwNtupleKinematics)
+
 class MEMbbwwNtupleManager_singlelepton : public MEMbbwwNtupleManager
 {
  public:
   MEMbbwwNtupleManager_singlelepton(const std::string & outputDirectoryName, const std::string & outputTreeName);
   ~MEMbbwwNtupleManager_singlelepton();
 
-  void initializeBranches();
   void read(const MEMEvent_singlelepton & memEvent);
-  void resetBranches();
 
  protected:
-  measuredJetBranches wjet1_;
-  measuredJetBranches wjet2_;
-  Int_t nwjets_;
-  genJetBranches gen_wjet1_;
-  genJetBranches gen_wjet2_;
-  Int_t gen_nwjets_;
-
-  measuredLeptonBranches lepton_;
-  Int_t nleptons_;
-  genLeptonBranches gen_lepton_;
-  Int_t gen_nleptons_;
-
-  // CV: define auxiliary variables for BDT regression training
-  Float_t ptjj_;
-  Float_t drjj_;
-  Float_t mjj_;
-  Float_t ptww_;
-  Float_t mww_;
-  Float_t mt_;
-  Float_t ptmiss_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleEventRow_singlelepton> event_singlelepton_;
+
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> wjet1_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredJetRow> wjet2_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleGenJetRow> gen_wjet1_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleGenJetRow> gen_wjet2_;
+
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMeasuredLeptonRow> lepton_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleGenLeptonRow> gen_lepton_;
+
+  MEMbbwwNtupleBranches<MEMbbwwNtupleHadWRow_singlelepton> hadW_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleHwwRow_singlelepton> hww_;
 };
 
 #endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleManager_singlelepton_h
@@ -0,0 +1,406 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleSchema_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleSchema_h
+
+#include <Rtypes.h> // Float_t, Double_t, Int_t, UInt_t, ULong64_t, Bool_t
+#include <TTree.h>  // TTree, TBranch
+
+#include <cstddef> // offsetof, size_t
+#include <cstring> // std::memcpy
+#include <limits>  // std::numeric_limits<>
+#include <string>  // std::string
+#include <vector>  // std::vector<>
+#include <assert.h> // assert
+#include <math.h>   // log, exp
+
+/**
+ * @brief Declarative schema of the branches written to the MEM ntuples
+ *
+ *        The branches are organized in groups. The columns of each group are declared once, in a list of entries
+ *
+ *          COLUMN(name, type, resetValue, accessor)
+ *
+ *        From this list MEMBBWW_NTUPLE_ROW generates a plain struct with one data member per branch,
+ *        the table of branch names, ROOT leaf types and offsets, and the reset values,
+ *        while MEMBBWW_NTUPLE_DEFINE_READ generates a function readRow that sets the data members by evaluating the accessors
+ *        for the object "src" from which the group is read.
+ *        The branches are created (when writing the ntuples) or attached (when reading the ntuples) by MEMbbwwNtupleBranches.
+ *
+ *        The header depends on ROOT only, so that it can be included in the macros.
+ *        The accessors are only expanded by MEMBBWW_NTUPLE_DEFINE_READ, which is used by the ntuple managers, not by the macros.
+ */
+
+template <typename T>
+struct MEMbbwwNtupleLeafType;
+
+template <> struct MEMbbwwNtupleLeafType<Float_t>   { static constexpr char TYPE_NAME = 'F'; };
+template <> struct MEMbbwwNtupleLeafType<Double_t>  { static constexpr char TYPE_NAME = 'D'; };
+template <> struct MEMbbwwNtupleLeafType<Int_t>     { static constexpr char TYPE_NAME = 'I'; };
+template <> struct MEMbbwwNtupleLeafType<UInt_t>    { static constexpr char TYPE_NAME = 'i'; };
+template <> struct MEMbbwwNtupleLeafType<ULong64_t> { static constexpr char TYPE_NAME = 'l'; };
+template <> struct MEMbbwwNtupleLeafType<Bool_t>    { static constexpr char TYPE_NAME = 'O'; };
+
+struct MEMbbwwNtupleColumn
+{
+  const char * name_;   ///< branch name, without the prefix of the group
+  char         type_;   ///< ROOT leaf type
+  size_t       offset_; ///< offset of the data member within the row struct
+};
+
+#define MEMBBWW_NTUPLE_DECLARE_FIELD(name, type, resetValue, accessor) type name;
+#define MEMBBWW_NTUPLE_RESET_VALUE(name, type, resetValue, accessor) resetValue,
+#define MEMBBWW_NTUPLE_COLUMN(name, type, resetValue, accessor) { #name, MEMbbwwNtupleLeafType<type>::TYPE_NAME, offsetof(row_type, name) },
+#define MEMBBWW_NTUPLE_READ_FIELD(name, type, resetValue, accessor) row.name = accessor;
+
+#define MEMBBWW_NTUPLE_ROW(ROW, COLUMNS)                                                               \
+  struct ROW                                                                                           \
+  {                                                                                                    \
+    typedef ROW row_type;                                                                              \
+    COLUMNS(MEMBBWW_NTUPLE_DECLARE_FIELD)                                                              \
+    static const ROW & defaults()                                                                      \
+    {                                                                                                  \
+      static const ROW defaults_ = { COLUMNS(MEMBBWW_NTUPLE_RESET_VALUE) };                            \
+      return defaults_;                                                                                \
+    }                                                                                                  \
+    static const std::vector<MEMbbwwNtupleColumn> & columns()                                          \
+    {                                                                                                  \
+      static const std::vector<MEMbbwwNtupleColumn> columns_ = { COLUMNS(MEMBBWW_NTUPLE_COLUMN) };     \
+      return columns_;                                                                                 \
+    }                                                                                                  \
+  }
+
+#define MEMBBWW_NTUPLE_DEFINE_READ(ROW, COLUMNS, SOURCE)                                               \
+  inline void                                                                                          \
+  readRow(ROW & row, const SOURCE & src)                                                               \
+  {                                                                                                    \
+    COLUMNS(MEMBBWW_NTUPLE_READ_FIELD)                                                                 \
+  }
+
+/**
+ * @brief Branches of one group, operating on the column table of the row struct
+ */
+class MEMbbwwNtupleBranchGroup
+{
+ public:
+  MEMbbwwNtupleBranchGroup(const std::string & prefix, const std::vector<MEMbbwwNtupleColumn> & columns,
+                           void * row, const void * defaults, size_t rowSize)
+    : prefix_(prefix)
+    , columns_(columns)
+    , row_(static_cast<char *>(row))
+    , defaults_(defaults)
+    , rowSize_(rowSize)
+    , leafTypes_(columns.size())
+  {}
+  MEMbbwwNtupleBranchGroup(const MEMbbwwNtupleBranchGroup &) = delete;
+  MEMbbwwNtupleBranchGroup & operator=(const MEMbbwwNtupleBranchGroup &) = delete;
+
+  /**
+   * @brief Store all columns of the group with the given ROOT leaf type instead of the type declared in the schema,
+   *        e.g. "d[0,0,14]" to store Double_t columns as Double32_t with truncated mantissa
+   */
+  void setLeafType(const std::string & leafType)
+  {
+    leafTypes_.assign(columns_.size(), leafType);
+  }
+
+  /**
+   * @brief Store the column with given name with the given ROOT leaf type instead of the type declared in the schema
+   */
+  void setLeafType(const std::string & columnName, const std::string & leafType)
+  {
+    for ( size_t idxColumn = 0; idxColumn < columns_.size(); ++idxColumn )
+    {
+      if ( columnName == columns_[idxColumn].name_ )
+      {
+        leafTypes_[idxColumn] = leafType;
+        return;
+      }
+    }
+    assert(0);
+  }
+
+  /**
+   * @brief Create one branch per column (when writing the ntuple)
+   */
+  void initializeBranches(TTree * tree) const
+  {
+    for ( size_t idxColumn = 0; idxColumn < columns_.size(); ++idxColumn )
+    {
+      const MEMbbwwNtupleColumn & column = columns_[idxColumn];
+      const std::string & leafType = leafTypes_[idxColumn];
+      const std::string branchName = getBranchName(column);
+      const std::string leafList = branchName + "/" + ( leafType.empty() ? std::string(1, column.type_) : leafType );
+      tree->Branch(branchName.data(), row_ + column.offset_, leafList.data());
+    }
+  }
+
+  /**
+   * @brief Attach the data members to the branches of an existing ntuple (when reading the ntuple).
+   *
+   *        Columns that do not exist in the ntuple keep their reset value.
+   *        If branches is given, the attached branches are appended to it,
+   *        so that the caller can read only these branches with TBranch::GetEntry, instead of all branches with TTree::GetEntry.
+   */
+  void setBranchAddresses(TTree * tree, std::vector<TBranch *> * branches = nullptr) const
+  {
+    for ( std::vector<MEMbbwwNtupleColumn>::const_iterator column = columns_.begin();
+          column != columns_.end(); ++column )
+    {
+      const std::string branchName = getBranchName(*column);
+      TBranch * branch = tree->GetBranch(branchName.data());
+      if ( branch )
+      {
+        tree->SetBranchAddress(branchName.data(), row_ + column->offset_);
+        if ( branches ) branches->push_back(branch);
+      }
+    }
+  }
+
+  /**
+   * @brief Set all columns to their reset values, by copying the row of reset values in one block
+   */
+  void resetBranches()
+  {
+    std::memcpy(row_, defaults_, rowSize_);
+  }
+
+ private:
+  std::string getBranchName(const MEMbbwwNtupleColumn & column) const
+  {
+    return prefix_.empty() ? std::string(column.name_) : prefix_ + "_" + column.name_;
+  }
+
+  std::string prefix_;
+  const std::vector<MEMbbwwNtupleColumn> & columns_;
+  char * row_;
+  const void * defaults_;
+  size_t rowSize_;
+  std::vector<std::string> leafTypes_; ///< ROOT leaf type of each column (empty: type declared in the schema)
+};
+
+template <typename T_row>
+class MEMbbwwNtupleBranches : public MEMbbwwNtupleBranchGroup
+{
+ public:
+  MEMbbwwNtupleBranches(const std::string & prefix = "")
+    : MEMbbwwNtupleBranchGroup(prefix, T_row::columns(), &row_, &T_row::defaults(), sizeof(T_row))
+  {
+    resetBranches();
+  }
+
+  /**
+   * @brief Set the data members by evaluating the accessors of the columns (requires readRow to be defined for T_source)
+   */
+  template <typename T_source>
+  void read(const T_source & src)
+  {
+    readRow(row_, src);
+  }
+
+  T_row & row()             { return row_; }
+  const T_row & row() const { return row_; }
+
+ private:
+  T_row row_;
+};
+
+//-------------------------------------------------------------------------------
+// columns written for all channels
+
+#define MEMBBWW_NTUPLE_EVENT_COLUMNS(COLUMN)                                                                 \
+  COLUMN(run,                    UInt_t,    0,     src.eventInfo().run())                                    \
+  COLUMN(ls,                     UInt_t,    0,     src.eventInfo().lumi())                                   \
+  COLUMN(event,                  ULong64_t, 0,     src.eventInfo().event())                                  \
+  COLUMN(memCpuTime,             Float_t,   -1.,   src.memCpuTime())                                         \
+  COLUMN(memCpuTime_signal,      Float_t,   -1.,   src.memIntegrationStats().cpuTime_signal_)                \
+  COLUMN(memCpuTime_background,  Float_t,   -1.,   src.memIntegrationStats().cpuTime_background_)            \
+  COLUMN(memNumIntegrations,     Int_t,     0,     src.memIntegrationStats().numIntegrations_)               \
+  COLUMN(memNumCalls_signal,     Int_t,     0,     src.memIntegrationStats().numCalls_signal_)               \
+  COLUMN(memNumCalls_background, Int_t,     0,     src.memIntegrationStats().numCalls_background_)           \
+  COLUMN(genWeight,              Float_t,   0.,    src.eventInfo().genWeight())                              \
+  COLUMN(isSignal,               Bool_t,    false, src.isSignal())                                           \
+  COLUMN(nbjets_loose,           Int_t,     0,     src.numMeasuredBJets_loose())                             \
+  COLUMN(nbjets_medium,          Int_t,     0,     src.numMeasuredBJets_medium())                            \
+  COLUMN(nbjets,                 Int_t,     0,     src.numMeasuredBJets())                                   \
+  COLUMN(gen_nbjets,             Int_t,     0,     src.numGenBJets())                                        \
+  COLUMN(barcode,                Int_t,     -1,    src.barcode())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleEventRow, MEMBBWW_NTUPLE_EVENT_COLUMNS);
+
+/**
+ * @brief Natural logarithm of MEM probabilities, as stored in the ntuples written with the logarithmic encoding.
+ *
+ *        Probabilities equal to zero are stored as the lowest Float_t value.
+ */
+constexpr Float_t MEMbbwwNtupleLogZero = -std::numeric_limits<Float_t>::max();
+
+inline Float_t
+getLogValue(double value)
+{
+  return ( value > 0. ) ? log(value) : MEMbbwwNtupleLogZero;
+}
+
+inline double
+getLinearValue(Float_t logValue)
+{
+  return ( logValue > MEMbbwwNtupleLogZero ) ? exp(logValue) : 0.;
+}
+
+// MEM probabilities and likelihood ratio, stored as Double_t (the likelihood ratio optionally as Double32_t, see MEMbbwwNtupleWriteOptions)
+#define MEMBBWW_NTUPLE_MEMRESULT_COLUMNS(COLUMN)                                                             \
+  COLUMN(memProbS,               Double_t,  0.,    src.prob_signal_)                                         \
+  COLUMN(memProbSerr,            Double_t,  0.,    src.probErr_signal_)                                      \
+  COLUMN(memProbB,               Double_t,  0.,    src.prob_background_)                                     \
+  COLUMN(memProbBerr,            Double_t,  0.,    src.probErr_background_)                                  \
+  COLUMN(memLR,                  Double_t,  0.,    src.likelihoodRatio_)                                     \
+  COLUMN(memLRerr,               Double_t,  0.,    src.likelihoodRatioErr_)
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleMEMResultRow, MEMBBWW_NTUPLE_MEMRESULT_COLUMNS);
+
+// natural logarithm of the MEM probabilities and likelihood ratio, stored as Float_t;
+// the columns need to be in the same order as MEMBBWW_NTUPLE_MEMRESULT_COLUMNS
+#define MEMBBWW_NTUPLE_MEMLOGRESULT_COLUMNS(COLUMN)                                                          \
+  COLUMN(memLogProbS,            Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.prob_signal_))             \
+  COLUMN(memLogProbSerr,         Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.probErr_signal_))          \
+  COLUMN(memLogProbB,            Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.prob_background_))         \
+  COLUMN(memLogProbBerr,         Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.probErr_background_))      \
+  COLUMN(memLogLR,               Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.likelihoodRatio_))         \
+  COLUMN(memLogLRerr,            Float_t,   MEMbbwwNtupleLogZero, getLogValue(src.likelihoodRatioErr_))
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleMEMLogResultRow, MEMBBWW_NTUPLE_MEMLOGRESULT_COLUMNS);
+
+/**
+ * @brief Read MEM probabilities and likelihood ratio from ntuples written with any of the encodings
+ *
+ *        The Double_t and Double32_t encodings are converted to double precision by ROOT,
+ *        while the logarithmic encoding is converted back by the row() function.
+ */
+class MEMbbwwNtupleMEMResultReader
+{
+ public:
+  MEMbbwwNtupleMEMResultReader()
+    : isLog_(false)
+  {}
+
+  void setBranchAddresses(TTree * tree, std::vector<TBranch *> * branches = nullptr)
+  {
+    isLog_ = ( tree->GetBranch("memLogProbS") != nullptr );
+    if ( isLog_ ) logResult_.setBranchAddresses(tree, branches);
+    else          result_.setBranchAddresses(tree, branches);
+  }
+
+  /**
+   * @brief MEM probabilities and likelihood ratio of the current entry of the TTree
+   */
+  const MEMbbwwNtupleMEMResultRow & row()
+  {
+    if ( isLog_ )
+    {
+      const std::vector<MEMbbwwNtupleColumn> & columns = MEMbbwwNtupleMEMResultRow::columns();
+      const std::vector<MEMbbwwNtupleColumn> & logColumns = MEMbbwwNtupleMEMLogResultRow::columns();
+      assert(columns.size() == logColumns.size());
+      char * row = reinterpret_cast<char *>(&result_.row());
+      const char * logRow = reinterpret_cast<const char *>(&logResult_.row());
+      for ( size_t idxColumn = 0; idxColumn < columns.size(); ++idxColumn )
+      {
+        assert(columns[idxColumn].type_ == 'D' && logColumns[idxColumn].type_ == 'F');
+        Float_t logValue;
+        std::memcpy(&logValue, logRow + logColumns[idxColumn].offset_, sizeof(Float_t));
+        const Double_t value = getLinearValue(logValue);
+        std::memcpy(row + columns[idxColumn].offset_, &value, sizeof(Double_t));
+      }
+    }
+    return result_.row();
+  }
+
+  bool isLog() const { return isLog_; }
+
+ private:
+  bool isLog_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEMResultRow> result_;
+  MEMbbwwNtupleBranches<MEMbbwwNtupleMEMLogResultRow> logResult_;
+};
+
+#define MEMBBWW_NTUPLE_GENJET_COLUMNS(COLUMN)                                                                \
+  COLUMN(pt,                     Float_t,   0.,    src.particle_.pt())                                       \
+  COLUMN(eta,                    Float_t,   0.,    src.particle_.eta())                                      \
+  COLUMN(phi,                    Float_t,   0.,    src.particle_.phi())                                      \
+  COLUMN(mass,                   Float_t,   0.,    src.particle_.mass())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleGenJetRow, MEMBBWW_NTUPLE_GENJET_COLUMNS);
+
+#define MEMBBWW_NTUPLE_MEASUREDJET_COLUMNS(COLUMN)                                                           \
+  MEMBBWW_NTUPLE_GENJET_COLUMNS(COLUMN)                                                                      \
+  COLUMN(isGenMatched,           Bool_t,    false, src.isGenMatched_)
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleMeasuredJetRow, MEMBBWW_NTUPLE_MEASUREDJET_COLUMNS);
+
+#define MEMBBWW_NTUPLE_GENLEPTON_COLUMNS(COLUMN)                                                             \
+  COLUMN(pt,                     Float_t,   0.,    src.particle_.pt())                                       \
+  COLUMN(eta,                    Float_t,   0.,    src.particle_.eta())                                      \
+  COLUMN(phi,                    Float_t,   0.,    src.particle_.phi())                                      \
+  COLUMN(pdgId,                  Int_t,     0,     src.particle_.pdgId())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleGenLeptonRow, MEMBBWW_NTUPLE_GENLEPTON_COLUMNS);
+
+#define MEMBBWW_NTUPLE_MEASUREDLEPTON_COLUMNS(COLUMN)                                                        \
+  COLUMN(pt,                     Float_t,   0.,    src.particle_.pt())                                       \
+  COLUMN(eta,                    Float_t,   0.,    src.particle_.eta())                                      \
+  COLUMN(phi,                    Float_t,   0.,    src.particle_.phi())                                      \
+  COLUMN(pdgId,                  Int_t,     0,     getMeasuredLeptonPdgId(src.particle_))                    \
+  COLUMN(isGenMatched,           Bool_t,    false, src.isGenMatched_)
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleMeasuredLeptonRow, MEMBBWW_NTUPLE_MEASUREDLEPTON_COLUMNS);
+
+#define MEMBBWW_NTUPLE_MET_COLUMNS(COLUMN)                                                                   \
+  COLUMN(px,                     Float_t,   0.,    src.px_)                                                  \
+  COLUMN(py,                     Float_t,   0.,    src.py_)                                                  \
+  COLUMN(cov00,                  Float_t,   0.,    src.cov_.cov00_)                                          \
+  COLUMN(cov01,                  Float_t,   0.,    src.cov_.cov01_)                                          \
+  COLUMN(cov11,                  Float_t,   0.,    src.cov_.cov11_)
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleMEtRow, MEMBBWW_NTUPLE_MET_COLUMNS);
+
+// auxiliary variables for BDT regression training
+#define MEMBBWW_NTUPLE_HBB_COLUMNS(COLUMN)                                                                   \
+  COLUMN(ptbb,                   Float_t,   0.,    (src.p4_1_ + src.p4_2_).pt())                             \
+  COLUMN(drbb,                   Float_t,   0.,    deltaR(src.p4_1_, src.p4_2_))                             \
+  COLUMN(mbb,                    Float_t,   0.,    (src.p4_1_ + src.p4_2_).mass())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleHbbRow, MEMBBWW_NTUPLE_HBB_COLUMNS);
+
+//-------------------------------------------------------------------------------
+// columns written for the dilepton channel
+
+#define MEMBBWW_NTUPLE_EVENT_COLUMNS_DILEPTON(COLUMN)                                                        \
+  COLUMN(nleptons,               Int_t,     0,     src.numMeasuredLeptons())                                 \
+  COLUMN(gen_nleptons,           Int_t,     0,     src.numGenLeptons())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleEventRow_dilepton, MEMBBWW_NTUPLE_EVENT_COLUMNS_DILEPTON);
+
+// auxiliary variables for BDT regression training (p4_1 and p4_2 = leptons)
+#define MEMBBWW_NTUPLE_HWW_COLUMNS_DILEPTON(COLUMN)                                                          \
+  COLUMN(ptww,                   Float_t,   0.,    (src.p4_1_ + src.p4_2_ + src.metP4_).pt())                \
+  COLUMN(mww,                    Float_t,   0.,    (src.p4_1_ + src.p4_2_ + src.metP4_).mass())              \
+  COLUMN(ptll,                   Float_t,   0.,    (src.p4_1_ + src.p4_2_).pt())                             \
+  COLUMN(drll,                   Float_t,   0.,    deltaR(src.p4_1_, src.p4_2_))                             \
+  COLUMN(dphill,                 Float_t,   0.,    deltaPhi(src.p4_1_.phi(), src.p4_2_.phi()))               \
+  COLUMN(mll,                    Float_t,   0.,    (src.p4_1_ + src.p4_2_).mass())                           \
+  COLUMN(ptmiss,                 Float_t,   0.,    src.metP4_.pt())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleHwwRow_dilepton, MEMBBWW_NTUPLE_HWW_COLUMNS_DILEPTON);
+
+//-------------------------------------------------------------------------------
+// columns written for the single lepton channel
+
+#define MEMBBWW_NTUPLE_EVENT_COLUMNS_SINGLELEPTON(COLUMN)                                                    \
+  COLUMN(nwjets,                 Int_t,     0,     src.numMeasuredWJets())                                   \
+  COLUMN(gen_nwjets,             Int_t,     0,     src.numGenWJets())                                        \
+  COLUMN(nleptons,               Int_t,     0,     src.numMeasuredLeptons())                                 \
+  COLUMN(gen_nleptons,           Int_t,     0,     src.numGenLeptons())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleEventRow_singlelepton, MEMBBWW_NTUPLE_EVENT_COLUMNS_SINGLELEPTON);
+
+// auxiliary variables for BDT regression training (p4_1 and p4_2 = jets from W boson decay)
+#define MEMBBWW_NTUPLE_HADW_COLUMNS_SINGLELEPTON(COLUMN)                                                     \
+  COLUMN(ptjj,                   Float_t,   0.,    (src.p4_1_ + src.p4_2_).pt())                             \
+  COLUMN(drjj,                   Float_t,   0.,    deltaR(src.p4_1_, src.p4_2_))                             \
+  COLUMN(mjj,                    Float_t,   0.,    (src.p4_1_ + src.p4_2_).mass())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleHadWRow_singlelepton, MEMBBWW_NTUPLE_HADW_COLUMNS_SINGLELEPTON);
+
+// auxiliary variables for BDT regression training (p4_1 and p4_2 = jets from W boson decay, p4_3 = lepton)
+#define MEMBBWW_NTUPLE_HWW_COLUMNS_SINGLELEPTON(COLUMN)                                                      \
+  COLUMN(ptww,                   Float_t,   0.,    (src.p4_1_ + src.p4_2_ + src.p4_3_ + src.metP4_).pt())    \
+  COLUMN(mww,                    Float_t,   0.,    (src.p4_1_ + src.p4_2_ + src.p4_3_ + src.metP4_).mass())  \
+  COLUMN(mt,                     Float_t,   0.,    comp_MT_met(src.p4_3_, src.metP4_.pt(), src.metP4_.phi())) \
+  COLUMN(ptmiss,                 Float_t,   0.,    src.metP4_.pt())
+MEMBBWW_NTUPLE_ROW(MEMbbwwNtupleHwwRow_singlelepton, MEMBBWW_NTUPLE_HWW_COLUMNS_SINGLELEPTON);
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwNtupleSchema_h
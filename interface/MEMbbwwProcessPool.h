@@ -0,0 +1,104 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwProcessPool_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwProcessPool_h
+
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwTimingManager.h" // MEMbbwwTimingManager
+
+#include <deque>      // std::deque
+#include <functional> // std::function
+#include <map>        // std::map
+#include <string>     // std::string
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+#include <sys/types.h> // pid_t
+
+/**
+ * @brief Fixed-size pool of worker processes, used to run independent MEM integrations concurrently.
+ *
+ *        The MEM algorithms keep state outside of the algorithm instances (static pointer to the integrand
+ *        used by the VEGAS/VAMP callback, MadGraph parameter cards, LHAPDF), so integrations cannot run concurrently within one process.
+ *        The worker processes are forked from the calling process when the pool is created and hence see all objects created before,
+ *        e.g. the MEMbbwwAlgoPool, which each worker then uses on its own.
+ *        Requests and responses are passed as byte strings through one socket per worker,
+ *        and each request is processed by calling the handler function in a worker process.
+ *        Requests are sent to the idle workers in the order in which they are submitted;
+ *        the response is identified by the ticket returned by the submit method.
+ *        The wall-clock and CPU times that the handler adds to the timing manager in the worker process
+ *        are sent back with the response and added to the timing manager of the calling process.
+ *        In case the pool is created with numProcesses <= 1, no worker processes are started
+ *        and each request is processed immediately within the submit call.
+ *        The pool must be created by a single-threaded process.
+ */
+class MEMbbwwProcessPool
+{
+ public:
+  typedef std::function<void(const std::string & request, std::string & response)> handlerType;
+
+  MEMbbwwProcessPool(unsigned numProcesses, const handlerType & handler, MEMbbwwTimingManager * timingManager = nullptr);
+  ~MEMbbwwProcessPool();
+
+  /**
+   * @brief Queue request for processing
+   * @return Ticket that identifies the response
+   */
+  size_t
+  submit(const std::string & request);
+
+  /**
+   * @brief Check if the response to the request with given ticket has been received, without waiting for it
+   */
+  bool
+  isReady(size_t ticket);
+
+  /**
+   * @brief Wait for the response to the request with given ticket and remove it from the pool
+   *
+   *        Exceptions thrown by the handler function in the worker process are rethrown as cms::Exception.
+   */
+  void
+  get(size_t ticket, std::string & response);
+
+  /**
+   * @brief Number of worker processes (0 if requests are processed in the calling process)
+   */
+  unsigned
+  numProcesses() const;
+
+ private:
+  MEMbbwwProcessPool(const MEMbbwwProcessPool &) = delete;
+  MEMbbwwProcessPool & operator=(const MEMbbwwProcessPool &) = delete;
+
+  /// send queued requests to idle workers
+  void
+  dispatch();
+
+  /// read the responses of busy workers (waiting for at least one response in case wait is true)
+  void
+  receive(bool wait);
+
+  /// process requests received through the socket until the calling process closes it (executed by the worker processes)
+  void
+  work(int fd);
+
+  struct workerType
+  {
+    pid_t pid_;
+    int fd_;
+    bool isBusy_;
+    size_t ticket_;
+  };
+  struct responseType
+  {
+    bool isError_;
+    std::string message_;
+  };
+
+  handlerType handler_;
+  MEMbbwwTimingManager * timingManager_;
+  std::vector<workerType> workers_;
+  std::deque<std::pair<size_t, std::string>> requests_;
+  std::map<size_t, responseType> responses_;
+  size_t nextTicket_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwProcessPool_h
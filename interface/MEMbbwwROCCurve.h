@@ -0,0 +1,368 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwROCCurve_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwROCCurve_h
+
+#include <TGraph.h>   // TGraph
+#include <TRandom3.h> // TRandom3
+
+#include <algorithm> // std::sort, std::inplace_merge, std::min, std::max
+#include <string>    // std::string
+#include <thread>    // std::thread
+#include <vector>    // std::vector<>
+#include <math.h>    // sqrt, isnan
+
+/**
+ * @brief Unbinned distribution of a discriminating score (e.g. the MEM likelihood ratio) for one class of events (signal or background),
+ *        from which ROC curves and the area under the ROC curve (AUC) are computed without binning effects.
+ *
+ *        Up to maxSize entries are kept exactly. Once more entries are filled, the entries are compressed into a quantile sketch of bounded size:
+ *        entries that are neighbours in score are merged into centroids of at most 2/maxSize of all entries,
+ *        so that the efficiency for any threshold on the score is known to within this fraction.
+ *
+ *        The header depends on ROOT only, so that it can be included in the macros.
+ */
+class MEMbbwwScoreDistribution
+{
+ public:
+  struct centroid
+  {
+    double score_;      ///< score of the entry, or mean score of the entries merged into the centroid
+    double sumWeights_;
+    double numEntries_; ///< number of entries merged into the centroid (used to resample the centroid in the bootstrap)
+  };
+
+  /**
+   * @param numThreads number of threads used to sort the entries (0 = number of cores)
+   */
+  explicit MEMbbwwScoreDistribution(size_t maxSize = 1000000, unsigned numThreads = 0)
+    : maxSize_(std::max(maxSize, (size_t)2))
+    , numThreads_(( numThreads > 0 ) ? numThreads : std::max(1u, std::thread::hardware_concurrency()))
+    , isSorted_(true)
+    , isExact_(true)
+    , numEntries_(0.)
+    , sumWeights_(0.)
+  {}
+
+  /**
+   * @brief Add one entry; entries with undefined (NaN) score are ignored, while scores of +/- infinity are allowed
+   */
+  void fill(double score, double weight = 1.)
+  {
+    if ( isnan(score) ) return;
+    entries_.push_back({ score, weight, 1. });
+    isSorted_ = false;
+    numEntries_ += 1.;
+    sumWeights_ += weight;
+    if ( entries_.size() >= 2*maxSize_ ) compress();
+  }
+
+  /**
+   * @brief Add all entries of another distribution, e.g. filled by another thread
+   */
+  void add(const MEMbbwwScoreDistribution & other)
+  {
+    entries_.insert(entries_.end(), other.entries_.begin(), other.entries_.end());
+    isSorted_ = isSorted_ && other.entries_.empty();
+    isExact_ = isExact_ && other.isExact_;
+    numEntries_ += other.numEntries_;
+    sumWeights_ += other.sumWeights_;
+    if ( entries_.size() >= 2*maxSize_ ) compress();
+  }
+
+  /**
+   * @brief Entries (or centroids) sorted by decreasing score
+   */
+  const std::vector<centroid> & getSortedEntries() const
+  {
+    if ( !isSorted_ )
+    {
+      sortEntries();
+      isSorted_ = true;
+    }
+    return entries_;
+  }
+
+  double getNumEntries() const { return numEntries_; }
+  double getSumWeights() const { return sumWeights_; }
+
+  /**
+   * @brief Returns false if some of the entries have been merged into centroids
+   */
+  bool isExact() const { return isExact_; }
+
+ private:
+  static bool isHigherScore(const centroid & entry1, const centroid & entry2)
+  {
+    return entry1.score_ > entry2.score_;
+  }
+
+  /**
+   * @brief Sort the entries by decreasing score, in parallel: the threads sort one block of entries each,
+   *        after which the sorted blocks are merged pairwise
+   */
+  void sortEntries() const
+  {
+    const size_t minEntries_parallelSort = 10000;
+    const size_t numBlocks = std::min((size_t)numThreads_, entries_.size()/minEntries_parallelSort);
+    if ( numBlocks <= 1 )
+    {
+      std::sort(entries_.begin(), entries_.end(), isHigherScore);
+      return;
+    }
+    std::vector<size_t> blockBoundaries;
+    for ( size_t idxBlock = 0; idxBlock <= numBlocks; ++idxBlock )
+    {
+      blockBoundaries.push_back((idxBlock*entries_.size())/numBlocks);
+    }
+    std::vector<std::thread> threads;
+    for ( size_t idxBlock = 0; idxBlock < numBlocks; ++idxBlock )
+    {
+      threads.push_back(std::thread([this, &blockBoundaries, idxBlock]() {
+        std::sort(entries_.begin() + blockBoundaries[idxBlock], entries_.begin() + blockBoundaries[idxBlock + 1], isHigherScore);
+      }));
+    }
+    for ( std::thread & thread : threads ) thread.join();
+    for ( size_t width = 1; width < numBlocks; width *= 2 )
+    {
+      threads.clear();
+      for ( size_t idxBlock = 0; idxBlock + width < numBlocks; idxBlock += 2*width )
+      {
+        const size_t first  = blockBoundaries[idxBlock];
+        const size_t middle = blockBoundaries[idxBlock + width];
+        const size_t last   = blockBoundaries[std::min(idxBlock + 2*width, numBlocks)];
+        threads.push_back(std::thread([this, first, middle, last]() {
+          std::inplace_merge(entries_.begin() + first, entries_.begin() + middle, entries_.begin() + last, isHigherScore);
+        }));
+      }
+      for ( std::thread & thread : threads ) thread.join();
+    }
+  }
+
+  /**
+   * @brief Merge neighbouring entries into centroids of at most 2/maxSize of all entries
+   */
+  void compress()
+  {
+    sortEntries();
+    const double maxEntries_centroid = 2.*numEntries_/maxSize_;
+    std::vector<centroid> centroids;
+    centroids.reserve(maxSize_);
+    for ( std::vector<centroid>::const_iterator entry = entries_.begin(); entry != entries_.end(); ++entry )
+    {
+      if ( !centroids.empty() && (centroids.back().numEntries_ + entry->numEntries_) <= maxEntries_centroid )
+      {
+        centroid & current = centroids.back();
+        const double numEntries_sum = current.numEntries_ + entry->numEntries_;
+        current.score_ = (current.numEntries_*current.score_ + entry->numEntries_*entry->score_)/numEntries_sum;
+        current.sumWeights_ += entry->sumWeights_;
+        current.numEntries_ = numEntries_sum;
+      }
+      else
+      {
+        centroids.push_back(*entry);
+      }
+    }
+    entries_.swap(centroids);
+    isSorted_ = true;
+    isExact_ = false;
+  }
+
+  size_t maxSize_;
+  unsigned numThreads_;
+  mutable std::vector<centroid> entries_;
+  mutable bool isSorted_;
+  bool isExact_;
+  double numEntries_;
+  double sumWeights_;
+};
+
+/**
+ * @brief Point of the ROC curve, for selecting events with score >= threshold
+ */
+struct MEMbbwwROCPoint
+{
+  double threshold_;
+  double efficiency_signal_;
+  double efficiency_background_;
+};
+
+/**
+ * @brief Walk through the signal and background entries in order of decreasing score
+ *        and call func(threshold, efficiency_signal, efficiency_background) for each distinct score.
+ *
+ *        The weights of the entries are multiplied by the factors given in weightFactors_signal and weightFactors_background, if not empty.
+ *        Signal and background entries of the same score are added in the same step,
+ *        so that ties contribute half to the AUC, as in the Mann-Whitney U statistic.
+ */
+template <typename T_func>
+void
+walkROCCurve(const std::vector<MEMbbwwScoreDistribution::centroid> & entries_signal, const std::vector<double> & weightFactors_signal,
+             const std::vector<MEMbbwwScoreDistribution::centroid> & entries_background, const std::vector<double> & weightFactors_background,
+             T_func func)
+{
+  double sumWeights_signal = 0.;
+  for ( size_t idxEntry = 0; idxEntry < entries_signal.size(); ++idxEntry )
+  {
+    sumWeights_signal += entries_signal[idxEntry].sumWeights_*( weightFactors_signal.empty() ? 1. : weightFactors_signal[idxEntry] );
+  }
+  double sumWeights_background = 0.;
+  for ( size_t idxEntry = 0; idxEntry < entries_background.size(); ++idxEntry )
+  {
+    sumWeights_background += entries_background[idxEntry].sumWeights_*( weightFactors_background.empty() ? 1. : weightFactors_background[idxEntry] );
+  }
+  if ( !(sumWeights_signal > 0. && sumWeights_background > 0.) ) return;
+
+  double sumWeights_signal_passed = 0.;
+  double sumWeights_background_passed = 0.;
+  size_t idxEntry_signal = 0;
+  size_t idxEntry_background = 0;
+  while ( idxEntry_signal < entries_signal.size() || idxEntry_background < entries_background.size() )
+  {
+    double threshold;
+    if      ( idxEntry_signal     == entries_signal.size()     ) threshold = entries_background[idxEntry_background].score_;
+    else if ( idxEntry_background == entries_background.size() ) threshold = entries_signal[idxEntry_signal].score_;
+    else threshold = std::max(entries_signal[idxEntry_signal].score_, entries_background[idxEntry_background].score_);
+    while ( idxEntry_signal < entries_signal.size() && entries_signal[idxEntry_signal].score_ == threshold )
+    {
+      sumWeights_signal_passed += entries_signal[idxEntry_signal].sumWeights_*( weightFactors_signal.empty() ? 1. : weightFactors_signal[idxEntry_signal] );
+      ++idxEntry_signal;
+    }
+    while ( idxEntry_background < entries_background.size() && entries_background[idxEntry_background].score_ == threshold )
+    {
+      sumWeights_background_passed += entries_background[idxEntry_background].sumWeights_*( weightFactors_background.empty() ? 1. : weightFactors_background[idxEntry_background] );
+      ++idxEntry_background;
+    }
+    func(threshold, sumWeights_signal_passed/sumWeights_signal, sumWeights_background_passed/sumWeights_background);
+  }
+}
+
+/**
+ * @brief Compute ROC curve, one point per distinct score (starting with the point for which no event passes)
+ */
+inline std::vector<MEMbbwwROCPoint>
+compROCCurve(const MEMbbwwScoreDistribution & signal, const MEMbbwwScoreDistribution & background)
+{
+  std::vector<MEMbbwwROCPoint> points;
+  points.push_back({ +1.e+30, 0., 0. });
+  const std::vector<double> noWeightFactors;
+  walkROCCurve(signal.getSortedEntries(), noWeightFactors, background.getSortedEntries(), noWeightFactors,
+    [&points](double threshold, double efficiency_signal, double efficiency_background) {
+      points.push_back({ threshold, efficiency_signal, efficiency_background });
+    });
+  return points;
+}
+
+/**
+ * @brief Compute area under the ROC curve, i.e. the probability for a signal event to have a higher score than a background event
+ */
+inline double
+compAUC(const std::vector<MEMbbwwScoreDistribution::centroid> & entries_signal, const std::vector<double> & weightFactors_signal,
+        const std::vector<MEMbbwwScoreDistribution::centroid> & entries_background, const std::vector<double> & weightFactors_background)
+{
+  double auc = 0.;
+  double efficiency_signal_previous = 0.;
+  double efficiency_background_previous = 0.;
+  walkROCCurve(entries_signal, weightFactors_signal, entries_background, weightFactors_background,
+    [&](double /*threshold*/, double efficiency_signal, double efficiency_background) {
+      auc += 0.5*(efficiency_signal + efficiency_signal_previous)*(efficiency_background - efficiency_background_previous);
+      efficiency_signal_previous = efficiency_signal;
+      efficiency_background_previous = efficiency_background;
+    });
+  return auc;
+}
+
+inline double
+compAUC(const MEMbbwwScoreDistribution & signal, const MEMbbwwScoreDistribution & background)
+{
+  const std::vector<double> noWeightFactors;
+  return compAUC(signal.getSortedEntries(), noWeightFactors, background.getSortedEntries(), noWeightFactors);
+}
+
+/**
+ * @brief Estimate the uncertainty on the AUC by the Poisson bootstrap:
+ *        in each replica, the weight of each entry is multiplied by a random number drawn from a Poisson distribution of mean 1
+ *        (centroids of n entries are multiplied by a random number drawn from a Poisson distribution of mean n, divided by n).
+ *
+ *        The replicas are computed in parallel, each replica with its own random number generator (seeded with seed + index of replica),
+ *        so that the result does not depend on the number of threads.
+ */
+inline void
+compAUC_bootstrap(const MEMbbwwScoreDistribution & signal, const MEMbbwwScoreDistribution & background,
+                  unsigned numReplicas, unsigned seed, double & auc_mean, double & auc_uncertainty, unsigned numThreads = 0)
+{
+  const std::vector<MEMbbwwScoreDistribution::centroid> & entries_signal = signal.getSortedEntries();
+  const std::vector<MEMbbwwScoreDistribution::centroid> & entries_background = background.getSortedEntries();
+  std::vector<double> aucs(numReplicas);
+  if ( numThreads == 0 ) numThreads = std::max(1u, std::thread::hardware_concurrency());
+  numThreads = std::max(1u, std::min(numThreads, numReplicas));
+  std::vector<std::thread> threads;
+  for ( unsigned idxThread = 0; idxThread < numThreads; ++idxThread )
+  {
+    threads.push_back(std::thread([&, idxThread]() {
+      std::vector<double> weightFactors_signal(entries_signal.size());
+      std::vector<double> weightFactors_background(entries_background.size());
+      TRandom3 rnd;
+      for ( unsigned idxReplica = idxThread; idxReplica < numReplicas; idxReplica += numThreads )
+      {
+        rnd.SetSeed(seed + idxReplica);
+        for ( size_t idxEntry = 0; idxEntry < entries_signal.size(); ++idxEntry )
+        {
+          const double numEntries = entries_signal[idxEntry].numEntries_;
+          weightFactors_signal[idxEntry] = rnd.Poisson(numEntries)/numEntries;
+        }
+        for ( size_t idxEntry = 0; idxEntry < entries_background.size(); ++idxEntry )
+        {
+          const double numEntries = entries_background[idxEntry].numEntries_;
+          weightFactors_background[idxEntry] = rnd.Poisson(numEntries)/numEntries;
+        }
+        aucs[idxReplica] = compAUC(entries_signal, weightFactors_signal, entries_background, weightFactors_background);
+      }
+    }));
+  }
+  for ( std::thread & thread : threads ) thread.join();
+
+  double sum = 0.;
+  double sum2 = 0.;
+  for ( double auc : aucs )
+  {
+    sum += auc;
+    sum2 += auc*auc;
+  }
+  auc_mean = ( numReplicas > 0 ) ? sum/numReplicas : 0.;
+  auc_uncertainty = ( numReplicas > 1 ) ? sqrt(std::max(0., (sum2 - numReplicas*auc_mean*auc_mean)/(numReplicas - 1))) : 0.;
+}
+
+/**
+ * @brief Make TGraph of ROC curve, with the signal efficiency on the x-axis
+ *        and the background efficiency (useLogScale = true) or background rejection (useLogScale = false) on the y-axis,
+ *        as compGraphROC in the plotting macros.
+ *
+ *        Points are only added if the signal or the background efficiency changed by at least 1/maxPoints since the previous point.
+ */
+inline TGraph *
+compGraphROC(const std::string & graphName, const MEMbbwwScoreDistribution & signal, const MEMbbwwScoreDistribution & background,
+             bool useLogScale, unsigned maxPoints = 10000)
+{
+  const std::vector<MEMbbwwROCPoint> points = compROCCurve(signal, background);
+  const double minDelta = 1./std::max(1u, maxPoints);
+  std::vector<const MEMbbwwROCPoint *> selPoints;
+  for ( size_t idxPoint = 0; idxPoint < points.size(); ++idxPoint )
+  {
+    const MEMbbwwROCPoint & point = points[idxPoint];
+    if ( idxPoint == 0 || idxPoint == points.size() - 1 ||
+         (point.efficiency_signal_     - selPoints.back()->efficiency_signal_    ) >= minDelta ||
+         (point.efficiency_background_ - selPoints.back()->efficiency_background_) >= minDelta )
+    {
+      selPoints.push_back(&point);
+    }
+  }
+  TGraph * graphROC = new TGraph(selPoints.size());
+  graphROC->SetName(graphName.data());
+  for ( size_t idxPoint = 0; idxPoint < selPoints.size(); ++idxPoint )
+  {
+    const double efficiency_background = selPoints[idxPoint]->efficiency_background_;
+    graphROC->SetPoint(idxPoint, selPoints[idxPoint]->efficiency_signal_, ( useLogScale ) ? efficiency_background : 1. - efficiency_background);
+  }
+  return graphROC;
+}
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwROCCurve_h
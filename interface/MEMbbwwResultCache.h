@@ -0,0 +1,182 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwResultCache_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwResultCache_h
+
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwIntegrationStats.h" // MEMbbwwIntegrationStats
+
+#include <atomic>      // std::atomic
+#include <cstring>     // std::memcpy
+#include <iostream>    // std::ostream
+#include <string>      // std::string
+
+/**
+ * @brief On-disk cache of MEM results, addressed by the content of the MEM inputs
+ *
+ *        The key is made of everything that affects the result of the MEM integration:
+ *        the channel, the version of the MEM algorithms (see getMEMVersion),
+ *        the measured particles, the MET and its covariance matrix, the parameters of the transfer functions,
+ *        the PDF set, the content of the MadGraph parameter cards, and the number of integrand evaluations.
+ *        Each result is stored in a separate file, which is named by a hash of the key and contains the version of the file format
+ *        and the full key, so that hash collisions and files written in an older format are detected when the file is read.
+ *        Files are written to a temporary name and then renamed, so that several jobs can share one cache directory.
+ *
+ *        The six observables of the MEM result (probabilities of signal and background hypotheses, likelihood ratio, and their uncertainties)
+ *        and the integration statistics are stored value by value, and the MEM result is rebuilt through its setter functions.
+ */
+class MEMbbwwResultCache
+{
+public:
+  MEMbbwwResultCache(const std::string & cacheDirName);
+  ~MEMbbwwResultCache();
+
+  /**
+   * @brief Binary representation of the MEM inputs, built up one value at a time
+   */
+  class Key
+  {
+  public:
+    Key & add(double value);
+    Key & add(int value);
+    Key & add(const std::string & value);
+    /// add content of text or binary file
+    Key & addFile(const std::string & fileName);
+
+    const std::string & bytes() const;
+    /// 64-bit FNV-1a hash of the key, as hexadecimal string
+    std::string hash() const;
+
+  private:
+    std::string bytes_;
+  };
+
+  /**
+   * @brief Read MEM result and integration statistics from the cache
+   * @return true if the cache contains a result for the given key
+   */
+  template <class T_result>
+  bool
+  get(const Key & key, T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    std::string payload;
+    if ( !read(key, payload) || payload.size() != payloadSize ) {
+      ++numMisses_;
+      return false;
+    }
+    const char * data = payload.data();
+    decode(data, memResult, memStats);
+    memStats.fromCache_ = true;
+    ++numHits_;
+    return true;
+  }
+
+  /**
+   * @brief Store MEM result and integration statistics in the cache
+   */
+  template <class T_result>
+  void
+  put(const Key & key, const T_result & memResult, const MEMbbwwIntegrationStats & memStats)
+  {
+    std::string payload;
+    payload.reserve(payloadSize);
+    encode(memResult, memStats, payload);
+    write(key, payload);
+  }
+
+  /**
+   * @brief Append MEM result and integration statistics to a byte string, in the format used by the cache files
+   *        (also used to send MEM results from the worker processes of a MEMbbwwProcessPool to the calling process)
+   */
+  template <class T_result>
+  static void
+  encode(const T_result & memResult, const MEMbbwwIntegrationStats & memStats, std::string & payload)
+  {
+    appendValue(payload, memResult.getProb_signal());
+    appendValue(payload, memResult.getProbErr_signal());
+    appendValue(payload, memResult.getProb_background());
+    appendValue(payload, memResult.getProbErr_background());
+    appendValue(payload, memResult.getLikelihoodRatio());
+    appendValue(payload, memResult.getLikelihoodRatioErr());
+    appendValue(payload, memStats.cpuTime_);
+    appendValue(payload, memStats.cpuTime_signal_);
+    appendValue(payload, memStats.cpuTime_background_);
+    appendValue(payload, memStats.numCalls_signal_);
+    appendValue(payload, memStats.numCalls_background_);
+    appendValue(payload, memStats.numIntegrations_);
+  }
+
+  /**
+   * @brief Read MEM result and integration statistics written by the encode function and advance data to the next value
+   *
+   *        The caller needs to make sure that at least payloadSize bytes are available.
+   */
+  template <class T_result>
+  static void
+  decode(const char * & data, T_result & memResult, MEMbbwwIntegrationStats & memStats)
+  {
+    double observables[numObservables];
+    for ( size_t idxObservable = 0; idxObservable < numObservables; ++idxObservable ) {
+      observables[idxObservable] = readValue<double>(data);
+    }
+    memResult = T_result();
+    memResult.setProb_signal(observables[0]);
+    memResult.setProbErr_signal(observables[1]);
+    memResult.setProb_background(observables[2]);
+    memResult.setProbErr_background(observables[3]);
+    memResult.setLikelihoodRatio(observables[4]);
+    memResult.setLikelihoodRatioErr(observables[5]);
+    memStats = MEMbbwwIntegrationStats();
+    memStats.cpuTime_ = readValue<double>(data);
+    memStats.cpuTime_signal_ = readValue<double>(data);
+    memStats.cpuTime_background_ = readValue<double>(data);
+    memStats.numCalls_signal_ = readValue<int>(data);
+    memStats.numCalls_background_ = readValue<int>(data);
+    memStats.numIntegrations_ = readValue<int>(data);
+  }
+
+  /**
+   * @brief Version of the MEM algorithms, given by the hash of the shared library of the hhAnalysis/bbwwMEM package
+   *
+   *        Added to the cache keys, so that results computed with a different build of the MEM algorithms are not reused.
+   *        The library is searched for in $CMSSW_BASE/lib/$SCRAM_ARCH and in $CMSSW_RELEASE_BASE/lib/$SCRAM_ARCH.
+   */
+  static const std::string &
+  getMEMVersion();
+
+  /// print number of cache hits, misses and writes
+  void print(std::ostream & stream) const;
+
+  static const size_t numObservables = 6;
+  /// number of bytes written by the encode function
+  static const size_t payloadSize = numObservables*sizeof(double) + 3*sizeof(double) + 3*sizeof(int);
+
+  /// append value to byte string
+  template <typename T>
+  static void
+  appendValue(std::string & payload, const T & value)
+  {
+    payload.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  /// read value from byte string and advance data to the next value
+  template <typename T>
+  static T
+  readValue(const char * & data)
+  {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return value;
+  }
+
+protected:
+  std::string getFileName(const Key & key) const;
+
+  bool read(const Key & key, std::string & payload) const;
+  void write(const Key & key, const std::string & payload);
+
+  std::string cacheDirName_;
+  std::atomic<long> numHits_;
+  std::atomic<long> numMisses_;
+  std::atomic<long> numWrites_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwResultCache_h
@@ -0,0 +1,121 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwTimingManager_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwTimingManager_h
+
+#include "CommonTools/Utils/interface/TFileDirectory.h" // TFileDirectory
+
+#include <Rtypes.h> // Long64_t
+
+#include <chrono>   // std::chrono::steady_clock
+#include <iostream> // std::ostream
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+/**
+ * @brief Accumulate wall-clock time, CPU time and number of calls for the different phases of the event processing
+ *        (reading of input, generator-level selection, smearing, MEM computation, filling of ntuples and histograms).
+ *
+ *        The times are added by MEMbbwwScopedTimer objects. The times measured in the worker processes of a MEMbbwwProcessPool
+ *        are sent to the calling process and added to its MEMbbwwTimingManager.
+ *        The accumulated times are printed as summary table at the end of the job
+ *        and stored in a TTree with one entry per phase.
+ *        The phases are looked up by comparing the names with those of the phases called before,
+ *        so that timing a phase does not allocate memory once the phase has been called for the first time.
+ */
+class MEMbbwwTimingManager
+{
+public:
+  MEMbbwwTimingManager(const std::string & outputDirectoryName, const std::string & outputTreeName = "timing");
+  ~MEMbbwwTimingManager();
+
+  /**
+   * @brief Add one call of given phase
+   * @param wallTime wall-clock time (in units of seconds)
+   * @param cpuTime CPU time spent by the calling thread (in units of seconds)
+   */
+  void add(const char * phase, double wallTime, double cpuTime);
+
+  /**
+   * @brief Add given number of calls of given phase, with the wall-clock and CPU times summed over these calls
+   *        (used to restore the totals stored in a checkpoint when a pre-empted job is resumed
+   *         and to add the times measured in the worker processes of a MEMbbwwProcessPool)
+   */
+  void addTotals(const char * phase, Long64_t numCalls, double wallTime, double cpuTime);
+
+  /**
+   * @brief Return the totals accumulated so far, in the order in which the phases have been called first
+   */
+  void getTotals(std::vector<std::string> & phases, std::vector<Long64_t> & numCalls,
+                 std::vector<double> & wallTimes, std::vector<double> & cpuTimes) const;
+
+  /**
+   * @brief Return number of phases, and the totals of the phase with given index
+   */
+  size_t getNumPhases() const;
+  void getTotals(size_t idxPhase, const char * & phase, Long64_t & numCalls, double & wallTime, double & cpuTime) const;
+
+  /**
+   * @brief Reset the totals of all phases to zero (the phases are kept, so that their names do not need to be allocated again)
+   */
+  void clear();
+
+  void print(std::ostream & stream) const;
+
+  void writeTree(TFileDirectory & dir) const;
+
+protected:
+  std::string outputDirectoryName_;
+  std::string outputTreeName_;
+
+  struct timingEntry
+  {
+    timingEntry(const char * phase)
+      : phase_(phase)
+      , numCalls_(0)
+      , wallTime_(0.)
+      , cpuTime_(0.)
+    {}
+    std::string phase_;
+    Long64_t numCalls_;
+    double wallTime_;
+    double cpuTime_;
+  };
+  std::vector<timingEntry> entries_; ///< phases in the order in which they are first called
+  size_t lastEntryIdx_;              ///< phase of the last call, which is compared first
+};
+
+/**
+ * @brief CPU time consumed by the calling thread (in units of seconds)
+ *
+ *        In contrast to TBenchmark::GetCpuTime, which returns the CPU time of the whole process,
+ *        the CPU time used by other threads running concurrently (e.g. ROOT I/O threads) is not included.
+ */
+double
+getThreadCpuTime();
+
+/**
+ * @brief Measure wall-clock and CPU time spent between construction and destruction (or call to stop method)
+ *        and add it to the MEMbbwwTimingManager
+ */
+class MEMbbwwScopedTimer
+{
+public:
+  /**
+   * @param phase name of the phase, which needs to stay valid until the timer is stopped (e.g. a string literal)
+   */
+  MEMbbwwScopedTimer(MEMbbwwTimingManager * timingManager, const char * phase);
+  ~MEMbbwwScopedTimer();
+
+  void stop();
+
+private:
+  MEMbbwwScopedTimer(const MEMbbwwScopedTimer &) = delete;
+  MEMbbwwScopedTimer & operator=(const MEMbbwwScopedTimer &) = delete;
+
+  MEMbbwwTimingManager * timingManager_;
+  const char * phase_;
+  std::chrono::steady_clock::time_point wallTime_start_;
+  double cpuTime_start_;
+  bool isRunning_;
+};
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_MEMbbwwTimingManager_h
@@ -0,0 +1,78 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_eventLoopAuxFunctions_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_eventLoopAuxFunctions_h
+
+#include "DataFormats/Math/interface/deltaR.h" // deltaR
+
+#include <algorithm> // std::sort
+#include <vector>    // std::vector<>
+
+/**
+ * @brief Variants of convert_to_ptrs, ParticleCollectionCleaner and ParticleCollectionSelector
+ *        (defined in tthAnalysis/HiggsToTauTau) that write their output to a collection owned by the caller.
+ *
+ *        The output collection is cleared, but its memory is kept, so that no memory is allocated
+ *        once the collection has grown to the size needed by the largest event.
+ */
+
+/**
+ * @brief Fill pointers to the elements of collection into ptrs
+ */
+template <typename T>
+void
+convert_to_ptrs(const std::vector<T> & collection, std::vector<const T *> & ptrs)
+{
+  ptrs.clear();
+  for ( typename std::vector<T>::const_iterator particle = collection.begin();
+        particle != collection.end(); ++particle ) {
+    ptrs.push_back(&(*particle));
+  }
+}
+
+template <typename T>
+bool
+isOverlap(const T * /*particle*/, double /*dRmin*/)
+{
+  return false;
+}
+
+template <typename T, typename T_overlap, typename... T_overlaps>
+bool
+isOverlap(const T * particle, double dRmin, const std::vector<const T_overlap *> & overlaps, const T_overlaps & ... otherOverlaps)
+{
+  for ( typename std::vector<const T_overlap *>::const_iterator overlap = overlaps.begin();
+        overlap != overlaps.end(); ++overlap ) {
+    if ( deltaR((*overlap)->p4(), particle->p4()) < dRmin ) return true;
+  }
+  return isOverlap(particle, dRmin, otherOverlaps...);
+}
+
+/**
+ * @brief Fill particles that are separated by dR >= dRmin from all particles in the overlap collections into cleanedParticles
+ */
+template <typename T, typename... T_overlaps>
+void
+cleanCollection(const std::vector<const T *> & particles, double dRmin, std::vector<const T *> & cleanedParticles, const T_overlaps & ... overlaps)
+{
+  cleanedParticles.clear();
+  for ( typename std::vector<const T *>::const_iterator particle = particles.begin();
+        particle != particles.end(); ++particle ) {
+    if ( !isOverlap(*particle, dRmin, overlaps...) ) cleanedParticles.push_back(*particle);
+  }
+}
+
+/**
+ * @brief Fill particles that pass the selector into selParticles, sorted by the given function
+ */
+template <typename T, typename T_selector, typename T_sortFunction>
+void
+selectCollection(const std::vector<const T *> & particles, const T_selector & selector, T_sortFunction sortFunction, std::vector<const T *> & selParticles)
+{
+  selParticles.clear();
+  for ( typename std::vector<const T *>::const_iterator particle = particles.begin();
+        particle != particles.end(); ++particle ) {
+    if ( selector(**particle) ) selParticles.push_back(*particle);
+  }
+  std::sort(selParticles.begin(), selParticles.end(), sortFunction);
+}
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_eventLoopAuxFunctions_h
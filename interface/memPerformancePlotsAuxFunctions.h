@@ -0,0 +1,152 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_memPerformancePlotsAuxFunctions_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_memPerformancePlotsAuxFunctions_h
+
+// Auxiliary functions for making the MEM performance plots,
+// shared by the macros makeMEMPerformancePlotsFromHistograms_bbww_dilepton.C and makeMEMPerformancePlotsFromHistograms_bbww_singlelepton.C
+
+#include <functional> // std::function<>
+#include <string>     // std::string
+#include <vector>     // std::vector<>
+
+class MEMbbwwHistogramCache;
+class TGraph;
+class TH1;
+class TLine;
+
+enum { kUndefined, kSignal_lo, kSignal_nlo, kBackground_lo, kBackground_nlo };
+
+// formats in which the plots are saved
+extern bool makePlots_png;
+extern bool makePlots_pdf;
+extern bool makePlots_root;
+
+/**
+ * @brief Load histogram of given process (kSignal_lo, kSignal_nlo, kBackground_lo, kBackground_nlo) through the histogram cache,
+ *        normalized to unit area. The histogram is owned by the cache.
+ */
+TH1* loadHistogram(MEMbbwwHistogramCache& histogramCache, const std::string& inputFileName,
+                   const std::string& directory_part1, const std::string& directory_part2, int signal_or_background, const std::string& histogramName);
+
+/**
+ * @brief Sum of two or three histograms, normalized to unit area
+ */
+TH1* addHistograms(const std::string& histogramSumName, const TH1* histogram1, const TH1* histogram2, const TH1* histogram3 = nullptr);
+
+/**
+ * @brief Copy of histogram rebinned to numBinsX bins.
+ *        If a histogram cache is given, the rebinned histogram is made only once and copied from the cache.
+ */
+TH1* rebinHistogram(const TH1* histogram, int numBinsX, MEMbbwwHistogramCache* histogramCache = nullptr);
+
+/**
+ * @brief Plot up to four histograms, normalized to unit area and rebinned to numBinsX bins in the range xMin..xMax
+ */
+void showHistograms(double canvasSizeX, double canvasSizeY,
+		    TH1* histogram1, const std::string& legendEntry1,
+		    TH1* histogram2, const std::string& legendEntry2,
+		    TH1* histogram3, const std::string& legendEntry3,
+		    TH1* histogram4, const std::string& legendEntry4,
+		    int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		    double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+		    const std::string& labelText, double labelTextSize,
+		    double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		    int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		    bool useLogScale, double yMin, double yMax, const std::string& yAxisTitle, double yAxisOffset,
+		    const std::string& outputFileName,
+		    MEMbbwwHistogramCache* histogramCache = nullptr);
+
+TH1* compRatioHistogram(const TH1* histogram_numerator, const TH1* histogram_denominator);
+
+void copyHistogramStyle(const TH1* histogram_source, TH1* histogram_target);
+
+/**
+ * @brief Plot up to four histograms, with the ratios to histogramRef shown in a separate pad below
+ */
+void showHistograms_wRatio(double canvasSizeX, double canvasSizeY,
+			   TH1* histogramRef, const std::string& legendEntryRef,
+			   TH1* histogram2, const std::string& legendEntry2,
+			   TH1* histogram3, const std::string& legendEntry3,
+			   TH1* histogram4, const std::string& legendEntry4,
+			   int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+			   double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+			   const std::string& labelText, double labelTextSize,
+			   double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+			   int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+			   bool useLogScale, double yMin, double yMax, double yMin_ratio, double yMax_ratio, const std::string& yAxisTitle, double yAxisOffset,
+			   const std::string& outputFileName,
+			   MEMbbwwHistogramCache* histogramCache = nullptr);
+
+/**
+ * @brief Fraction of events above each bin of the histogram
+ */
+TGraph* compGraphEfficiency(const std::string& graphName, const TH1* histogram);
+
+/**
+ * @brief ROC curve, with the signal efficiency on the x-axis
+ *        and the background efficiency (useLogScale = true) or background rejection (useLogScale = false) on the y-axis
+ */
+TGraph* compGraphROC(const std::string& graphName, const TGraph* graphEfficiency_signal, const TGraph* graphEfficiency_background, bool useLogScale);
+
+TGraph* compGraphROC(const std::string& graphName, const TH1* histogram_signal, const TH1* histogram_background, bool useLogScale);
+
+/**
+ * @brief Copy of graph reduced to the points that differ by more than minDeltaX or maxDeltaY from the previous point
+ */
+TGraph* sparsifyGraph(TGraph* graph, double minDeltaX = 0.025, double maxDeltaY = 0.100);
+
+void setLineStyle(TLine* line);
+
+/**
+ * @brief Plot up to four graphs
+ */
+void showGraphs(double canvasSizeX, double canvasSizeY,
+		TGraph* graph1, const std::string& legendEntry1,
+		TGraph* graph2, const std::string& legendEntry2,
+		TGraph* graph3, const std::string& legendEntry3,
+		TGraph* graph4, const std::string& legendEntry4,
+		int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions,
+		const std::string& labelText, double labelTextSize,
+		double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		bool useLogScale, double yMin, double yMax, const std::string& yAxisTitle, double yAxisOffset,
+		const std::string& outputFileName);
+
+TGraph* compRatioGraph(const TGraph* graph_numerator, const TGraph* graph_denominator);
+
+void copyGraphStyle(const TGraph* graph_source, TGraph* graph_target);
+
+/**
+ * @brief Plot up to four graphs, with the ratios to graphRef shown in a separate pad below
+ */
+void showGraphs_wRatio(double canvasSizeX, double canvasSizeY,
+		       TGraph* graphRef, const std::string& legendEntryRef,
+		       TGraph* graph2, const std::string& legendEntry2,
+		       TGraph* graph3, const std::string& legendEntry3,
+		       TGraph* graph4, const std::string& legendEntry4,
+		       int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		       double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+		       const std::string& labelText, double labelTextSize,
+		       double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		       int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		       bool useLogScale, double yMin, double yMax, double yMin_ratio, double yMax_ratio, const std::string& yAxisTitle, double yAxisOffset,
+		       const std::string& outputFileName);
+
+/**
+ * @brief Plot that is rendered independently of all other plots (e.g. a call to showHistograms or showGraphs).
+ *        The histogram cache is passed to the job by renderPlots.
+ */
+typedef std::function<void(MEMbbwwHistogramCache*)> plotJobType;
+
+/**
+ * @brief Render plots in parallel, using numProcesses worker processes (0 = number of cores, 1 = render in the calling process).
+ *
+ *        ROOT graphics is not thread-safe, so the plots are rendered by processes forked from the calling process,
+ *        which share the histograms loaded before the call (copy-on-write). Each worker takes the next job that has not been started yet,
+ *        until all jobs are done. The function returns when all workers are finished
+ *        and throws an exception if one of the workers failed.
+ *        It must be called from a single-threaded process, with ROOT in batch mode.
+ */
+void renderPlots(const std::vector<plotJobType>& plotJobs, MEMbbwwHistogramCache* histogramCache, unsigned numProcesses);
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_memPerformancePlotsAuxFunctions_h
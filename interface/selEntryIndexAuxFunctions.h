@@ -0,0 +1,30 @@
+#ifndef hhAnalysis_bbwwMEMPerformanceStudies_selEntryIndexAuxFunctions_h
+#define hhAnalysis_bbwwMEMPerformanceStudies_selEntryIndexAuxFunctions_h
+
+#include <Rtypes.h> // Long64_t
+
+#include <string> // std::string
+
+/**
+ * @brief Return range [firstSelEntry, lastSelEntry) of entries in the input files that contains
+ *        the selected entries rangeIdx*maxSelEvents, ..., (rangeIdx + 1)*maxSelEvents - 1 of the index file
+ *        written by the analyzers when run with makeSelEntryIndex = True
+ *        (one 64-bit integer per entry passing the generator-level selection, in order of increasing entry index).
+ *
+ *        The last range is open-ended and is represented by lastSelEntry = -1.
+ *        The range is empty (firstSelEntry = lastSelEntry = 0) in case the index contains no more than rangeIdx*maxSelEvents entries.
+ *        The ranges need to match those counted by getNumSelEntryRanges in python/configs/selEntryIndex.py.
+ */
+void
+getSelEntryRange(const std::string & selEntryIndexFileName, int rangeIdx, int maxSelEvents, Long64_t & firstSelEntry, Long64_t & lastSelEntry);
+
+/**
+ * @brief Rename output file that has been written under the temporary name fileName + ".tmp" to fileName
+ *
+ *        The index and skim files are renamed only once the job that writes them has finished successfully,
+ *        so that the jobs depending on these files never read an incomplete index or skim file.
+ */
+void
+commitOutputFile(const std::string & fileName);
+
+#endif // hhAnalysis_bbwwMEMPerformanceStudies_selEntryIndexAuxFunctions_h
@@ -4,6 +4,7 @@ import re
 from hhAnalysis.multilepton.configs.analyzeConfig_hh import *
 from tthAnalysis.HiggsToTauTau.jobTools import create_if_not_exists
 from tthAnalysis.HiggsToTauTau.analysisTools import initDict, getKey, create_cfg, createFile, generateInputFileList
+from hhAnalysis.bbwwMEMPerformanceStudies.configs.selEntryIndex import readSelEntryIndex, getNumSelEntryRanges
 
 def getHistogramDir(category, apply_jetSmearing, apply_metSmearing):
   histogramDir = category
@@ -23,7 +24,13 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
   Sets up a folder structure by defining full path names; no directory creation is delegated here.
 
   Args specific to analyzeConfig_hh_bbwwMEM_dilepton:
-    None.
+    single_pass: if True, process all combinations of apply_jetSmearing_options and apply_metSmearing_options in the same job,
+                 so that each Ntuple file is read and the generator-level selection is run only once per event
+    use_skim: if True, the events passing the generator-level selection are written to compact skim files when the index is made,
+              and the analysis jobs read the events from the skim files instead of from the Ntuples
+              (the histograms of generator-level particles and LHE weights are not filled in this case)
+    use_sparse_histograms: if True, the finely binned MEM histograms are stored as THnSparse instead of TH1,
+                           to reduce the memory used by the analysis jobs, the size of their output files and the time needed by hadd
 
   See $CMSSW_BASE/src/tthAnalysis/HiggsToTauTau/python/analyzeConfig.py
   for documentation of further Args.
@@ -43,6 +50,9 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
         check_output_files,
         running_method,
         num_parallel_jobs,
+        single_pass       = False,
+        use_skim          = False,
+        use_sparse_histograms = False,
         select_rle_output = False,
         verbose           = False,
         isDebug           = False,
@@ -76,11 +86,15 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
     self.max_jobs_per_sample = max_jobs_per_sample
     self.apply_jetSmearing_options = apply_jetSmearing_options
     self.apply_metSmearing_options = apply_metSmearing_options
+    self.single_pass = single_pass
+    self.use_skim = use_skim
+    self.use_sparse_histograms = use_sparse_histograms
     self.cfgFile_analyze = os.path.join(self.template_dir, cfgFile_analyze)
     self.select_rle_output = select_rle_output
     self.rle_select = rle_select
     self.evtCategory_inclusive = "hh_bbwwMEM_dilepton"
     self.make_dependency_hadd_stage2 = "phony_hadd_stage1"
+    self.jobOptions_selEntryIndex = {}
 
   def createCfg_analyze(self, jobOptions, sample_info):
     """Create python configuration file for the analyze_hh_bbwwMEM_dilepton executable (analysis code)
@@ -91,11 +105,50 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
       process: either `TT` or `signal`
     """
 
-    jobOptions['histogramDir'] = getHistogramDir(self.evtCategory_inclusive, jobOptions['apply_jetSmearing'], jobOptions['apply_metSmearing'])
+    smearingVariants = jobOptions.get('smearingVariants', [])
+    if len(smearingVariants) > 1:
+      jobOptions['histogramDir'] = self.evtCategory_inclusive
+    else:
+      jobOptions['histogramDir'] = getHistogramDir(self.evtCategory_inclusive, jobOptions['apply_jetSmearing'], jobOptions['apply_metSmearing'])
     lines = super(analyzeConfig_hh_bbwwMEM_dilepton, self).createCfg_analyze(jobOptions, sample_info,
-      additionalJobOptions = [ "apply_jetSmearing", "apply_metSmearing", "maxSelEvents", "skipSelEvents" ])
+      additionalJobOptions = [ "apply_jetSmearing", "apply_metSmearing", "maxSelEvents",
+                               "firstSelEntry", "lastSelEntry", "makeSelEntryIndex", "selEntryIndexFileName", "selEntryRangeIdx",
+                               "skimFileName_output", "skimFileName_input", "fillGenHistograms" ])
+    lines.append("process.analyze_%s.useSparseHistograms = cms.bool(%s)" % (self.channel, self.use_sparse_histograms))
+    if len(smearingVariants) > 1:
+      lines.append("process.analyze_%s.smearingVariants = cms.VPSet(" % self.channel)
+      for apply_jetSmearing, apply_metSmearing in smearingVariants:
+        lines.append("  cms.PSet(apply_jetSmearing = cms.bool(%s), apply_metSmearing = cms.bool(%s), histogramDir = cms.string('%s'))," % \
+          (apply_jetSmearing, apply_metSmearing, getHistogramDir(self.evtCategory_inclusive, apply_jetSmearing, apply_metSmearing)))
+      lines.append(")")
     create_cfg(self.cfgFile_analyze, jobOptions['cfgFile_modified'], lines)
 
+  def addToMakefile_selEntryIndex(self, lines_makefile):
+    """Adds the commands to Makefile that are necessary for running the analysis code in index mode,
+       and adds the index files to the prerequisites of the analysis jobs
+    """
+    if self.jobOptions_selEntryIndex:
+      if self.is_sbatch:
+        lines_makefile.append("sbatch_selEntryIndex:")
+        lines_makefile.append("\t%s %s" % ("python", self.sbatchFile_selEntryIndex))
+        lines_makefile.append("")
+      for jobOptions in self.jobOptions_selEntryIndex.values():
+        if self.is_sbatch:
+          lines_makefile.append("%s: %s" % (jobOptions['selEntryIndexFileName'], "sbatch_selEntryIndex"))
+          lines_makefile.append("\t%s" % ":")
+        else:
+          lines_makefile.append("%s:" % jobOptions['selEntryIndexFileName'])
+          lines_makefile.append("\t%s %s > %s 2>&1" % (self.executable_analyze, jobOptions['cfgFile_modified'], jobOptions['logFile']))
+        lines_makefile.append("")
+    # rules without commands only add prerequisites to the rules for the analysis jobs written by addToMakefile_analyze
+    if self.is_sbatch:
+      selEntryIndexFiles = set(jobOptions['selEntryIndexFileName'] for jobOptions in self.jobOptions_analyze.values())
+      lines_makefile.append("%s: %s" % ("sbatch_analyze", " ".join(sorted(selEntryIndexFiles))))
+    else:
+      for jobOptions in self.jobOptions_analyze.values():
+        lines_makefile.append("%s: %s" % (jobOptions['histogramFile'], jobOptions['selEntryIndexFileName']))
+    lines_makefile.append("")
+
   def create(self):
     """Creates all necessary config files and runs the complete analysis workfow -- either locally or on the batch system
     """
@@ -130,6 +183,53 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
       logging.info("Checking input files for sample %s" % sample_info["process_name_specific"])
       inputFileLists[sample_name] = generateInputFileList(sample_info, self.max_files_per_job)
 
+    # run the analysis code once per input file in index mode, to find the entries that pass the generator-level selection
+    # (and to write these entries to a skim file, in case use_skim is enabled);
+    # the index jobs are run as part of the workflow, before the analysis jobs, which read their range of entries from the index file
+    selEntryIndexFiles = {}
+    skimFiles = {}
+    for sample_name, sample_info in self.samples.items():
+      if not sample_info["use_it"]:
+        continue
+      process_name = sample_info["process_name_specific"]
+      key_dir = getKey(process_name)
+      selEntryIndexFiles[sample_name] = {}
+      skimFiles[sample_name] = {}
+      for ntupleId, ntupleFiles in inputFileLists[sample_name].items():
+        if len(ntupleFiles) == 0:
+          continue
+        selEntryIndexFile_path = os.path.join(self.dirs[key_dir][DKEY_HIST], "selEntryIndex_%s_%s_%i.bin" % (self.channel, process_name, ntupleId))
+        skimFile_path = os.path.join(self.dirs[key_dir][DKEY_HIST], "skim_%s_%s_%i.bin" % (self.channel, process_name, ntupleId)) \
+                        if self.use_skim else None
+        selEntryIndexFiles[sample_name][ntupleId] = selEntryIndexFile_path
+        skimFiles[sample_name][ntupleId] = skimFile_path
+        if os.path.exists(selEntryIndexFile_path) and (not skimFile_path or os.path.exists(skimFile_path)):
+          logging.info("Using existing index file %s" % selEntryIndexFile_path)
+          continue
+        key_selEntryIndex_job = getKey(process_name, ntupleId)
+        self.jobOptions_selEntryIndex[key_selEntryIndex_job] = {
+          'ntupleFiles'              : ntupleFiles,
+          'cfgFile_modified'         : os.path.join(self.dirs[key_dir][DKEY_CFGS], "selEntryIndex_%s_%s_%i_cfg.py" % (self.channel, process_name, ntupleId)),
+          'histogramFile'            : os.path.join(self.dirs[key_dir][DKEY_HIST], "selEntryIndex_%s_%s_%i.root" % (self.channel, process_name, ntupleId)),
+          'logFile'                  : os.path.join(self.dirs[key_dir][DKEY_LOGS], "selEntryIndex_%s_%s_%i.log" % (self.channel, process_name, ntupleId)),
+          'selEventsFileName_output' : "",
+          'apply_jetSmearing'        : False,
+          'apply_metSmearing'        : False,
+          'maxSelEvents'             : -1,
+          'firstSelEntry'            : 0,
+          'lastSelEntry'             : -1,
+          'makeSelEntryIndex'        : True,
+          'selEntryIndexFileName'    : selEntryIndexFile_path,
+          'selEntryRangeIdx'         : -1,
+          'skimFileName_output'      : skimFile_path if skimFile_path else "",
+          'skimFileName_input'       : "",
+          'fillGenHistograms'        : False,
+        }
+        self.createCfg_analyze(self.jobOptions_selEntryIndex[key_selEntryIndex_job], sample_info)
+
+    # in single-pass mode, one job processes all smearing variants;
+    # otherwise, separate jobs are created for each combination of jet and MET smearing options
+    smearingOptions = []
     for apply_jetSmearing in self.apply_jetSmearing_options:
       jetSmearingLabel = None
       if apply_jetSmearing:
@@ -142,87 +242,102 @@ class analyzeConfig_hh_bbwwMEM_dilepton(analyzeConfig_hh):
           metSmearingLabel = "metSmearingEnabled"
         else:
           metSmearingLabel = "metSmearingDisabled"
-        for sample_name, sample_info in self.samples.items():
-          if not sample_info["use_it"]:
-            continue
-          process_name = sample_info["process_name_specific"]
-          isSignal = True if process_name.find("signal") != -1 else False
-          logging.info("Creating configuration files to run '%s' for sample %s" % (self.executable_analyze, process_name))
-          sample_category = sample_info["sample_category"]
-
-          inputFileList = inputFileLists[sample_name]
-          numJobsPerFile = None
-          if   sample_info["process_name_specific"] == "signal_ggf_nonresonant_node_sm_hh_2b2v":
-            numJobsPerFile = 500
-          elif sample_info["process_name_specific"] == "signal_ggf_nonresonant_cHHH1_hh_2b2v":
-            numJobsPerFile = 100
-          elif sample_info["process_name_specific"] == "TTJets_DiLept":
-            numJobsPerFile = 50
-          elif sample_info["process_name_specific"] == "TTJets_DiLept_ext1":
-            numJobsPerFile = 50
-          elif sample_info["process_name_specific"] == "TTTo2L2Nu": 
-            numJobsPerFile = 10
+        smearingOptions.append(("%s_%s" % (jetSmearingLabel, metSmearingLabel), [ (apply_jetSmearing, apply_metSmearing) ]))
+    if self.single_pass:
+      smearingOptions = [ ("allSmearingVariants", [ smearingVariant for _, smearingVariants in smearingOptions for smearingVariant in smearingVariants ]) ]
+
+    for smearingLabel, smearingVariants in smearingOptions:
+      apply_jetSmearing, apply_metSmearing = smearingVariants[0]
+      for sample_name, sample_info in self.samples.items():
+        if not sample_info["use_it"]:
+          continue
+        process_name = sample_info["process_name_specific"]
+        isSignal = True if process_name.find("signal") != -1 else False
+        logging.info("Creating configuration files to run '%s' for sample %s" % (self.executable_analyze, process_name))
+        sample_category = sample_info["sample_category"]
+
+        inputFileList = inputFileLists[sample_name]
+        maxSelEvents = 500
+        selEntryRanges = []
+        for ntupleId in sorted(selEntryIndexFiles[sample_name].keys()):
+          selEntryIndexFile_path = selEntryIndexFiles[sample_name][ntupleId]
+          if os.path.exists(selEntryIndexFile_path):
+            numSelEntryRanges = getNumSelEntryRanges(readSelEntryIndex(selEntryIndexFile_path), maxSelEvents)
           else:
-            raise ValueError("Invalid sample: %s" % sample_info["process_name_specific"])
-          numJobs = numJobsPerFile*len(inputFileList.keys())
-          if numJobs > self.max_jobs_per_sample:
-            print("Processing of full sample would require submission of %i jobs. Restricting the number of jobs to %i." % (numJobs, self.max_jobs_per_sample))
-            numJobs = self.max_jobs_per_sample
-          for jobId in range(1, numJobs + 1):
-            
-            ntupleId = ((jobId - 1)/numJobsPerFile) + 1
-            maxSelEvents = 500
-            skipSelEvents = maxSelEvents*((jobId - 1) % numJobsPerFile)
-
-            # build config files for executing analysis code
-            key_dir = getKey(process_name)
-            key_analyze_job = getKey(process_name, jetSmearingLabel, metSmearingLabel, jobId)
-            ntupleFiles = inputFileList[ntupleId]
-            if len(ntupleFiles) == 0:
-              logging.warning("No input ntuples for %s --> skipping job !!" % (key_analyze_job))
-              continue
-
-            cfgFile_modified_path = os.path.join(self.dirs[key_dir][DKEY_CFGS], "analyze_%s_%s_%s_%s_%i_cfg.py" % (self.channel, process_name, jetSmearingLabel, metSmearingLabel, jobId))
-            histogramFile_path = os.path.join(self.dirs[key_dir][DKEY_HIST], "analyze_%s_%s_%s_%s_%i.root" % (self.channel, process_name, jetSmearingLabel, metSmearingLabel, jobId))
-            logFile_path = os.path.join(self.dirs[key_dir][DKEY_LOGS], "analyze_%s_%s_%s_%s_%i.log" % (self.channel, process_name, jetSmearingLabel, metSmearingLabel, jobId))
-            rleOutputFile_path = os.path.join(self.dirs[key_dir][DKEY_RLES], "rle_%s_%s_%s_%s_%i.txt" % (self.channel, process_name, jetSmearingLabel, metSmearingLabel, jobId)) \
-                                 if self.select_rle_output else ""
-            self.jobOptions_analyze[key_analyze_job] = {
-              'ntupleFiles'              : ntupleFiles,
-              'cfgFile_modified'         : cfgFile_modified_path,
-              'histogramFile'            : histogramFile_path,
-              'logFile'                  : logFile_path,
-              'selEventsFileName_output' : rleOutputFile_path,
-              'apply_jetSmearing'        : apply_jetSmearing,
-              'apply_metSmearing'        : apply_metSmearing,
-              'maxSelEvents'             : maxSelEvents,
-              'skipSelEvents'            : skipSelEvents
-            }
-            self.createCfg_analyze(self.jobOptions_analyze[key_analyze_job], sample_info)
-
-            # initialize input and output file names for hadd_stage1
-            key_hadd_stage1 = getKey(process_name, jetSmearingLabel, metSmearingLabel)
-            if not key_hadd_stage1 in self.inputFiles_hadd_stage1:
-              self.inputFiles_hadd_stage1[key_hadd_stage1] = []
-            self.inputFiles_hadd_stage1[key_hadd_stage1].append(self.jobOptions_analyze[key_analyze_job]['histogramFile'])
-            self.outputFile_hadd_stage1[key_hadd_stage1] = os.path.join(self.dirs[DKEY_HIST], "histograms_harvested_stage1_%s_%s_%s_%s.root" % \
-              (self.channel, process_name, jetSmearingLabel, metSmearingLabel))
-
-          # add output files of hadd_stage1 to list of input files for hadd_stage2
-          key_hadd_stage1 = getKey(process_name, jetSmearingLabel, metSmearingLabel)
-          key_hadd_stage2 = getKey("")
-          if not key_hadd_stage2 in self.inputFiles_hadd_stage2:
-            self.inputFiles_hadd_stage2[key_hadd_stage2] = []
-          self.inputFiles_hadd_stage2[key_hadd_stage2].append(self.outputFile_hadd_stage1[key_hadd_stage1])
-          self.outputFile_hadd_stage2[key_hadd_stage2] = os.path.join(self.dirs[DKEY_HIST], "histograms_harvested_stage2_%s.root" % self.channel)
+            # the number of selected entries is known only once the index job has finished:
+            # distribute the jobs evenly among the Ntuple files (jobs whose range contains no selected entries process no events)
+            numSelEntryRanges = max(1, self.max_jobs_per_sample // len(selEntryIndexFiles[sample_name]))
+            logging.info("Index file %s does not exist yet --> creating %i jobs for Ntuple file #%i" % (selEntryIndexFile_path, numSelEntryRanges, ntupleId))
+          for selEntryRangeIdx in range(numSelEntryRanges):
+            selEntryRanges.append((ntupleId, selEntryRangeIdx))
+        numJobs = len(selEntryRanges)
+        if numJobs > self.max_jobs_per_sample:
+          print("Processing of full sample would require submission of %i jobs. Restricting the number of jobs to %i." % (numJobs, self.max_jobs_per_sample))
+          numJobs = self.max_jobs_per_sample
+        for ntupleId, selEntryRangeIdx in selEntryRanges[:numJobs]:
+
+          # build config files for executing analysis code;
+          # the jobs are labelled by Ntuple file and range of selected entries, so that the names of their output files
+          # do not change when the number of jobs per Ntuple file is updated once the index files exist
+          key_dir = getKey(process_name)
+          key_analyze_job = getKey(process_name, smearingLabel, ntupleId, selEntryRangeIdx)
+          ntupleFiles = inputFileList[ntupleId]
+          jobLabel = "%s_%s_%s_%i_%i" % (self.channel, process_name, smearingLabel, ntupleId, selEntryRangeIdx)
+
+          cfgFile_modified_path = os.path.join(self.dirs[key_dir][DKEY_CFGS], "analyze_%s_cfg.py" % jobLabel)
+          histogramFile_path = os.path.join(self.dirs[key_dir][DKEY_HIST], "analyze_%s.root" % jobLabel)
+          logFile_path = os.path.join(self.dirs[key_dir][DKEY_LOGS], "analyze_%s.log" % jobLabel)
+          rleOutputFile_path = os.path.join(self.dirs[key_dir][DKEY_RLES], "rle_%s.txt" % jobLabel) \
+                               if self.select_rle_output else ""
+          self.jobOptions_analyze[key_analyze_job] = {
+            'ntupleFiles'              : ntupleFiles,
+            'cfgFile_modified'         : cfgFile_modified_path,
+            'histogramFile'            : histogramFile_path,
+            'logFile'                  : logFile_path,
+            'selEventsFileName_output' : rleOutputFile_path,
+            'apply_jetSmearing'        : apply_jetSmearing,
+            'apply_metSmearing'        : apply_metSmearing,
+            'smearingVariants'         : smearingVariants,
+            'maxSelEvents'             : maxSelEvents,
+            'firstSelEntry'            : 0,
+            'lastSelEntry'             : -1,
+            'makeSelEntryIndex'        : False,
+            'selEntryIndexFileName'    : selEntryIndexFiles[sample_name][ntupleId],
+            'selEntryRangeIdx'         : selEntryRangeIdx,
+            'skimFileName_output'      : "",
+            'skimFileName_input'       : skimFiles[sample_name][ntupleId] if self.use_skim else "",
+            'fillGenHistograms'        : not self.use_skim,
+          }
+          self.createCfg_analyze(self.jobOptions_analyze[key_analyze_job], sample_info)
+
+          # initialize input and output file names for hadd_stage1
+          key_hadd_stage1 = getKey(process_name, smearingLabel)
+          if not key_hadd_stage1 in self.inputFiles_hadd_stage1:
+            self.inputFiles_hadd_stage1[key_hadd_stage1] = []
+          self.inputFiles_hadd_stage1[key_hadd_stage1].append(self.jobOptions_analyze[key_analyze_job]['histogramFile'])
+          self.outputFile_hadd_stage1[key_hadd_stage1] = os.path.join(self.dirs[DKEY_HIST], "histograms_harvested_stage1_%s_%s_%s.root" % \
+            (self.channel, process_name, smearingLabel))
+
+        # add output files of hadd_stage1 to list of input files for hadd_stage2
+        key_hadd_stage1 = getKey(process_name, smearingLabel)
+        key_hadd_stage2 = getKey("")
+        if not key_hadd_stage2 in self.inputFiles_hadd_stage2:
+          self.inputFiles_hadd_stage2[key_hadd_stage2] = []
+        self.inputFiles_hadd_stage2[key_hadd_stage2].append(self.outputFile_hadd_stage1[key_hadd_stage1])
+        self.outputFile_hadd_stage2[key_hadd_stage2] = os.path.join(self.dirs[DKEY_HIST], "histograms_harvested_stage2_%s.root" % self.channel)
 
     if self.is_sbatch:
+      if self.jobOptions_selEntryIndex:
+        logging.info("Creating script for submitting '%s' jobs in index mode to batch system" % self.executable_analyze)
+        self.sbatchFile_selEntryIndex = os.path.join(self.dirs[DKEY_SCRIPTS], "sbatch_selEntryIndex_%s.py" % self.channel)
+        self.createScript_sbatch_analyze(self.executable_analyze, self.sbatchFile_selEntryIndex, self.jobOptions_selEntryIndex)
       logging.info("Creating script for submitting '%s' jobs to batch system" % self.executable_analyze)
       self.sbatchFile_analyze = os.path.join(self.dirs[DKEY_SCRIPTS], "sbatch_analyze_%s.py" % self.channel)
       self.createScript_sbatch_analyze(self.executable_analyze, self.sbatchFile_analyze, self.jobOptions_analyze)
 
     logging.info("Creating Makefile")
     lines_makefile = []
+    self.addToMakefile_selEntryIndex(lines_makefile)
     self.addToMakefile_analyze(lines_makefile)
     self.addToMakefile_hadd_stage1(lines_makefile)
     self.addToMakefile_hadd_stage2(lines_makefile)
@@ -0,0 +1,23 @@
+import array
+import os
+
+def readSelEntryIndex(selEntryIndexFileName):
+  """Read the entry numbers of events passing the generator-level selection,
+     written by the analyze_hh_bbwwMEM_* executables when run with makeSelEntryIndex = True
+
+  Args:
+    selEntryIndexFileName: name of the (binary) index file, containing one 64-bit integer per selected entry
+  """
+  selEntryIndex = array.array('q')
+  with open(selEntryIndexFileName, 'rb') as selEntryIndexFile:
+    numBytes = os.path.getsize(selEntryIndexFileName)
+    selEntryIndex.fromfile(selEntryIndexFile, numBytes // selEntryIndex.itemsize)
+  return list(selEntryIndex)
+
+def getNumSelEntryRanges(selEntryIndex, maxSelEvents):
+  """Return the number of ranges of maxSelEvents selected entries into which the index is split
+
+  The analyze_hh_bbwwMEM_* executables read the range with index selEntryRangeIdx from the index file at runtime
+  (see getSelEntryRange in src/selEntryIndexAuxFunctions.cc)
+  """
+  return (len(selEntryIndex) + maxSelEvents - 1) // maxSelEvents
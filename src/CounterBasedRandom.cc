@@ -0,0 +1,64 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/CounterBasedRandom.h"
+
+#include <TMath.h> // TMath::Sqrt, TMath::Log, TMath::Cos, TMath::TwoPi
+
+namespace
+{
+  /**
+   * @brief Bijective mixing function with good avalanche properties,
+   *        taken from the SplitMix64 generator (http://xorshift.di.unimi.it/splitmix64.c)
+   */
+  ULong64_t
+  mix64(ULong64_t x)
+  {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  const ULong64_t goldenGamma = 0x9e3779b97f4a7c15ULL;
+
+  ULong64_t
+  combine(ULong64_t key, ULong64_t value)
+  {
+    return mix64(key ^ mix64(value + goldenGamma));
+  }
+}
+
+CounterBasedRandom::CounterBasedRandom(ULong64_t seed, UInt_t run, UInt_t lumi, ULong64_t event, UInt_t idxObject)
+  : key_(mix64(seed))
+  , counter_(0)
+{
+  key_ = combine(key_, run);
+  key_ = combine(key_, lumi);
+  key_ = combine(key_, event);
+  key_ = combine(key_, idxObject);
+}
+
+CounterBasedRandom::~CounterBasedRandom()
+{}
+
+double
+CounterBasedRandom::Uniform()
+{
+  ++counter_;
+  const ULong64_t bits = mix64(key_ + counter_*goldenGamma);
+  // use the upper 53 bits, so that every random number is exactly representable as double;
+  // the offset by 0.5 excludes the values 0 and 1
+  return ((bits >> 11) + 0.5)*(1./9007199254740992.);
+}
+
+double
+CounterBasedRandom::Uniform(double x1, double x2)
+{
+  return x1 + (x2 - x1)*Uniform();
+}
+
+double
+CounterBasedRandom::Gaus(double mean, double sigma)
+{
+  // Box-Muller transformation
+  const double u1 = Uniform();
+  const double u2 = Uniform();
+  return mean + sigma*TMath::Sqrt(-2.*TMath::Log(u1))*TMath::Cos(TMath::TwoPi()*u2);
+}
@@ -0,0 +1,268 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenEventSkim.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <algorithm> // std::equal, std::lower_bound
+#include <iostream> // std::cerr
+#include <cstring> // std::memset, std::memcpy
+#include <cstdint> // uint32_t
+#include <assert.h> // assert
+#include <fcntl.h> // open, O_RDONLY
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+
+namespace
+{
+  const char skimFileMagic[4] = { 'G', 'E', 'N', 'S' };
+  const uint32_t skimFileVersion = 1;
+
+  struct skimFileHeaderType
+  {
+    char magic_[4];
+    uint32_t version_;
+    uint32_t headerSize_;
+    uint32_t recordSize_;
+  };
+
+  bool
+  isValidHeader(const skimFileHeaderType & header)
+  {
+    return std::equal(header.magic_, header.magic_ + sizeof(header.magic_), skimFileMagic) &&
+      header.version_ == skimFileVersion && header.headerSize_ == sizeof(skimFileHeaderType) && header.recordSize_ == sizeof(GenEventSkimRecord);
+  }
+
+  const GenParticle &
+  getGenParticle(const GenParticle & genParticle)
+  {
+    return genParticle;
+  }
+
+  const GenParticle &
+  getGenParticle(const GenParticle * genParticle)
+  {
+    return *genParticle;
+  }
+
+  template <typename T>
+  unsigned
+  setParticles(GenEventSkimParticle * particles, unsigned maxParticles, const std::vector<T> & input, const char * name)
+  {
+    if ( input.size() > maxParticles ) {
+      std::cerr << "Warning in <GenEventSkimWriter>: Number of " << name << " = " << input.size()
+                << " exceeds capacity of skim record = " << maxParticles << " --> dropping the " << name << " of lowest pT !!" << std::endl;
+    }
+    unsigned numParticles = 0;
+    for ( typename std::vector<T>::const_iterator particle = input.begin();
+          particle != input.end() && numParticles < maxParticles; ++particle ) {
+      const GenParticle & genParticle = getGenParticle(*particle);
+      particles[numParticles].pt_ = genParticle.pt();
+      particles[numParticles].eta_ = genParticle.eta();
+      particles[numParticles].phi_ = genParticle.phi();
+      particles[numParticles].mass_ = genParticle.mass();
+      particles[numParticles].pdgId_ = genParticle.pdgId();
+      ++numParticles;
+    }
+    return numParticles;
+  }
+}
+
+GenEventSkimWriter::GenEventSkimWriter(const std::string & fileName)
+  : fileName_(fileName)
+  , file_(nullptr)
+  , numEvents_(0)
+{
+  std::memset(&record_, 0, sizeof(record_));
+  file_ = new std::ofstream(fileName_.data(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if ( !(*file_) )
+    throw cms::Exception("GenEventSkimWriter")
+      << "Failed to open file = " << fileName_ << " !!\n";
+  skimFileHeaderType header;
+  std::memcpy(header.magic_, skimFileMagic, sizeof(skimFileMagic));
+  header.version_ = skimFileVersion;
+  header.headerSize_ = sizeof(skimFileHeaderType);
+  header.recordSize_ = sizeof(GenEventSkimRecord);
+  file_->write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+GenEventSkimWriter::~GenEventSkimWriter()
+{
+  delete file_;
+}
+
+void
+GenEventSkimWriter::set(Long64_t entry, const EventInfo & eventInfo, double lheWeight_scale_central, double genMEtPx, double genMEtPy)
+{
+  // reset the record, so that unused particle slots and padding bytes are written as zeros
+  std::memset(&record_, 0, sizeof(record_));
+  record_.entry_ = entry;
+  record_.run_ = eventInfo.run;
+  record_.lumi_ = eventInfo.lumi;
+  record_.event_ = eventInfo.event;
+  record_.genWeight_ = eventInfo.genWeight;
+  record_.pileupWeight_ = eventInfo.pileupWeight;
+  record_.lheWeight_scale_central_ = lheWeight_scale_central;
+  record_.genMEtPx_ = genMEtPx;
+  record_.genMEtPy_ = genMEtPy;
+}
+
+void
+GenEventSkimWriter::setGenLeptons(const std::vector<GenLepton> & genLeptons)
+{
+  record_.numGenLeptons_ = setParticles(record_.genLeptons_, GenEventSkimRecord::maxGenLeptons, genLeptons, "genLeptons");
+}
+
+void
+GenEventSkimWriter::setGenBJets(const std::vector<GenJet> & genBJets)
+{
+  record_.numGenBJets_ = setParticles(record_.genBJets_, GenEventSkimRecord::maxGenBJets, genBJets, "genBJets");
+}
+
+void
+GenEventSkimWriter::setGenWJets(const std::vector<GenJet> & genWJets)
+{
+  record_.numGenWJets_ = setParticles(record_.genWJets_, GenEventSkimRecord::maxGenWJets, genWJets, "genWJets");
+}
+
+void
+GenEventSkimWriter::setGenJets(const std::vector<const GenJet *> & genJets)
+{
+  record_.numGenJets_ = setParticles(record_.genJets_, GenEventSkimRecord::maxGenJets, genJets, "genJets");
+}
+
+void
+GenEventSkimWriter::write()
+{
+  file_->write(reinterpret_cast<const char *>(&record_), sizeof(record_));
+  if ( !(*file_) )
+    throw cms::Exception("GenEventSkimWriter")
+      << "Failed to write to file = " << fileName_ << " !!\n";
+  ++numEvents_;
+}
+
+Long64_t
+GenEventSkimWriter::numEvents() const
+{
+  return numEvents_;
+}
+
+GenEventSkimReader::GenEventSkimReader(const std::string & fileName, Long64_t maxEntry, EventInfo * eventInfo)
+  : fileName_(fileName)
+  , fd_(-1)
+  , fileSize_(0)
+  , data_(nullptr)
+  , records_(nullptr)
+  , numEvents_(0)
+  , maxEntry_(maxEntry)
+  , currentEvent_(-1)
+  , eventInfo_(eventInfo)
+{
+  fd_ = open(fileName_.data(), O_RDONLY);
+  if ( fd_ < 0 )
+    throw cms::Exception("GenEventSkimReader")
+      << "Failed to open file = " << fileName_ << " !!\n";
+  struct stat fileStat;
+  if ( fstat(fd_, &fileStat) != 0 )
+    throw cms::Exception("GenEventSkimReader")
+      << "Failed to determine size of file = " << fileName_ << " !!\n";
+  fileSize_ = fileStat.st_size;
+  if ( fileSize_ < sizeof(skimFileHeaderType) )
+    throw cms::Exception("GenEventSkimReader")
+      << "File = " << fileName_ << " is too small to be a skim file !!\n";
+  void * data = mmap(nullptr, fileSize_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if ( data == MAP_FAILED )
+    throw cms::Exception("GenEventSkimReader")
+      << "Failed to map file = " << fileName_ << " into memory !!\n";
+  data_ = static_cast<const char *>(data);
+  // the events are read in the order in which they are stored
+  madvise(data, fileSize_, MADV_SEQUENTIAL);
+
+  const skimFileHeaderType * header = reinterpret_cast<const skimFileHeaderType *>(data_);
+  if ( !isValidHeader(*header) )
+    throw cms::Exception("GenEventSkimReader")
+      << "File = " << fileName_ << " is not a skim file of version = " << skimFileVersion << " !!\n";
+  if ( (fileSize_ - header->headerSize_) % header->recordSize_ != 0 )
+    throw cms::Exception("GenEventSkimReader")
+      << "File = " << fileName_ << " contains an incomplete record !!\n";
+  numEvents_ = (fileSize_ - header->headerSize_)/header->recordSize_;
+  records_ = reinterpret_cast<const GenEventSkimRecord *>(data_ + header->headerSize_);
+}
+
+GenEventSkimReader::~GenEventSkimReader()
+{
+  if ( data_ ) munmap(const_cast<char *>(data_), fileSize_);
+  if ( fd_ >= 0 ) close(fd_);
+}
+
+void
+GenEventSkimReader::setFirstEntry(Long64_t firstEntry)
+{
+  assert(currentEvent_ == -1);
+  // the records are stored in order of increasing entry index
+  const GenEventSkimRecord * firstRecord = std::lower_bound(records_, records_ + numEvents_, firstEntry,
+    [](const GenEventSkimRecord & record, Long64_t entry) { return record.entry_ < entry; });
+  currentEvent_ = (firstRecord - records_) - 1;
+}
+
+bool
+GenEventSkimReader::hasNextEvent()
+{
+  if ( currentEvent_ + 1 >= numEvents_ ) return false;
+  const GenEventSkimRecord & record = records_[currentEvent_ + 1];
+  // the records are stored in order of increasing entry index
+  if ( maxEntry_ >= 0 && record.entry_ >= maxEntry_ ) return false;
+  ++currentEvent_;
+  if ( eventInfo_ ) {
+    eventInfo_->run = record.run_;
+    eventInfo_->lumi = record.lumi_;
+    eventInfo_->event = record.event_;
+    eventInfo_->genWeight = record.genWeight_;
+    eventInfo_->pileupWeight = record.pileupWeight_;
+  }
+  return true;
+}
+
+const GenEventSkimRecord &
+GenEventSkimReader::getEvent() const
+{
+  assert(currentEvent_ >= 0 && currentEvent_ < numEvents_);
+  return records_[currentEvent_];
+}
+
+Long64_t
+GenEventSkimReader::numEvents() const
+{
+  return numEvents_;
+}
+
+Long64_t
+GenEventSkimReader::numEventsRead() const
+{
+  return currentEvent_ + 1;
+}
+
+bool
+GenEventSkimReader::canReport(unsigned reportEvery) const
+{
+  return reportEvery > 0 && currentEvent_ >= 0 && (currentEvent_ % reportEvery) == 0;
+}
+
+void
+getGenLeptons(const GenEventSkimParticle * particles, unsigned numParticles, std::vector<GenLepton> & genLeptons)
+{
+  genLeptons.clear();
+  for ( unsigned idxParticle = 0; idxParticle < numParticles; ++idxParticle ) {
+    const GenEventSkimParticle & particle = particles[idxParticle];
+    genLeptons.push_back(GenLepton(particle.pt_, particle.eta_, particle.phi_, particle.mass_, particle.pdgId_));
+  }
+}
+
+void
+getGenJets(const GenEventSkimParticle * particles, unsigned numParticles, std::vector<GenJet> & genJets)
+{
+  genJets.clear();
+  for ( unsigned idxParticle = 0; idxParticle < numParticles; ++idxParticle ) {
+    const GenEventSkimParticle & particle = particles[idxParticle];
+    genJets.push_back(GenJet(particle.pt_, particle.eta_, particle.phi_, particle.mass_, particle.pdgId_));
+  }
+}
@@ -1,12 +1,13 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenJetSmearer.h"
 
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/CounterBasedRandom.h" // CounterBasedRandom
+
 #include <TMath.h> // TMath::Sqrt, TMath::Max
 
 GenJetSmearer::GenJetSmearer()
   : coeff_(1.00) // CV: take jet pT resolution to be 100%*sqrt(pT)
-{
-  rnd_.SetSeed(0);
-}
+  , seed_(1)
+{}
 
 GenJetSmearer::~GenJetSmearer()
 {}
@@ -23,11 +24,18 @@ GenJetSmearer::get_coeff() const
   return coeff_;
 }
 
+void 
+GenJetSmearer::set_seed(ULong64_t seed)
+{
+  seed_ = seed;
+}
+
 GenJet
-GenJetSmearer::operator()(const GenJet& jet) const
+GenJetSmearer::operator()(const GenJet& jet, const EventInfo& eventInfo, UInt_t idxObject) const
 {
+  CounterBasedRandom rnd(seed_, eventInfo.run, eventInfo.lumi, eventInfo.event, idxObject);
   double sigma = coeff_*TMath::Sqrt(TMath::Max(1., jet.pt()));
-  double jetPt_smeared = rnd_.Gaus(jet.pt(), sigma);
+  double jetPt_smeared = rnd.Gaus(jet.pt(), sigma);
   GenJet jet_smeared(jetPt_smeared, jet.eta(), jet.phi(), jet.mass(), jet.pdgId());
   return jet_smeared;
 }
@@ -1,11 +1,12 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/GenMEtSmearer.h"
 
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/CounterBasedRandom.h" // CounterBasedRandom
+
 GenMEtSmearer::GenMEtSmearer()
   : sigmaX_(25.)
   , sigmaY_(25.)
-{
-  rnd_.SetSeed(0);
-}
+  , seed_(2)
+{}
 
 GenMEtSmearer::~GenMEtSmearer()
 {}
@@ -34,11 +35,18 @@ GenMEtSmearer::get_sigmaY() const
   return sigmaY_;
 }
 
+void 
+GenMEtSmearer::set_seed(ULong64_t seed)
+{
+  seed_ = seed;
+}
+
 GenMEt 
-GenMEtSmearer::operator()(const GenMEt& met) const
+GenMEtSmearer::operator()(const GenMEt& met, const EventInfo& eventInfo) const
 {
-  double metPx_smeared = rnd_.Gaus(met.px(), sigmaX_);
-  double metPy_smeared = rnd_.Gaus(met.py(), sigmaY_);
+  CounterBasedRandom rnd(seed_, eventInfo.run, eventInfo.lumi, eventInfo.event);
+  double metPx_smeared = rnd.Gaus(met.px(), sigmaX_);
+  double metPy_smeared = rnd.Gaus(met.py(), sigmaY_);
   GenMEt met_smeared(metPx_smeared, metPy_smeared);
   return met_smeared;
 }
@@ -3,12 +3,16 @@
 #include "tthAnalysis/tthMEM/interface/JetTransferFunction.h" // gaussianPDF
 #include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::bottomQuarkMass2
 
-#include <TMath.h> // TMath::Sqrt, TMath::CosH
+#include <TMath.h> // TMath::Sqrt, TMath::CosH, TMath::Pi
+
+#include <algorithm> // std::max
+#include <cmath>     // std::sqrt, std::exp
 
 using namespace mem;
 
 HadWJetTF_toy::HadWJetTF_toy(int verbosity)
   : HadWJetTF(verbosity)
+  , measuredCoshEta_(1.)
   , coeff_(1.00) // CV: take jet pT resolution to be 100%/sqrt(pT)
 {}
 
@@ -24,6 +28,7 @@ void HadWJetTF_toy::setInputs(const mem::LorentzVector& measuredP4)
 {
   HadWJetTF::setInputs(measuredP4);
   measuredPt_ = measuredP4.pt();
+  measuredCoshEta_ = TMath::CosH(measuredEta_);
 }
 
 double HadWJetTF_toy::Eval(double trueEn) const
@@ -32,9 +37,25 @@ double HadWJetTF_toy::Eval(double trueEn) const
   double prob = 0.;
   if ( trueEn > bottomQuarkMass ) {
     double trueP = TMath::Sqrt(trueEn*trueEn - bottomQuarkMass2);
-    double truePt = trueP/TMath::CosH(measuredEta_);
+    double truePt = trueP/measuredCoshEta_;
     double sigma = coeff_/TMath::Sqrt(TMath::Max(1., truePt));
     prob = tthMEM::functions::gaussianPDF(measuredPt_, truePt, sigma);
   }
   return prob;
 }
+
+void HadWJetTF_toy::Eval(const double* trueEn, double* out, size_t n) const
+{
+  // same formulae as for the scalar version, written without branches and function calls other than sqrt and exp,
+  // so that the compiler can vectorize the loop
+  const double norm = 1./std::sqrt(2.*TMath::Pi());
+  for ( size_t idx = 0; idx < n; ++idx ) {
+    const double trueEn_i = trueEn[idx];
+    const double trueP = std::sqrt(std::max(0., trueEn_i*trueEn_i - bottomQuarkMass2));
+    const double truePt = trueP/measuredCoshEta_;
+    const double sigma = coeff_/std::sqrt(std::max(1., truePt));
+    const double pull = (measuredPt_ - truePt)/sigma;
+    const double prob = norm*std::exp(-0.5*pull*pull)/sigma;
+    out[idx] = ( trueEn_i > bottomQuarkMass ) ? prob : 0.;
+  }
+}
@@ -1,17 +1,118 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent.h"
 
+#include <assert.h> // assert
+
+MEMEventParticle::MEMEventParticle()
+  : pt_(0.)
+  , eta_(0.)
+  , phi_(0.)
+  , mass_(0.)
+  , type_(-1)
+  , charge_(0)
+  , pdgId_(0)
+  , isValid_(false)
+{}
+
+MEMEventParticle::MEMEventParticle(const mem::MeasuredParticle* measuredParticle)
+  : MEMEventParticle()
+{
+  if ( measuredParticle )
+  {
+    pt_      = measuredParticle->pt();
+    eta_     = measuredParticle->eta();
+    phi_     = measuredParticle->phi();
+    mass_    = measuredParticle->mass();
+    type_    = measuredParticle->type();
+    charge_  = measuredParticle->charge();
+    isValid_ = true;
+  }
+}
+
+MEMEventParticle::MEMEventParticle(const GenParticle* genParticle)
+  : MEMEventParticle()
+{
+  if ( genParticle )
+  {
+    pt_      = genParticle->pt();
+    eta_     = genParticle->eta();
+    phi_     = genParticle->phi();
+    mass_    = genParticle->mass();
+    charge_  = genParticle->charge();
+    pdgId_   = genParticle->pdgId();
+    isValid_ = true;
+  }
+}
+
+math::PtEtaPhiMLorentzVector 
+MEMEventParticle::p4() const
+{
+  return math::PtEtaPhiMLorentzVector(pt_, eta_, phi_, mass_);
+}
+
+mem::MeasuredParticle 
+MEMEventParticle::measuredParticle() const
+{
+  assert(isValid_ && type_ != -1);
+  return mem::MeasuredParticle(type_, pt_, eta_, phi_, mass_, charge_);
+}
+
+MEMEventMEtCov::MEMEventMEtCov()
+  : cov00_(0.)
+  , cov01_(0.)
+  , cov11_(0.)
+{}
+
+MEMEventMEtCov::MEMEventMEtCov(const TMatrixD& cov)
+  : cov00_(cov(0, 0))
+  , cov01_(cov(0, 1))
+  , cov11_(cov(1, 1))
+{}
+
+MEMEventResult::MEMEventResult()
+  : prob_signal_(0.)
+  , probErr_signal_(0.)
+  , prob_background_(0.)
+  , probErr_background_(0.)
+  , likelihoodRatio_(0.)
+  , likelihoodRatioErr_(0.)
+{}
+
+MEMEventResult::MEMEventResult(const MEMResultBase& memResult)
+  : prob_signal_(memResult.getProb_signal())
+  , probErr_signal_(memResult.getProbErr_signal())
+  , prob_background_(memResult.getProb_background())
+  , probErr_background_(memResult.getProbErr_background())
+  , likelihoodRatio_(memResult.getLikelihoodRatio())
+  , likelihoodRatioErr_(memResult.getLikelihoodRatioErr())
+{}
+
+MEMEvent::MEMEvent()
+  : isSignal_(false)
+  , isBoosted_Hbb_(false)
+  , numMeasuredBJets_(0)
+  , numGenBJets_(0)
+  , numMeasuredBJets_loose_(0)
+  , numMeasuredBJets_medium_(0)
+  , measuredMEtPx_(0.)
+  , genMEtPx_(0.)
+  , measuredMEtPy_(0.)
+  , genMEtPy_(0.)
+  , memCpuTime_(-1.)
+  , barcode_(-1)
+{}
+
 MEMEvent::MEMEvent(const MEMEventInfo & eventInfo, bool isSignal,
                    const mem::MeasuredParticle* measuredBJet1, const mem::MeasuredParticle* measuredBJet2, 
                    double measuredMEtPx, double measuredMEtPy, const TMatrixD& measuredMEtCov)
     : eventInfo_(eventInfo)
     , isSignal_(isSignal)
     , measuredBJet1_(measuredBJet1)
-    , genBJet1_(nullptr)
     , measuredBJet2_(measuredBJet2)
-    , genBJet2_(nullptr)
     , isBoosted_Hbb_(false)
     , numMeasuredBJets_(0)
     , numGenBJets_(0)
+    , numMeasuredBJets_loose_(0)
+    , numMeasuredBJets_medium_(0)
     , measuredMEtPx_(measuredMEtPx)
     , genMEtPx_(0.)
     , measuredMEtPy_(measuredMEtPy)
@@ -23,28 +124,25 @@ MEMEvent::MEMEvent(const MEMEventInfo & eventInfo, bool isSignal,
   countMeasuredBJets();
 }
 
-MEMEvent::~MEMEvent()
-{}
-
 void 
-MEMEvent::set_genBJet1(const GenJet* genBJet1)
+MEMEvent::set_genBJet1(const GenParticle* genBJet1)
 {
-  genBJet1_ = genBJet1;
+  genBJet1_ = MEMEventParticle(genBJet1);
   countGenBJets();
 }
 
 void 
-MEMEvent::set_genBJet2(const GenJet* genBJet2)
+MEMEvent::set_genBJet2(const GenParticle* genBJet2)
 {
-  genBJet2_ = genBJet2;
+  genBJet2_ = MEMEventParticle(genBJet2);
   countGenBJets();
 }
 
 void 
 MEMEvent::set_numGenBJets(int numGenBJets)
 {
-  genBJet1_ = nullptr;
-  genBJet2_ = nullptr;
+  genBJet1_ = MEMEventParticle();
+  genBJet2_ = MEMEventParticle();
   numGenBJets_ = numGenBJets;
 }
 
@@ -82,7 +180,7 @@ MEMEvent::set_numMeasuredBJets_medium(int numMeasuredBJets_medium)
 void 
 MEMEvent::set_memResult(const MEMResultBase& memResult)
 {
-  memResult_ = memResult;
+  memResult_ = MEMEventResult(memResult);
 }
 
 void 
@@ -91,6 +189,12 @@ MEMEvent::set_memCpuTime(double memCpuTime)
   memCpuTime_ = memCpuTime;
 }
 
+void 
+MEMEvent::set_memIntegrationStats(const MEMbbwwIntegrationStats& memIntegrationStats)
+{
+  memIntegrationStats_ = memIntegrationStats;
+}
+
 void 
 MEMEvent::set_barcode(int barcode)
 {
@@ -109,25 +213,25 @@ MEMEvent::isSignal() const
   return isSignal_;
 }
 
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent::measuredBJet1() const
 {
   return measuredBJet1_;
 }
   
-const GenJet* 
+const MEMEventParticle &
 MEMEvent::genBJet1() const
 {
   return genBJet1_;
 }
   
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent::measuredBJet2() const
 {
   return measuredBJet2_;
 }
 
-const GenJet* 
+const MEMEventParticle &
 MEMEvent::genBJet2() const
 {
   return genBJet2_;
@@ -187,13 +291,13 @@ MEMEvent::genMEtPy() const
   return genMEtPy_;
 }
 
-const TMatrixD &
+const MEMEventMEtCov &
 MEMEvent::measuredMEtCov() const
 {
   return measuredMEtCov_;
 }
   
-const MEMResultBase &
+const MEMEventResult &
 MEMEvent::memResult() const
 {
   return memResult_;
@@ -204,6 +308,12 @@ MEMEvent::memCpuTime() const
 {
   return memCpuTime_;
 }
+
+const MEMbbwwIntegrationStats &
+MEMEvent::memIntegrationStats() const
+{
+  return memIntegrationStats_;
+}
   
 int 
 MEMEvent::barcode() const
@@ -215,14 +325,14 @@ void
 MEMEvent::countMeasuredBJets()
 {
   numMeasuredBJets_ = 0;
-  if ( measuredBJet1_ ) ++numMeasuredBJets_;
-  if ( measuredBJet2_ ) ++numMeasuredBJets_;
+  if ( measuredBJet1_.isValid() ) ++numMeasuredBJets_;
+  if ( measuredBJet2_.isValid() ) ++numMeasuredBJets_;
 }
 
 void 
 MEMEvent::countGenBJets()
 {
   numGenBJets_ = 0;
-  if ( genBJet1_ ) ++numGenBJets_;
-  if ( genBJet2_ ) ++numGenBJets_;
+  if ( genBJet1_.isValid() ) ++numGenBJets_;
+  if ( genBJet2_.isValid() ) ++numGenBJets_;
 }
@@ -1,58 +1,65 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent_dilepton.h"
 
+MEMEvent_dilepton::MEMEvent_dilepton()
+  : MEMEvent()
+  , numMeasuredLeptons_(0)
+  , numGenLeptons_(0)
+{}
+
 MEMEvent_dilepton::MEMEvent_dilepton(const MEMEventInfo & eventInfo, bool isSignal,
                                      const mem::MeasuredParticle* measuredBJet1, const mem::MeasuredParticle* measuredBJet2, 
                                      const mem::MeasuredParticle* measuredLepton1, const mem::MeasuredParticle* measuredLepton2, 
                                      double measuredMEtPx, double measuredMEtPy, const TMatrixD& measuredMEtCov)
   : MEMEvent(eventInfo, isSignal, measuredBJet1, measuredBJet2, measuredMEtPx, measuredMEtPy, measuredMEtCov)
   , measuredLepton1_(measuredLepton1)
-  , genLepton1_(nullptr)
   , measuredLepton2_(measuredLepton2)
-  , genLepton2_(nullptr)
-{}
-
-MEMEvent_dilepton::~MEMEvent_dilepton()
-{}
+  , numMeasuredLeptons_(0)
+  , numGenLeptons_(0)
+{
+  countMeasuredLeptons();
+}
 
 void 
-MEMEvent_dilepton::set_genLepton1(const GenLepton* genLepton1)
+MEMEvent_dilepton::set_genLepton1(const GenParticle* genLepton1)
 {
-  genLepton1_ = genLepton1;
+  genLepton1_ = MEMEventParticle(genLepton1);
+  countGenLeptons();
 }
   
 void 
-MEMEvent_dilepton::set_genLepton2(const GenLepton* genLepton2)
+MEMEvent_dilepton::set_genLepton2(const GenParticle* genLepton2)
 {
-  genLepton2_ = genLepton2;
+  genLepton2_ = MEMEventParticle(genLepton2);
+  countGenLeptons();
 }
 
 void 
 MEMEvent_dilepton::set_numGenLeptons(int numGenLeptons)
 {
-  genLepton1_ = nullptr;
-  genLepton2_ = nullptr;
+  genLepton1_ = MEMEventParticle();
+  genLepton2_ = MEMEventParticle();
   numGenLeptons_ = numGenLeptons;
 }
 
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent_dilepton::measuredLepton1() const
 {
   return measuredLepton1_;
 }
 
-const GenLepton* 
+const MEMEventParticle &
 MEMEvent_dilepton::genLepton1() const
 {
   return genLepton1_;
 }
 
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent_dilepton::measuredLepton2() const
 {
   return measuredLepton2_;
 }
 
-const GenLepton* 
+const MEMEventParticle &
 MEMEvent_dilepton::genLepton2() const
 {
   return genLepton2_;
@@ -74,15 +81,15 @@ void
 MEMEvent_dilepton::countMeasuredLeptons()
 {
   numMeasuredLeptons_ = 0;
-  if ( measuredLepton1_ ) ++numMeasuredLeptons_;
-  if ( measuredLepton2_ ) ++numMeasuredLeptons_;
+  if ( measuredLepton1_.isValid() ) ++numMeasuredLeptons_;
+  if ( measuredLepton2_.isValid() ) ++numMeasuredLeptons_;
 }
 
 void 
 MEMEvent_dilepton::countGenLeptons()
 {
   numGenLeptons_ = 0;
-  if ( genLepton1_ ) ++numGenLeptons_;
-  if ( genLepton2_ ) ++numGenLeptons_;
+  if ( genLepton1_.isValid() ) ++numGenLeptons_;
+  if ( genLepton2_.isValid() ) ++numGenLeptons_;
 }
 
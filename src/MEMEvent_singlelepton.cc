@@ -1,5 +1,14 @@
 #include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMEvent_singlelepton.h"
 
+MEMEvent_singlelepton::MEMEvent_singlelepton()
+  : MEMEvent()
+  , isBoosted_Wjj_(false)
+  , numMeasuredWJets_(0)
+  , numGenWJets_(0)
+  , numMeasuredLeptons_(0)
+  , numGenLeptons_(0)
+{}
+
 MEMEvent_singlelepton::MEMEvent_singlelepton(const MEMEventInfo & eventInfo, bool isSignal,
                                              const mem::MeasuredParticle* measuredBJet1, const mem::MeasuredParticle* measuredBJet2, 
                                              const mem::MeasuredParticle* measuredWJet1, const mem::MeasuredParticle* measuredWJet2, 
@@ -7,37 +16,36 @@ MEMEvent_singlelepton::MEMEvent_singlelepton(const MEMEventInfo & eventInfo, boo
                                              double measuredMEtPx, double measuredMEtPy, const TMatrixD& measuredMEtCov)
   : MEMEvent(eventInfo, isSignal, measuredBJet1, measuredBJet2, measuredMEtPx, measuredMEtPy, measuredMEtCov)
   , measuredWJet1_(measuredWJet1)
-  , genWJet1_(nullptr)
   , measuredWJet2_(measuredWJet2)
-  , genWJet2_(nullptr)
   , isBoosted_Wjj_(false)
   , numMeasuredWJets_(0)
   , numGenWJets_(0)
   , measuredLepton_(measuredLepton)
-  , genLepton_(nullptr)
-{}
-
-MEMEvent_singlelepton::~MEMEvent_singlelepton()
-{}
+  , numMeasuredLeptons_(0)
+  , numGenLeptons_(0)
+{
+  countMeasuredWJets();
+  countMeasuredLeptons();
+}
 
 void 
-MEMEvent_singlelepton::set_genWJet1(const GenJet* genWJet1)
+MEMEvent_singlelepton::set_genWJet1(const GenParticle* genWJet1)
 {
-  genWJet1_ = genWJet1;
+  genWJet1_ = MEMEventParticle(genWJet1);
   countGenWJets();
 }
 
 void 
-MEMEvent_singlelepton::set_genWJet2(const GenJet* genWJet2)
+MEMEvent_singlelepton::set_genWJet2(const GenParticle* genWJet2)
 {
-  genWJet2_ = genWJet2;
+  genWJet2_ = MEMEventParticle(genWJet2);
   countGenWJets();
 }
 
 void MEMEvent_singlelepton::set_numGenWJets(int numGenWJets)
 {
-  genWJet1_ = nullptr;
-  genWJet2_ = nullptr;
+  genWJet1_ = MEMEventParticle();
+  genWJet2_ = MEMEventParticle();
   numGenWJets_ = numGenWJets;
 }
 
@@ -48,37 +56,38 @@ MEMEvent_singlelepton::set_isBoosted_Wjj(bool isBoosted_Wjj)
 }
 
 void 
-MEMEvent_singlelepton::set_genLepton(const GenLepton* genLepton)
+MEMEvent_singlelepton::set_genLepton(const GenParticle* genLepton)
 {
-  genLepton_ = genLepton;
+  genLepton_ = MEMEventParticle(genLepton);
+  countGenLeptons();
 }
 
 void 
 MEMEvent_singlelepton::set_numGenLeptons(int numGenLeptons)
 {
-  genLepton_ = nullptr;
+  genLepton_ = MEMEventParticle();
   numGenLeptons_ = numGenLeptons;
 }
 
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent_singlelepton::measuredWJet1() const
 {
   return measuredWJet1_;
 }
   
-const GenJet* 
+const MEMEventParticle &
 MEMEvent_singlelepton::genWJet1() const
 {
   return genWJet1_;
 }
   
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent_singlelepton::measuredWJet2() const
 {
   return measuredWJet2_;
 }
 
-const GenJet* 
+const MEMEventParticle &
 MEMEvent_singlelepton::genWJet2() const
 {
   return genWJet2_;
@@ -102,13 +111,13 @@ MEMEvent_singlelepton::numGenWJets() const
   return numGenWJets_;
 }
 
-const mem::MeasuredParticle* 
+const MEMEventParticle &
 MEMEvent_singlelepton::measuredLepton() const
 {
   return measuredLepton_;
 }
 
-const GenLepton* 
+const MEMEventParticle &
 MEMEvent_singlelepton::genLepton() const
 {
   return genLepton_;
@@ -130,29 +139,29 @@ void
 MEMEvent_singlelepton::countMeasuredWJets()
 {
   numMeasuredWJets_ = 0;
-  if ( measuredWJet1_ ) ++numMeasuredWJets_;
-  if ( measuredWJet2_ ) ++numMeasuredWJets_;
+  if ( measuredWJet1_.isValid() ) ++numMeasuredWJets_;
+  if ( measuredWJet2_.isValid() ) ++numMeasuredWJets_;
 }
 
 void 
 MEMEvent_singlelepton::countGenWJets()
 {
   numGenWJets_ = 0;
-  if ( genWJet1_ ) ++numGenWJets_;
-  if ( genWJet2_ ) ++numGenWJets_;
+  if ( genWJet1_.isValid() ) ++numGenWJets_;
+  if ( genWJet2_.isValid() ) ++numGenWJets_;
 }
 
 void 
 MEMEvent_singlelepton::countMeasuredLeptons()
 {
   numMeasuredLeptons_ = 0;
-  if ( measuredLepton_ ) ++numMeasuredLeptons_;
+  if ( measuredLepton_.isValid() ) ++numMeasuredLeptons_;
 }
 
 void 
 MEMEvent_singlelepton::countGenLeptons()
 {
   numGenLeptons_ = 0;
-  if ( genLepton_ ) ++numGenLeptons_;
+  if ( genLepton_.isValid() ) ++numGenLeptons_;
 }
 
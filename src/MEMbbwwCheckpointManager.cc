@@ -0,0 +1,304 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwCheckpointManager.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TDirectory.h> // TDirectory, gDirectory
+#include <TFile.h> // TFile
+#include <TH1.h> // TH1
+#include <THnSparse.h> // THnSparse
+#include <TKey.h> // TKey
+#include <TList.h> // TList, TIter
+#include <TNamed.h> // TNamed
+#include <TParameter.h> // TParameter<>
+#include <TSystem.h> // gSystem
+#include <TTree.h> // TTree
+
+#include <iostream> // std::cout
+#include <set> // std::set<>
+#include <string> // std::to_string
+#include <assert.h> // assert
+#include <cerrno> // errno, ENOENT
+#include <unistd.h> // truncate
+
+namespace
+{
+  const char * checkpointDirName = "checkpoint";
+
+  bool
+  hasCheckpoint(const std::string & fileName)
+  {
+    // TSystem::AccessPathName returns false in case the file exists
+    if ( gSystem->AccessPathName(fileName.data()) ) return false;
+    TDirectory * dir_current = gDirectory;
+    TFile * file = TFile::Open(fileName.data(), "READ");
+    bool retVal = file && !file->IsZombie() && file->GetDirectory(checkpointDirName);
+    delete file;
+    dir_current->cd();
+    return retVal;
+  }
+
+  template <typename T>
+  T
+  readParameter(TDirectory * dir, const std::string & name)
+  {
+    TParameter<T> * parameter = dynamic_cast<TParameter<T> *>(dir->Get(name.data()));
+    if ( !parameter )
+      throw cms::Exception("MEMbbwwCheckpointManager")
+        << "Failed to read parameter = " << name << " from checkpoint !!\n";
+    T value = parameter->GetVal();
+    delete parameter;
+    return value;
+  }
+
+  template <typename T>
+  void
+  writeParameter(TDirectory * dir, const std::string & name, const T & value)
+  {
+    TParameter<T> parameter(name.data(), value);
+    dir->WriteTObject(&parameter, name.data(), "Overwrite");
+  }
+
+  // strings are stored as title of a TNamed object, as TParameter<> supports only arithmetic types
+  std::string
+  readString(TDirectory * dir, const std::string & name)
+  {
+    TNamed * named = dynamic_cast<TNamed *>(dir->Get(name.data()));
+    if ( !named )
+      throw cms::Exception("MEMbbwwCheckpointManager")
+        << "Failed to read string = " << name << " from checkpoint !!\n";
+    std::string value = named->GetTitle();
+    delete named;
+    return value;
+  }
+
+  void
+  writeString(TDirectory * dir, const std::string & name, const std::string & value)
+  {
+    TNamed named(name.data(), value.data());
+    dir->WriteTObject(&named, name.data(), "Overwrite");
+  }
+
+  void
+  restore_recursively(TDirectory * dir_checkpoint, TDirectory * dir_output)
+  {
+    std::set<std::string> names;
+    TIter next(dir_checkpoint->GetListOfKeys());
+    while ( TKey * key = dynamic_cast<TKey *>(next()) ) {
+      std::string name = key->GetName();
+      // keys are sorted by decreasing cycle number, take only the most recent cycle of each object
+      if ( names.find(name) != names.end() ) continue;
+      names.insert(name);
+      if ( dir_checkpoint == dir_checkpoint->GetFile() && name == checkpointDirName ) continue;
+      TObject * object = key->ReadObj();
+      if ( TDirectory * subdir_checkpoint = dynamic_cast<TDirectory *>(object) ) {
+        TDirectory * subdir_output = dir_output->GetDirectory(name.data());
+        if ( subdir_output ) {
+          restore_recursively(subdir_checkpoint, subdir_output);
+        } else {
+          std::cout << "Warning in <MEMbbwwCheckpointManager::restore>: No directory = " << name
+                    << " booked in " << dir_output->GetPath() << " --> skipping !!" << std::endl;
+        }
+      } else if ( TH1 * histogram_checkpoint = dynamic_cast<TH1 *>(object) ) {
+        TH1 * histogram_output = dynamic_cast<TH1 *>(dir_output->Get(name.data()));
+        if ( histogram_output ) {
+          histogram_output->Add(histogram_checkpoint);
+        } else {
+          std::cout << "Warning in <MEMbbwwCheckpointManager::restore>: No histogram = " << name
+                    << " booked in " << dir_output->GetPath() << " --> skipping !!" << std::endl;
+        }
+        delete histogram_checkpoint;
+      } else if ( THnSparse * histogram_sparse_checkpoint = dynamic_cast<THnSparse *>(object) ) {
+        THnSparse * histogram_sparse_output = dynamic_cast<THnSparse *>(dir_output->Get(name.data()));
+        if ( histogram_sparse_output ) {
+          histogram_sparse_output->Add(histogram_sparse_checkpoint);
+        } else {
+          std::cout << "Warning in <MEMbbwwCheckpointManager::restore>: No histogram = " << name
+                    << " booked in " << dir_output->GetPath() << " --> skipping !!" << std::endl;
+        }
+        delete histogram_sparse_checkpoint;
+      } else if ( TTree * tree_checkpoint = dynamic_cast<TTree *>(object) ) {
+        TTree * tree_output = dynamic_cast<TTree *>(dir_output->Get(name.data()));
+        if ( tree_output ) {
+          tree_output->CopyEntries(tree_checkpoint);
+        } else {
+          std::cout << "Warning in <MEMbbwwCheckpointManager::restore>: No TTree = " << name
+                    << " booked in " << dir_output->GetPath() << " --> skipping !!" << std::endl;
+        }
+        delete tree_checkpoint;
+      } else {
+        delete object;
+      }
+    }
+  }
+
+  void
+  write_recursively(TDirectory * dir)
+  {
+    TIter next(dir->GetList());
+    while ( TObject * object = next() ) {
+      if ( TTree * tree = dynamic_cast<TTree *>(object) ) {
+        tree->AutoSave("FlushBaskets");
+      } else if ( TH1 * histogram = dynamic_cast<TH1 *>(object) ) {
+        dir->WriteTObject(histogram, histogram->GetName(), "Overwrite");
+      } else if ( THnSparse * histogram_sparse = dynamic_cast<THnSparse *>(object) ) {
+        dir->WriteTObject(histogram_sparse, histogram_sparse->GetName(), "Overwrite");
+      } else if ( TDirectory * subdir = dynamic_cast<TDirectory *>(object) ) {
+        write_recursively(subdir);
+      }
+    }
+  }
+}
+
+MEMbbwwCheckpointManager::MEMbbwwCheckpointManager(const std::string & outputFileName, int checkpointInterval, bool resume)
+  : outputFileName_(outputFileName)
+  , checkpointFileName_(outputFileName + ".checkpoint")
+  , checkpointInterval_(checkpointInterval)
+  , isResumed_(false)
+  , numCheckpoints_(0)
+{
+  if ( !resume ) return;
+
+  // The output file of the pre-empted job contains the most recent checkpoint.
+  // In case the pre-empted job was itself resumed and got pre-empted before writing its first checkpoint,
+  // the output file contains no checkpoint and the checkpoint file of the previous attempt is used instead
+  if ( hasCheckpoint(outputFileName_) ) {
+    if ( gSystem->Rename(outputFileName_.data(), checkpointFileName_.data()) != 0 )
+      throw cms::Exception("MEMbbwwCheckpointManager")
+        << "Failed to rename file = " << outputFileName_ << " to " << checkpointFileName_ << " !!\n";
+  }
+  if ( !hasCheckpoint(checkpointFileName_) ) {
+    std::cout << "No checkpoint found for output file = " << outputFileName_ << " --> processing all events." << std::endl;
+    return;
+  }
+
+  TDirectory * dir_current = gDirectory;
+  TFile * checkpointFile = TFile::Open(checkpointFileName_.data(), "READ");
+  TDirectory * dir_checkpoint = checkpointFile->GetDirectory(checkpointDirName);
+  state_resumed_.nextEntry_                = readParameter<Long64_t>(dir_checkpoint, "nextEntry");
+  state_resumed_.analyzedEntries_          = readParameter<Long64_t>(dir_checkpoint, "analyzedEntries");
+  state_resumed_.selectedEntries_          = readParameter<Long64_t>(dir_checkpoint, "selectedEntries");
+  state_resumed_.selectedEntries_weighted_ = readParameter<double>(dir_checkpoint, "selectedEntries_weighted");
+  int numVariants = readParameter<int>(dir_checkpoint, "numSmearingVariants");
+  for ( int idxVariant = 0; idxVariant < numVariants; ++idxVariant ) {
+    std::string suffix = std::to_string(idxVariant);
+    state_resumed_.selectedEntries_variant_.push_back(readParameter<Long64_t>(dir_checkpoint, "selectedEntries_variant" + suffix));
+    state_resumed_.selectedEntries_weighted_variant_.push_back(readParameter<double>(dir_checkpoint, "selectedEntries_weighted_variant" + suffix));
+  }
+  state_resumed_.selEventsFileSize_        = readParameter<Long64_t>(dir_checkpoint, "selEventsFileSize");
+  state_resumed_.selEntryIndexFileSize_    = readParameter<Long64_t>(dir_checkpoint, "selEntryIndexFileSize");
+  int numTimingPhases = readParameter<int>(dir_checkpoint, "numTimingPhases");
+  for ( int idxPhase = 0; idxPhase < numTimingPhases; ++idxPhase ) {
+    std::string suffix = std::to_string(idxPhase);
+    state_resumed_.timingPhases_.push_back(readString(dir_checkpoint, "timingPhase" + suffix));
+    state_resumed_.timingNumCalls_.push_back(readParameter<Long64_t>(dir_checkpoint, "timingNumCalls" + suffix));
+    state_resumed_.timingWallTimes_.push_back(readParameter<double>(dir_checkpoint, "timingWallTime" + suffix));
+    state_resumed_.timingCpuTimes_.push_back(readParameter<double>(dir_checkpoint, "timingCpuTime" + suffix));
+  }
+  delete checkpointFile;
+  dir_current->cd();
+  isResumed_ = true;
+
+  std::cout << "Resuming from checkpoint = " << checkpointFileName_ << ":"
+            << " nextEntry = " << state_resumed_.nextEntry_ << ","
+            << " selectedEntries = " << state_resumed_.selectedEntries_ << std::endl;
+}
+
+MEMbbwwCheckpointManager::~MEMbbwwCheckpointManager()
+{}
+
+bool
+MEMbbwwCheckpointManager::isResumed() const
+{
+  return isResumed_;
+}
+
+const MEMbbwwCheckpointState &
+MEMbbwwCheckpointManager::getState_resumed() const
+{
+  return state_resumed_;
+}
+
+std::ofstream *
+MEMbbwwCheckpointManager::openOutputFile(const std::string & fileName, std::ios_base::openmode mode, Long64_t size_checkpoint) const
+{
+  if ( isResumed_ ) {
+    // discard what was written to the file after the last checkpoint
+    if ( truncate(fileName.data(), size_checkpoint) != 0 && !(errno == ENOENT && size_checkpoint == 0) )
+      throw cms::Exception("MEMbbwwCheckpointManager")
+        << "Failed to truncate file = " << fileName << " to size = " << size_checkpoint << " !!\n";
+    return new std::ofstream(fileName.data(), mode | std::ios::app);
+  }
+  return new std::ofstream(fileName.data(), mode);
+}
+
+void
+MEMbbwwCheckpointManager::restore(TFile & outputFile) const
+{
+  if ( !isResumed_ ) return;
+
+  TDirectory * dir_current = gDirectory;
+  TFile * checkpointFile = TFile::Open(checkpointFileName_.data(), "READ");
+  if ( !checkpointFile || checkpointFile->IsZombie() )
+    throw cms::Exception("MEMbbwwCheckpointManager")
+      << "Failed to open checkpoint file = " << checkpointFileName_ << " !!\n";
+  restore_recursively(checkpointFile, &outputFile);
+  delete checkpointFile;
+  dir_current->cd();
+}
+
+bool
+MEMbbwwCheckpointManager::isDue(Long64_t selectedEntries) const
+{
+  return checkpointInterval_ > 0 && selectedEntries > 0 && (selectedEntries % checkpointInterval_) == 0;
+}
+
+void
+MEMbbwwCheckpointManager::write(TFile & outputFile, const MEMbbwwCheckpointState & state)
+{
+  TDirectory * dir_current = gDirectory;
+  write_recursively(&outputFile);
+  TDirectory * dir_checkpoint = outputFile.GetDirectory(checkpointDirName);
+  if ( !dir_checkpoint ) dir_checkpoint = outputFile.mkdir(checkpointDirName);
+  writeParameter<Long64_t>(dir_checkpoint, "nextEntry", state.nextEntry_);
+  writeParameter<Long64_t>(dir_checkpoint, "analyzedEntries", state.analyzedEntries_);
+  writeParameter<Long64_t>(dir_checkpoint, "selectedEntries", state.selectedEntries_);
+  writeParameter<double>(dir_checkpoint, "selectedEntries_weighted", state.selectedEntries_weighted_);
+  assert(state.selectedEntries_weighted_variant_.size() == state.selectedEntries_variant_.size());
+  writeParameter<int>(dir_checkpoint, "numSmearingVariants", state.selectedEntries_variant_.size());
+  for ( size_t idxVariant = 0; idxVariant < state.selectedEntries_variant_.size(); ++idxVariant ) {
+    std::string suffix = std::to_string(idxVariant);
+    writeParameter<Long64_t>(dir_checkpoint, "selectedEntries_variant" + suffix, state.selectedEntries_variant_[idxVariant]);
+    writeParameter<double>(dir_checkpoint, "selectedEntries_weighted_variant" + suffix, state.selectedEntries_weighted_variant_[idxVariant]);
+  }
+  writeParameter<Long64_t>(dir_checkpoint, "selEventsFileSize", state.selEventsFileSize_);
+  writeParameter<Long64_t>(dir_checkpoint, "selEntryIndexFileSize", state.selEntryIndexFileSize_);
+  assert(state.timingNumCalls_.size() == state.timingPhases_.size());
+  assert(state.timingWallTimes_.size() == state.timingPhases_.size());
+  assert(state.timingCpuTimes_.size() == state.timingPhases_.size());
+  writeParameter<int>(dir_checkpoint, "numTimingPhases", state.timingPhases_.size());
+  for ( size_t idxPhase = 0; idxPhase < state.timingPhases_.size(); ++idxPhase ) {
+    std::string suffix = std::to_string(idxPhase);
+    writeString(dir_checkpoint, "timingPhase" + suffix, state.timingPhases_[idxPhase]);
+    writeParameter<Long64_t>(dir_checkpoint, "timingNumCalls" + suffix, state.timingNumCalls_[idxPhase]);
+    writeParameter<double>(dir_checkpoint, "timingWallTime" + suffix, state.timingWallTimes_[idxPhase]);
+    writeParameter<double>(dir_checkpoint, "timingCpuTime" + suffix, state.timingCpuTimes_[idxPhase]);
+  }
+  // write keys and headers of all directories, so that the file can be read in case the job gets killed
+  outputFile.SaveSelf(true);
+  outputFile.Flush();
+  dir_current->cd();
+  ++numCheckpoints_;
+}
+
+void
+MEMbbwwCheckpointManager::finish(TFile & outputFile)
+{
+  if ( numCheckpoints_ > 0 ) {
+    TDirectory * dir_current = gDirectory;
+    outputFile.rmdir(checkpointDirName);
+    dir_current->cd();
+  }
+  if ( isResumed_ ) {
+    gSystem->Unlink(checkpointFileName_.data());
+  }
+}
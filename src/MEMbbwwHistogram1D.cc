@@ -0,0 +1,60 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwHistogram1D.h"
+
+#include "tthAnalysis/HiggsToTauTau/interface/histogramAuxFunctions.h" // fillWithOverFlow()
+
+#include <TAxis.h> // TAxis
+#include <TDirectory.h> // TDirectory
+#include <TH1.h> // TH1
+#include <THnSparse.h> // THnSparse, THnSparseD
+
+MEMbbwwHistogram1D::MEMbbwwHistogram1D()
+  : histogram_(nullptr)
+  , histogram_sparse_(nullptr)
+{}
+
+MEMbbwwHistogram1D::~MEMbbwwHistogram1D()
+{}
+
+void
+MEMbbwwHistogram1D::book(TH1 * histogram, bool useSparseHistogram)
+{
+  histogram_ = histogram;
+  histogram_sparse_ = nullptr;
+  histogram_detached_.reset();
+  // HistManagerBase::book1D returns a null pointer for histograms that are not booked for the current central_or_shift option
+  if ( !histogram_ || !useSparseHistogram ) return;
+
+  const TAxis * xAxis = histogram_->GetXaxis();
+  const int numBins = xAxis->GetNbins();
+  const double xMin = xAxis->GetXmin();
+  const double xMax = xAxis->GetXmax();
+  histogram_sparse_ = new THnSparseD(histogram_->GetName(), histogram_->GetTitle(), 1, &numBins, &xMin, &xMax);
+  histogram_sparse_->Sumw2();
+  histogram_sparse_->GetAxis(0)->SetTitle(xAxis->GetTitle());
+
+  // replace the TH1 by the THnSparse in the output file
+  TDirectory * dir = histogram_->GetDirectory();
+  if ( dir ) {
+    histogram_->SetDirectory(nullptr);
+    histogram_detached_.reset(histogram_);
+    dir->Append(histogram_sparse_);
+  }
+  histogram_->SetBins(1, xMin, xMax);
+}
+
+void
+MEMbbwwHistogram1D::fillWithOverFlow(double x, double evtWeight, double evtWeightErr)
+{
+  if ( histogram_sparse_ ) {
+    const TAxis * xAxis = histogram_sparse_->GetAxis(0);
+    int idxBin = xAxis->FindFixBin(x);
+    const int numBins = xAxis->GetNbins();
+    if ( idxBin < 1       ) idxBin = 1;
+    if ( idxBin > numBins ) idxBin = numBins;
+    const double x_bin = xAxis->GetBinCenter(idxBin);
+    const Long64_t bin = histogram_sparse_->Fill(&x_bin, evtWeight);
+    if ( evtWeightErr != 0. ) histogram_sparse_->AddBinError2(bin, evtWeightErr*evtWeightErr);
+  } else if ( histogram_ ) {
+    ::fillWithOverFlow(histogram_, x, evtWeight, evtWeightErr);
+  }
+}
@@ -0,0 +1,106 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwHistogramCache.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TFile.h> // TFile
+#include <TH1.h> // TH1
+#include <THnSparse.h> // THnSparse
+#include <TString.h> // Form
+
+MEMbbwwHistogramCache::MEMbbwwHistogramCache()
+  : numMisses_(0)
+  , numHits_(0)
+{}
+
+MEMbbwwHistogramCache::~MEMbbwwHistogramCache()
+{
+  for ( auto & histogram_rebinned : histograms_rebinned_ ) {
+    delete histogram_rebinned.second;
+  }
+  for ( auto & histogram : histograms_ ) {
+    delete histogram.second;
+  }
+  for ( auto & inputFile : inputFiles_ ) {
+    delete inputFile.second;
+  }
+}
+
+TFile *
+MEMbbwwHistogramCache::getFile(const std::string & inputFileName)
+{
+  std::map<std::string, TFile *>::const_iterator inputFile_cached = inputFiles_.find(inputFileName);
+  if ( inputFile_cached != inputFiles_.end() ) {
+    return inputFile_cached->second;
+  }
+  TFile * inputFile = TFile::Open(inputFileName.data(), "READ");
+  if ( !inputFile || inputFile->IsZombie() )
+    throw cms::Exception("MEMbbwwHistogramCache")
+      << "Failed to open input file = " << inputFileName << " !!\n";
+  inputFiles_[inputFileName] = inputFile;
+  return inputFile;
+}
+
+TH1 *
+MEMbbwwHistogramCache::getHistogram(const std::string & inputFileName, const std::string & directory, const std::string & histogramName)
+{
+  const std::tuple<std::string, std::string, std::string> key(inputFileName, directory, histogramName);
+  std::map<std::tuple<std::string, std::string, std::string>, TH1 *>::const_iterator histogram_cached = histograms_.find(key);
+  if ( histogram_cached != histograms_.end() ) {
+    ++numHits_;
+    return histogram_cached->second;
+  }
+  ++numMisses_;
+
+  TFile * inputFile = getFile(inputFileName);
+  std::string histogramName_full = directory;
+  if ( !histogramName_full.empty() && histogramName_full.back() != '/' ) histogramName_full.append("/");
+  histogramName_full.append(histogramName);
+  TObject * object = inputFile->Get(histogramName_full.data());
+  TH1 * histogram = dynamic_cast<TH1 *>(object);
+  // histograms booked with useSparseHistograms = True are stored as THnSparse and converted to TH1 here
+  if ( THnSparse * histogram_sparse = dynamic_cast<THnSparse *>(object) ) {
+    histogram = histogram_sparse->Projection(0, "E");
+    histogram->SetName(histogram_sparse->GetName());
+    delete histogram_sparse;
+  }
+  if ( !histogram )
+    throw cms::Exception("MEMbbwwHistogramCache")
+      << "Failed to load histogram = " << histogramName_full << " from file = " << inputFileName << " !!\n";
+  histogram->SetDirectory(nullptr);
+  if ( !histogram->GetSumw2N() ) histogram->Sumw2();
+  // exclude underflow and overflow bins
+  const double integral = histogram->Integral(1, histogram->GetNbinsX());
+  if ( integral > 0. ) histogram->Scale(1./integral);
+  histograms_[key] = histogram;
+  return histogram;
+}
+
+const TH1 *
+MEMbbwwHistogramCache::getHistogram_rebinned(const TH1 * histogram, int numBinsX)
+{
+  const std::pair<const TH1 *, int> key(histogram, numBinsX);
+  std::map<std::pair<const TH1 *, int>, TH1 *>::const_iterator histogram_cached = histograms_rebinned_.find(key);
+  if ( histogram_cached != histograms_rebinned_.end() ) {
+    return histogram_cached->second;
+  }
+  TH1 * histogram_rebinned = (TH1 *)histogram->Clone(Form("%s_rebinned%i", histogram->GetName(), numBinsX));
+  histogram_rebinned->SetDirectory(nullptr);
+  if ( !histogram_rebinned->GetSumw2N() ) histogram_rebinned->Sumw2();
+  if ( numBinsX > 0 && numBinsX < histogram->GetNbinsX() && (histogram->GetNbinsX() % numBinsX) == 0 ) {
+    histogram_rebinned->Rebin(histogram->GetNbinsX() / numBinsX);
+  }
+  histograms_rebinned_[key] = histogram_rebinned;
+  return histogram_rebinned;
+}
+
+unsigned long
+MEMbbwwHistogramCache::numMisses() const
+{
+  return numMisses_;
+}
+
+unsigned long
+MEMbbwwHistogramCache::numHits() const
+{
+  return numHits_;
+}
@@ -0,0 +1,164 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwInputTree.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include "tthAnalysis/HiggsToTauTau/interface/ReaderBase.h" // ReaderBase
+
+#include <TBranch.h> // TBranch
+#include <TFile.h> // TFile
+#include <TList.h> // TIter
+#include <TTree.h> // TTree
+
+#include <iostream> // std::cout
+#include <algorithm> // std::max
+
+MEMbbwwInputTree::MEMbbwwInputTree(const std::string & treeName, const std::vector<std::string> & fileNames, Long64_t maxEventCount)
+  : treeName_(treeName)
+  , fileNames_(fileNames)
+  , maxEventCount_(maxEventCount)
+  , firstEntry_(0)
+  , currentFile_(nullptr)
+  , currentTree_(nullptr)
+  , numFilesProcessed_(0)
+  , currentFileOffset_(0)
+  , currentFileEntries_(0)
+  , currentEventIdx_(-1)
+  , numEventsRead_(0)
+{}
+
+MEMbbwwInputTree::~MEMbbwwInputTree()
+{
+  closeFile();
+}
+
+void
+MEMbbwwInputTree::registerReader(ReaderBase * reader)
+{
+  readers_.push_back(reader);
+}
+
+void
+MEMbbwwInputTree::setFirstEntry(Long64_t firstEntry)
+{
+  if ( numFilesProcessed_ > 0 )
+    throw cms::Exception("MEMbbwwInputTree")
+      << "First entry needs to be set before the first entry is read !!\n";
+  firstEntry_ = firstEntry;
+}
+
+bool
+MEMbbwwInputTree::hasNextEvent()
+{
+  while ( true ) {
+    if ( currentTree_ && currentEventIdx_ + 1 < currentFileEntries_ ) break;
+    if ( !openNextFile() ) return false;
+  }
+  if ( maxEventCount_ >= 0 && currentFileOffset_ + currentEventIdx_ + 1 >= maxEventCount_ ) return false;
+  ++currentEventIdx_;
+  if ( currentTree_->GetEntry(currentEventIdx_) < 0 )
+    throw cms::Exception("MEMbbwwInputTree")
+      << "Failed to read entry #" << currentEventIdx_ << " from file = " << getCurrentFileName() << " !!\n";
+  ++numEventsRead_;
+  return true;
+}
+
+bool
+MEMbbwwInputTree::openNextFile()
+{
+  if ( currentTree_ ) {
+    currentFileOffset_ += currentFileEntries_;
+    closeFile();
+  }
+  while ( numFilesProcessed_ < (int)fileNames_.size() ) {
+    if ( maxEventCount_ >= 0 && currentFileOffset_ >= maxEventCount_ ) return false;
+    const std::string & fileName = fileNames_[numFilesProcessed_];
+    ++numFilesProcessed_;
+    currentFile_ = TFile::Open(fileName.data(), "READ");
+    if ( !currentFile_ || currentFile_->IsZombie() )
+      throw cms::Exception("MEMbbwwInputTree")
+        << "Failed to open input file = " << fileName << " !!\n";
+    currentTree_ = dynamic_cast<TTree *>(currentFile_->Get(treeName_.data()));
+    if ( !currentTree_ )
+      throw cms::Exception("MEMbbwwInputTree")
+        << "Failed to find tree = " << treeName_ << " in input file = " << fileName << " !!\n";
+    currentFileEntries_ = currentTree_->GetEntries();
+    if ( currentFileOffset_ + currentFileEntries_ <= firstEntry_ ) {
+      // all entries of this file precede the first entry to be processed
+      currentFileOffset_ += currentFileEntries_;
+      closeFile();
+      continue;
+    }
+    for ( std::vector<ReaderBase *>::iterator reader = readers_.begin();
+          reader != readers_.end(); ++reader ) {
+      (*reader)->setBranchAddresses(currentTree_);
+    }
+    // read only the branches used by the readers
+    currentTree_->SetBranchStatus("*", false);
+    TIter next(currentTree_->GetListOfBranches());
+    while ( TBranch * branch = dynamic_cast<TBranch *>(next()) ) {
+      if ( branch->GetAddress() ) currentTree_->SetBranchStatus(branch->GetName(), true);
+    }
+    currentEventIdx_ = std::max(firstEntry_ - currentFileOffset_, (Long64_t)0) - 1;
+    std::cout << "Opened input file = " << fileName << " (" << currentFileEntries_ << " entries";
+    if ( currentEventIdx_ >= 0 ) std::cout << ", starting at entry #" << (currentEventIdx_ + 1);
+    std::cout << ")" << std::endl;
+    return true;
+  }
+  return false;
+}
+
+void
+MEMbbwwInputTree::closeFile()
+{
+  delete currentFile_;
+  currentFile_ = nullptr;
+  currentTree_ = nullptr;
+}
+
+int
+MEMbbwwInputTree::getFileCount() const
+{
+  return fileNames_.size();
+}
+
+int
+MEMbbwwInputTree::getProcessedFileCount() const
+{
+  return numFilesProcessed_;
+}
+
+Long64_t
+MEMbbwwInputTree::getCurrentMaxEventIdx() const
+{
+  return currentFileOffset_ + currentEventIdx_;
+}
+
+Long64_t
+MEMbbwwInputTree::getCurrentEventIdx() const
+{
+  return currentEventIdx_;
+}
+
+Long64_t
+MEMbbwwInputTree::getCumulativeMaxEventCount() const
+{
+  return numEventsRead_;
+}
+
+std::string
+MEMbbwwInputTree::getCurrentFileName() const
+{
+  return ( numFilesProcessed_ > 0 ) ? fileNames_[numFilesProcessed_ - 1] : "";
+}
+
+bool
+MEMbbwwInputTree::isOpen() const
+{
+  return currentTree_ != nullptr;
+}
+
+bool
+MEMbbwwInputTree::canReport(unsigned reportEvery) const
+{
+  return reportEvery > 0 && numEventsRead_ > 0 && ((numEventsRead_ - 1) % reportEvery) == 0;
+}
@@ -2,37 +2,90 @@
 
 #include "tthAnalysis/HiggsToTauTau/interface/histogramAuxFunctions.h" // createSubdirectory_recursively
 
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TBranch.h> // TBranch
+
+#include <algorithm> // std::replace
+#include <math.h>      // sqrt, atan2
+
+MEMbbwwNtupleWriteOptions::MEMbbwwNtupleWriteOptions()
+  : compressionSettings_(-1)
+  , basketSize_(0)
+  , autoFlush_(0)
+  , memResultEncoding_(kDouble)
+  , memResultMantissaBits_(14)
+{}
+
+MEMbbwwNtupleWriteOptions::MEMbbwwNtupleWriteOptions(const edm::ParameterSet & cfg)
+  : MEMbbwwNtupleWriteOptions()
+{
+  // compression algorithms, numbered as in ROOT's Compression.h
+  const std::string compressionAlgorithm = cfg.getParameter<std::string>("compressionAlgorithm");
+  const int compressionLevel = cfg.getParameter<int>("compressionLevel");
+  int algorithm = -1;
+  if      ( compressionAlgorithm == ""     ) algorithm = -1;
+  else if ( compressionAlgorithm == "ZLIB" ) algorithm = 1;
+  else if ( compressionAlgorithm == "LZMA" ) algorithm = 2;
+  else if ( compressionAlgorithm == "LZ4"  ) algorithm = 4;
+  else if ( compressionAlgorithm == "ZSTD" ) algorithm = 5;
+  else throw cms::Exception("MEMbbwwNtupleWriteOptions")
+    << "Invalid Configuration parameter 'compressionAlgorithm' = " << compressionAlgorithm << " !!\n";
+  if ( algorithm != -1 )
+  {
+    if ( compressionLevel < 0 || compressionLevel > 9 )
+      throw cms::Exception("MEMbbwwNtupleWriteOptions")
+        << "Invalid Configuration parameter 'compressionLevel' = " << compressionLevel << " !!\n";
+    compressionSettings_ = 100*algorithm + compressionLevel;
+  }
+  basketSize_ = cfg.getParameter<int>("basketSize");
+  autoFlush_ = cfg.getParameter<long long>("autoFlush");
+  const std::string memResultEncoding = cfg.getParameter<std::string>("memResultEncoding");
+  if      ( memResultEncoding == "Double_t"   ) memResultEncoding_ = kDouble;
+  else if ( memResultEncoding == "Double32_t" ) memResultEncoding_ = kDouble32;
+  else if ( memResultEncoding == "logFloat_t" ) memResultEncoding_ = kLogFloat;
+  else throw cms::Exception("MEMbbwwNtupleWriteOptions")
+    << "Invalid Configuration parameter 'memResultEncoding' = " << memResultEncoding << " !!\n";
+  memResultMantissaBits_ = cfg.getParameter<unsigned>("memResultMantissaBits");
+  // ROOT truncates the mantissa of Double32_t values without range for 2 <= nbits <= 14 only
+  if ( memResultEncoding_ == kDouble32 && (memResultMantissaBits_ < 2 || memResultMantissaBits_ > 14) )
+    throw cms::Exception("MEMbbwwNtupleWriteOptions")
+      << "Invalid Configuration parameter 'memResultMantissaBits' = " << memResultMantissaBits_ << " !!\n";
+}
+
+MEMbbwwNtupleKinematics::MEMbbwwNtupleKinematics(const math::PtEtaPhiMLorentzVector & p4_1, const math::PtEtaPhiMLorentzVector & p4_2,
+                                                 const math::PtEtaPhiMLorentzVector & p4_3, double metPx, double metPy)
+  : p4_1_(p4_1)
+  , p4_2_(p4_2)
+  , p4_3_(p4_3)
+  , metP4_(sqrt(metPx*metPx + metPy*metPy), 0., atan2(metPy, metPx), 0.)
+{}
+
+int
+getMeasuredLeptonPdgId(const MEMEventParticle & lepton)
+{
+  if      ( lepton.type() == mem::MeasuredParticle::kElectron && lepton.charge() < 0 ) return +11;
+  else if ( lepton.type() == mem::MeasuredParticle::kElectron && lepton.charge() > 0 ) return -11;
+  else if ( lepton.type() == mem::MeasuredParticle::kMuon     && lepton.charge() < 0 ) return +13;
+  else if ( lepton.type() == mem::MeasuredParticle::kMuon     && lepton.charge() > 0 ) return -13;
+  else assert(0);
+  return 0;
+}
+
 MEMbbwwNtupleManager::MEMbbwwNtupleManager(const std::string & outputDirectoryName, const std::string & outputTreeName)
   : outputDirectoryName_(outputDirectoryName)
   , outputTreeName_(outputTreeName)
   , tree_(nullptr)
-  , run_(0)
-  , ls_(0)
-  , event_(0)
-  , genWeight_(0.)
-  , isSignal_(false)
-  , nbjets_loose_(0)
-  , nbjets_medium_(0)
-  , memProbS_(0.)
-  , memProbSerr_(0.)
-  , memProbB_(0.)
-  , memProbBerr_(0.)
-  , memLR_(0.)
-  , memLRerr_(0.)
-  , memCpuTime_(0.)
+  , memResultEncoding_(MEMbbwwNtupleWriteOptions::kDouble)
   , bjet1_("bjet1")
   , bjet2_("bjet2")
-  , nbjets_(0)
   , gen_bjet1_("gen_bjet1")
   , gen_bjet2_("gen_bjet2")
-  , gen_nbjets_(0)
   , met_("met")
   , gen_met_("gen_met")
-  , barcode_(-1)
-  , ptbb_(0.)
-  , drbb_(0.)
-  , mbb_(0.)
-{}
+{
+  branchGroups_ = { &event_, &memResult_, &bjet1_, &bjet2_, &gen_bjet1_, &gen_bjet2_, &met_, &gen_met_, &hbb_ };
+}
 
 MEMbbwwNtupleManager::~MEMbbwwNtupleManager()
 {}
@@ -47,90 +100,78 @@ MEMbbwwNtupleManager::makeTree(TFileDirectory & dir)
 }
 
 void 
-MEMbbwwNtupleManager::initializeBranches()
+MEMbbwwNtupleManager::initializeBranches(const MEMbbwwNtupleWriteOptions & options)
 {
   assert(tree_);
 
-  tree_->Branch("run",           &run_,           Form("run/%s",           Traits<UInt_t>::TYPE_NAME));
-  tree_->Branch("ls",            &ls_,            Form("ls/%s",            Traits<UInt_t>::TYPE_NAME));
-  tree_->Branch("event",         &event_,         Form("event/%s",         Traits<ULong64_t>::TYPE_NAME));
-  
-  tree_->Branch("memProbS",      &memProbS_,      Form("memProbS/%s",      Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memProbSerr",   &memProbSerr_,   Form("memProbSerr/%s",   Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memProbB",      &memProbB_,      Form("memProbB/%s",      Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memProbBerr",   &memProbBerr_,   Form("memProbBerr/%s",   Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memLR",         &memLR_,         Form("memLR/%s",         Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memLRerr",      &memLRerr_,      Form("memLRerr/%s",      Traits<Double_t>::TYPE_NAME));
-  tree_->Branch("memCpuTime",    &memCpuTime_,    Form("memCpuTime/%s",    Traits<Float_t>::TYPE_NAME));
-
-  tree_->Branch("genWeight",     &genWeight_,     Form("genWeight/%s",     Traits<Float_t>::TYPE_NAME));
-
-  tree_->Branch("isSignal",      &isSignal_,      Form("isSignal/%s",      Traits<Bool_t>::TYPE_NAME));
-
-  tree_->Branch("nbjets_loose",  &nbjets_loose_,  Form("nbjets_loose/%s",  Traits<Int_t>::TYPE_NAME));
-  tree_->Branch("nbjets_medium", &nbjets_medium_, Form("nbjets_medium/%s", Traits<Int_t>::TYPE_NAME));
-
-  bjet1_.initializeBranches(tree_);
-  bjet2_.initializeBranches(tree_);
-  tree_->Branch("nbjets",        &nbjets_,        Form("nbjets/%s",        Traits<Int_t>::TYPE_NAME));
-  gen_bjet1_.initializeBranches(tree_);
-  gen_bjet2_.initializeBranches(tree_);
-  tree_->Branch("gen_nbjets",    &gen_nbjets_,    Form("gen_nbjets/%s",    Traits<Int_t>::TYPE_NAME));
-  
-  met_.initializeBranches(tree_);
-  gen_met_.initializeBranches(tree_);
-
-  tree_->Branch("barcode",       &barcode_,       Form("barcode/%s",       Traits<Int_t>::TYPE_NAME));
-
-  tree_->Branch("ptbb",          &ptbb_,          Form("ptbb/%s",          Traits<Float_t>::TYPE_NAME));
-  tree_->Branch("drbb",          &drbb_,          Form("drbb/%s",          Traits<Float_t>::TYPE_NAME));
-  tree_->Branch("mbb",           &mbb_,           Form("mbb/%s",           Traits<Float_t>::TYPE_NAME));
-}
-
-void 
-MEMbbwwNtupleManager::read(const MEMEvent & memEvent)
-{
-  run_           = memEvent.eventInfo().run();
-  ls_            = memEvent.eventInfo().lumi();
-  event_         = memEvent.eventInfo().event();
+  memResultEncoding_ = options.memResultEncoding_;
+  if ( memResultEncoding_ == MEMbbwwNtupleWriteOptions::kDouble32 )
+  {
+    memResult_.setLeafType("memLR",    Form("d[0,0,%u]", options.memResultMantissaBits_));
+    memResult_.setLeafType("memLRerr", Form("d[0,0,%u]", options.memResultMantissaBits_));
+  }
+  else if ( memResultEncoding_ == MEMbbwwNtupleWriteOptions::kLogFloat )
+  {
+    std::replace(branchGroups_.begin(), branchGroups_.end(),
+                 static_cast<MEMbbwwNtupleBranchGroup *>(&memResult_), static_cast<MEMbbwwNtupleBranchGroup *>(&memLogResult_));
+  }
 
-  genWeight_     = memEvent.eventInfo().genWeight();
+  for ( std::vector<MEMbbwwNtupleBranchGroup *>::const_iterator branchGroup = branchGroups_.begin();
+        branchGroup != branchGroups_.end(); ++branchGroup )
+  {
+    (*branchGroup)->initializeBranches(tree_);
+  }
 
-  isSignal_      = memEvent.isSignal();
+  setWriteOptions(options);
+}
 
-  nbjets_loose_  = memEvent.numMeasuredBJets_loose();
-  nbjets_medium_ = memEvent.numMeasuredBJets_medium();
+void
+MEMbbwwNtupleManager::setWriteOptions(const MEMbbwwNtupleWriteOptions & options)
+{
+  assert(tree_);
 
-  memProbS_      = memEvent.memResult().getProb_signal();
-  memProbSerr_   = memEvent.memResult().getProbErr_signal();
-  memProbB_      = memEvent.memResult().getProb_background();
-  memProbBerr_   = memEvent.memResult().getProbErr_background();
-  memLR_         = memEvent.memResult().getLikelihoodRatio();
-  memLRerr_      = memEvent.memResult().getLikelihoodRatioErr();
-  memCpuTime_    = memEvent.memCpuTime();
+  if ( options.basketSize_ > 0 )
+  {
+    tree_->SetBasketSize("*", options.basketSize_);
+  }
+  if ( options.compressionSettings_ != -1 )
+  {
+    TIter nextBranch(tree_->GetListOfBranches());
+    while ( TBranch * branch = dynamic_cast<TBranch *>(nextBranch()) )
+    {
+      branch->SetCompressionSettings(options.compressionSettings_);
+    }
+  }
+  if ( options.autoFlush_ != 0 )
+  {
+    tree_->SetAutoFlush(options.autoFlush_);
+  }
+}
 
-  bjet1_.read(memEvent.measuredBJet1(), memEvent.genBJet1() != nullptr);
-  bjet2_.read(memEvent.measuredBJet2(), memEvent.genBJet2() != nullptr);
-  nbjets_        = memEvent.numMeasuredBJets();
-  gen_bjet1_.read(memEvent.genBJet1());
-  gen_bjet2_.read(memEvent.genBJet2());
-  gen_nbjets_    = memEvent.numGenBJets();
+void 
+MEMbbwwNtupleManager::read(const MEMEvent & memEvent)
+{
+  event_.read(memEvent);
+  if ( memResultEncoding_ == MEMbbwwNtupleWriteOptions::kLogFloat )
+  {
+    memLogResult_.read(memEvent.memResult());
+  }
+  else
+  {
+    memResult_.read(memEvent.memResult());
+  }
 
-  met_.read(memEvent.measuredMEtPx(), memEvent.measuredMEtPy(), &memEvent.measuredMEtCov());
-  gen_met_.read(memEvent.genMEtPx(), memEvent.genMEtPy());
+  readParticle(bjet1_, memEvent.measuredBJet1(), memEvent.genBJet1().isValid());
+  readParticle(bjet2_, memEvent.measuredBJet2(), memEvent.genBJet2().isValid());
+  readParticle(gen_bjet1_, memEvent.genBJet1());
+  readParticle(gen_bjet2_, memEvent.genBJet2());
 
-  barcode_       = memEvent.barcode();
+  met_.read(MEMbbwwNtupleMEt(memEvent.measuredMEtPx(), memEvent.measuredMEtPy(), memEvent.measuredMEtCov()));
+  gen_met_.read(MEMbbwwNtupleMEt(memEvent.genMEtPx(), memEvent.genMEtPy()));
 
-  if ( memEvent.measuredBJet1() && memEvent.measuredBJet2() )
+  if ( memEvent.measuredBJet1().isValid() && memEvent.measuredBJet2().isValid() )
   {
-    const mem::MeasuredParticle * bjet1 = memEvent.measuredBJet1();
-    math::PtEtaPhiMLorentzVector bjet1P4(bjet1->pt(), bjet1->eta(), bjet1->phi(), bjet1->mass());
-    const mem::MeasuredParticle * bjet2 = memEvent.measuredBJet2();
-    math::PtEtaPhiMLorentzVector bjet2P4(bjet2->pt(), bjet2->eta(), bjet2->phi(), bjet2->mass());
-    math::PtEtaPhiMLorentzVector hbbP4 = bjet1P4 + bjet2P4;
-    ptbb_        = hbbP4.pt();
-    drbb_        = deltaR(bjet1P4, bjet2P4); 
-    mbb_         = hbbP4.mass();
+    hbb_.read(MEMbbwwNtupleKinematics(memEvent.measuredBJet1().p4(), memEvent.measuredBJet2().p4()));
   }
 }
 
@@ -143,38 +184,9 @@ void MEMbbwwNtupleManager::fill()
 void 
 MEMbbwwNtupleManager::resetBranches()
 {
-  run_           = 0;
-  ls_            = 0;
-  event_         = 0;
-
-  genWeight_     = 0.;
-
-  isSignal_      = false;
-
-  memProbS_      = 0.;
-  memProbSerr_   = 0.;
-  memProbB_      = 0.;
-  memProbBerr_   = 0.;
-  memLR_         = 0.;
-  memLRerr_      = 0.;
-  memCpuTime_    = -1.;
-
-  nbjets_loose_  = 0;
-  nbjets_medium_ = 0;
-
-  bjet1_.resetBranches();
-  bjet2_.resetBranches();
-  nbjets_        = 0;
-  gen_bjet1_.resetBranches();
-  gen_bjet2_.resetBranches();
-  gen_nbjets_    = 0;
-
-  met_.resetBranches();
-  gen_met_.resetBranches();
-
-  barcode_       = -1;
-
-  ptbb_          = 0.;
-  drbb_          = 0.;
-  mbb_           = 0.;
+  for ( std::vector<MEMbbwwNtupleBranchGroup *>::const_iterator branchGroup = branchGroups_.begin();
+        branchGroup != branchGroups_.end(); ++branchGroup )
+  {
+    (*branchGroup)->resetBranches();
+  }
 }
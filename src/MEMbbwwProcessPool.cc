@@ -0,0 +1,293 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwProcessPool.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <cerrno>    // errno, EINTR
+#include <cstdint>   // uint64_t
+#include <cstdio>    // fflush
+#include <cstring>   // std::memcpy, std::strlen
+#include <exception> // std::exception
+#include <iostream>  // std::cout, std::cerr
+#include <poll.h>       // poll, pollfd, POLLIN
+#include <sys/socket.h> // socketpair, send, MSG_NOSIGNAL
+#include <sys/wait.h>   // waitpid
+#include <unistd.h>     // fork, read, close, _exit
+
+namespace
+{
+  /// write all bytes, return false in case the other end of the socket has been closed
+  bool
+  writeBytes(int fd, const char * data, size_t size)
+  {
+    while ( size > 0 ) {
+      ssize_t numBytes = send(fd, data, size, MSG_NOSIGNAL);
+      if ( numBytes < 0 && errno == EINTR ) continue;
+      if ( numBytes <= 0 ) return false;
+      data += numBytes;
+      size -= numBytes;
+    }
+    return true;
+  }
+
+  /// read given number of bytes, return false in case the other end of the socket has been closed
+  bool
+  readBytes(int fd, char * data, size_t size)
+  {
+    while ( size > 0 ) {
+      ssize_t numBytes = read(fd, data, size);
+      if ( numBytes < 0 && errno == EINTR ) continue;
+      if ( numBytes <= 0 ) return false;
+      data += numBytes;
+      size -= numBytes;
+    }
+    return true;
+  }
+
+  // messages are sent as their length, followed by their content
+  bool
+  writeMessage(int fd, const std::string & message)
+  {
+    const uint64_t size = message.size();
+    return writeBytes(fd, reinterpret_cast<const char *>(&size), sizeof(size)) && writeBytes(fd, message.data(), message.size());
+  }
+
+  bool
+  readMessage(int fd, std::string & message)
+  {
+    uint64_t size = 0;
+    if ( !readBytes(fd, reinterpret_cast<char *>(&size), sizeof(size)) ) return false;
+    message.resize(size);
+    return size == 0 || readBytes(fd, &message[0], size);
+  }
+
+  template <typename T>
+  void
+  appendValue(std::string & message, const T & value)
+  {
+    message.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  T
+  readValue(const char * & data)
+  {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return value;
+  }
+
+  const char status_ok = 0;
+  const char status_error = 1;
+}
+
+MEMbbwwProcessPool::MEMbbwwProcessPool(unsigned numProcesses, const handlerType & handler, MEMbbwwTimingManager * timingManager)
+  : handler_(handler)
+  , timingManager_(timingManager)
+  , nextTicket_(0)
+{
+  if ( numProcesses <= 1 ) return;
+
+  // flush output buffers, so that their content is not written again by the worker processes
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(nullptr);
+
+  for ( unsigned idxProcess = 0; idxProcess < numProcesses; ++idxProcess ) {
+    int fds[2];
+    if ( socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0 ) {
+      std::cerr << "Failed to create socket for worker process #" << idxProcess << " --> running MEM integrations with " << workers_.size() << " processes." << std::endl;
+      break;
+    }
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+      close(fds[0]);
+      close(fds[1]);
+      std::cerr << "Failed to start worker process #" << idxProcess << " --> running MEM integrations with " << workers_.size() << " processes." << std::endl;
+      break;
+    }
+    if ( pid == 0 ) {
+      // close the sockets of the calling process, so that the other workers see when the calling process closes them
+      close(fds[0]);
+      for ( const workerType & worker : workers_ ) {
+        close(worker.fd_);
+      }
+      work(fds[1]);
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(nullptr);
+      // skip the cleanup of ROOT and of the objects owned by the calling process, which is done by the calling process
+      _exit(0);
+    }
+    close(fds[1]);
+    workers_.push_back({ pid, fds[0], false, 0 });
+  }
+}
+
+MEMbbwwProcessPool::~MEMbbwwProcessPool()
+{
+  // the workers exit once they see that the socket has been closed
+  for ( const workerType & worker : workers_ ) {
+    close(worker.fd_);
+  }
+  for ( const workerType & worker : workers_ ) {
+    int status = 0;
+    waitpid(worker.pid_, &status, 0);
+  }
+}
+
+size_t
+MEMbbwwProcessPool::submit(const std::string & request)
+{
+  const size_t ticket = nextTicket_++;
+  if ( workers_.empty() ) {
+    responseType & response = responses_[ticket];
+    response.isError_ = false;
+    handler_(request, response.message_);
+  } else {
+    requests_.push_back(std::make_pair(ticket, request));
+    dispatch();
+  }
+  return ticket;
+}
+
+bool
+MEMbbwwProcessPool::isReady(size_t ticket)
+{
+  receive(false);
+  dispatch();
+  return responses_.count(ticket);
+}
+
+void
+MEMbbwwProcessPool::get(size_t ticket, std::string & response)
+{
+  std::map<size_t, responseType>::iterator response_received = responses_.find(ticket);
+  while ( response_received == responses_.end() ) {
+    if ( requests_.empty() ) {
+      bool isBusy = false;
+      for ( const workerType & worker : workers_ ) {
+        if ( worker.isBusy_ ) isBusy = true;
+      }
+      if ( !isBusy )
+        throw cms::Exception("MEMbbwwProcessPool")
+          << "No request with ticket = " << ticket << " !!\n";
+    }
+    receive(true);
+    dispatch();
+    response_received = responses_.find(ticket);
+  }
+  const bool isError = response_received->second.isError_;
+  response.swap(response_received->second.message_);
+  responses_.erase(response_received);
+  if ( isError )
+    throw cms::Exception("MEMbbwwProcessPool")
+      << "Worker process failed to process request with ticket = " << ticket << ": " << response << " !!\n";
+}
+
+unsigned
+MEMbbwwProcessPool::numProcesses() const
+{
+  return workers_.size();
+}
+
+void
+MEMbbwwProcessPool::dispatch()
+{
+  for ( size_t idxWorker = 0; idxWorker < workers_.size() && !requests_.empty(); ++idxWorker ) {
+    workerType & worker = workers_[idxWorker];
+    if ( worker.isBusy_ ) continue;
+    if ( !writeMessage(worker.fd_, requests_.front().second) )
+      throw cms::Exception("MEMbbwwProcessPool")
+        << "Worker process #" << idxWorker << " terminated unexpectedly !!\n";
+    worker.isBusy_ = true;
+    worker.ticket_ = requests_.front().first;
+    requests_.pop_front();
+  }
+}
+
+void
+MEMbbwwProcessPool::receive(bool wait)
+{
+  std::vector<pollfd> fds;
+  std::vector<size_t> idxWorkers;
+  for ( size_t idxWorker = 0; idxWorker < workers_.size(); ++idxWorker ) {
+    if ( !workers_[idxWorker].isBusy_ ) continue;
+    fds.push_back({ workers_[idxWorker].fd_, POLLIN, 0 });
+    idxWorkers.push_back(idxWorker);
+  }
+  if ( fds.empty() ) return;
+  if ( poll(fds.data(), fds.size(), ( wait ) ? -1 : 0) < 0 ) {
+    if ( errno == EINTR ) return;
+    throw cms::Exception("MEMbbwwProcessPool")
+      << "Failed to poll worker processes !!\n";
+  }
+  std::string message;
+  std::string timing;
+  for ( size_t idxFd = 0; idxFd < fds.size(); ++idxFd ) {
+    if ( !fds[idxFd].revents ) continue;
+    workerType & worker = workers_[idxWorkers[idxFd]];
+    if ( !readMessage(worker.fd_, message) || message.empty() || !readMessage(worker.fd_, timing) )
+      throw cms::Exception("MEMbbwwProcessPool")
+        << "Worker process #" << idxWorkers[idxFd] << " terminated unexpectedly !!\n";
+    responseType & response = responses_[worker.ticket_];
+    response.isError_ = message[0] != status_ok;
+    response.message_.assign(message, 1, std::string::npos);
+    worker.isBusy_ = false;
+    if ( timingManager_ ) {
+      const char * data = timing.data();
+      const char * data_end = data + timing.size();
+      while ( data < data_end ) {
+        // the phase names are sent including their terminating null character
+        const char * phase = data;
+        data += std::strlen(phase) + 1;
+        const Long64_t numCalls = readValue<Long64_t>(data);
+        const double wallTime = readValue<double>(data);
+        const double cpuTime = readValue<double>(data);
+        timingManager_->addTotals(phase, numCalls, wallTime, cpuTime);
+      }
+    }
+  }
+}
+
+void
+MEMbbwwProcessPool::work(int fd)
+{
+  std::string request;
+  std::string response;
+  std::string message;
+  std::string timing;
+  while ( readMessage(fd, request) ) {
+    // only the times spent on this request are sent to the calling process
+    if ( timingManager_ ) timingManager_->clear();
+    message.assign(1, status_ok);
+    try {
+      response.clear();
+      handler_(request, response);
+      message.append(response);
+    } catch ( const std::exception & exception ) {
+      message.assign(1, status_error);
+      message.append(exception.what());
+    } catch ( ... ) {
+      message.assign(1, status_error);
+      message.append("unknown exception");
+    }
+    timing.clear();
+    if ( timingManager_ ) {
+      for ( size_t idxPhase = 0; idxPhase < timingManager_->getNumPhases(); ++idxPhase ) {
+        const char * phase = nullptr;
+        Long64_t numCalls = 0;
+        double wallTime = 0.;
+        double cpuTime = 0.;
+        timingManager_->getTotals(idxPhase, phase, numCalls, wallTime, cpuTime);
+        if ( numCalls == 0 ) continue;
+        timing.append(phase, std::strlen(phase) + 1);
+        appendValue(timing, numCalls);
+        appendValue(timing, wallTime);
+        appendValue(timing, cpuTime);
+      }
+    }
+    if ( !writeMessage(fd, message) || !writeMessage(fd, timing) ) break;
+  }
+  close(fd);
+}
@@ -0,0 +1,200 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwResultCache.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TSystem.h> // gSystem
+
+#include <algorithm> // std::equal
+#include <fstream> // std::ifstream, std::ofstream
+#include <sstream> // std::ostringstream
+#include <iomanip> // std::setw, std::setfill
+#include <cstdio> // std::rename, std::remove
+#include <cstdint> // uint32_t, uint64_t
+#include <cstdlib> // std::getenv
+
+namespace
+{
+  const char cacheFileMagic[4] = { 'M', 'E', 'M', 'C' };
+  // version of the file format, to be incremented whenever the content of the key or of the payload changes
+  const uint32_t cacheFileVersion = 5;
+
+  std::atomic<long> tmpFileCounter(0);
+
+  bool
+  readBytes(std::istream & stream, std::string & bytes)
+  {
+    uint64_t size = 0;
+    if ( !stream.read(reinterpret_cast<char *>(&size), sizeof(size)) ) return false;
+    bytes.resize(size);
+    return size == 0 || stream.read(&bytes[0], size);
+  }
+
+  void
+  writeBytes(std::ostream & stream, const std::string & bytes)
+  {
+    const uint64_t size = bytes.size();
+    stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    stream.write(bytes.data(), size);
+  }
+
+  /// 64-bit FNV-1a hash, as hexadecimal string
+  std::string
+  hash_fnv1a(const std::string & bytes)
+  {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for ( std::string::const_iterator byte = bytes.begin(); byte != bytes.end(); ++byte ) {
+      hash ^= static_cast<unsigned char>(*byte);
+      hash *= 0x100000001b3ULL;
+    }
+    std::ostringstream hash_string;
+    hash_string << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return hash_string.str();
+  }
+
+  std::string
+  readFile(const std::string & fileName)
+  {
+    std::ifstream file(fileName.data(), std::ios::in | std::ios::binary);
+    if ( !file )
+      throw cms::Exception("MEMbbwwResultCache")
+        << "Failed to open file = " << fileName << " !!\n";
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  std::string
+  computeMEMVersion()
+  {
+    const char * scramArch = std::getenv("SCRAM_ARCH");
+    const char * baseDirNames[] = { std::getenv("CMSSW_BASE"), std::getenv("CMSSW_RELEASE_BASE") };
+    for ( const char * baseDirName : baseDirNames ) {
+      if ( !baseDirName || !scramArch ) continue;
+      const std::string libraryFileName = std::string(baseDirName) + "/lib/" + scramArch + "/libhhAnalysisbbwwMEM.so";
+      if ( gSystem->AccessPathName(libraryFileName.data()) ) continue; // AccessPathName returns true if the file does not exist
+      return hash_fnv1a(readFile(libraryFileName));
+    }
+    throw cms::Exception("MEMbbwwResultCache")
+      << "Failed to find shared library of the hhAnalysis/bbwwMEM package, needed to identify the version of the MEM algorithms !!\n";
+  }
+}
+
+MEMbbwwResultCache::Key &
+MEMbbwwResultCache::Key::add(double value)
+{
+  bytes_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  return *this;
+}
+
+MEMbbwwResultCache::Key &
+MEMbbwwResultCache::Key::add(int value)
+{
+  bytes_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  return *this;
+}
+
+MEMbbwwResultCache::Key &
+MEMbbwwResultCache::Key::add(const std::string & value)
+{
+  // prefix strings by their length, so that e.g. ("ab", "c") and ("a", "bc") give different keys
+  const uint64_t size = value.size();
+  bytes_.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  bytes_.append(value);
+  return *this;
+}
+
+MEMbbwwResultCache::Key &
+MEMbbwwResultCache::Key::addFile(const std::string & fileName)
+{
+  return add(readFile(fileName));
+}
+
+const std::string &
+MEMbbwwResultCache::Key::bytes() const
+{
+  return bytes_;
+}
+
+std::string
+MEMbbwwResultCache::Key::hash() const
+{
+  return hash_fnv1a(bytes_);
+}
+
+MEMbbwwResultCache::MEMbbwwResultCache(const std::string & cacheDirName)
+  : cacheDirName_(cacheDirName)
+  , numHits_(0)
+  , numMisses_(0)
+  , numWrites_(0)
+{
+  if ( gSystem->mkdir(cacheDirName_.data(), true) != 0 && gSystem->AccessPathName(cacheDirName_.data()) )
+    throw cms::Exception("MEMbbwwResultCache")
+      << "Failed to create cache directory = " << cacheDirName_ << " !!\n";
+}
+
+MEMbbwwResultCache::~MEMbbwwResultCache()
+{}
+
+const std::string &
+MEMbbwwResultCache::getMEMVersion()
+{
+  // the shared library is read only once per process (the initialization of function-local statics is thread-safe)
+  static const std::string memVersion = computeMEMVersion();
+  return memVersion;
+}
+
+void
+MEMbbwwResultCache::print(std::ostream & stream) const
+{
+  stream << "MEM result cache = " << cacheDirName_ << " (MEM version = " << getMEMVersion() << "):"
+         << " hits = " << numHits_ << ", misses = " << numMisses_ << ", writes = " << numWrites_ << std::endl;
+}
+
+std::string
+MEMbbwwResultCache::getFileName(const Key & key) const
+{
+  // distribute the files over 256 subdirectories, to keep the number of files per directory manageable
+  const std::string hash = key.hash();
+  return cacheDirName_ + "/" + hash.substr(0, 2) + "/" + hash + ".mem";
+}
+
+bool
+MEMbbwwResultCache::read(const Key & key, std::string & payload) const
+{
+  std::ifstream file(getFileName(key).data(), std::ios::in | std::ios::binary);
+  if ( !file ) return false;
+  char magic[sizeof(cacheFileMagic)];
+  uint32_t version = 0;
+  if ( !file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), cacheFileMagic) ) return false;
+  if ( !file.read(reinterpret_cast<char *>(&version), sizeof(version)) || version != cacheFileVersion ) return false;
+  std::string key_cached;
+  if ( !readBytes(file, key_cached) || key_cached != key.bytes() ) return false;
+  return readBytes(file, payload);
+}
+
+void
+MEMbbwwResultCache::write(const Key & key, const std::string & payload)
+{
+  const std::string fileName = getFileName(key);
+  const std::string dirName = fileName.substr(0, fileName.find_last_of('/'));
+  gSystem->mkdir(dirName.data(), true);
+  std::ostringstream tmpFileName;
+  tmpFileName << fileName << ".tmp" << gSystem->GetPid() << "_" << tmpFileCounter++;
+  {
+    std::ofstream file(tmpFileName.str().data(), std::ios::out | std::ios::binary);
+    file.write(cacheFileMagic, sizeof(cacheFileMagic));
+    file.write(reinterpret_cast<const char *>(&cacheFileVersion), sizeof(cacheFileVersion));
+    writeBytes(file, key.bytes());
+    writeBytes(file, payload);
+    if ( !file ) {
+      std::cerr << "Warning in <MEMbbwwResultCache::write>: Failed to write file = " << tmpFileName.str() << " !!" << std::endl;
+      std::remove(tmpFileName.str().data());
+      return;
+    }
+  }
+  if ( std::rename(tmpFileName.str().data(), fileName.data()) != 0 ) {
+    std::remove(tmpFileName.str().data());
+    return;
+  }
+  ++numWrites_;
+}
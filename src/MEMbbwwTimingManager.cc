@@ -0,0 +1,183 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwTimingManager.h"
+
+#include "tthAnalysis/HiggsToTauTau/interface/histogramAuxFunctions.h"     // createSubdirectory_recursively
+#include "tthAnalysis/HiggsToTauTau/interface/TypeTraits.h"                // Traits<>
+
+#include <TTree.h> // TTree
+
+#include <iomanip> // std::setw, std::setprecision, std::fixed
+#include <cstring> // std::strncpy
+#include <time.h>  // clock_gettime, CLOCK_THREAD_CPUTIME_ID
+
+MEMbbwwTimingManager::MEMbbwwTimingManager(const std::string & outputDirectoryName, const std::string & outputTreeName)
+  : outputDirectoryName_(outputDirectoryName)
+  , outputTreeName_(outputTreeName)
+  , lastEntryIdx_(0)
+{}
+
+MEMbbwwTimingManager::~MEMbbwwTimingManager()
+{}
+
+void
+MEMbbwwTimingManager::add(const char * phase, double wallTime, double cpuTime)
+{
+  addTotals(phase, 1, wallTime, cpuTime);
+}
+
+void
+MEMbbwwTimingManager::addTotals(const char * phase, Long64_t numCalls, double wallTime, double cpuTime)
+{
+  // the number of phases is small, so a linear search is sufficient;
+  // consecutive calls often refer to the same phase, which is hence checked first
+  if ( !(lastEntryIdx_ < entries_.size() && entries_[lastEntryIdx_].phase_ == phase) )
+  {
+    lastEntryIdx_ = 0;
+    while ( lastEntryIdx_ < entries_.size() && entries_[lastEntryIdx_].phase_ != phase )
+    {
+      ++lastEntryIdx_;
+    }
+    if ( lastEntryIdx_ == entries_.size() )
+    {
+      entries_.push_back(timingEntry(phase));
+    }
+  }
+  timingEntry & entry = entries_[lastEntryIdx_];
+  entry.numCalls_ += numCalls;
+  entry.wallTime_ += wallTime;
+  entry.cpuTime_  += cpuTime;
+}
+
+void
+MEMbbwwTimingManager::getTotals(std::vector<std::string> & phases, std::vector<Long64_t> & numCalls,
+                                std::vector<double> & wallTimes, std::vector<double> & cpuTimes) const
+{
+  phases.clear();
+  numCalls.clear();
+  wallTimes.clear();
+  cpuTimes.clear();
+  for ( std::vector<timingEntry>::const_iterator entry = entries_.begin();
+        entry != entries_.end(); ++entry )
+  {
+    phases.push_back(entry->phase_);
+    numCalls.push_back(entry->numCalls_);
+    wallTimes.push_back(entry->wallTime_);
+    cpuTimes.push_back(entry->cpuTime_);
+  }
+}
+
+size_t
+MEMbbwwTimingManager::getNumPhases() const
+{
+  return entries_.size();
+}
+
+void
+MEMbbwwTimingManager::getTotals(size_t idxPhase, const char * & phase, Long64_t & numCalls, double & wallTime, double & cpuTime) const
+{
+  const timingEntry & entry = entries_.at(idxPhase);
+  phase = entry.phase_.data();
+  numCalls = entry.numCalls_;
+  wallTime = entry.wallTime_;
+  cpuTime = entry.cpuTime_;
+}
+
+void
+MEMbbwwTimingManager::clear()
+{
+  for ( std::vector<timingEntry>::iterator entry = entries_.begin();
+        entry != entries_.end(); ++entry )
+  {
+    entry->numCalls_ = 0;
+    entry->wallTime_ = 0.;
+    entry->cpuTime_ = 0.;
+  }
+}
+
+void
+MEMbbwwTimingManager::print(std::ostream & stream) const
+{
+  stream << "timing summary:\n";
+  stream << " " << std::setw(40) << std::left << "phase" << std::right
+         << std::setw(12) << "#calls"
+         << std::setw(14) << "wall [s]"
+         << std::setw(14) << "CPU [s]"
+         << std::setw(16) << "CPU/call [ms]" << '\n';
+  for ( std::vector<timingEntry>::const_iterator entry = entries_.begin();
+        entry != entries_.end(); ++entry )
+  {
+    const double cpuTime_per_call = ( entry->numCalls_ > 0 ) ? 1.e+3*entry->cpuTime_/entry->numCalls_ : 0.;
+    stream << " " << std::setw(40) << std::left << entry->phase_ << std::right
+           << std::setw(12) << entry->numCalls_
+           << std::fixed << std::setprecision(3)
+           << std::setw(14) << entry->wallTime_
+           << std::setw(14) << entry->cpuTime_
+           << std::setw(16) << cpuTime_per_call << '\n';
+    stream.unsetf(std::ios_base::floatfield);
+  }
+  stream << std::flush;
+}
+
+void
+MEMbbwwTimingManager::writeTree(TFileDirectory & dir) const
+{
+  TDirectory * subDir = createSubdirectory_recursively(dir, outputDirectoryName_);
+  subDir->cd();
+  TTree * tree = new TTree(outputTreeName_.c_str(), outputTreeName_.c_str());
+
+  const size_t maxPhaseLength = 256;
+  char phase[maxPhaseLength];
+  Long64_t numCalls;
+  Double_t wallTime;
+  Double_t cpuTime;
+  tree->Branch("phase",    phase,     "phase/C");
+  tree->Branch("numCalls", &numCalls, Form("numCalls/%s", Traits<Long64_t>::TYPE_NAME));
+  tree->Branch("wallTime", &wallTime, Form("wallTime/%s", Traits<Double_t>::TYPE_NAME));
+  tree->Branch("cpuTime",  &cpuTime,  Form("cpuTime/%s",  Traits<Double_t>::TYPE_NAME));
+
+  for ( std::vector<timingEntry>::const_iterator entry = entries_.begin();
+        entry != entries_.end(); ++entry )
+  {
+    std::strncpy(phase, entry->phase_.data(), maxPhaseLength - 1);
+    phase[maxPhaseLength - 1] = '\0';
+    numCalls = entry->numCalls_;
+    wallTime = entry->wallTime_;
+    cpuTime  = entry->cpuTime_;
+    tree->Fill();
+  }
+  // the TTree is written to the output file by the TFileService at the end of the job
+  tree->ResetBranchAddresses();
+  dir.cd();
+}
+
+MEMbbwwScopedTimer::MEMbbwwScopedTimer(MEMbbwwTimingManager * timingManager, const char * phase)
+  : timingManager_(timingManager)
+  , phase_(phase)
+  , wallTime_start_(std::chrono::steady_clock::now())
+  , cpuTime_start_(getThreadCpuTime())
+  , isRunning_(true)
+{}
+
+MEMbbwwScopedTimer::~MEMbbwwScopedTimer()
+{
+  stop();
+}
+
+void
+MEMbbwwScopedTimer::stop()
+{
+  if ( !isRunning_ ) return;
+  isRunning_ = false;
+  if ( timingManager_ )
+  {
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - wallTime_start_;
+    timingManager_->add(phase_, wallTime.count(), getThreadCpuTime() - cpuTime_start_);
+  }
+}
+
+double
+getThreadCpuTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1.e-9*ts.tv_nsec;
+}
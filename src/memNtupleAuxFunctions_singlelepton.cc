@@ -2,6 +2,18 @@
 
 #include "hhAnalysis/bbwwMEM/interface/measuredParticleAuxFunctions.h" // findGenMatch
 
+namespace
+{
+  template <typename T>
+  const T*
+  findGenMatch(const MEMEventParticle & measuredParticle, const std::vector<const T*> & genParticles)
+  {
+    if ( !measuredParticle.isValid() ) return nullptr;
+    const mem::MeasuredParticle measuredParticle_mem = measuredParticle.measuredParticle();
+    return mem::findGenMatch(&measuredParticle_mem, genParticles);
+  }
+}
+
 void
 addGenMatches_singlelepton(MEMEvent_singlelepton & memEvent,
                            const std::vector<const GenJet*> & genBJets,
@@ -9,11 +21,11 @@ addGenMatches_singlelepton(MEMEvent_singlelepton & memEvent,
                            const std::vector<const GenLepton*> & genLeptons,
                            double genMEtPx, double genMEtPy)
 {
-  memEvent.set_genBJet1(mem::findGenMatch(memEvent.measuredBJet1(), genBJets));
-  memEvent.set_genBJet2(mem::findGenMatch(memEvent.measuredBJet2(), genBJets));
-  memEvent.set_genWJet1(mem::findGenMatch(memEvent.measuredWJet1(), genWJets));
-  memEvent.set_genWJet2(mem::findGenMatch(memEvent.measuredWJet2(), genWJets));
-  memEvent.set_genLepton(mem::findGenMatch(memEvent.measuredLepton(), genLeptons));
+  memEvent.set_genBJet1(findGenMatch(memEvent.measuredBJet1(), genBJets));
+  memEvent.set_genBJet2(findGenMatch(memEvent.measuredBJet2(), genBJets));
+  memEvent.set_genWJet1(findGenMatch(memEvent.measuredWJet1(), genWJets));
+  memEvent.set_genWJet2(findGenMatch(memEvent.measuredWJet2(), genWJets));
+  memEvent.set_genLepton(findGenMatch(memEvent.measuredLepton(), genLeptons));
   memEvent.set_genMEtPx(genMEtPx);
   memEvent.set_genMEtPy(genMEtPy);
 }
@@ -0,0 +1,1251 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/memPerformancePlotsAuxFunctions.h"
+
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/MEMbbwwHistogramCache.h" // MEMbbwwHistogramCache
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <TAxis.h> // TAxis
+#include <TCanvas.h> // TCanvas
+#include <TGraph.h> // TGraph
+#include <TH1.h> // TH1
+#include <TLegend.h> // TLegend
+#include <TLine.h> // TLine
+#include <TMath.h> // TMath::Nint, TMath::Abs, TMath::Sqrt
+#include <TPad.h> // TPad
+#include <TPaveText.h> // TPaveText
+#include <TString.h> // Form
+
+#include <algorithm> // std::min, std::max
+#include <atomic> // std::atomic
+#include <cstdio> // fflush
+#include <exception> // std::exception
+#include <iostream> // std::cout, std::cerr
+#include <new> // placement new
+#include <thread> // std::thread::hardware_concurrency
+#include <assert.h> // assert
+#include <sys/mman.h> // mmap, munmap
+#include <sys/wait.h> // waitpid
+#include <unistd.h> // fork, _exit
+
+bool makePlots_png  = true;
+bool makePlots_pdf  = true;
+bool makePlots_root = true;
+
+TH1* loadHistogram(MEMbbwwHistogramCache& histogramCache, const std::string& inputFileName,
+                   const std::string& directory_part1, const std::string& directory_part2, int signal_or_background, const std::string& histogramName)
+{
+  std::string directory = directory_part1;
+  if ( directory.back() != '/' ) directory.append("/");
+  directory.append(directory_part2);
+  if ( directory.back() != '/' ) directory.append("/");
+  if      ( signal_or_background == kSignal_lo      ) directory.append("signal_lo");
+  else if ( signal_or_background == kSignal_nlo     ) directory.append("signal_nlo");
+  else if ( signal_or_background == kBackground_lo  ) directory.append("background_lo");
+  else if ( signal_or_background == kBackground_nlo ) directory.append("background_nlo");
+  else assert(0);
+  return histogramCache.getHistogram(inputFileName, directory, histogramName);
+}
+
+TH1* addHistograms(const std::string& histogramSumName, const TH1* histogram1, const TH1* histogram2, const TH1* histogram3)
+{
+  TH1* histogramSum = (TH1*)histogram1->Clone(histogramSumName.data());
+  histogramSum->Reset();
+  if ( !histogramSum->GetSumw2N() ) histogramSum->Sumw2();
+  histogramSum->Add(histogram1);
+  histogramSum->Add(histogram2);
+  if ( histogram3 ) histogramSum->Add(histogram3);
+  double integral = histogramSum->Integral(1, histogramSum->GetNbinsX()); // CV: exclude underflow and overflow bins
+  if ( integral > 0. ) histogramSum->Scale(1./integral);
+  return histogramSum;
+}
+
+TH1* rebinHistogram(const TH1* histogram, int numBinsX, MEMbbwwHistogramCache* histogramCache)
+{
+  if ( histogramCache ) {
+    return (TH1*)histogramCache->getHistogram_rebinned(histogram, numBinsX)->Clone(Form("%s_rebinned", histogram->GetName()));
+  }
+  TH1* histogram_rebinned = (TH1*)histogram->Clone(Form("%s_rebinned", histogram->GetName()));
+  if ( !histogram_rebinned->GetSumw2N() ) histogram_rebinned->Sumw2();
+  if ( numBinsX < histogram->GetNbinsX() && (histogram->GetNbinsX() % numBinsX) == 0 ) {
+    histogram_rebinned->Rebin(histogram->GetNbinsX() / numBinsX);
+  }
+  return histogram_rebinned;
+}
+
+void showHistograms(double canvasSizeX, double canvasSizeY,
+		    TH1* histogram1, const std::string& legendEntry1,
+		    TH1* histogram2, const std::string& legendEntry2,
+		    TH1* histogram3, const std::string& legendEntry3,
+		    TH1* histogram4, const std::string& legendEntry4,
+		    int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		    double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+		    const std::string& labelText, double labelTextSize,
+		    double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		    int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		    bool useLogScale, double yMin, double yMax, const std::string& yAxisTitle, double yAxisOffset,
+		    const std::string& outputFileName,
+		    MEMbbwwHistogramCache* histogramCache)
+{
+  const double margin_top      = ( labelText != "" ) ? 0.065 : 0.025;
+  const double margin_left     = ( outputFileName.find("_prob") != std::string::npos ) ? 0.162 : 0.150;
+  const double margin_bottom   = ( outputFileName.find("_prob") != std::string::npos ) ? 0.140 : 0.125;
+  const double margin_right    = 0.015;
+
+  TCanvas* canvas = new TCanvas("canvas", "canvas", canvasSizeX, canvasSizeY);
+  canvas->SetFillColor(10);
+  canvas->SetBorderSize(2);
+  canvas->SetTopMargin(margin_top);
+  canvas->SetLeftMargin(margin_left);
+  canvas->SetBottomMargin(margin_bottom);
+  canvas->SetRightMargin(margin_right); 
+  canvas->SetLogx(false);
+  canvas->SetLogy(useLogScale);
+  canvas->Draw();
+  canvas->cd();
+
+  assert(histogram1);
+  double numBinsX_forRebinning;
+  if ( xMax > xMin ) {
+    const TAxis* xAxis = histogram1->GetXaxis();
+    assert(xAxis->GetXmax() > xAxis->GetXmin());
+    numBinsX_forRebinning = TMath::Nint(numBinsX*(xAxis->GetXmax() - xAxis->GetXmin())/(xMax - xMin));
+    //std::cout << "numBinsX = " << numBinsX << ": numBinsX_forRebinning = " << numBinsX_forRebinning << std::endl;
+  } else {
+    numBinsX_forRebinning = numBinsX;
+  }
+  
+  assert(histogram1);
+  TH1* histogram1_rebinned = rebinHistogram(histogram1, numBinsX_forRebinning, histogramCache);
+  histogram1_rebinned->SetFillColor(0);
+  histogram1_rebinned->SetFillStyle(0);
+  histogram1_rebinned->SetLineColor(colors[0]);
+  histogram1_rebinned->SetLineStyle(lineStyles[0]);
+  histogram1_rebinned->SetLineWidth(lineWidths[0]);
+  histogram1_rebinned->SetMarkerColor(colors[0]);
+  histogram1_rebinned->SetMarkerStyle(markerStyles[0]);
+  histogram1_rebinned->SetMarkerSize(markerSizes[0]);
+
+  assert(histogram2);
+  TH1* histogram2_rebinned = rebinHistogram(histogram2, numBinsX_forRebinning, histogramCache);
+  histogram2_rebinned->SetFillColor(0);
+  histogram2_rebinned->SetFillStyle(0);
+  histogram2_rebinned->SetLineColor(colors[1]);
+  histogram2_rebinned->SetLineStyle(lineStyles[1]);
+  histogram2_rebinned->SetLineWidth(lineWidths[1]);
+  histogram2_rebinned->SetMarkerColor(colors[1]);
+  histogram2_rebinned->SetMarkerStyle(markerStyles[1]);
+  histogram2_rebinned->SetMarkerSize(markerSizes[1]);
+
+  TH1* histogram3_rebinned = nullptr;     
+  if ( histogram3 ) {
+    histogram3_rebinned = rebinHistogram(histogram3, numBinsX_forRebinning, histogramCache);
+    histogram3_rebinned->SetFillColor(0);
+    histogram3_rebinned->SetFillStyle(0);
+    histogram3_rebinned->SetLineColor(colors[2]);
+    histogram3_rebinned->SetLineStyle(lineStyles[2]);
+    histogram3_rebinned->SetLineWidth(lineWidths[2]);
+    histogram3_rebinned->SetMarkerColor(colors[2]);
+    histogram3_rebinned->SetMarkerStyle(markerStyles[2]);
+    histogram3_rebinned->SetMarkerSize(markerSizes[2]);
+  }
+
+  TH1* histogram4_rebinned = nullptr; 
+  if ( histogram4 ) {
+    histogram4_rebinned = rebinHistogram(histogram4, numBinsX_forRebinning, histogramCache);
+    histogram4_rebinned->SetFillColor(0);
+    histogram4_rebinned->SetFillStyle(0);
+    histogram4_rebinned->SetLineColor(colors[3]);
+    histogram4_rebinned->SetLineStyle(lineStyles[3]);
+    histogram4_rebinned->SetLineWidth(lineWidths[3]);
+    histogram4_rebinned->SetMarkerColor(colors[3]);
+    histogram4_rebinned->SetMarkerStyle(markerStyles[3]);
+    histogram4_rebinned->SetMarkerSize(markerSizes[3]);
+  }
+  
+  TAxis* xAxis = histogram1_rebinned->GetXaxis();
+  xAxis->SetTitle(xAxisTitle.data());
+  xAxis->SetTitleOffset(xAxisOffset);
+  xAxis->SetTitleSize(60);
+  xAxis->SetTitleFont(43);
+  //xAxis->SetLabelOffset(-0.01);
+  xAxis->SetLabelSize(0.050);
+  if ( xMax > xMin ) {
+    xAxis->SetRangeUser(xMin, xMax);
+  }
+  xAxis->SetLabelFont(42);
+  xAxis->SetTickLength(0.040);
+  xAxis->SetNdivisions(505);
+
+  TAxis* yAxis = histogram1_rebinned->GetYaxis();
+  yAxis->SetTitle(yAxisTitle.data());
+  yAxis->SetTitleOffset(yAxisOffset);
+  yAxis->SetTitleSize(60);
+  yAxis->SetTitleFont(43);
+  if ( yMax > yMin ) {
+    yAxis->SetRangeUser(yMin, yMax);
+  }
+  //yAxis->SetLabelOffset(0.010);
+  yAxis->SetLabelSize(0.055);
+  yAxis->SetLabelFont(42);
+  yAxis->SetTickLength(0.040);  
+  yAxis->SetNdivisions(505);
+
+  histogram1_rebinned->SetTitle("");
+  histogram1_rebinned->SetStats(false);
+
+  histogram1_rebinned->Draw(Form("%ssame", drawOptions[0].data()));
+  histogram2_rebinned->Draw(Form("%ssame", drawOptions[1].data()));
+  if ( histogram3_rebinned ) histogram3_rebinned->Draw(Form("%ssame", drawOptions[2].data()));
+  if ( histogram4_rebinned ) histogram4_rebinned->Draw(Form("%ssame", drawOptions[3].data()));
+  histogram1_rebinned->Draw("axissame");
+
+  TPaveText* label = nullptr;
+  if ( labelText != "" ) {
+    label = new TPaveText(labelPosX, labelPosY, labelPosX + labelSizeX, labelPosY + labelSizeY, "NDC");
+    label->SetFillStyle(0);
+    label->SetBorderSize(0);
+    label->AddText(labelText.data());
+    label->SetTextFont(42);
+    label->SetTextSize(labelTextSize);
+    label->SetTextColor(1);
+    label->SetTextAlign(13);
+    label->Draw();
+  }
+
+  TLegend* legend = nullptr;
+  if ( legendEntry1 != "" && legendEntry2 != "" ) {
+    legend = new TLegend(legendPosX, legendPosY, legendPosX + legendSizeX, legendPosY + legendSizeY, NULL, "brNDC");
+    legend->SetFillColor(10);
+    legend->SetFillStyle(0);
+    legend->SetBorderSize(0);
+    legend->SetTextFont(42);
+    legend->SetTextSize(legendTextSize);
+    legend->SetTextColor(1);
+    legend->SetMargin(0.20);
+    legend->AddEntry(histogram1_rebinned, legendEntry1.data(), legendOptions[0].data());
+    legend->AddEntry(histogram2_rebinned, legendEntry2.data(), legendOptions[1].data());
+    if ( histogram3 ) legend->AddEntry(histogram3_rebinned, legendEntry3.data(), legendOptions[2].data());
+    if ( histogram4 ) legend->AddEntry(histogram4_rebinned, legendEntry4.data(), legendOptions[3].data());
+    legend->Draw();
+  }
+
+  canvas->Update();
+
+  std::string outputFileName_plot = "plots/";
+  size_t idx = outputFileName.find_last_of('.');
+  outputFileName_plot.append(std::string(outputFileName, 0, idx));
+  //if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
+  if ( makePlots_png  ) canvas->Print(std::string(outputFileName_plot).append(".png").data());
+  if ( makePlots_pdf  ) canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  if ( makePlots_root ) canvas->Print(std::string(outputFileName_plot).append(".root").data());
+
+  delete label;
+  delete legend;
+  delete histogram1_rebinned;
+  delete histogram2_rebinned;
+  delete histogram3_rebinned;
+  delete histogram4_rebinned;
+  delete canvas;
+}
+
+namespace
+{
+  double square(double x)
+  {
+    return x*x;
+  }
+}
+
+TH1* compRatioHistogram(const TH1* histogram_numerator, const TH1* histogram_denominator)
+{
+  assert(histogram_numerator->GetNbinsX() == histogram_denominator->GetNbinsX());
+
+  std::string histogramRatioName = Form("%s_div_%s", histogram_numerator->GetName(), histogram_denominator->GetName());
+  TH1* histogramRatio = (TH1*)histogram_numerator->Clone(histogramRatioName.data());
+  histogramRatio->Reset();
+  if ( !histogramRatio->GetSumw2N() ) histogramRatio->Sumw2();
+  histogramRatio->SetTitle("");
+  histogramRatio->SetStats(false);
+
+  int numBinsX = histogram_numerator->GetNbinsX();
+  for ( int idxBin = 1; idxBin <= numBinsX; ++idxBin ) {
+    double binContent_numerator   = histogram_numerator->GetBinContent(idxBin);
+    double binError_numerator     = histogram_numerator->GetBinError(idxBin);
+    double binContent_denominator = histogram_denominator->GetBinContent(idxBin);
+    double binError_denominator   = histogram_denominator->GetBinError(idxBin);
+
+    if ( binContent_denominator > 0. ) {
+      //double binContent_ratio = binContent_numerator/binContent_denominator - 1.;
+      double binContent_ratio = binContent_numerator/binContent_denominator;
+      double binErr2_ratio = 0.;
+      binErr2_ratio += square(binError_numerator/binContent_denominator);
+      binErr2_ratio += square(binError_denominator*binContent_numerator/square(binContent_denominator));
+      double binErr_ratio = TMath::Sqrt(binErr2_ratio);
+      histogramRatio->SetBinContent(idxBin, binContent_ratio);
+      histogramRatio->SetBinError(idxBin, binErr_ratio);
+    }
+  }
+  
+  return histogramRatio;
+}
+
+void copyHistogramStyle(const TH1* histogram_source, TH1* histogram_target)
+{
+  histogram_target->SetMarkerColor(histogram_source->GetMarkerColor());
+  histogram_target->SetMarkerSize(histogram_source->GetMarkerSize());
+  histogram_target->SetMarkerStyle(histogram_source->GetMarkerStyle());
+  histogram_target->SetLineColor(histogram_source->GetLineColor());
+  histogram_target->SetLineWidth(histogram_source->GetLineWidth());
+  histogram_target->SetLineStyle(histogram_source->GetLineStyle());
+  histogram_target->SetFillColor(histogram_source->GetFillColor());
+  histogram_target->SetFillStyle(histogram_source->GetFillStyle());
+}
+
+void showHistograms_wRatio(double canvasSizeX, double canvasSizeY,
+			   TH1* histogramRef, const std::string& legendEntryRef,
+			   TH1* histogram2, const std::string& legendEntry2,
+			   TH1* histogram3, const std::string& legendEntry3,
+			   TH1* histogram4, const std::string& legendEntry4,
+			   int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+			   double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+			   const std::string& labelText, double labelTextSize,
+			   double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+			   int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+			   bool useLogScale, double yMin, double yMax, double yMin_ratio, double yMax_ratio, const std::string& yAxisTitle, double yAxisOffset,
+			   const std::string& outputFileName,
+			   MEMbbwwHistogramCache* histogramCache)
+{
+  const double margin_top      = ( labelText != "" ) ? 0.065 : 0.025;
+  const double margin_left     = 0.170;
+  const double margin_bottom   = 0.155;
+  const double margin_right    = 0.015;
+  
+  const double topPad_sizeY    = 0.69;
+  const double clearance_sizeY = 0.02;
+  const double bottomPad_sizeY = 0.29;
+  const double sum_sizeY       = topPad_sizeY + clearance_sizeY + bottomPad_sizeY;
+
+  TCanvas* canvas = new TCanvas("canvas", "canvas", canvasSizeX, canvasSizeY);
+  canvas->SetFillColor(10);
+  canvas->SetBorderSize(2);
+  canvas->SetTopMargin(0.);
+  canvas->SetLeftMargin(0.);
+  canvas->SetBottomMargin(0.);
+  canvas->SetRightMargin(0.); 
+  canvas->Draw();
+  canvas->cd();
+
+  const double topPad_x0 = 0.;
+  const double topPad_x1 = 1.;
+  const double topPad_y1 = 1.;
+  const double topPad_y0 = topPad_y1 - topPad_sizeY/sum_sizeY;
+  assert(topPad_x1 > topPad_x0 && topPad_y1 > topPad_y0);
+
+  TPad* topPad = new TPad("topPad", "topPad", topPad_x0, topPad_y0, topPad_x1, topPad_y1);
+  topPad->SetFillColor(10);
+  topPad->SetBorderSize(0);
+  topPad->SetTopMargin(margin_top);
+  topPad->SetLeftMargin(margin_left);
+  topPad->SetBottomMargin(0.000);
+  topPad->SetRightMargin(margin_right); 
+  topPad->SetLogx(false);
+  topPad->SetLogy(useLogScale);
+  topPad->Draw();
+  topPad->cd();
+
+  assert(histogramRef);
+  double numBinsX_forRebinning;
+  if ( xMax > xMin ) {
+    const TAxis* xAxis = histogramRef->GetXaxis();
+    assert(xAxis->GetXmax() > xAxis->GetXmin());
+    numBinsX_forRebinning = TMath::Nint(numBinsX*(xAxis->GetXmax() - xAxis->GetXmin())/(xMax - xMin));
+    //std::cout << "numBinsX = " << numBinsX << ": numBinsX_forRebinning = " << numBinsX_forRebinning << std::endl;
+  } else {
+    numBinsX_forRebinning = numBinsX;
+  }
+  
+  assert(histogramRef);
+  TH1* histogramRef_rebinned = rebinHistogram(histogramRef, numBinsX_forRebinning, histogramCache);
+  histogramRef_rebinned->SetFillColor(0);
+  histogramRef_rebinned->SetFillStyle(0);
+  histogramRef_rebinned->SetLineColor(colors[0]);
+  histogramRef_rebinned->SetLineStyle(lineStyles[0]);
+  histogramRef_rebinned->SetLineWidth(lineWidths[0]);
+  histogramRef_rebinned->SetMarkerColor(colors[0]);
+  histogramRef_rebinned->SetMarkerStyle(markerStyles[0]);
+  histogramRef_rebinned->SetMarkerSize(markerSizes[0]);
+
+  assert(histogram2);
+  TH1* histogram2_rebinned = rebinHistogram(histogram2, numBinsX_forRebinning, histogramCache);
+  histogram2_rebinned->SetFillColor(0);
+  histogram2_rebinned->SetFillStyle(0);
+  histogram2_rebinned->SetLineColor(colors[1]);
+  histogram2_rebinned->SetLineStyle(lineStyles[1]);
+  histogram2_rebinned->SetLineWidth(lineWidths[1]);
+  histogram2_rebinned->SetMarkerColor(colors[1]);
+  histogram2_rebinned->SetMarkerStyle(markerStyles[1]);
+  histogram2_rebinned->SetMarkerSize(markerSizes[1]);
+
+  TH1* histogram3_rebinned = nullptr;     
+  if ( histogram3 ) {
+    histogram3_rebinned = rebinHistogram(histogram3, numBinsX_forRebinning, histogramCache);
+    histogram3_rebinned->SetFillColor(0);
+    histogram3_rebinned->SetFillStyle(0);
+    histogram3_rebinned->SetLineColor(colors[2]);
+    histogram3_rebinned->SetLineStyle(lineStyles[2]);
+    histogram3_rebinned->SetLineWidth(lineWidths[2]);
+    histogram3_rebinned->SetMarkerColor(colors[2]);
+    histogram3_rebinned->SetMarkerStyle(markerStyles[2]);
+    histogram3_rebinned->SetMarkerSize(markerSizes[2]);
+  }
+
+  TH1* histogram4_rebinned = nullptr; 
+  if ( histogram4 ) {
+    histogram4_rebinned = rebinHistogram(histogram4, numBinsX_forRebinning, histogramCache);
+    histogram4_rebinned->SetFillColor(0);
+    histogram4_rebinned->SetFillStyle(0);
+    histogram4_rebinned->SetLineColor(colors[3]);
+    histogram4_rebinned->SetLineStyle(lineStyles[3]);
+    histogram4_rebinned->SetLineWidth(lineWidths[3]);
+    histogram4_rebinned->SetMarkerColor(colors[3]);
+    histogram4_rebinned->SetMarkerStyle(markerStyles[3]);
+    histogram4_rebinned->SetMarkerSize(markerSizes[3]);
+  }
+  
+  TAxis* xAxis_top = histogramRef_rebinned->GetXaxis();
+  xAxis_top->SetTitle(xAxisTitle.data());
+  xAxis_top->SetTitleOffset(xAxisOffset);
+  xAxis_top->SetTitle(xAxisTitle.data());
+  xAxis_top->SetTitleOffset(xAxisOffset);
+  xAxis_top->SetTitleSize(65);
+  xAxis_top->SetTitleFont(43);
+  //xAxis_top->SetLabelOffset(-0.01);
+  xAxis_top->SetLabelSize(0.050);
+  if ( xMax > xMin ) {
+    xAxis_top->SetRangeUser(xMin, xMax);
+  }
+  xAxis_top->SetLabelFont(42);
+  xAxis_top->SetTickLength(0.040);
+  xAxis_top->SetNdivisions(505);
+  xAxis_top->SetLabelColor(10);
+  xAxis_top->SetTitleColor(10);
+
+  TAxis* yAxis_top = histogramRef_rebinned->GetYaxis();
+  yAxis_top->SetTitle(yAxisTitle.data());
+  yAxis_top->SetTitleOffset(yAxisOffset);
+  yAxis_top->SetTitleSize(65);
+  yAxis_top->SetTitleFont(43);
+  if ( yMax > yMin ) {
+    yAxis_top->SetRangeUser(yMin, yMax);
+  }
+  //yAxis_top->SetLabelOffset(0.010);
+  yAxis_top->SetLabelSize(0.055);
+  yAxis_top->SetLabelFont(42);
+  yAxis_top->SetTickLength(0.040);  
+  yAxis_top->SetNdivisions(505);
+
+  histogramRef_rebinned->SetTitle("");
+  histogramRef_rebinned->SetStats(false);
+
+  histogramRef_rebinned->Draw(drawOptions[0].data());
+  histogram2_rebinned->Draw(Form("%ssame", drawOptions[1].data()));
+  if ( histogram3_rebinned ) histogram3_rebinned->Draw(Form("%ssame", drawOptions[2].data()));
+  if ( histogram4_rebinned ) histogram4_rebinned->Draw(Form("%ssame", drawOptions[3].data()));
+  histogramRef_rebinned->Draw("axissame");
+
+  TPaveText* label = nullptr;
+  if ( labelText != "" ) {
+    label = new TPaveText(labelPosX, labelPosY, labelPosX + labelSizeX, labelPosY + labelSizeY, "NDC");
+    label->SetFillStyle(0);
+    label->SetBorderSize(0);
+    label->AddText(labelText.data());
+    label->SetTextFont(42);
+    label->SetTextSize(labelTextSize);
+    label->SetTextColor(1);
+    label->SetTextAlign(13);
+    label->Draw();
+  }
+
+  TLegend* legend = nullptr;
+  if ( legendEntryRef != "" && legendEntry2 != "" ) {
+    legend = new TLegend(legendPosX, legendPosY, legendPosX + legendSizeX, legendPosY + legendSizeY, NULL, "brNDC");
+    legend->SetFillColor(10);
+    legend->SetFillStyle(0);
+    legend->SetBorderSize(0);
+    legend->SetTextFont(42);
+    legend->SetTextSize(legendTextSize);
+    legend->SetTextColor(1);
+    legend->SetMargin(0.20);
+    legend->AddEntry(histogramRef_rebinned, legendEntryRef.data(), legendOptions[0].data());
+    legend->AddEntry(histogram2_rebinned, legendEntry2.data(), legendOptions[1].data());
+    if ( histogram3 ) legend->AddEntry(histogram3_rebinned, legendEntry3.data(), legendOptions[2].data());
+    if ( histogram4 ) legend->AddEntry(histogram4_rebinned, legendEntry4.data(), legendOptions[3].data());
+    legend->Draw();
+  }
+
+  canvas->cd();
+
+  const double bottomPad_x0 = 0.;
+  const double bottomPad_x1 = 1.;
+  const double bottomPad_y0 = 0.;
+  const double bottomPad_y1 = bottomPad_y0 + bottomPad_sizeY/sum_sizeY;
+  assert(bottomPad_x1 > bottomPad_x0 && bottomPad_y1 > bottomPad_y0);
+
+  TPad* bottomPad = new TPad("bottomPad", "bottomPad", bottomPad_x0, bottomPad_y0, bottomPad_x1, bottomPad_y1);
+  bottomPad->SetFillColor(10);
+  bottomPad->SetBorderSize(0);
+  bottomPad->SetTopMargin(0.000);
+  bottomPad->SetLeftMargin(margin_left);
+  bottomPad->SetBottomMargin(margin_bottom*topPad_sizeY/bottomPad_sizeY);
+  bottomPad->SetRightMargin(margin_right);
+  bottomPad->SetLogx(false);
+  bottomPad->SetLogy(false);
+  bottomPad->Draw();
+  bottomPad->cd();
+
+  TH1* histogramRatio2_rebinned = compRatioHistogram(histogram2_rebinned, histogramRef_rebinned);
+  copyHistogramStyle(histogram2_rebinned, histogramRatio2_rebinned);
+
+  TH1* histogramRatio3_rebinned = nullptr;
+  if ( histogram3_rebinned ) {
+    histogramRatio3_rebinned = compRatioHistogram(histogram3_rebinned, histogramRef_rebinned);
+    copyHistogramStyle(histogram3_rebinned, histogramRatio3_rebinned);
+  }
+
+  TH1* histogramRatio4_rebinned = nullptr;
+  if ( histogram4_rebinned ) {
+    histogramRatio4_rebinned = compRatioHistogram(histogram4_rebinned, histogramRef_rebinned);
+    copyHistogramStyle(histogram4_rebinned, histogramRatio4_rebinned);
+  }
+
+  TAxis* xAxis_bottom = histogramRatio2_rebinned->GetXaxis();
+  xAxis_bottom->SetTitle(xAxisTitle.data());
+  xAxis_bottom->SetTitleOffset(xAxisOffset);
+  xAxis_bottom->SetTitleSize(65);
+  xAxis_bottom->SetTitleFont(43);
+  //xAxis_bottom->SetLabelOffset(-0.01);
+  xAxis_bottom->SetLabelSize(0.132);
+  if ( xMax > xMin ) {
+    xAxis_bottom->SetRangeUser(xMin, xMax);
+  }
+  xAxis_bottom->SetLabelFont(42);
+  xAxis_bottom->SetTickLength(0.105);
+  xAxis_bottom->SetNdivisions(505);
+
+  TAxis* yAxis_bottom = histogramRatio2_rebinned->GetYaxis();
+  yAxis_bottom->SetTitle("Ratio");
+  yAxis_bottom->SetTitleOffset(yAxisOffset);
+  yAxis_bottom->SetTitleSize(65);
+  yAxis_bottom->SetTitleFont(43);
+  //yAxis_bottom->SetLabelOffset(0.010);
+  yAxis_bottom->SetLabelSize(0.132);
+  yAxis_bottom->SetLabelFont(42);
+  yAxis_bottom->SetTickLength(0.060);
+  yAxis_bottom->SetNdivisions(505);
+
+  histogramRatio2_rebinned->SetMinimum(yMin_ratio);
+  histogramRatio2_rebinned->SetMaximum(yMax_ratio);
+
+  histogramRatio2_rebinned->Draw(drawOptions[1].data());
+  
+  TGraph* graph_line = new TGraph(2);
+  graph_line->SetPoint(0, xAxis_bottom->GetXmin(), 1.);
+  graph_line->SetPoint(1, xAxis_bottom->GetXmax(), 1.);
+  graph_line->SetLineColor(colors[0]);
+  graph_line->SetLineStyle(lineStyles[0]);
+  graph_line->SetLineWidth(lineWidths[0]);
+  graph_line->Draw("L");
+
+  histogramRatio2_rebinned->Draw("same");
+
+  if ( histogramRatio3_rebinned ) histogramRatio3_rebinned->Draw(Form("%ssame", drawOptions[2].data()));
+  if ( histogramRatio4_rebinned ) histogramRatio4_rebinned->Draw(Form("%ssame", drawOptions[3].data()));
+  histogramRatio2_rebinned->Draw("axissame");
+
+  canvas->Update();
+
+  std::string outputFileName_plot = "plots/";
+  size_t idx = outputFileName.find_last_of('.');
+  outputFileName_plot.append(std::string(outputFileName, 0, idx));
+  //if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
+  if ( makePlots_png  ) canvas->Print(std::string(outputFileName_plot).append(".png").data());
+  if ( makePlots_pdf  ) canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  if ( makePlots_root ) canvas->Print(std::string(outputFileName_plot).append(".root").data());
+
+  delete label;
+  delete legend;
+  delete histogramRef_rebinned;
+  delete histogram2_rebinned;
+  delete histogramRatio2_rebinned;
+  delete histogram3_rebinned;
+  delete histogramRatio3_rebinned;
+  delete histogram4_rebinned;
+  delete histogramRatio4_rebinned;
+  delete graph_line;
+  delete topPad;
+  delete bottomPad;
+  delete canvas;
+}
+
+TGraph* compGraphEfficiency(const std::string& graphName, const TH1* histogram)
+{
+  const TAxis* xAxis = histogram->GetXaxis();
+  int numPoints = xAxis->GetNbins();
+  TGraph* graphEfficiency = new TGraph(numPoints + 2);
+  graphEfficiency->SetName(graphName.data());
+  graphEfficiency->SetPoint(0, xAxis->GetXmin(), 1.0);
+  double integral = histogram->Integral(1, histogram->GetNbinsX());
+  double sum = 0.;
+  for ( int idxPoint = 1; idxPoint <= numPoints; ++idxPoint ) {
+    int idxBin = idxPoint;
+    double binCenter = xAxis->GetBinCenter(idxBin);
+    double binContent = histogram->GetBinContent(idxBin);
+    sum += binContent;
+    graphEfficiency->SetPoint(idxPoint, binCenter, 1.0 - (sum/integral));
+  }
+  graphEfficiency->SetPoint(numPoints + 1, xAxis->GetXmax(), 0.0);
+  return graphEfficiency;
+} 
+
+TGraph* compGraphROC(const std::string& graphName, const TGraph* graphEfficiency_signal, const TGraph* graphEfficiency_background, bool useLogScale)
+{
+  //std::cout << "<compGraphROC>:" << std::endl;
+  //std::cout << " graphName = " << graphName << std::endl;
+  assert(graphEfficiency_signal->GetN() == graphEfficiency_background->GetN());
+  int numPoints = graphEfficiency_signal->GetN();
+  TGraph* graphROC = new TGraph(numPoints);
+  graphROC->SetName(graphName.data());
+  for ( int idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    double x, efficiency_signal;
+    graphEfficiency_signal->GetPoint(idxPoint, x, efficiency_signal);
+    double efficiency_background = graphEfficiency_background->Eval(x);
+    double xROC = efficiency_signal;
+    double yROC;
+    if ( useLogScale ) yROC = efficiency_background;
+    else yROC = 1.0 - efficiency_background;
+    //std::cout << "point #" << idxPoint << ": x = " << xROC << ", y = " << yROC << std::endl;
+    graphROC->SetPoint(idxPoint, xROC, yROC);
+  }
+  return graphROC;
+}
+
+TGraph* compGraphROC(const std::string& graphName, const TH1* histogram_signal, const TH1* histogram_background, bool useLogScale)
+{
+  //std::cout << "<compGraphROC>:" << std::endl;
+  //std::cout << " graphName = " << graphName << std::endl;
+  assert(histogram_signal->GetNbinsX() == histogram_background->GetNbinsX());
+  TGraph* graphEfficiency_signal = compGraphEfficiency(Form("%s_signal", graphName.data()), histogram_signal);
+  TGraph* graphEfficiency_background = compGraphEfficiency(Form("%s_background", graphName.data()), histogram_background);
+  TGraph* graphROC = compGraphROC(graphName, graphEfficiency_signal, graphEfficiency_background, useLogScale);
+  delete graphEfficiency_signal;
+  delete graphEfficiency_background;
+  return graphROC;
+}
+
+namespace
+{
+  struct graphPoint
+  {
+    graphPoint(double x, double y)
+      : x_(x)
+      , y_(y)
+    {}
+    ~graphPoint() {}
+    double x_;
+    double y_;
+  };
+}
+
+TGraph* sparsifyGraph(TGraph* graph, double minDeltaX, double maxDeltaY)
+{
+  std::vector<graphPoint> graphPoints_sparsified;
+  double x_last = -1.e+3;
+  double y_last = -1.e+3;
+  int numPoints = graph->GetN();
+  for ( int idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    double x, y;
+    graph->GetPoint(idxPoint, x, y);
+    if ( x < 0.01 ) continue; // CV: prevent point @ zero signal efficiency and zero background rate from being drawn
+    //if ( x > 0.99 ) continue; // CV: prevent point @ 100% signal efficiency and 100% background rate from being drawn
+    if ( idxPoint == 0 || TMath::Abs(x - x_last) > minDeltaX || TMath::Abs(y - y_last) > maxDeltaY || idxPoint == (numPoints - 1) ) {
+      graphPoints_sparsified.push_back(graphPoint(x, y));
+      x_last = x;
+      y_last = y;
+    }
+  }
+  int numPoints_sparsified = graphPoints_sparsified.size();
+  TGraph* graph_sparsified = new TGraph(numPoints_sparsified);
+  graph_sparsified->SetName(Form("%s_sparsified", graph->GetName()));
+  for ( int idxPoint = 0; idxPoint < numPoints_sparsified; ++idxPoint ) {
+    const graphPoint& graphPoint_sparsified = graphPoints_sparsified[idxPoint];
+    graph_sparsified->SetPoint(idxPoint, graphPoint_sparsified.x_, graphPoint_sparsified.y_);
+  }
+  return graph_sparsified;
+}
+
+void setLineStyle(TLine* line)
+{
+  line->SetLineColor(14);
+  line->SetLineStyle(7);
+  line->SetLineWidth(1);
+}
+
+void showGraphs(double canvasSizeX, double canvasSizeY,
+		TGraph* graph1, const std::string& legendEntry1,
+		TGraph* graph2, const std::string& legendEntry2,
+		TGraph* graph3, const std::string& legendEntry3,
+		TGraph* graph4, const std::string& legendEntry4,
+		int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions,
+		const std::string& labelText, double labelTextSize,
+		double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		bool useLogScale, double yMin, double yMax, const std::string& yAxisTitle, double yAxisOffset,
+		const std::string& outputFileName)
+{
+  const double margin_top      = ( labelText != "" ) ? 0.065 : 0.025;
+  const double margin_left     = 0.170;
+  const double margin_bottom   = 0.145;
+  const double margin_right    = 0.015;
+
+  TCanvas* canvas = new TCanvas("canvas", "canvas", canvasSizeX, canvasSizeY);
+  canvas->SetFillColor(10);
+  canvas->SetBorderSize(2);
+  canvas->SetTopMargin(margin_top);
+  canvas->SetLeftMargin(margin_left);
+  canvas->SetBottomMargin(margin_bottom);
+  canvas->SetRightMargin(margin_right); 
+  canvas->SetLogx(false);
+  canvas->SetLogy(useLogScale);
+  canvas->Draw();
+  canvas->cd();
+
+  assert(graph1);
+  TGraph* graph1_sparsified = sparsifyGraph(graph1);
+  graph1_sparsified->SetLineColor(colors[0]);
+  graph1_sparsified->SetLineStyle(lineStyles[0]);
+  graph1_sparsified->SetLineWidth(lineWidths[0]);
+  graph1_sparsified->SetMarkerColor(colors[0]);
+  graph1_sparsified->SetMarkerStyle(markerStyles[0]);
+  graph1_sparsified->SetMarkerSize(markerSizes[0]);
+
+  TGraph* graph2_sparsified = nullptr;
+  if ( graph2 ) {    
+    graph2_sparsified = sparsifyGraph(graph2);
+    graph2_sparsified->SetLineColor(colors[1]);
+    graph2_sparsified->SetLineStyle(lineStyles[1]);
+    graph2_sparsified->SetLineWidth(lineWidths[1]);
+    graph2_sparsified->SetMarkerColor(colors[1]);
+    graph2_sparsified->SetMarkerStyle(markerStyles[1]);
+    graph2_sparsified->SetMarkerSize(markerSizes[1]);
+  }
+  
+  TGraph* graph3_sparsified = nullptr;
+  if ( graph3 ) {    
+    graph3_sparsified = sparsifyGraph(graph3);
+    graph3_sparsified->SetLineColor(colors[2]);
+    graph3_sparsified->SetLineStyle(lineStyles[2]);
+    graph3_sparsified->SetLineWidth(lineWidths[2]);
+    graph3_sparsified->SetMarkerColor(colors[2]);
+    graph3_sparsified->SetMarkerStyle(markerStyles[2]);
+    graph3_sparsified->SetMarkerSize(markerSizes[2]);
+  }
+  
+  TGraph* graph4_sparsified = nullptr;
+  if ( graph4 ) {
+    graph4_sparsified = sparsifyGraph(graph4);
+    graph4_sparsified->SetLineColor(colors[3]);
+    graph4_sparsified->SetLineStyle(lineStyles[3]);
+    graph4_sparsified->SetLineWidth(lineWidths[3]);
+    graph4_sparsified->SetMarkerColor(colors[3]);
+    graph4_sparsified->SetMarkerStyle(markerStyles[3]);
+    graph4_sparsified->SetMarkerSize(markerSizes[3]);
+  }
+
+  TH1* dummyHistogram = new TH1D("dummyHistogram", "dummyHistogram", numBinsX, xMin, xMax);
+  dummyHistogram->SetTitle("");
+  dummyHistogram->SetStats(false);
+  assert(yMax > yMin);
+  dummyHistogram->SetMinimum(yMin);
+  dummyHistogram->SetMaximum(yMax);
+
+  TAxis* xAxis = dummyHistogram->GetXaxis();
+  xAxis->SetTitle(xAxisTitle.data());
+  xAxis->SetTitleOffset(xAxisOffset);
+  xAxis->SetTitleSize(55);
+  xAxis->SetTitleFont(43);
+  //xAxis->SetLabelOffset(-0.01);
+  xAxis->SetLabelSize(0.050);
+  xAxis->SetLabelFont(42);
+  xAxis->SetTickLength(0.040);
+  xAxis->SetNdivisions(505);
+
+  TAxis* yAxis = dummyHistogram->GetYaxis();
+  yAxis->SetTitle(yAxisTitle.data());
+  yAxis->SetTitleOffset(yAxisOffset);
+  yAxis->SetTitleSize(55);
+  yAxis->SetTitleFont(43);
+  //yAxis->SetLabelOffset(0.010);
+  yAxis->SetLabelSize(0.050);
+  yAxis->SetLabelFont(42);
+  yAxis->SetTickLength(0.040);  
+  yAxis->SetNdivisions(505);
+  
+  dummyHistogram->Draw("axis");
+  graph1_sparsified->Draw(drawOptions[0].data());
+  if ( graph2_sparsified ) graph2_sparsified->Draw(drawOptions[1].data());
+  if ( graph3_sparsified ) graph3_sparsified->Draw(drawOptions[2].data());
+  if ( graph4_sparsified ) graph4_sparsified->Draw(drawOptions[3].data());
+
+  std::vector<TLine*> lines;
+  if ( outputFileName == "hh_bbwwMEM_dilepton_effectOfFakes_2graphs_ROC.pdf" ) {
+    double x = 0.35;
+    assert(graph1);
+    double y1 = graph1->Eval(x);
+    TLine* line1_horizontal = new TLine(0., y1, x, y1);
+    setLineStyle(line1_horizontal);
+    line1_horizontal->Draw();
+    lines.push_back(line1_horizontal);
+    assert(graph2);
+    double y2 = graph2->Eval(x);
+    TLine* line2_horizontal = new TLine(0., y2, x, y2);
+    setLineStyle(line2_horizontal);
+    line2_horizontal->Draw();
+    lines.push_back(line2_horizontal);
+    TLine* line_vertical = new TLine(x, yMin, x, TMath::Max(y1, y2));
+    setLineStyle(line_vertical);
+    line_vertical->Draw();
+    lines.push_back(line_vertical);
+  } else if ( outputFileName == "hh_bbwwMEM_dilepton_effectOfFakes_ROC_missingBJet.pdf" ) {
+    double x = 0.35;
+    assert(graph1);
+    double y = graph1->Eval(x);
+    TLine* line_horizontal = new TLine(0., y, x, y);
+    setLineStyle(line_horizontal);
+    line_horizontal->Draw();
+    lines.push_back(line_horizontal);
+    TLine* line_vertical = new TLine(x, yMin, x, y);
+    setLineStyle(line_vertical);
+    line_vertical->Draw();
+    lines.push_back(line_vertical);
+  }
+
+  dummyHistogram->Draw("axissame");
+
+  TPaveText* label = nullptr;
+  if ( labelText != "" ) {
+    label = new TPaveText(labelPosX, labelPosY, labelPosX + labelSizeX, labelPosY + labelSizeY, "NDC");
+    label->SetFillStyle(0);
+    label->SetBorderSize(0);
+    label->AddText(labelText.data());
+    label->SetTextFont(42);
+    label->SetTextSize(labelTextSize);
+    label->SetTextColor(1);
+    label->SetTextAlign(13);
+    label->Draw();
+  }
+
+  TLegend* legend = nullptr;
+  if ( graph2_sparsified || graph3_sparsified || graph4_sparsified ) {
+    legend = new TLegend(legendPosX, legendPosY, legendPosX + legendSizeX, legendPosY + legendSizeY, NULL, "brNDC");
+    legend->SetFillColor(10);
+    legend->SetFillStyle(0);
+    legend->SetBorderSize(0);
+    legend->SetTextFont(42);
+    legend->SetTextSize(legendTextSize);
+    legend->SetTextColor(1);
+    legend->SetMargin(0.20);
+    legend->AddEntry(graph1_sparsified, legendEntry1.data(), legendOptions[0].data());
+    if ( graph2_sparsified ) legend->AddEntry(graph2_sparsified, legendEntry2.data(), legendOptions[1].data());
+    if ( graph3_sparsified ) legend->AddEntry(graph3_sparsified, legendEntry3.data(), legendOptions[2].data());
+    if ( graph4_sparsified ) legend->AddEntry(graph4_sparsified, legendEntry4.data(), legendOptions[3].data());
+    legend->Draw();
+  }
+
+  canvas->Update();
+
+  std::string outputFileName_plot = "plots/";
+  size_t idx = outputFileName.find_last_of('.');
+  outputFileName_plot.append(std::string(outputFileName, 0, idx));
+  //if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
+  if ( makePlots_png  ) canvas->Print(std::string(outputFileName_plot).append(".png").data());
+  if ( makePlots_pdf  ) canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  if ( makePlots_root ) canvas->Print(std::string(outputFileName_plot).append(".root").data());
+
+  delete label;
+  delete legend;
+  delete graph1_sparsified;
+  delete graph2_sparsified;
+  delete graph3_sparsified;
+  delete graph4_sparsified;
+  for ( std::vector<TLine*>::iterator line = lines.begin();
+        line != lines.end(); ++line ) {
+    delete (*line);
+  }
+  delete canvas;
+}
+
+TGraph* compRatioGraph(const TGraph* graph_numerator, const TGraph* graph_denominator)
+{
+  assert(graph_numerator->GetN() == graph_denominator->GetN());
+
+  std::string graphRatioName = Form("%s_div_%s", graph_numerator->GetName(), graph_denominator->GetName());
+  int numPoints = graph_numerator->GetN();
+  TGraph* graphRatio = new TGraph(numPoints);
+
+  for ( int idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    double x, y_numerator;
+    graph_numerator->GetPoint(idxPoint, x, y_numerator);
+
+    double y_denominator = graph_denominator->Eval(x);
+
+    if ( y_denominator > 0. ) {
+      //double y_ratio = y_numerator/y_denominator - 1.;
+      double y_ratio = y_numerator/y_denominator;
+      graphRatio->SetPoint(idxPoint, x, y_ratio);
+    }
+  }
+  
+  return graphRatio;
+}
+
+void copyGraphStyle(const TGraph* graph_source, TGraph* graph_target)
+{
+  graph_target->SetMarkerColor(graph_source->GetMarkerColor());
+  graph_target->SetMarkerSize(graph_source->GetMarkerSize());
+  graph_target->SetMarkerStyle(graph_source->GetMarkerStyle());
+  graph_target->SetLineColor(graph_source->GetLineColor());
+  graph_target->SetLineWidth(graph_source->GetLineWidth());
+  graph_target->SetLineStyle(graph_source->GetLineStyle());
+}
+
+void showGraphs_wRatio(double canvasSizeX, double canvasSizeY,
+		       TGraph* graphRef, const std::string& legendEntryRef,
+		       TGraph* graph2, const std::string& legendEntry2,
+		       TGraph* graph3, const std::string& legendEntry3,
+		       TGraph* graph4, const std::string& legendEntry4,
+		       int colors[], int markerStyles[], int markerSizes[], int lineStyles[], int lineWidths[], const std::vector<std::string>& drawOptions,
+		       double legendTextSize, double legendPosX, double legendPosY, double legendSizeX, double legendSizeY, const std::vector<std::string>& legendOptions, 
+		       const std::string& labelText, double labelTextSize,
+		       double labelPosX, double labelPosY, double labelSizeX, double labelSizeY,
+		       int numBinsX, double xMin, double xMax, const std::string& xAxisTitle, double xAxisOffset,
+		       bool useLogScale, double yMin, double yMax, double yMin_ratio, double yMax_ratio, const std::string& yAxisTitle, double yAxisOffset,
+		       const std::string& outputFileName)
+{
+  const double margin_top      = ( labelText != "" ) ? 0.065 : 0.025;
+  const double margin_left     = 0.170;
+  const double margin_bottom   = 0.145;
+  const double margin_right    = 0.015;
+  
+  const double topPad_sizeY    = 0.69;
+  const double clearance_sizeY = 0.02;
+  const double bottomPad_sizeY = 0.29;
+  const double sum_sizeY       = topPad_sizeY + clearance_sizeY + bottomPad_sizeY;
+
+  TCanvas* canvas = new TCanvas("canvas", "canvas", canvasSizeX, canvasSizeY);
+  canvas->SetFillColor(10);
+  canvas->SetBorderSize(2);
+  canvas->SetTopMargin(0.);
+  canvas->SetLeftMargin(0.);
+  canvas->SetBottomMargin(0.);
+  canvas->SetRightMargin(0.); 
+  canvas->Draw();
+  canvas->cd();
+
+  const double topPad_x0 = 0.;
+  const double topPad_x1 = 1.;
+  const double topPad_y1 = 1.;
+  const double topPad_y0 = topPad_y1 - topPad_sizeY/sum_sizeY;
+  assert(topPad_x1 > topPad_x0 && topPad_y1 > topPad_y0);
+
+  TPad* topPad = new TPad("topPad", "topPad", topPad_x0, topPad_y0, topPad_x1, topPad_y1);
+  topPad->SetFillColor(10);
+  topPad->SetBorderSize(0);
+  topPad->SetTopMargin(margin_top);
+  topPad->SetLeftMargin(margin_left);
+  topPad->SetBottomMargin(0.000);
+  topPad->SetRightMargin(margin_right); 
+  topPad->SetLogx(false);
+  topPad->SetLogy(useLogScale);
+  topPad->Draw();
+  topPad->cd();
+
+  assert(graphRef);
+  TGraph* graphRef_sparsified = sparsifyGraph(graphRef);
+  graphRef_sparsified->SetLineColor(colors[0]);
+  graphRef_sparsified->SetLineStyle(lineStyles[0]);
+  graphRef_sparsified->SetLineWidth(lineWidths[0]);
+  graphRef_sparsified->SetMarkerColor(colors[0]);
+  graphRef_sparsified->SetMarkerStyle(markerStyles[0]);
+  graphRef_sparsified->SetMarkerSize(markerSizes[0]);
+
+  assert(graph2);
+  TGraph* graph2_sparsified = sparsifyGraph(graph2);
+  graph2_sparsified->SetLineColor(colors[1]);
+  graph2_sparsified->SetLineStyle(lineStyles[1]);
+  graph2_sparsified->SetLineWidth(lineWidths[1]);
+  graph2_sparsified->SetMarkerColor(colors[1]);
+  graph2_sparsified->SetMarkerStyle(markerStyles[1]);
+  graph2_sparsified->SetMarkerSize(markerSizes[1]);
+  
+  TGraph* graph3_sparsified = nullptr;
+  if ( graph3 ) {    
+    graph3_sparsified = sparsifyGraph(graph3);
+    graph3_sparsified->SetLineColor(colors[2]);
+    graph3_sparsified->SetLineStyle(lineStyles[2]);
+    graph3_sparsified->SetLineWidth(lineWidths[2]);
+    graph3_sparsified->SetMarkerColor(colors[2]);
+    graph3_sparsified->SetMarkerStyle(markerStyles[2]);
+    graph3_sparsified->SetMarkerSize(markerSizes[2]);
+  }
+  
+  TGraph* graph4_sparsified = nullptr;
+  if ( graph4 ) {
+    graph4_sparsified = sparsifyGraph(graph4);
+    graph4_sparsified->SetLineColor(colors[3]);
+    graph4_sparsified->SetLineStyle(lineStyles[3]);
+    graph4_sparsified->SetLineWidth(lineWidths[3]);
+    graph4_sparsified->SetMarkerColor(colors[3]);
+    graph4_sparsified->SetMarkerStyle(markerStyles[3]);
+    graph4_sparsified->SetMarkerSize(markerSizes[3]);
+  }
+
+  TH1* dummyHistogram_top = new TH1D("dummyHistogram_top", "dummyHistogram_top", numBinsX, xMin, xMax);
+  dummyHistogram_top->SetTitle("");
+  dummyHistogram_top->SetStats(false);
+  assert(yMax > yMin);
+  dummyHistogram_top->SetMinimum(yMin);
+  dummyHistogram_top->SetMaximum(yMax);
+
+  TAxis* xAxis_top = dummyHistogram_top->GetXaxis();
+  xAxis_top->SetTitle(xAxisTitle.data());
+  xAxis_top->SetTitleOffset(xAxisOffset);
+  xAxis_top->SetTitle(xAxisTitle.data());
+  xAxis_top->SetTitleOffset(xAxisOffset);
+  xAxis_top->SetTitleSize(60);
+  xAxis_top->SetTitleFont(43);
+  //xAxis_top->SetLabelOffset(-0.01);
+  xAxis_top->SetLabelSize(0.050);
+  xAxis_top->SetLabelFont(42);
+  xAxis_top->SetTickLength(0.040);
+  xAxis_top->SetNdivisions(505);
+  xAxis_top->SetLabelColor(10);
+  xAxis_top->SetTitleColor(10);
+
+  TAxis* yAxis_top = dummyHistogram_top->GetYaxis();
+  yAxis_top->SetTitle(yAxisTitle.data());
+  yAxis_top->SetTitleOffset(yAxisOffset);
+  yAxis_top->SetTitleSize(60);
+  yAxis_top->SetTitleFont(43);
+  //yAxis_top->SetLabelOffset(0.010);
+  yAxis_top->SetLabelSize(0.055);
+  yAxis_top->SetLabelFont(42);
+  yAxis_top->SetTickLength(0.040);  
+  yAxis_top->SetNdivisions(505);
+  
+  dummyHistogram_top->Draw("axis");
+  graphRef_sparsified->Draw(drawOptions[0].data());
+  graph2_sparsified->Draw(drawOptions[1].data());
+  if ( graph3_sparsified ) graph3_sparsified->Draw(drawOptions[2].data());
+  if ( graph4_sparsified ) graph4_sparsified->Draw(drawOptions[3].data());
+  dummyHistogram_top->Draw("axissame");
+
+  TPaveText* label = nullptr;
+  if ( labelText != "" ) {
+    label = new TPaveText(labelPosX, labelPosY, labelPosX + labelSizeX, labelPosY + labelSizeY, "NDC");
+    label->SetFillStyle(0);
+    label->SetBorderSize(0);
+    label->AddText(labelText.data());
+    label->SetTextFont(42);
+    label->SetTextSize(labelTextSize);
+    label->SetTextColor(1);
+    label->SetTextAlign(13);
+    label->Draw();
+  }
+
+  TLegend* legend = nullptr;
+  if ( legendEntryRef != "" && legendEntry2 != "" ) {
+    legend = new TLegend(legendPosX, legendPosY, legendPosX + legendSizeX, legendPosY + legendSizeY, NULL, "brNDC");
+    legend->SetFillColor(10);
+    legend->SetFillStyle(0);
+    legend->SetBorderSize(0);
+    legend->SetTextFont(42);
+    legend->SetTextSize(legendTextSize);
+    legend->SetTextColor(1);
+    legend->SetMargin(0.20);
+    legend->AddEntry(graphRef_sparsified, legendEntryRef.data(), legendOptions[0].data());
+    legend->AddEntry(graph2_sparsified, legendEntry2.data(), legendOptions[1].data());
+    if ( graph3_sparsified ) legend->AddEntry(graph3_sparsified, legendEntry3.data(), legendOptions[2].data());
+    if ( graph4_sparsified ) legend->AddEntry(graph4_sparsified, legendEntry4.data(), legendOptions[3].data());
+    legend->Draw();
+  }
+
+  canvas->cd();
+
+  const double bottomPad_x0 = 0.;
+  const double bottomPad_x1 = 1.;
+  const double bottomPad_y0 = 0.;
+  const double bottomPad_y1 = bottomPad_y0 + bottomPad_sizeY/sum_sizeY;
+  assert(bottomPad_x1 > bottomPad_x0 && bottomPad_y1 > bottomPad_y0);
+
+  TPad* bottomPad = new TPad("bottomPad", "bottomPad", bottomPad_x0, bottomPad_y0, bottomPad_x1, bottomPad_y1);
+  bottomPad->SetFillColor(10);
+  bottomPad->SetBorderSize(0);
+  bottomPad->SetTopMargin(0.000);
+  bottomPad->SetLeftMargin(margin_left);
+  bottomPad->SetBottomMargin(margin_bottom*topPad_sizeY/bottomPad_sizeY);
+  bottomPad->SetRightMargin(margin_right);
+  bottomPad->SetLogx(false);
+  bottomPad->SetLogy(false);
+  bottomPad->Draw();
+  bottomPad->cd();
+
+  TH1* dummyHistogram_bottom = new TH1D("dummyHistogram_bottom", "dummyHistogram_bottom", numBinsX, xMin, xMax);
+  dummyHistogram_bottom->SetTitle("");
+  dummyHistogram_bottom->SetStats(false);
+
+  TGraph* graphRatio2_sparsified = compRatioGraph(graph2_sparsified, graphRef_sparsified);
+  copyGraphStyle(graph2_sparsified, graphRatio2_sparsified);
+
+  TGraph* graphRatio3_sparsified = nullptr;
+  if ( graph3_sparsified ) {
+    graphRatio3_sparsified = compRatioGraph(graph3_sparsified, graphRef_sparsified);
+    copyGraphStyle(graph3_sparsified, graphRatio3_sparsified);
+  }
+
+  TGraph* graphRatio4_sparsified = nullptr;
+  if ( graph4_sparsified ) {
+    graphRatio4_sparsified = compRatioGraph(graph4_sparsified, graphRef_sparsified);
+    copyGraphStyle(graph4_sparsified, graphRatio4_sparsified);
+  }
+
+  TAxis* xAxis_bottom = dummyHistogram_bottom->GetXaxis();
+  xAxis_bottom->SetTitle(xAxisTitle.data());
+  xAxis_bottom->SetTitleOffset(xAxisOffset);
+  xAxis_bottom->SetTitleSize(60);
+  xAxis_bottom->SetTitleFont(43);
+  //xAxis_bottom->SetLabelOffset(-0.01);
+  xAxis_bottom->SetLabelSize(0.132);
+  xAxis_bottom->SetLabelFont(42);
+  xAxis_bottom->SetTickLength(0.105);
+  xAxis_bottom->SetNdivisions(505);
+
+  TAxis* yAxis_bottom = dummyHistogram_bottom->GetYaxis();
+  yAxis_bottom->SetTitle("Ratio");
+  yAxis_bottom->SetTitleOffset(yAxisOffset);
+  yAxis_bottom->SetTitleSize(60);
+  yAxis_bottom->SetTitleFont(43);
+  //yAxis_bottom->SetLabelOffset(0.010);
+  yAxis_bottom->SetLabelSize(0.132);
+  yAxis_bottom->SetLabelFont(42);
+  yAxis_bottom->SetTickLength(0.060);
+  yAxis_bottom->SetNdivisions(505);
+
+  dummyHistogram_bottom->SetMinimum(yMin_ratio);
+  dummyHistogram_bottom->SetMaximum(yMax_ratio);
+
+  dummyHistogram_bottom->Draw("axis");
+
+  TGraph* graph_line = new TGraph(2);
+  graph_line->SetPoint(0, xAxis_bottom->GetXmin(), 1.);
+  graph_line->SetPoint(1, xAxis_bottom->GetXmax(), 1.);
+  graph_line->SetLineColor(colors[0]);
+  graph_line->SetLineStyle(lineStyles[0]);
+  graph_line->SetLineWidth(lineWidths[0]);
+  graph_line->Draw("L");
+
+  graphRatio2_sparsified->Draw(drawOptions[1].data());
+  if ( graphRatio3_sparsified ) graphRatio3_sparsified->Draw(drawOptions[2].data());
+  if ( graphRatio4_sparsified ) graphRatio4_sparsified->Draw(drawOptions[3].data());
+  dummyHistogram_bottom->Draw("axissame");
+
+  canvas->Update();
+
+  std::string outputFileName_plot = "plots/";
+  size_t idx = outputFileName.find_last_of('.');
+  outputFileName_plot.append(std::string(outputFileName, 0, idx));
+  //if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
+  if ( makePlots_png  ) canvas->Print(std::string(outputFileName_plot).append(".png").data());
+  if ( makePlots_pdf  ) canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  if ( makePlots_root ) canvas->Print(std::string(outputFileName_plot).append(".root").data());
+
+  delete label;
+  delete legend;
+  delete dummyHistogram_top;
+  delete dummyHistogram_bottom;
+  delete graphRef_sparsified;
+  delete graph2_sparsified;
+  delete graphRatio2_sparsified;
+  delete graph3_sparsified;
+  delete graphRatio3_sparsified;
+  delete graph4_sparsified;
+  delete graphRatio4_sparsified;
+  delete graph_line;
+  delete canvas;
+}
+
+void renderPlots(const std::vector<plotJobType>& plotJobs, MEMbbwwHistogramCache* histogramCache, unsigned numProcesses)
+{
+  if ( numProcesses == 0 ) numProcesses = std::max(1u, std::thread::hardware_concurrency());
+  numProcesses = std::min(numProcesses, (unsigned)plotJobs.size());
+  if ( numProcesses <= 1 ) {
+    for ( const plotJobType& plotJob : plotJobs ) {
+      plotJob(histogramCache);
+    }
+    return;
+  }
+
+  // index of the next job to be rendered, shared by all worker processes
+  void* sharedMemory = mmap(nullptr, sizeof(std::atomic<unsigned>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if ( sharedMemory == MAP_FAILED )
+    throw cms::Exception("renderPlots")
+      << "Failed to allocate shared memory !!\n";
+  std::atomic<unsigned>* nextJob = new (sharedMemory) std::atomic<unsigned>(0);
+
+  // flush output buffers, so that their content is not written again by the worker processes
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(nullptr);
+
+  std::vector<pid_t> workers;
+  for ( unsigned idxProcess = 0; idxProcess < numProcesses; ++idxProcess ) {
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+      std::cerr << "Failed to start worker process #" << idxProcess << " --> rendering plots with " << workers.size() << " processes." << std::endl;
+      break;
+    }
+    if ( pid == 0 ) {
+      int status = 0;
+      try {
+        for ( unsigned idxJob = (*nextJob)++; idxJob < plotJobs.size(); idxJob = (*nextJob)++ ) {
+          plotJobs[idxJob](histogramCache);
+        }
+      } catch ( const std::exception& exception ) {
+        std::cerr << "Worker process #" << idxProcess << " failed: " << exception.what() << std::endl;
+        status = 1;
+      }
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(nullptr);
+      // skip the cleanup of ROOT and of the objects owned by the calling process, which is done by the calling process
+      _exit(status);
+    }
+    workers.push_back(pid);
+  }
+  // render plots in the calling process in case no worker process could be started
+  if ( workers.empty() ) {
+    for ( unsigned idxJob = (*nextJob)++; idxJob < plotJobs.size(); idxJob = (*nextJob)++ ) {
+      plotJobs[idxJob](histogramCache);
+    }
+  }
+
+  unsigned numFailures = 0;
+  for ( pid_t pid : workers ) {
+    int status = 0;
+    if ( waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) ++numFailures;
+  }
+  munmap(sharedMemory, sizeof(std::atomic<unsigned>));
+  if ( numFailures > 0 )
+    throw cms::Exception("renderPlots")
+      << numFailures << " out of " << workers.size() << " worker processes failed !!\n";
+}
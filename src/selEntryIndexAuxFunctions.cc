@@ -0,0 +1,53 @@
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/selEntryIndexAuxFunctions.h"
+
+#include "FWCore/Utilities/interface/Exception.h" // cms::Exception
+
+#include <fstream> // std::ifstream
+#include <cstdio> // std::rename
+
+namespace
+{
+  Long64_t
+  readSelEntry(std::ifstream & selEntryIndexFile, const std::string & selEntryIndexFileName, Long64_t idx)
+  {
+    Long64_t selEntry = -1;
+    selEntryIndexFile.seekg(idx*sizeof(selEntry));
+    if ( !selEntryIndexFile.read(reinterpret_cast<char *>(&selEntry), sizeof(selEntry)) )
+      throw cms::Exception("getSelEntryRange")
+        << "Failed to read entry #" << idx << " from index file = " << selEntryIndexFileName << " !!\n";
+    return selEntry;
+  }
+}
+
+void
+getSelEntryRange(const std::string & selEntryIndexFileName, int rangeIdx, int maxSelEvents, Long64_t & firstSelEntry, Long64_t & lastSelEntry)
+{
+  if ( rangeIdx < 0 || maxSelEvents <= 0 )
+    throw cms::Exception("getSelEntryRange")
+      << "Invalid range #" << rangeIdx << " of " << maxSelEvents << " selected entries !!\n";
+  std::ifstream selEntryIndexFile(selEntryIndexFileName.data(), std::ios::in | std::ios::binary);
+  if ( !selEntryIndexFile )
+    throw cms::Exception("getSelEntryRange")
+      << "Failed to open index file = " << selEntryIndexFileName << " !!\n";
+  selEntryIndexFile.seekg(0, std::ios::end);
+  const Long64_t numSelEntries = selEntryIndexFile.tellg()/(Long64_t)sizeof(Long64_t);
+
+  const Long64_t idxFirst = (Long64_t)rangeIdx*maxSelEvents;
+  const Long64_t idxLast = idxFirst + maxSelEvents;
+  if ( idxFirst >= numSelEntries ) {
+    firstSelEntry = 0;
+    lastSelEntry = 0;
+    return;
+  }
+  firstSelEntry = readSelEntry(selEntryIndexFile, selEntryIndexFileName, idxFirst);
+  lastSelEntry = ( idxLast < numSelEntries ) ? readSelEntry(selEntryIndexFile, selEntryIndexFileName, idxLast) : -1;
+}
+
+void
+commitOutputFile(const std::string & fileName)
+{
+  const std::string fileName_tmp = fileName + ".tmp";
+  if ( std::rename(fileName_tmp.data(), fileName.data()) != 0 )
+    throw cms::Exception("commitOutputFile")
+      << "Failed to rename file = " << fileName_tmp << " to " << fileName << " !!\n";
+}
@@ -0,0 +1,50 @@
+#!/bin/bash
+#
+# Check that the MEM ntuples do not depend on the number of processes used for the MEM integrations.
+#
+# The analyzer is run on the same configuration file with numProcesses = 1 and with numProcesses = N,
+# the latter with parallelHypotheses disabled and enabled,
+# and the MEM ntuples of the jobs are compared entry by entry (excluding the CPU time columns).
+# Run this check whenever the MEM algorithms or the MEMbbwwProcessPool are updated.
+#
+# E.g.: ./checkProcessInvariance.sh analyze_hh_bbwwMEM_dilepton analyze_hh_bbwwMEM_dilepton_cfg.py 8
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 analyzer cfgFile [numProcesses]"
+  exit 1
+fi
+
+ANALYZER=$1
+CFG_FILE=$2
+NUM_PROCESSES=${3:-4}
+
+WORK_DIR=$(mktemp -d)
+trap "rm -rf $WORK_DIR" EXIT
+
+# run the analyzer on a copy of the configuration file, with the parameters that influence the parallelization overwritten;
+# the result cache and checkpoints are disabled, so that all MEM results are computed by the job itself
+run_analyzer() {
+  local label=$1
+  local numProcesses=$2
+  local parallelHypotheses=$3
+  local cfgFile=$WORK_DIR/cfg_$label.py
+  cp $CFG_FILE $cfgFile
+  cat >> $cfgFile <<EOF_CFG
+
+process.fwliteOutput.fileName = cms.string('$WORK_DIR/$label.root')
+process.$(basename $ANALYZER).numProcesses = cms.uint32($numProcesses)
+process.$(basename $ANALYZER).parallelHypotheses = cms.bool($parallelHypotheses)
+process.$(basename $ANALYZER).memResultCacheDir = cms.string('')
+process.$(basename $ANALYZER).checkpointInterval = cms.int32(0)
+EOF_CFG
+  echo "running $ANALYZER with numProcesses = $numProcesses, parallelHypotheses = $parallelHypotheses"
+  $ANALYZER $cfgFile > $WORK_DIR/$label.log 2>&1 || { echo "$ANALYZER failed, see log:"; tail -20 $WORK_DIR/$label.log; exit 1; }
+}
+
+run_analyzer numProcesses1 1 False
+run_analyzer numProcesses$NUM_PROCESSES $NUM_PROCESSES False
+run_analyzer numProcesses${NUM_PROCESSES}_parallelHypotheses $NUM_PROCESSES True
+
+compareMEMNtuples $WORK_DIR/numProcesses1.root $WORK_DIR/numProcesses$NUM_PROCESSES.root || { echo "MEM ntuples depend on the number of processes !!"; exit 1; }
+compareMEMNtuples $WORK_DIR/numProcesses1.root $WORK_DIR/numProcesses${NUM_PROCESSES}_parallelHypotheses.root || { echo "MEM ntuples depend on option parallelHypotheses !!"; exit 1; }
+echo "MEM ntuples are identical for numProcesses = 1 and numProcesses = $NUM_PROCESSES, with parallelHypotheses disabled and enabled"
@@ -12,6 +12,18 @@ parser = tthAnalyzeParser()
 parser.add_rle_select()
 parser.add_files_per_job(1) # CV: need to reduce number of Ntuple files processed per job, as computation of MEM takes considerable time
 parser.add_use_home()
+parser.add_argument('--single-pass',
+  dest = 'single_pass', action = 'store_true', default = False,
+  help = 'R|Process all jet and MET smearing options in the same job (reading each Ntuple only once)',
+)
+parser.add_argument('--use-skim',
+  dest = 'use_skim', action = 'store_true', default = False,
+  help = 'R|Read the events passing the generator-level selection from compact skim files instead of from the Ntuples',
+)
+parser.add_argument('--sparse-histograms',
+  dest = 'use_sparse_histograms', action = 'store_true', default = False,
+  help = 'R|Store the finely binned MEM histograms as THnSparse (converted to TH1 by the plotting macros)',
+)
 args = parser.parse_args()
 
 # Common arguments
@@ -29,6 +41,9 @@ running_method     = args.running_method
 rle_select        = os.path.expanduser(args.rle_select)
 files_per_job     = args.files_per_job
 use_home          = args.use_home
+single_pass       = args.single_pass
+use_skim          = args.use_skim
+use_sparse_histograms = args.use_sparse_histograms
 
 if era == "2016":
   from hhAnalysis.bbwwMEMPerformanceStudies.samples.hhAnalyzeSamples_singlelepton_2016 import samples_2016 as samples
@@ -62,6 +77,9 @@ if __name__ == '__main__':
     check_output_files                    = check_output_files,
     running_method                        = running_method,
     num_parallel_jobs                     = num_parallel_jobs,
+    single_pass                           = single_pass,
+    use_skim                              = use_skim,
+    use_sparse_histograms                 = use_sparse_histograms,
     select_rle_output                     = True,
     isDebug                               = debug,
     rle_select                            = rle_select,
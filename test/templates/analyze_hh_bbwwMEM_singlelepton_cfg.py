@@ -23,9 +23,72 @@ process.fwliteOutput = cms.PSet(
 process.analyze_hh_bbwwMEM_singlelepton = cms.PSet(
     treeName = cms.string('Events'),
 
-    skipSelEvents = cms.int32(0),
     maxSelEvents = cms.int32(1000),
 
+    # range [firstSelEntry, lastSelEntry) of entries to be processed (lastSelEntry = -1: process all entries up to the end)
+    firstSelEntry = cms.int32(0),
+    lastSelEntry = cms.int32(-1),
+    # write index of entries passing the generator-level selection to selEntryIndexFileName, instead of computing the MEM
+    # (the index and skim files are written with the suffix '.tmp', which is removed once the job has finished successfully)
+    makeSelEntryIndex = cms.bool(False),
+    selEntryIndexFileName = cms.string(''),
+    # read the range [firstSelEntry, lastSelEntry) from the index file selEntryIndexFileName (disabled if < 0):
+    # the range contains the selected entries selEntryRangeIdx*maxSelEvents, ..., (selEntryRangeIdx + 1)*maxSelEvents - 1
+    selEntryRangeIdx = cms.int32(-1),
+    # write generator-level objects, weights and event identifiers of events passing the generator-level selection to the compact skim file
+    # skimFileName_output, or read the events from the skim file skimFileName_input instead of from the Ntuples
+    skimFileName_output = cms.string(''),
+    skimFileName_input = cms.string(''),
+    # book and fill the histograms of generator-level particles and LHE weights (genEvt and lheInfo directories);
+    # they need the full Ntuples and have to be disabled when the events are read from a skim file
+    fillGenHistograms = cms.bool(True),
+    # write checkpoint every checkpointInterval selected events (disabled if <= 0);
+    # a pre-empted job is resumed from its last checkpoint by running the analyzer with the option --resume
+    checkpointInterval = cms.int32(0),
+
+    # number of worker processes used for computing the MEM (1 = run MEM integrations in the main process);
+    # the MEM algorithms keep global state (integrand pointer used by VEGAS/VAMP, MadGraph parameter cards, LHAPDF),
+    # so concurrent integrations need to run in separate processes
+    numProcesses = cms.uint32(1),
+    # send the integrations for the different hypotheses (full, missing jet cases) of the same event to different worker processes
+    parallelHypotheses = cms.bool(False),
+
+    # number of integrand evaluations for signal and background hypotheses
+    maxObjFunctionCalls_signal = cms.int32(1000),
+    maxObjFunctionCalls_background = cms.int32(10000),
+    # signal and background hypotheses are integrated in separate calls, in order to measure their CPU time individually;
+    # number of integrand evaluations used for the hypothesis whose result is discarded in each call
+    maxObjFunctionCalls_inactive = cms.int32(100),
+    # adaptive integration (enabled if memLRerrTarget > 0): the first integration uses maxObjFunctionCalls_*_initial evaluations,
+    # further integrations are run with the number of evaluations expected to bring the relative uncertainty memLRerr/memLR
+    # below memLRerrTarget and are combined with the previous ones by inverse-variance weighting,
+    # until the target is reached or the total number of evaluations reaches maxObjFunctionCalls_signal_max and maxObjFunctionCalls_background_max
+    memLRerrTarget = cms.double(-1.),
+    maxObjFunctionCalls_signal_initial = cms.int32(250),
+    maxObjFunctionCalls_background_initial = cms.int32(2500),
+    maxObjFunctionCalls_signal_max = cms.int32(16000),
+    maxObjFunctionCalls_background_max = cms.int32(160000),
+    # directory of on-disk cache of MEM results (disabled if empty);
+    # results are looked up by the content of the MEM inputs and settings and by the build of the hhAnalysis/bbwwMEM library,
+    # so the cache can be shared by different jobs
+    memResultCacheDir = cms.string(''),
+    # output settings of the MEM ntuples:
+    # compression algorithm ('ZLIB', 'LZMA', 'LZ4' or 'ZSTD'; empty: use compression settings of the output file) and level (1-9),
+    # basket size in bytes (<= 0: ROOT default), auto-flush, which defines the cluster size of the TTree
+    # (> 0: number of entries, < 0: number of bytes, 0: ROOT default)
+    memNtupleWriteOptions = cms.PSet(
+        compressionAlgorithm = cms.string(''),
+        compressionLevel = cms.int32(4),
+        basketSize = cms.int32(0),
+        autoFlush = cms.int64(0),
+        # 'Double_t', 'Double32_t' (likelihood ratio only, probabilities stay Double_t) or 'logFloat_t'
+        memResultEncoding = cms.string('Double_t'),
+        memResultMantissaBits = cms.uint32(14)
+    ),
+    # store the finely binned MEM histograms (memLR, memScore, log_memProb, ...) as THnSparse,
+    # which only allocates memory for filled bins; the plotting macros convert them to TH1
+    useSparseHistograms = cms.bool(False),
+
     process = cms.string(''),
     histogramDir = cms.string(''),
     era = cms.string('2017'),
@@ -35,6 +98,11 @@ process.analyze_hh_bbwwMEM_singlelepton = cms.PSet(
     apply_metSmearing = cms.bool(True),
     metSmearing_sigmaX = cms.double(25.),
     metSmearing_sigmaY = cms.double(25.),
+    # process several smearing variants in one job, reading the input files and running the generator-level selection only once;
+    # each entry is a PSet with the parameters apply_jetSmearing, apply_metSmearing and histogramDir
+    # (if empty, the smearing is applied according to the parameters apply_jetSmearing and apply_metSmearing given above)
+    smearingVariants = cms.VPSet(),
+    randomSeed = cms.uint32(12345),
 
     apply_genWeight = cms.bool(True),
     hasLHE = cms.bool(True),
@@ -0,0 +1,103 @@
+#include "DataFormats/Math/interface/LorentzVector.h" // math::PtEtaPhiMLorentzVector
+
+#include "hhAnalysis/bbwwMEM/interface/memAuxFunctions.h" // mem::LorentzVector, mem::bottomQuarkMass
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/BJetTF_toy.h" // mem::BJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/HadWJetTF_toy.h" // mem::HadWJetTF_toy
+#include "hhAnalysis/bbwwMEMPerformanceStudies/interface/JetTF_kernels.h" // mem::BJetTF_kernel, mem::HadWJetTF_kernel
+
+#include <iostream> // std::cout
+#include <string> // std::string
+#include <vector> // std::vector<>
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <algorithm> // std::max()
+#include <cmath> // std::fabs
+
+namespace
+{
+  /**
+   * @brief Compare the scalar and batch versions of the Eval method of a transfer function kernel
+   *        with the transfer function it replaces, point by point
+   * @return Number of points for which the relative difference exceeds the tolerance
+   */
+  template <class T_tf, class T_tf_kernel>
+  int
+  compare(const std::string & label, const T_tf& tf, const T_tf_kernel& tf_kernel, const std::vector<double>& trueEn)
+  {
+    const double tolerance = 1.e-12;
+    const size_t numPoints = trueEn.size();
+    std::vector<double> prob(numPoints);
+    std::vector<double> prob_kernel(numPoints);
+    tf.Eval(trueEn.data(), prob.data(), numPoints);
+    tf_kernel.Eval(trueEn.data(), prob_kernel.data(), numPoints);
+
+    int numErrors = 0;
+    for ( size_t idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+      const double values[] = { tf.Eval(trueEn[idxPoint]), prob[idxPoint], tf_kernel.Eval(trueEn[idxPoint]), prob_kernel[idxPoint] };
+      const double value_ref = values[0];
+      for ( double value : values ) {
+        const double diff = std::fabs(value - value_ref);
+        if ( diff > tolerance*std::max(std::fabs(value_ref), 1.e-300) && diff > 0. ) {
+          std::cout << label << ": trueEn = " << trueEn[idxPoint] << ","
+                    << " scalar = " << values[0] << ", batch = " << values[1] << ","
+                    << " kernel scalar = " << values[2] << ", kernel batch = " << values[3] << " !!" << std::endl;
+          ++numErrors;
+          break;
+        }
+      }
+    }
+    return numErrors;
+  }
+}
+
+/**
+ * @brief Check that BJetTF_kernel<BJetTFKernel_toy> and HadWJetTF_kernel<HadWJetTFKernel_toy>
+ *        compute the same values as BJetTF_toy and HadWJetTF_toy.
+ */
+int main()
+{
+//--- true energies from zero to well above the measured energy, including values just below and above the b-quark mass
+  std::vector<double> trueEn;
+  for ( int idxPoint = 0; idxPoint <= 1000; ++idxPoint ) {
+    trueEn.push_back(0.5*idxPoint);
+  }
+  trueEn.push_back(mem::bottomQuarkMass);
+  trueEn.push_back(0.999*mem::bottomQuarkMass);
+  trueEn.push_back(1.001*mem::bottomQuarkMass);
+
+  const double measuredPts[] = { 20., 50., 150. };
+  const double measuredEtas[] = { 0., 1.2, -2.4 };
+  const double coeffs[] = { 0.5, 1.00, 2.0 };
+
+  int numErrors = 0;
+  int numChecks = 0;
+  for ( double measuredPt : measuredPts ) {
+    for ( double measuredEta : measuredEtas ) {
+      const math::PtEtaPhiMLorentzVector measuredP4_ptEtaPhiM(measuredPt, measuredEta, 0.3, mem::bottomQuarkMass);
+      const mem::LorentzVector measuredP4(measuredP4_ptEtaPhiM);
+      for ( double coeff : coeffs ) {
+        const std::string label = "pT = " + std::to_string(measuredPt) + ", eta = " + std::to_string(measuredEta) + ", coeff = " + std::to_string(coeff);
+
+        mem::BJetTF_toy bjetTF;
+        bjetTF.set_coeff(coeff);
+        bjetTF.setInputs(measuredP4);
+        const mem::jetTF::ResolutionSqrtPt bjetTF_resolution(coeff);
+        mem::BJetTF_kernel<mem::BJetTFKernel_toy> bjetTF_kernel(bjetTF_resolution);
+        bjetTF_kernel.setInputs(measuredP4);
+        numErrors += compare("BJetTF (" + label + ")", bjetTF, bjetTF_kernel, trueEn);
+
+        mem::HadWJetTF_toy hadWJetTF;
+        hadWJetTF.set_coeff(coeff);
+        hadWJetTF.setInputs(measuredP4);
+        const mem::jetTF::ResolutionInvSqrtPt hadWJetTF_resolution(coeff);
+        mem::HadWJetTF_kernel<mem::HadWJetTFKernel_toy> hadWJetTF_kernel(hadWJetTF_resolution);
+        hadWJetTF_kernel.setInputs(measuredP4);
+        numErrors += compare("HadWJetTF (" + label + ")", hadWJetTF, hadWJetTF_kernel, trueEn);
+
+        numChecks += 2*trueEn.size();
+      }
+    }
+  }
+
+  std::cout << "<testJetTFKernels>: " << numErrors << " of " << numChecks << " points differ." << std::endl;
+  return ( numErrors == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}